@@ -0,0 +1,49 @@
+#ifndef ATOMIC_OPS_H
+#define ATOMIC_OPS_H
+
+/***************************************************************************************************
+Atomic Operations.
+
+Thin wrappers around the Windows Interlocked functions so the lock-free pieces of the camera
+pipeline (triple buffer, frame pool, counters) can also be built and exercised on Linux with GCC.
+Every operation is a full memory barrier.
+****************************************************************************************************/
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+typedef volatile LONG atomic_long_t;
+
+#define ATOMIC_LOAD(p)                  InterlockedCompareExchange((p), 0, 0)
+#define ATOMIC_STORE(p, v)              ((void)InterlockedExchange((p), (LONG)(v)))
+#define ATOMIC_EXCHANGE(p, v)           InterlockedExchange((p), (LONG)(v))
+#define ATOMIC_COMPARE_EXCHANGE(p, v, c) InterlockedCompareExchange((p), (LONG)(v), (LONG)(c)) // Returns the previous value
+#define ATOMIC_INCREMENT(p)             InterlockedIncrement(p) // Returns the new value
+#define ATOMIC_DECREMENT(p)             InterlockedDecrement(p) // Returns the new value
+#define ATOMIC_ADD(p, v)                InterlockedExchangeAdd((p), (LONG)(v)) // Returns the previous value
+
+// 64-bit counters (volatile int64_t), atomic on 32-bit Windows too
+#define ATOMIC_LOAD64(p)                InterlockedCompareExchange64((volatile LONG64 *)(p), 0, 0)
+#define ATOMIC_COMPARE_EXCHANGE64(p, v, c) InterlockedCompareExchange64((volatile LONG64 *)(p), (LONG64)(v), (LONG64)(c)) // Returns the previous value
+#define ATOMIC_ADD64(p, v)              InterlockedExchangeAdd64((volatile LONG64 *)(p), (LONG64)(v)) // Returns the previous value
+
+#else
+
+typedef volatile long atomic_long_t;
+
+#define ATOMIC_LOAD(p)                  __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE(p, v)              __atomic_store_n((p), (long)(v), __ATOMIC_SEQ_CST)
+#define ATOMIC_EXCHANGE(p, v)           __atomic_exchange_n((p), (long)(v), __ATOMIC_SEQ_CST)
+#define ATOMIC_COMPARE_EXCHANGE(p, v, c) __sync_val_compare_and_swap((p), (long)(c), (long)(v))
+#define ATOMIC_INCREMENT(p)             __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_DECREMENT(p)             __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_ADD(p, v)                __atomic_fetch_add((p), (long)(v), __ATOMIC_SEQ_CST)
+
+#define ATOMIC_LOAD64(p)                __atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define ATOMIC_COMPARE_EXCHANGE64(p, v, c) __sync_val_compare_and_swap((p), (int64_t)(c), (int64_t)(v))
+#define ATOMIC_ADD64(p, v)              __atomic_fetch_add((p), (int64_t)(v), __ATOMIC_SEQ_CST)
+
+#endif
+
+#endif
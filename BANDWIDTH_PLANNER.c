@@ -0,0 +1,101 @@
+#include "BANDWIDTH_PLANNER.h"
+
+/***************************************************************************************************
+Bandwidth Planner Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define BANDWIDTH_UNLIMITED	1e300
+
+double BandwidthDemand(const struct bandwidth_request_s *request, double overhead);
+
+// Bytes per second the camera wants, overhead included, BANDWIDTH_UNLIMITED if it has no limit at all
+double BandwidthDemand(const struct bandwidth_request_s *request, double overhead) {
+	
+	double fps = request->RequestedFps;
+	
+	if (request->MaxFps > 0 && (fps <= 0 || fps > request->MaxFps)) fps = request->MaxFps;
+	
+	double demand = (fps > 0) ? (double)request->PayloadBytes * (1.0 + overhead) * fps : BANDWIDTH_UNLIMITED;
+	
+	if (request->LinkMaxBytesPerSec > 0 && demand > request->LinkMaxBytesPerSec) demand = request->LinkMaxBytesPerSec;
+	
+	return demand;
+}
+
+/***************************************************************************************************
+Plan
+****************************************************************************************************/
+
+int BandwidthPlan(const struct bandwidth_request_s *requests, int numCameras, double budgetBytesPerSec,
+				  double overhead, struct bandwidth_plan_s *plans) {
+	
+	double demand[BANDWIDTH_PLAN_MAX_CAMERAS];
+	double weight[BANDWIDTH_PLAN_MAX_CAMERAS];
+	int settled[BANDWIDTH_PLAN_MAX_CAMERAS];
+	
+	if (numCameras < 1 || numCameras > BANDWIDTH_PLAN_MAX_CAMERAS || budgetBytesPerSec <= 0 || overhead < 0) return CANCEL;
+	
+	for (int i = 0; i < numCameras; i++) {
+		
+		if (requests[i].PayloadBytes <= 0) return CANCEL;
+		
+		demand[i]  = BandwidthDemand(&requests[i], overhead);
+		weight[i]  = (requests[i].Weight > 0) ? requests[i].Weight : 1;
+		settled[i] = FALSE;
+		
+		plans[i].BytesPerSec = 0;
+		plans[i].Limited     = FALSE;
+	}
+	
+	// Water filling: settle every camera that wants less than its share, share out the rest again
+	double remaining = budgetBytesPerSec;
+	int unsettled = numCameras;
+	int changed = TRUE;
+	
+	while (unsettled > 0 && changed) {
+		
+		double weights = 0;
+		for (int i = 0; i < numCameras; i++) if (!settled[i]) weights += weight[i];
+		
+		double perWeight = remaining / weights;
+		changed = FALSE;
+		
+		for (int i = 0; i < numCameras; i++) {
+			
+			if (settled[i] || demand[i] > perWeight * weight[i]) continue;
+			
+			plans[i].BytesPerSec = demand[i];
+			remaining -= demand[i];
+			settled[i] = TRUE;
+			unsettled--;
+			changed = TRUE;
+		}
+		
+		if (changed) continue;
+		
+		// Everybody left wants more than its share
+		for (int i = 0; i < numCameras; i++) {
+			
+			if (settled[i]) continue;
+			
+			plans[i].BytesPerSec = perWeight * weight[i];
+			plans[i].Limited     = TRUE;
+		}
+	}
+	
+	int limited = 0;
+	
+	for (int i = 0; i < numCameras; i++) {
+		
+		plans[i].Fps = plans[i].BytesPerSec / ((double)requests[i].PayloadBytes * (1.0 + overhead));
+		
+		if (plans[i].Limited) limited++;
+	}
+	
+	return limited;
+}
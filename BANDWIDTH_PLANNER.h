@@ -0,0 +1,43 @@
+#ifndef BANDWIDTH_PLANNER_H
+#define BANDWIDTH_PLANNER_H
+
+#include <stdint.h>
+
+/***************************************************************************************************
+Bandwidth planner. Cameras sharing one link (NIC, switch uplink, USB hub) split its budget:
+
+ 1. Each camera wants payload x frame rate (its requested rate, or the fastest it can go), plus the
+    protocol overhead, never more than its own link limit.
+ 2. If everything fits, everybody gets what it wants.
+ 3. Otherwise the budget is shared max-min fair by weight: cameras wanting less than their share
+    get all of it, the rest split what is left in proportion to their weights.
+
+Pure arithmetic, no camera access, so the plan can be checked without hardware.
+****************************************************************************************************/
+
+#define BANDWIDTH_PLAN_MAX_CAMERAS	16
+#define BANDWIDTH_DEFAULT_OVERHEAD	0.05	// GVSP/IP/UDP headers and resends, fraction of the payload
+
+struct bandwidth_request_s {
+	int64_t PayloadBytes;			// Bytes per frame
+	double RequestedFps;			// Wanted frame rate, 0 = as fast as possible
+	double MaxFps;					// Fastest the camera can go with its geometry/exposure, 0 = no limit
+	double LinkMaxBytesPerSec;		// Camera's own link limit, 0 = no limit
+	double Weight;					// Share of a congested link, 0 = 1
+};
+
+struct bandwidth_plan_s {
+	double Fps;						// Frame rate to set
+	double BytesPerSec;				// Throughput limit to set, overhead included
+	int Limited;					// TRUE if the shared budget cut it below what it wanted
+};
+
+/***************************************************************************************************
+Bandwidth Planner Public Functions
+****************************************************************************************************/
+
+// Returns the number of cameras limited by the budget, CANCEL (-1) on bad arguments
+int BandwidthPlan(const struct bandwidth_request_s *requests, int numCameras, double budgetBytesPerSec,
+				  double overhead, struct bandwidth_plan_s *plans);
+
+#endif
@@ -1,5 +1,5 @@
-//==============================================================================
-// UI callback function prototypes
-//==============================================================================
-
-int CVICALLBACK MAIN_CALLBACK(int panel, int event, void *callbackData, int eventData1, int eventData2);
+//==============================================================================
+// UI callback function prototypes
+//==============================================================================
+
+int CVICALLBACK MAIN_CALLBACK(int panel, int event, void *callbackData, int eventData1, int eventData2);
@@ -0,0 +1,171 @@
+#include "CAMERA_REGISTRY.h"
+
+/***************************************************************************************************
+Camera Registry Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+struct camera_registry_s CameraRegistry = {0};
+
+void CameraRegistryLock(void);
+void CameraRegistryUnlock(void);
+int CameraRegistryIndexOf(const char *serialNumber);
+
+void CameraRegistryLock(void) {
+	
+	while (ATOMIC_COMPARE_EXCHANGE(&CameraRegistry.Lock, 1, 0) != 0) {
+		// Held only for a few pointer copies, just spin
+	}
+}
+
+void CameraRegistryUnlock(void) {
+	
+	ATOMIC_STORE(&CameraRegistry.Lock, 0);
+}
+
+// Call with the lock held
+int CameraRegistryIndexOf(const char *serialNumber) {
+	
+	for (int i = 0; i < CameraRegistry.Count; i++)
+		if (strcmp((const char *)CameraRegistry.Cameras[i]->SerialNumber, serialNumber) == 0) return i;
+	
+	return -1;
+}
+
+/***************************************************************************************************
+Add / Remove
+****************************************************************************************************/
+
+struct camera_s* CameraRegistryAdd(const char *serialNumber) {
+	
+	if (serialNumber == NULL || strlen(serialNumber) >= sizeof(((struct camera_s *)0)->SerialNumber)) return NULL;
+	
+	// Own cache lines, zeroed like the globals it replaces
+	struct camera_s *cam = (struct camera_s *)AlignedAlloc(sizeof(struct camera_s));
+	if (cam == NULL) return NULL;
+	
+	memset(cam, 0, sizeof(*cam));
+	strcpy((char *)cam->SerialNumber, serialNumber);
+	
+	CameraRegistryLock();
+	
+	if (CameraRegistry.Count >= CAMERA_REGISTRY_MAX || CameraRegistryIndexOf(serialNumber) >= 0) {
+		CameraRegistryUnlock();
+		AlignedFree(cam);
+		return NULL;
+	}
+	
+	// Grow the array, readers hold the lock too so it may move
+	if (CameraRegistry.Count == CameraRegistry.Capacity) {
+		
+		int capacity = CameraRegistry.Capacity ? CameraRegistry.Capacity * 2 : 4;
+		if (capacity > CAMERA_REGISTRY_MAX) capacity = CAMERA_REGISTRY_MAX;
+		
+		struct camera_s **cameras = (struct camera_s **)realloc(CameraRegistry.Cameras, capacity * sizeof(struct camera_s *));
+		
+		if (cameras == NULL) {
+			CameraRegistryUnlock();
+			AlignedFree(cam);
+			return NULL;
+		}
+		
+		CameraRegistry.Cameras  = cameras;
+		CameraRegistry.Capacity = capacity;
+	}
+	
+	CameraRegistry.Cameras[CameraRegistry.Count++] = cam;
+	
+	CameraRegistryUnlock();
+	return cam;
+}
+
+int CameraRegistryRemove(struct camera_s *cam) {
+	
+	int index = -1;
+	
+	CameraRegistryLock();
+	
+	for (int i = 0; i < CameraRegistry.Count; i++) if (CameraRegistry.Cameras[i] == cam) index = i;
+	
+	// Keep the order of the other cameras
+	if (index >= 0) {
+		for (int i = index; i < CameraRegistry.Count - 1; i++) CameraRegistry.Cameras[i] = CameraRegistry.Cameras[i + 1];
+		CameraRegistry.Count--;
+	}
+	
+	CameraRegistryUnlock();
+	
+	if (index < 0) return CANCEL;
+	
+	// Out of the registry, nobody new can find it. Stop it and give its link share to the others.
+	if (cam->IsSnap) StopCameraAcquisition(cam);
+	RemoveFromBandwidthPlan(cam);
+	CloseDevice(cam);
+	
+	AlignedFree(cam);
+	return OK;
+}
+
+void CameraRegistryClear(void) {
+	
+	struct camera_s *cam;
+	
+	while ((cam = CameraRegistryAt(CameraRegistryCount() - 1)) != NULL) CameraRegistryRemove(cam);
+	
+	CameraRegistryLock();
+	free(CameraRegistry.Cameras);
+	CameraRegistry.Cameras  = NULL;
+	CameraRegistry.Capacity = 0;
+	CameraRegistryUnlock();
+}
+
+/***************************************************************************************************
+Lookup / iteration
+****************************************************************************************************/
+
+int CameraRegistryCount(void) {
+	
+	CameraRegistryLock();
+	int count = CameraRegistry.Count;
+	CameraRegistryUnlock();
+	
+	return count;
+}
+
+struct camera_s* CameraRegistryAt(int index) {
+	
+	struct camera_s *cam = NULL;
+	
+	CameraRegistryLock();
+	if (index >= 0 && index < CameraRegistry.Count) cam = CameraRegistry.Cameras[index];
+	CameraRegistryUnlock();
+	
+	return cam;
+}
+
+struct camera_s* CameraRegistryFind(const char *serialNumber) {
+	
+	struct camera_s *cam = NULL;
+	
+	CameraRegistryLock();
+	int index = CameraRegistryIndexOf(serialNumber);
+	if (index >= 0) cam = CameraRegistry.Cameras[index];
+	CameraRegistryUnlock();
+	
+	return cam;
+}
+
+int CameraRegistrySnapshot(struct camera_s **cams, int maxCams) {
+	
+	CameraRegistryLock();
+	
+	int count = (CameraRegistry.Count < maxCams) ? CameraRegistry.Count : maxCams;
+	for (int i = 0; i < count; i++) cams[i] = CameraRegistry.Cameras[i];
+	
+	CameraRegistryUnlock();
+	return count;
+}
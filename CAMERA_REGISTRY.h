@@ -0,0 +1,41 @@
+#ifndef CAMERA_REGISTRY_H
+#define CAMERA_REGISTRY_H
+
+#include "DAHENG_CAMERA_DRIVERS.h"
+
+/***************************************************************************************************
+Camera registry. Every camera of the process lives here instead of in fixed globals. The registry
+owns the struct camera_s, one cache line aligned allocation per camera, so the frame callback,
+polling, reconnect and timer threads of different cameras never write to a shared cache line. Each
+camera keeps its own pipeline, timers and buffers inside its struct.
+
+Cameras are found by index (iteration) or serial number, and can be added and removed while the
+others are acquiring. Add/Find/Snapshot may be called from any thread. A camera pointer stays valid
+until the camera is removed, so remove cameras from the thread that iterates over them (the UI).
+****************************************************************************************************/
+
+#define CAMERA_REGISTRY_MAX		16
+
+struct camera_registry_s {
+	
+	struct camera_s **Cameras;		// Count cameras, room for Capacity
+	int Count;
+	int Capacity;
+	atomic_long_t Lock;				// Spin lock, held for a few pointer copies only
+};
+
+extern struct camera_registry_s CameraRegistry;
+
+/***************************************************************************************************
+Camera Registry Public Functions
+****************************************************************************************************/
+
+struct camera_s* CameraRegistryAdd  (const char *serialNumber); // New zeroed camera, NULL if full or already registered
+int  CameraRegistryRemove (struct camera_s *cam); // Stops and closes the camera, then frees it. OK (1) / CANCEL (-1)
+void CameraRegistryClear  (void); // Removes every camera
+int  CameraRegistryCount  (void);
+struct camera_s* CameraRegistryAt   (int index); // NULL past the end
+struct camera_s* CameraRegistryFind (const char *serialNumber);
+int  CameraRegistrySnapshot (struct camera_s **cams, int maxCams); // Copy of the list for iterating off the UI thread, returns the count
+
+#endif
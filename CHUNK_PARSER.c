@@ -0,0 +1,104 @@
+#include "CHUNK_PARSER.h"
+#include <string.h>
+
+/***************************************************************************************************
+Chunk Parser Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+uint32_t ChunkRead32(const uint8_t *p, int bigEndian);
+uint64_t ChunkRead64(const uint8_t *p, int bigEndian);
+
+// Byte by byte, the chunk data has no alignment
+uint32_t ChunkRead32(const uint8_t *p, int bigEndian) {
+	
+	if (bigEndian) return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+	
+	return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+}
+
+uint64_t ChunkRead64(const uint8_t *p, int bigEndian) {
+	
+	if (bigEndian) return ((uint64_t)ChunkRead32(p, TRUE) << 32) | ChunkRead32(p + 4, TRUE);
+	
+	return ((uint64_t)ChunkRead32(p + 4, FALSE) << 32) | ChunkRead32(p, FALSE);
+}
+
+/***************************************************************************************************
+Parsing
+****************************************************************************************************/
+
+int ChunkParse(const uint8_t *payload, size_t payloadSize, size_t imageBytes, int bigEndian,
+			   struct chunk_entry_s *chunks, int maxChunks) {
+	
+	if (payload == NULL || chunks == NULL || maxChunks <= 0 || imageBytes > payloadSize) return CANCEL;
+	
+	size_t end = payloadSize;
+	int numChunks = 0;
+	
+	while (end != imageBytes && end != 0) {
+		
+		if (end < CHUNK_TRAILER_BYTES || numChunks == maxChunks) return CANCEL;
+		
+		uint32_t id     = ChunkRead32(payload + end - CHUNK_TRAILER_BYTES, bigEndian);
+		uint32_t length = ChunkRead32(payload + end - CHUNK_TRAILER_BYTES + 4, bigEndian);
+		
+		if ((size_t)length > end - CHUNK_TRAILER_BYTES) return CANCEL;
+		
+		end -= CHUNK_TRAILER_BYTES + (size_t)length;
+		
+		// A walk that crosses the end of the image is not chunk data
+		if (end < imageBytes && end != 0) return CANCEL;
+		
+		chunks[numChunks].ID     = id;
+		chunks[numChunks].Length = length;
+		chunks[numChunks].Offset = end;
+		numChunks++;
+	}
+	
+	return numChunks;
+}
+
+int ChunkFind(const struct chunk_entry_s *chunks, int numChunks, uint32_t id) {
+	
+	for (int i = 0; i < numChunks; i++)
+		if (chunks[i].ID == id) return i;
+	
+	return -1;
+}
+
+/***************************************************************************************************
+Values
+****************************************************************************************************/
+
+int ChunkReadInt(const uint8_t *payload, const struct chunk_entry_s *chunk, int bigEndian, int64_t *value) {
+	
+	if (chunk->Length == 8) *value = (int64_t)ChunkRead64(payload + chunk->Offset, bigEndian);
+	else if (chunk->Length == 4) *value = (int32_t)ChunkRead32(payload + chunk->Offset, bigEndian);
+	else return CANCEL;
+	
+	return OK;
+}
+
+int ChunkReadFloat(const uint8_t *payload, const struct chunk_entry_s *chunk, int bigEndian, double *value) {
+	
+	if (chunk->Length == 8) {
+		
+		uint64_t bits = ChunkRead64(payload + chunk->Offset, bigEndian);
+		memcpy(value, &bits, sizeof(*value));
+	}
+	else if (chunk->Length == 4) {
+		
+		uint32_t bits = ChunkRead32(payload + chunk->Offset, bigEndian);
+		float f;
+		memcpy(&f, &bits, sizeof(f));
+		*value = f;
+	}
+	else return CANCEL;
+	
+	return OK;
+}
@@ -0,0 +1,48 @@
+#ifndef CHUNK_PARSER_H
+#define CHUNK_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/***************************************************************************************************
+GenICam chunk data. With ChunkModeActive the camera appends the selected chunks (exposure time, gain,
+...) to the image, so the values that belong to a frame arrive with it instead of being read back
+with GXGetFloat while the stream runs. Every chunk is its data followed by an 8-byte trailer:
+
+ [image] [chunk 1 data] [ID][length] ... [chunk N data] [ID][length]   <- end of the payload
+
+The trailer is read from the end of the payload backwards, each length says how far back the next
+trailer is. The walk has to land exactly on the end of the image (or on offset 0 when the image is a
+chunk of its own), anything else is a truncated or foreign payload and nothing is returned.
+IDs and lengths are big-endian on GigE Vision and little-endian on USB3 Vision, the chunk values use
+the same byte order.
+****************************************************************************************************/
+
+#define CHUNK_TRAILER_BYTES		8
+#define CHUNK_MAX_ENTRIES		16		// Chunks kept per frame
+
+struct chunk_entry_s {
+	
+	uint32_t ID;				// ChunkID, from the camera's GenICam XML
+	uint32_t Length;			// Data bytes
+	size_t Offset;				// Start of the data in the payload
+};
+
+// A value the camera can send as a chunk
+struct chunk_value_s {
+	
+	int64_t Selector;			// ChunkSelector entry (GX_ENUM_CHUNK_SELECTOR), 0 = not available
+	uint32_t ID;				// ChunkID of that entry in the camera's XML
+};
+
+/***************************************************************************************************
+Chunk Parser Public Functions
+****************************************************************************************************/
+
+int ChunkParse     (const uint8_t *payload, size_t payloadSize, size_t imageBytes, int bigEndian,
+					struct chunk_entry_s *chunks, int maxChunks); // Returns the chunks found (last first), -1 if malformed
+int ChunkFind      (const struct chunk_entry_s *chunks, int numChunks, uint32_t id); // Index, -1 if not there
+int ChunkReadInt   (const uint8_t *payload, const struct chunk_entry_s *chunk, int bigEndian, int64_t *value); // 4 or 8 byte integer
+int ChunkReadFloat (const uint8_t *payload, const struct chunk_entry_s *chunk, int bigEndian, double *value); // 4 or 8 byte IEEE float
+
+#endif
@@ -0,0 +1,216 @@
+#include "CLOCK_SYNC.h"
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+/***************************************************************************************************
+Clock Sync Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+void ClockSyncFit(struct clock_sync_s *sync);
+void ClockSyncLine(const double *x, const double *y, const double *w, const int *use, int n, double *a, double *c);
+double ClockSyncMedian(double *values, int n); // Sorts values
+int ClockSyncCompare(const void *a, const void *b);
+
+int ClockSyncCompare(const void *a, const void *b) {
+	
+	double da = *(const double *)a;
+	double db = *(const double *)b;
+	
+	return (da > db) - (da < db);
+}
+
+double ClockSyncMedian(double *values, int n) {
+	
+	if (n <= 0) return 0;
+	
+	qsort(values, (size_t)n, sizeof(double), ClockSyncCompare);
+	
+	return (n & 1) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// Weighted least squares y = a + c * x over the used points, c = 0 with less than two distinct x
+void ClockSyncLine(const double *x, const double *y, const double *w, const int *use, int n, double *a, double *c) {
+	
+	double sw = 0, sx = 0, sy = 0;
+	
+	for (int i = 0; i < n; i++) {
+		if (!use[i]) continue;
+		sw += w[i];
+		sx += w[i] * x[i];
+		sy += w[i] * y[i];
+	}
+	
+	*a = 0;
+	*c = 0;
+	if (sw <= 0) return;
+	
+	double xm = sx / sw;
+	double ym = sy / sw;
+	double sxx = 0, sxy = 0;
+	
+	for (int i = 0; i < n; i++) {
+		if (!use[i]) continue;
+		sxx += w[i] * (x[i] - xm) * (x[i] - xm);
+		sxy += w[i] * (x[i] - xm) * (y[i] - ym);
+	}
+	
+	if (sxx > 0) *c = sxy / sxx;
+	*a = ym - *c * xm;
+}
+
+/***************************************************************************************************
+Writer side
+****************************************************************************************************/
+
+void ClockSyncInit(struct clock_sync_s *sync, int64_t tickFrequency) {
+	
+	memset(sync->Samples, 0, sizeof(sync->Samples));
+	memset(&sync->Stats, 0, sizeof(sync->Stats));
+	
+	sync->TickFrequency = tickFrequency > 0 ? tickFrequency : 1000000000;
+	sync->NumSamples    = 0;
+	sync->Next          = 0;
+	
+	ATOMIC_INCREMENT(&sync->Sequence);
+	sync->Valid = FALSE;
+	ATOMIC_INCREMENT(&sync->Sequence);
+}
+
+void ClockSyncAddSample(struct clock_sync_s *sync, uint64_t deviceTicks, double hostBeforeUs, double hostAfterUs) {
+	
+	struct clock_sync_sample_s *sample = &sync->Samples[sync->Next];
+	
+	sample->DeviceTicks   = deviceTicks;
+	sample->HostUs        = 0.5 * (hostBeforeUs + hostAfterUs);
+	sample->UncertaintyUs = 0.5 * fabs(hostAfterUs - hostBeforeUs);
+	
+	sync->Next = (sync->Next + 1) & (CLOCK_SYNC_MAX_SAMPLES - 1);
+	if (sync->NumSamples < CLOCK_SYNC_MAX_SAMPLES) sync->NumSamples++;
+	
+	ClockSyncFit(sync);
+}
+
+void ClockSyncFit(struct clock_sync_s *sync) {
+	
+	double x[CLOCK_SYNC_MAX_SAMPLES], y[CLOCK_SYNC_MAX_SAMPLES], w[CLOCK_SYNC_MAX_SAMPLES];
+	double scratch[CLOCK_SYNC_MAX_SAMPLES];
+	int use[CLOCK_SYNC_MAX_SAMPLES];
+	int n = sync->NumSamples;
+	double a = 0, c = 0;
+	
+	// n > 0 also tells the compiler the loop below fills x, y, w before they are used
+	if (n <= 0 || n > CLOCK_SYNC_MAX_SAMPLES) return;
+	
+	// Fit around the newest pair, against the nominal rate: x = device time, y = host - device time (us)
+	const struct clock_sync_sample_s *ref = &sync->Samples[(sync->Next - 1) & (CLOCK_SYNC_MAX_SAMPLES - 1)];
+	double nominalUsPerTick = 1e6 / (double)sync->TickFrequency;
+	
+	for (int i = 0; i < n; i++) {
+		
+		const struct clock_sync_sample_s *s = &sync->Samples[i];
+		
+		x[i] = (double)(int64_t)(s->DeviceTicks - ref->DeviceTicks) * nominalUsPerTick;
+		y[i] = (s->HostUs - ref->HostUs) - x[i];
+		w[i] = 1.0 / ((s->UncertaintyUs + 0.5) * (s->UncertaintyUs + 0.5)); // Half a us floor, timer resolution
+		scratch[i] = s->UncertaintyUs;
+	}
+	
+	// 1. Round trip test
+	double maxUncertainty = 2.0 * ClockSyncMedian(scratch, n);
+	for (int i = 0; i < n; i++) use[i] = sync->Samples[i].UncertaintyUs <= maxUncertainty;
+	
+	// 2. Fit
+	ClockSyncLine(x, y, w, use, n, &a, &c);
+	
+	// 3. Residual test, then fit again without the outliers
+	int m = 0;
+	for (int i = 0; i < n; i++)
+		if (use[i]) scratch[m++] = fabs(y[i] - (a + c * x[i]));
+	
+	double limit = CLOCK_SYNC_OUTLIER_MADS * 1.4826 * ClockSyncMedian(scratch, m);
+	if (limit < CLOCK_SYNC_MIN_OUTLIER_US) limit = CLOCK_SYNC_MIN_OUTLIER_US;
+	
+	int dropped = 0;
+	for (int i = 0; i < n; i++) {
+		if (use[i] && fabs(y[i] - (a + c * x[i])) > limit) {
+			use[i] = FALSE;
+			dropped++;
+		}
+	}
+	
+	if (dropped) ClockSyncLine(x, y, w, use, n, &a, &c);
+	
+	// Fit quality
+	struct clock_sync_stats_s *stats = &sync->Stats;
+	double sumSquares = 0;
+	
+	stats->Samples       = n;
+	stats->Used          = 0;
+	stats->ResidualMaxUs = 0;
+	
+	for (int i = 0; i < n; i++) {
+		
+		if (!use[i]) continue;
+		
+		double r = fabs(y[i] - (a + c * x[i]));
+		sumSquares += r * r;
+		if (r > stats->ResidualMaxUs) stats->ResidualMaxUs = r;
+		stats->Used++;
+	}
+	
+	stats->Outliers      = n - stats->Used;
+	stats->ResidualRmsUs = stats->Used ? sqrt(sumSquares / stats->Used) : 0;
+	stats->DriftPpm      = c * 1e6;
+	
+	// Publish
+	ATOMIC_INCREMENT(&sync->Sequence);
+	
+	sync->RefTicks  = ref->DeviceTicks;
+	sync->RefHostUs = ref->HostUs + a;
+	sync->UsPerTick = nominalUsPerTick * (1.0 + c);
+	sync->Valid     = TRUE;
+	
+	ATOMIC_INCREMENT(&sync->Sequence);
+	
+	stats->OffsetUs = sync->RefHostUs - (double)sync->RefTicks * sync->UsPerTick;
+}
+
+/***************************************************************************************************
+Reader side
+****************************************************************************************************/
+
+int ClockSyncToHostUs(struct clock_sync_s *sync, uint64_t deviceTicks, double *hostUs) {
+	
+	uint64_t refTicks;
+	double refHostUs, usPerTick;
+	int valid;
+	
+	for (;;) {
+		
+		long sequence = ATOMIC_LOAD(&sync->Sequence);
+		if (sequence & 1) continue; // Being written, a few stores long
+		
+		valid     = sync->Valid;
+		refTicks  = sync->RefTicks;
+		refHostUs = sync->RefHostUs;
+		usPerTick = sync->UsPerTick;
+		
+		if (ATOMIC_LOAD(&sync->Sequence) == sequence) break;
+	}
+	
+	if (!valid) return FALSE;
+	
+	*hostUs = refHostUs + (double)(int64_t)(deviceTicks - refTicks) * usPerTick;
+	return TRUE;
+}
+
+void ClockSyncStats(struct clock_sync_s *sync, struct clock_sync_stats_s *stats) {
+	
+	*stats = sync->Stats;
+}
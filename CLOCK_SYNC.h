@@ -0,0 +1,76 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Device clock -> host clock mapping. Every camera counts frame timestamps on its own oscillator, with
+its own zero and a rate a few ppm off nominal, so raw timestamps of two cameras (or of a camera and
+a host log) can not be compared. A sampler latches the device clock (TimestampLatch) between two
+host clock reads and adds the pair here:
+
+ host time of the latch ~ midpoint of the two reads, uncertainty = half the round trip
+
+The last CLOCK_SYNC_MAX_SAMPLES pairs are fitted with a line, host = offset + device * (1 + drift):
+
+ 1. Pairs with a round trip over twice the median are dropped (the latch was delayed somewhere).
+ 2. Least squares fit of the rest, weighted by 1 / uncertainty^2.
+ 3. Residuals beyond CLOCK_SYNC_OUTLIER_MADS median absolute deviations are dropped, fit again.
+
+The result is published as a reference point and a rate, converting a timestamp is one multiply and
+add (ClockSyncToHostUs). One writer (the sampler), any number of readers: the model carries a
+sequence number, odd while it is written, readers retry when it changed under them.
+****************************************************************************************************/
+
+#define CLOCK_SYNC_MAX_SAMPLES		64		// Latches in the fit, power of two
+#define CLOCK_SYNC_OUTLIER_MADS		3.0		// Residual limit in (normal-scaled) median absolute deviations
+#define CLOCK_SYNC_MIN_OUTLIER_US	5.0		// ... but never tighter than this
+
+struct clock_sync_sample_s {
+	
+	uint64_t DeviceTicks;		// GX_INT_TIMESTAMP_LATCH_VALUE
+	double HostUs;				// Host time of the latch (midpoint)
+	double UncertaintyUs;		// Half the host round trip around the latch
+};
+
+// Fit quality, see ClockSyncStats
+struct clock_sync_stats_s {
+	
+	int Samples;				// Pairs in the window
+	int Used;					// Pairs left in the fit
+	int Outliers;				// Pairs dropped by the round trip or residual test
+	double OffsetUs;			// Host time of device tick 0
+	double DriftPpm;			// Device clock rate error against the host clock
+	double ResidualRmsUs;		// Of the pairs in the fit
+	double ResidualMaxUs;
+};
+
+struct clock_sync_s {
+	
+	int64_t TickFrequency;		// Nominal device ticks per second (GX_INT_TIMESTAMP_TICK_FREQUENCY)
+	
+	// Writer state
+	struct clock_sync_sample_s Samples[CLOCK_SYNC_MAX_SAMPLES];
+	int NumSamples;
+	int Next;					// Slot of the next sample
+	struct clock_sync_stats_s Stats;
+	
+	// Published model: host us = RefHostUs + (ticks - RefTicks) * UsPerTick
+	atomic_long_t Sequence;		// Odd while the writer updates the model
+	int Valid;
+	uint64_t RefTicks;
+	double RefHostUs;
+	double UsPerTick;
+};
+
+/***************************************************************************************************
+Clock Sync Public Functions
+****************************************************************************************************/
+
+void   ClockSyncInit     (struct clock_sync_s *sync, int64_t tickFrequency); // Not thread safe, also after the device clock restarted
+void   ClockSyncAddSample(struct clock_sync_s *sync, uint64_t deviceTicks, double hostBeforeUs, double hostAfterUs); // Refits
+int    ClockSyncToHostUs (struct clock_sync_s *sync, uint64_t deviceTicks, double *hostUs); // FALSE until the first sample
+void   ClockSyncStats    (struct clock_sync_s *sync, struct clock_sync_stats_s *stats); // Sampler thread, or copy while it is idle
+
+#endif
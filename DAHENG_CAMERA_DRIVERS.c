@@ -1,879 +1,3783 @@
-#include "DAHENG_CAMERA_DRIVERS.h"
-
-/***************************************************************************************************
-Camera Private Functions And Variables
-****************************************************************************************************/
-
-// Helper macros
-#define MAKE_COLOR(r, g, b)  ( ((b) << 16) | ((g) << 8) | (r) )
-
-
-void GX_STDC OnFrameCallbackFun(GX_FRAME_CALLBACK_PARAM *pFrame); // Frame callback function for GxIAPI
-
-GX_STATUS SetPixelFormat8bit(struct camera_s *cam);
-GX_STATUS GX_STDC GXInitLib(void);
-void UnPrepareForShowImg(struct camera_s *cam);
-int PrepareForShowImg(struct camera_s *cam);
-int PrepareForShowColorImg(struct camera_s *cam);
-int PrepareForShowMonoImg(struct camera_s *cam);
-int SaveBufferAsBMP(const char* fileName, struct camera_s *cam);
-
-/***************************************************************************************************
-Return Defines
-****************************************************************************************************/
-
-#define TRUE        1
-#define FALSE       0
-#define CANCEL      -1
-#define OK			1
-
-/***************************************************************************************************
-Camera open and close functions.
-
-
-GX_STRING_VALUE stStringValue;
-emStatus = GXGetStringValue(m_hDevice, "DeviceSerialNumber", &stStringValue);
-VERIFY_STATUS_RET(emStatus);
-****************************************************************************************************/
-
-GX_STATUS OpenDevice(struct camera_s *cam) {
-	
-    GX_STATUS   emStatus      = GX_STATUS_SUCCESS;
-    uint32_t    nDevNum       = 0;
-    GX_OPEN_PARAM stOpenParam = {0};
-    GX_DEV_HANDLE hTempDevice = NULL;
-    int         foundDevice   = 0;
-
-    // Initialize GxIAPI library
-    emStatus = GXInitLib();
-    if (emStatus != GX_STATUS_SUCCESS)
-    {
-        ShowErrorString(emStatus);
-        return CANCEL;
-    }
-
-    // Update/Enumerate the device list
-    emStatus = GXUpdateDeviceList(&nDevNum, 1000);
-    if (emStatus != GX_STATUS_SUCCESS)
-    {
-        ShowErrorString(emStatus);
-        MessagePopup("Camera Error", "Failed to enumerate devices.");
-        return CANCEL;
-    }
-
-    // Check how many devices we found
-    if (nDevNum == 0)
-    {
-        MessagePopup("Camera Error", "No cameras detected!");
-        return CANCEL;
-    }
-
-    // If our camera struct is already open, close it first
-    if (cam->Device != NULL)
-    {
-        emStatus = GXCloseDevice(cam->Device);
-        if (emStatus != GX_STATUS_SUCCESS)
-        {
-            ShowErrorString(emStatus);
-            MessagePopup("Camera Error", "Failed to close previously open camera handle.");
-            return CANCEL;
-        }
-        cam->Device = NULL;
-    }
-
-    // We want to match this camera's serial number
-    // (Ensure cam->SerialNumber is set to the desired serial before calling!)
-    const char* desiredSerial = (const char*)cam->SerialNumber;
-
-    // Loop over each camera index, 1 through nDevNum
-    // (Daheng cameras are 1-based for GX_OPEN_INDEX)
-    for (uint32_t i = 1; i <= nDevNum; i++)
-    {
-        char indexStr[64];
-        sprintf(indexStr, "%u", i);
-
-        stOpenParam.accessMode = GX_ACCESS_EXCLUSIVE;
-        stOpenParam.openMode   = GX_OPEN_INDEX;
-        stOpenParam.pszContent = indexStr;
-
-        // Try opening device #i
-        emStatus = GXOpenDevice(&stOpenParam, &hTempDevice);
-        if (emStatus != GX_STATUS_SUCCESS)
-        {
-            // Could not open this device; skip it
-            // (e.g., device might be in use, or some error)
-            continue;
-        }
-
-        // Once open, query the device for its serial number
-        // (We do it in two steps: first get length, then get the string)
-        size_t len = 0;
-        emStatus = GXGetStringLength(hTempDevice, GX_STRING_DEVICE_SERIAL_NUMBER, &len);
-        if (emStatus != GX_STATUS_SUCCESS || len == 0)
-        {
-            // If we can't read the serial number, close and keep looking
-            GXCloseDevice(hTempDevice);
-            hTempDevice = NULL;
-            continue;
-        }
-
-        // Allocate a buffer for the serial number and read it
-        char* deviceSerial = (char*)malloc(len + 1);
-        if (!deviceSerial)
-        {
-            GXCloseDevice(hTempDevice);
-            hTempDevice = NULL;
-            MessagePopup("Memory Error", "Failed to allocate memory for serial reading!");
-            return CANCEL;
-        }
-        memset(deviceSerial, 0, len + 1);
-
-        // Actually retrieve the serial string
-        emStatus = GXGetString(hTempDevice, GX_STRING_DEVICE_SERIAL_NUMBER, deviceSerial, &len);
-        if (emStatus != GX_STATUS_SUCCESS)
-        {
-            free(deviceSerial);
-            GXCloseDevice(hTempDevice);
-            hTempDevice = NULL;
-            continue;
-        }
-
-        // Compare with the desiredSerial
-        if (strcmp(deviceSerial, desiredSerial) == 0)
-        {
-            // It's a match! Assign this device to our camera struct
-            cam->Device    = hTempDevice;
-            cam->DevOpened = 1;
-            foundDevice    = 1;
-
-            // Store the actual serial we opened (for reference or logging)
-            strncpy((char*)cam->SerialNumber, deviceSerial, 2047);
-            cam->SerialNumber[2047] = '\0';
-
-            free(deviceSerial);
-            deviceSerial = NULL;
-            break;  // We found the one we want; stop searching
-        }
-        else
-        {
-            // Not the one we need; close and move on
-            free(deviceSerial);
-            deviceSerial = NULL;
-            GXCloseDevice(hTempDevice);
-            hTempDevice = NULL;
-        }
-    }
-
-    // If we never found the requested serial number, show an error
-    if (!foundDevice)
-    {
-        MessagePopup("Camera Error", 
-                     "No camera with the specified serial number was found!");
-        return CANCEL;
-    }
-
-    return GX_STATUS_SUCCESS;
-}
-
-void CloseDevice(struct camera_s *cam) {
-	
-    GX_STATUS emStatus;
-
-    // Kill the timer if running
-    if (cam->timerId > 0)
-        DiscardAsyncTimer(cam->timerId);
-
-    // If snapping, stop
-    if (cam->IsSnap) {
-		
-        emStatus = GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_STOP);
-        GXUnregisterCaptureCallback(cam->Device);
-        cam->IsSnap = 0;
-        UnPrepareForShowImg(cam);
-    }
-
-    // If open, close
-    if (cam->DevOpened) {
-		
-        emStatus = GXCloseDevice(cam->Device);
-        cam->DevOpened = 0;
-        cam->Device    = NULL;
-    }
-}
-
-/***************************************************************************************************
-Start / Stop Image Acquisition Functions.
-****************************************************************************************************/
-
-void StartCameraAcquisition (struct camera_s *cam) {
-	
-    GX_STATUS emStatus = GX_STATUS_ERROR;
-
-    // PrepareForShowImg allocates RawBuffer & ImgBuffer, 
-    // plus creates the LabWindows bitmap handle 
-    if (PrepareForShowImg(cam) != OK) {
-		
-        MessagePopup("Camera Error", "Fail to allocate resources for image!");
-        return;
-    }
-
-    // Register frame callback with cameraOne as user pointer
-    emStatus = GXRegisterCaptureCallback(cam->Device, cam, OnFrameCallbackFun);
-    if (emStatus != GX_STATUS_SUCCESS) {
-		
-        UnPrepareForShowImg(cam);
-        ShowErrorString(emStatus);
-        return;
-    }
-
-    // Set stream buffer handling to OLDEST_FIRST
-    emStatus = GXSetEnum(cam->Device, GX_DS_ENUM_STREAM_BUFFER_HANDLING_MODE, GX_DS_STREAM_BUFFER_HANDLING_MODE_OLDEST_FIRST);
-	
-    if (emStatus != GX_STATUS_SUCCESS) {
-		
-        UnPrepareForShowImg(cam);
-        ShowErrorString(emStatus);
-        return;
-    }
-
-    // Send AcquisitionStart command
-    emStatus = GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_START);
-	
-    if (emStatus != GX_STATUS_SUCCESS) {
-        UnPrepareForShowImg(cam);
-        ShowErrorString(emStatus);
-        return;
-    }
-
-    cam->IsSnap = 1; // true
-}
-
-
-void StopCameraAcquisition (struct camera_s *cam) {
-	
-    GX_STATUS emStatus = GX_STATUS_SUCCESS;
-
-    // Send AcquisitionStop command
-    emStatus = GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_STOP);
-    GX_VERIFY(emStatus);
-
-    // Unregister frame callback
-    emStatus = GXUnregisterCaptureCallback(cam->Device);
-    GX_VERIFY(emStatus);
-	
-    // Stop the timer FIRST, so no callbacks can run
-	// Kill the timer 
-    if (cam->timerId > 0)
-    {
-        DiscardAsyncTimer(cam->timerId);
-        cam->timerId = 0;
-    }
-	
-    cam->IsSnap = 0;
-
-    // Release memory
-    UnPrepareForShowImg(cam);
-}
-
-/***************************************************************************************************
-Function to save a frame to a BMP. Caution, these files are large!
-
-Helper function to write a BMP file from a buffer that already 
-has the correct row alignment/padding. 
-For 24-bit color: rowBytes = ((width * 3) + 3) & ~3
-For 8-bit mono:  rowBytes = (width + 3) & ~3, plus a grayscale palette.
-
-Return 0 on success, -1 on failure
-****************************************************************************************************/
-
-int SaveBufferAsBMP(const char* fileName, struct camera_s *cam) {
-	
-    int width  = (int)cam->ImageWidth; 
-    int height = (int)cam->ImageHeight; 
-    int bitsPerPixel = cam->IsColorFilter ? 24 : 8;
-    int rowBytes = cam->IsColorFilter ? (((width * 3) + 3) & ~3) : ((width + 3) & ~3);
-
-    FILE *fp = fopen(fileName, "wb");
-    if (!fp) return -1;
-
-    uint32_t imageSize = rowBytes * height;
-
-    // Prepare file header
-    cam->BmpFile.bfType    = 0x4D42; // 'BM'
-    cam->BmpFile.bfOffBits = sizeof(cam->BmpFile) + 40; // 40 = size of standard BITMAPINFOHEADER
-    uint32_t paletteSize   = 0;
-
-    // If 8-bit, we need a 256-color palette
-    if (bitsPerPixel == 8) {
-        paletteSize = 256 * 4;
-        cam->BmpFile.bfOffBits += paletteSize; 
-    }
-
-    cam->BmpFile.bfSize      = cam->BmpFile.bfOffBits + imageSize;
-    cam->BmpFile.bfReserved1 = 0;
-    cam->BmpFile.bfReserved2 = 0;
-
-    // Prepare the standard 40-byte info header
-    // (remove that extra int32_t biColorTable[256] from your struct or do not rely on it)
-    BmpInfoHeader infoHeader;
-    memset(&infoHeader, 0, sizeof(infoHeader));
-    infoHeader.biSize        = 40;        // *** Must be exactly 40 for BITMAPINFOHEADER ***
-    infoHeader.biWidth       = width;
-    infoHeader.biHeight      = height;
-    infoHeader.biPlanes      = 1;
-    infoHeader.biBitCount    = (uint16_t)bitsPerPixel;
-    infoHeader.biCompression = 0;         // BI_RGB
-    infoHeader.biSizeImage   = imageSize;
-
-    // Write file header
-    fwrite(&cam->BmpFile, 1, sizeof(cam->BmpFile), fp);
-    // Write the standard 40-byte info header
-    fwrite(&infoHeader, 1, 40, fp);
-
-    // If 8-bit, write a grayscale palette (256 BGRA entries)
-    if (bitsPerPixel == 8) {
-        for (int i = 0; i < 256; i++) {
-            unsigned char bgra[4];
-            bgra[0] = (unsigned char)i; // B
-            bgra[1] = (unsigned char)i; // G
-            bgra[2] = (unsigned char)i; // R
-            bgra[3] = 0;                // A (unused)
-            fwrite(bgra, 1, 4, fp);
-        }
-    }
-
-    // Finally write pixel data
-    fwrite(cam->ImgBuffer, 1, imageSize, fp);
-
-    fclose(fp);
-    return 0;
-}
-
-/***************************************************************************************************
-The GxIAPI frame callback. This is called from the camera driver thread
-whenever a new frame is ready. We decode/copy the data into our 
-cameraOne.ImgBuffer holds the BMP image, i.e. can be drawn to a canvas, saved to file, ETC.
-****************************************************************************************************/
-
-void GX_STDC OnFrameCallbackFun(GX_FRAME_CALLBACK_PARAM *pFrame) {
-	
-    if (pFrame == NULL || pFrame->status != 0) return;
-
-    struct camera_s *cam = (struct camera_s*)pFrame->pUserParam;
-    if (!cam) return; // Camera object is not passed correctly
-	
-    // Ensure that RawBuffer is allocated before copying
-    if (cam->RawBuffer == NULL || pFrame->pImgBuf == NULL) {
-        // Log the error
-        MessagePopup("Error", "RawBuffer or pImgBuf is NULL. Check memory allocation.");
-        return;
-    }
-
-    // Copy from driver to RawBuffer
-    if (pFrame->nImgSize > 0) {
-        memcpy(cam->RawBuffer, pFrame->pImgBuf, pFrame->nImgSize);
-    }
-	else {
-        // Log an error if image size is zero or negative
-        MessagePopup("Error", "Invalid image size in frame callback.");
-        return;
-	}
-    
-
-    int width  = (int)cam->ImageWidth; 
-    int height = (int)cam->ImageHeight; 
-	int bitsPerPixel = cam->IsColorFilter ? 24 : 8;
-    int rowBytes = cam->IsColorFilter ? (((width * 3) + 3) & ~3) : ((width + 3) & ~3);
-
-    if (cam->IsColorFilter) {
-        // If the acquired image is color format,convert it to RGB
-        DxRaw8toRGB24 (cam->RawBuffer, cam->ImgBuffer, (VxUint32)width, (VxUint32)height, RAW2RGB_NEIGHBOUR, (DX_PIXEL_COLOR_FILTER)cam->PixelColorFilter, TRUE);
-    }
-	
-    else {
-        // If the acquired image is mono format,you must flip the image data for showing.
-        for (int y = 0; y < height; y++) {
-            unsigned char *src = cam->RawBuffer + (size_t)(height - 1 - y) * width;
-            unsigned char *dst = cam->ImgBuffer + (size_t)y * rowBytes;
-            memcpy(dst, src, width);
-        }
-    }
-	
-	//static int g_frameIndex = 0;  // keeps incrementing on each callback
-    //char filename[256];
-    //sprintf(filename, "C:\\temp\\frame_%04d.bmp", g_frameIndex++);
-	
-	//int rc = SaveBufferAsBMP(filename, cam);
-}
-
-/***************************************************************************************************
-Prepare/unprepare to show image
-****************************************************************************************************/
-
-int PrepareForShowImg(struct camera_s *cam) {
-
-	//Allocate memory for getting image
-    // Always allocate RawBuffer = PayLoadSize for the raw bytes
-    // (which is 8 bits/pixel for color Bayer or mono).
-    cam->RawBuffer = (unsigned char*)malloc((size_t)cam->PayLoadSize);
-    if (!cam->RawBuffer) {
-        return CANCEL; // error
-    }
-	
-	if (cam->IsColorFilter) {
-		// Allocate buffer for showing color image.
-		if (PrepareForShowColorImg(cam) != OK) {
-			UnPrepareForShowImg(cam);
-			return CANCEL;
-		}
-	}
-	else {
-		// Allocate buffer for showing mono image.
-		if (PrepareForShowMonoImg(cam) != OK) {
-			UnPrepareForShowImg(cam);
-			return CANCEL;
-		}
-	}
-	
-    // Compute rowBytes
-    int rowBytes = 0;
-    if (cam->BmpInfo.biBitCount == 24) rowBytes = ((cam->BmpInfo.biWidth * 3) + 3) & ~3;
-    else rowBytes = (cam->BmpInfo.biWidth + 3) & ~3; // 8-bit
-	
-    size_t totalBytes = (size_t)rowBytes * cam->BmpInfo.biHeight;
-
-    // Create the LabWindows/CVI bitmap
-    int error = NewBitmap(
-        rowBytes,           		// bytesPerRow (24-bit color => 3width, aligned)
-        cam->BmpInfo.biBitCount,	// 24 for color, 8 for mono
-        cam->BmpInfo.biWidth,
-        cam->BmpInfo.biHeight,
-        cam->BmpInfo.biColorTable,  // grayscale palette if mono
-        cam->ImgBuffer,     		// pointer to image data
-        NULL,               		// no mask
-        &cam->BitmapHandle
-    );
-	
-    if (error < 0) {
-        free(cam->RawBuffer);
-        free(cam->ImgBuffer);
-        cam->RawBuffer    = NULL;
-        cam->ImgBuffer    = NULL;
-        cam->BitmapHandle = 0;
-        return CANCEL; // error
-    }
-
-    return OK; // success
-}
-
-//allocate memory for showing color image.
-int PrepareForShowColorImg(struct camera_s *cam) {
-	
-	memset(cam->BmpBuf, 0, sizeof(cam->BmpBuf));
-	
-	//Initialize bitmap header
-	//cam->BmpInfo					= (BITMAPINFO *)cam->BmpBuf;
-	cam->BmpInfo.biSize				= sizeof(BITMAPINFOHEADER);
-	cam->BmpInfo.biWidth			= (LONG)cam->ImageWidth;
-	cam->BmpInfo.biHeight			= (LONG)cam->ImageHeight;	
-
-	cam->BmpInfo.biPlanes			= 1;
-	cam->BmpInfo.biBitCount			= 24; 
-	cam->BmpInfo.biCompression		= BI_RGB;
-	cam->BmpInfo.biSizeImage		= 0;
-	cam->BmpInfo.biXPelsPerMeter	= 0;
-	cam->BmpInfo.biYPelsPerMeter	= 0;
-	cam->BmpInfo.biClrUsed			= 0;
-	cam->BmpInfo.biClrImportant		= 0;
-	
-	int width = (int)cam->ImageWidth;
-	int height = (int)cam->ImageHeight;
-	
-	// Allocate memory for showing converted color images. 3 bytes per pixel.
-	cam->ImgBuffer = (unsigned char *)malloc((size_t)width * height * 3);
-	
-    if (cam->ImgBuffer == NULL) {
-        // If allocation fails, free RawBuffer (if previously allocated)
-        if (cam->RawBuffer) {
-            free(cam->RawBuffer);
-            cam->RawBuffer = NULL;
-        }
-        return CANCEL;
-    }
-
-    // Initialize the new buffer to zero
-	memset(cam->ImgBuffer, 0, (size_t)(width * height * 3));
-
-	return OK;
-}
-
-//allocate memory for showing mono image.
-int PrepareForShowMonoImg(struct camera_s *cam) {
-	
-	memset(cam->BmpBuf, 0, sizeof(cam->BmpBuf));
-	
-	//Initialize bitmap header
-	//cam->BmpInfo					= (BITMAPINFO *)cam->BmpBuf;
-	cam->BmpInfo.biSize				= sizeof(BITMAPINFOHEADER);
-	cam->BmpInfo.biWidth			= (LONG)cam->ImageWidth;
-	cam->BmpInfo.biHeight			= (LONG)cam->ImageHeight;	
-
-	cam->BmpInfo.biPlanes			= 1;
-	cam->BmpInfo.biBitCount			= 8;  
-	cam->BmpInfo.biCompression		= BI_RGB;
-	cam->BmpInfo.biSizeImage		= 0;
-	cam->BmpInfo.biXPelsPerMeter	= 0;
-	cam->BmpInfo.biYPelsPerMeter	= 0;
-	cam->BmpInfo.biClrUsed			= 0;
-	cam->BmpInfo.biClrImportant		= 0;
-
-	if (!cam->IsColorFilter) {
-		// If using mono cameras,you need to initialize color palette first.
-		for(int i = 0; i < 256; i++) {
-			// MAKE_COLOR(r, g, b) -> uses 0x00BBGGRR in CVI
-			cam->BmpInfo.biColorTable[i] = MAKE_COLOR(i, i, i);
-		}
-	}
-	
-	int width = (int)cam->ImageWidth;
-	int height = (int)cam->ImageHeight;
-	
-	// Allocate memory for showing converted mono images
-	cam->ImgBuffer = (unsigned char *)malloc((size_t)width * height);
-	
-    if (cam->ImgBuffer == NULL) {
-        // If allocation fails, free RawBuffer (if previously allocated)
-        if (cam->RawBuffer) {
-            free(cam->RawBuffer);
-            cam->RawBuffer = NULL;
-        }
-        return CANCEL;
-    }
-
-    // Initialize the new buffer to zero
-	memset(cam->ImgBuffer, 0, (size_t)(width * height));
-	
-	return OK;
-}
-
-void UnPrepareForShowImg(struct camera_s *cam) {
-	
-    if (cam->RawBuffer) {
-		
-        free(cam->RawBuffer);
-        cam->RawBuffer = NULL;
-    }
-
-    if (cam->ImgBuffer) {
-		
-        free(cam->ImgBuffer);
-        cam->ImgBuffer = NULL;
-    }
-
-    // If you want, you can also discard the BitmapHandle here:
-    if (cam->BitmapHandle) {
-		
-        DiscardBitmap(cam->BitmapHandle);
-        cam->BitmapHandle = 0;
-    }
-}
-
-/***************************************************************************************************
-Camera Initilization.
-
-Initilizes camera to a preset known state. Prepares it for proper image capturing.
-
-Loads parameters from device to struct.
-
-Loads parameters Gain and Exposure from struct to device.
-****************************************************************************************************/
-
-GX_STATUS InitDevice(struct camera_s *cam) {
-	
-	GX_STATUS emStatus = GX_STATUS_SUCCESS;
-
-    // AcquisitionMode = Continuous
-    emStatus = GXSetEnum(cam->Device, GX_ENUM_ACQUISITION_MODE, GX_ACQ_MODE_CONTINUOUS);
-    VERIFY_STATUS_RET(emStatus);
-
-    // TriggerMode = Off
-    emStatus = GXSetEnum(cam->Device, GX_ENUM_TRIGGER_MODE, GX_TRIGGER_MODE_OFF);
-    VERIFY_STATUS_RET(emStatus);
-
-    // Force camera to 8-bit pixel format
-	emStatus = SetPixelFormat8bit(cam);
-	VERIFY_STATUS_RET(emStatus);
-	
-    // Payload size
-    emStatus = GXGetInt(cam->Device, GX_INT_PAYLOAD_SIZE, &cam->PayLoadSize);
-    VERIFY_STATUS_RET(emStatus);
-
-    // Width, Height
-    emStatus = GXGetInt(cam->Device, GX_INT_WIDTH, &cam->ImageWidth);
-    VERIFY_STATUS_RET(emStatus);
-
-    emStatus = GXGetInt(cam->Device, GX_INT_HEIGHT, &cam->ImageHeight);
-    VERIFY_STATUS_RET(emStatus);
-
-    // IsColorFilter?
-    emStatus = GXIsImplemented(cam->Device, GX_ENUM_PIXEL_COLOR_FILTER, &cam->IsColorFilter);
-    VERIFY_STATUS_RET(emStatus);
-	
-    // ROI
-    GXGetInt(cam->Device, GX_INT_AAROI_OFFSETX, &cam->RoiX);
-    GXGetInt(cam->Device, GX_INT_AAROI_OFFSETY, &cam->RoiY);
-    GXGetInt(cam->Device, GX_INT_AAROI_WIDTH,   &cam->RoiW);
-    GXGetInt(cam->Device, GX_INT_AAROI_HEIGHT,  &cam->RoiH);
-
-    // Gray
-    GXGetInt(cam->Device, GX_INT_GRAY_VALUE, &cam->Gray);
-
-    // If color filter, get it
-    if (cam->IsColorFilter) GXGetEnum(cam->Device, GX_ENUM_PIXEL_COLOR_FILTER, &cam->PixelColorFilter);
-	
-	// Configure Gain Mode
-	if (cam->GainMode == 0) emStatus = GXSetEnum(cam->Device, GX_ENUM_GAIN_AUTO, GX_GAIN_AUTO_OFF);
-	else if (cam->GainMode == 1) emStatus = GXSetEnum(cam->Device, GX_ENUM_GAIN_AUTO, GX_GAIN_AUTO_CONTINUOUS);
-	else if (cam->GainMode == 2) emStatus = GXSetEnum(cam->Device, GX_ENUM_GAIN_AUTO, GX_GAIN_AUTO_ONCE);
-	else return CANCEL;
-	VERIFY_STATUS_RET(emStatus);
-	
-	emStatus = GXSetFloat(cam->Device,GX_FLOAT_GAIN,cam->Gain);
-	VERIFY_STATUS_RET(emStatus);
-	
-	emStatus = GXSetFloat(cam->Device, GX_FLOAT_AUTO_GAIN_MIN, cam->AutoGainMin);
-	VERIFY_STATUS_RET(emStatus);
-	
-	emStatus = GXSetFloat(cam->Device, GX_FLOAT_AUTO_GAIN_MAX, cam->AutoGainMax);
-	VERIFY_STATUS_RET(emStatus);
-	
-	// Configure Exposure Time Mode 
-	if (cam->ExposureTimeMode == 0) emStatus = GXSetEnum(cam->Device, GX_ENUM_EXPOSURE_AUTO, GX_EXPOSURE_AUTO_OFF);
-	else if (cam->ExposureTimeMode == 1) emStatus = GXSetEnum(cam->Device, GX_ENUM_EXPOSURE_AUTO, GX_EXPOSURE_AUTO_CONTINUOUS);
-	else if (cam->ExposureTimeMode == 2) emStatus = GXSetEnum(cam->Device, GX_ENUM_EXPOSURE_AUTO, GX_EXPOSURE_AUTO_ONCE);
-	else return CANCEL;
-	VERIFY_STATUS_RET(emStatus);
-	
-	emStatus = GXSetFloat(cam->Device, GX_FLOAT_EXPOSURE_TIME, cam->ExposureTime);
-	VERIFY_STATUS_RET(emStatus);
-	
-	emStatus =GXSetFloat(cam->Device, GX_FLOAT_AUTO_EXPOSURE_TIME_MIN, cam->AutoExposureTimeMin);
-	VERIFY_STATUS_RET(emStatus);
-	
-	emStatus =GXSetFloat(cam->Device, GX_FLOAT_AUTO_EXPOSURE_TIME_MAX, cam->AutoExposureTimeMax);
-	VERIFY_STATUS_RET(emStatus);
-	
-    return emStatus;
-}
-
-/***************************************************************************************************
-Set pixel format to 8-Bit
-If you don't know the device supports which kind of pixel format,
-you could use following function to set the pixel format to 8-bit.
-****************************************************************************************************/
-
-GX_STATUS SetPixelFormat8bit(struct camera_s *cam) {
-	
-    GX_STATUS emStatus   = GX_STATUS_SUCCESS;
-    int64_t   nPixelSize = 0;
-	uint32_t  nEnumEntry  = 0;
-    size_t    nBufferSize = 0;
-	
-	GX_ENUM_DESCRIPTION *pEnumDescription = NULL;
-
-    // PixelSize is bits per pixel
-	// Get the feature PixelSize, this feature indicates the depth of the pixel values in the acquired images in bits per pixel
-    emStatus = GXGetEnum(cam->Device, GX_ENUM_PIXEL_SIZE, &nPixelSize);
-    VERIFY_STATUS_RET(emStatus);
-
-    // If the PixelSize is 8bit then return, or set the PixelSize to 8bit.
-    if (nPixelSize == GX_PIXEL_SIZE_BPP8) return GX_STATUS_SUCCESS;
-	
-	else {
-		
-	    // We want to find an 8-bit format among the supported pixel formats
-		// Get the enumeration entry of the pixel format the device supports.
-	    emStatus = GXGetEnumEntryNums(cam->Device, GX_ENUM_PIXEL_FORMAT, &nEnumEntry);
-	    VERIFY_STATUS_RET(emStatus);
-
-		// Allocate memory for getting the enumeration entry of the pixel format.
-	    nBufferSize = nEnumEntry * sizeof(GX_ENUM_DESCRIPTION);
-	    pEnumDescription = (GX_ENUM_DESCRIPTION*) malloc(nBufferSize);
-	    
-		if (!pEnumDescription) return CANCEL;
-
-	    emStatus = GXGetEnumDescription(cam->Device, GX_ENUM_PIXEL_FORMAT, pEnumDescription, &nBufferSize);
-	
-	    if (emStatus != GX_STATUS_SUCCESS) {
-			if (pEnumDescription != NULL) {
-	        	free(pEnumDescription);
-			}
-			return emStatus;
-	    }
-
-	    // Try each supported format to see if it's 8-bit
-		// A loop to visit every enumeration entry node once to find which enumeration entry node is 8bit and then set pixel format to its value
-	    for (uint32_t i = 0; i < nEnumEntry; i++) {
-		
-	        if ((pEnumDescription[i].nValue & GX_PIXEL_8BIT) == GX_PIXEL_8BIT)
-	        {
-	            emStatus = GXSetEnum(cam->Device, GX_ENUM_PIXEL_FORMAT, pEnumDescription[i].nValue);
-	            break;
-	        }
-	    }
-	}
-
-    free(pEnumDescription);
-    return emStatus;
-}
-
-
-
-/***************************************************************************************************
-Camera Error Handling Functions.
-****************************************************************************************************/
-
-int VERIFY_STATUS_RET (GX_STATUS emStatus) {
-	
-    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
-	
-    else return GX_STATUS_SUCCESS;
-}
-
-// Show error info from GxIAPI
-void ShowErrorString(GX_STATUS emErrorStatus) {
-	
-	char*  pchErrorInfo = NULL;
-    size_t nSize        = 0;
-    GX_STATUS emStatus  = GX_STATUS_ERROR;
-
-    // Get length
-    emStatus = GXGetLastError(&emErrorStatus, NULL, &nSize);
-    if (emStatus != GX_STATUS_SUCCESS || nSize == 0) {
-		
-        MessagePopup("Error", "Failed to retrieve error info length.");
-        return;
-    }
-
-    pchErrorInfo = (char*)malloc(nSize);
-    if (!pchErrorInfo) {
-		
-        MessagePopup("Error", "Memory allocation failed for error string.");
-        return;
-    }
-
-    // Get actual error info
-    emStatus = GXGetLastError(&emErrorStatus, pchErrorInfo, &nSize);
-    if (emStatus != GX_STATUS_SUCCESS) MessagePopup("Error", "Fail to call GXGetLastError!");
-    else MessagePopup("GxIAPI Error", pchErrorInfo);
-
-    free(pchErrorInfo);
-}
-
-/***************************************************************************************************
-The async timer callback: draws the latest image in cam->ImgBuffer.
-
-The correct panelHandle and canvasControl must be set in order to display the image!
-****************************************************************************************************/
-
-void CVICALLBACK UpdateCameraCallback(int reserved, int timerId, int event, struct camera_s *cam, int eventData1, int eventData2) {
-	
-    if (cam->IsSnap && cam->BitmapHandle) {
-		
-		// Canvas Control Information
-    	int panelHandle      = cam->panelHandle;
-    	int canvasControl    = cam->canvasControl;
-		
-        // Grab local copies (cast 64-bit to int if safe)
-        int width        = (int)cam->BmpInfo.biWidth;
-        int height       = (int)cam->BmpInfo.biHeight;
-        int bitsPerPixel = (int)cam->BmpInfo.biBitCount;
-		
-        // Use GetBitmapInfo to check the nandle is truly valid
-        int error = GetBitmapInfo(cam->BitmapHandle, NULL, NULL, NULL);
-
-        if (GetBitmapInfo(cam->BitmapHandle, NULL, NULL, NULL) < 0) {
-			
-            // If GetBitmapInfo fails, the handle is invalid (or something is wrong)
-            printf("GetBitmapInfo failed for camera's bitmap handle. Error = %d\n", error);
-            return;
-        }
-		
-        // Compute rowBytes
-        int rowBytes = (bitsPerPixel == 24) ? (((width * 3) + 3) & ~3) : ((width + 3) & ~3);  // For 8-bit
-
-        // For 8-bit images, use cameraOne.BmpInfo.biColorTable;
-        // For 24-bit images, pass NULL for the colorTable parameter.
-        int *colorTablePtr = (bitsPerPixel == 8) ? cam->BmpInfo.biColorTable : NULL;
-
-        // Update the existing bitmap handle with new frame data
-        // SetBitmapData signature:
-        //     int SetBitmapData(int bitmapID,
-        //                       int bytesPerRow,
-        //                       int pixelDepth,
-        //                       int colorTable[],    // or NULL for 24-bit
-        //                       unsigned char bits[], // pointer to pixel data
-        //                       unsigned char mask[]); // or NULL for no mask
-        error = SetBitmapData(
-                        cam->BitmapHandle,
-                        rowBytes,
-                        bitsPerPixel,
-                        colorTablePtr,
-                        cam->ImgBuffer,
-                        NULL   // no mask
-                    );
-        if (error < 0)
-        {
-            // Not fatal, but we can log something
-            printf("SetBitmapData failed: %d\n", error);
-        }
-
-        // Now draw it onto the canvas
-        CanvasDrawBitmap(panelHandle,
-                         canvasControl,
-                         cam->BitmapHandle,
-                         VAL_ENTIRE_OBJECT, // source rect
-                         VAL_ENTIRE_OBJECT  // dest rect
-        );
-		
-		
-        // Draw the crosshair lines
-		if (cam->UseCrosshair == 1) {
-			
-			int width, height, scaled_crosshair_x, scaled_crosshair_y;
-			
-			// Set the pen width and color.
-			SetCtrlAttribute(panelHandle, canvasControl, ATTR_PEN_COLOR, cam->CrosshairColor);
-			SetCtrlAttribute(panelHandle, canvasControl, ATTR_PEN_WIDTH, cam->CrosshairThickness);
-
-		    // 1) Get the canvas width and height
-		    GetCtrlAttribute (panelHandle, canvasControl, ATTR_WIDTH,  &width);
-		    GetCtrlAttribute (panelHandle, canvasControl, ATTR_HEIGHT, &height);
-
-		    // 2) Make sure the cameraOne.CrosshairX / CrosshairY are within the valid image range
-		    if (cam->CrosshairX > cam->ImageWidth) cam->CrosshairX = (int)cam->ImageWidth;
-		    if (cam->CrosshairY > cam->ImageHeight) cam->CrosshairY = (int)cam->ImageHeight;
-
-		    // 3) Scale from full-resolution space [0 .. ImageWidth] to canvas space [0 .. width]
-		    //    and [0 .. ImageHeight] to [0 .. height].
-		    //    (Use a float cast to avoid integer division issues.)
-		    scaled_crosshair_x = (int)( (float)cam->CrosshairX / (float)cam->ImageWidth  * (float)width );
-		    scaled_crosshair_y = (int)( (float)cam->CrosshairY / (float)cam->ImageHeight * (float)height );
-
-		    // 4) Clip scaled coordinates again just to ensure they are not outside the Canvas
-		    if (scaled_crosshair_x < 0)        scaled_crosshair_x = 0;
-		    else if (scaled_crosshair_x > width)  scaled_crosshair_x = width;
-
-		    if (scaled_crosshair_y < 0)        scaled_crosshair_y = 0;
-		    else if (scaled_crosshair_y > height) scaled_crosshair_y = height;
-			
-			
-			// Horizontal line in cameraOne's canvas:
-			CanvasDrawLine (panelHandle, canvasControl, MakePoint(scaled_crosshair_x - cam->CrosshairSize, scaled_crosshair_y), MakePoint(scaled_crosshair_x + cam->CrosshairSize, scaled_crosshair_y));
-			// Vertical line in cameraOne's canvas:
-			CanvasDrawLine (panelHandle, canvasControl, MakePoint(scaled_crosshair_x, scaled_crosshair_y - cam->CrosshairSize), MakePoint(scaled_crosshair_x, scaled_crosshair_y + cam->CrosshairSize));
-			
-			
-		}
-    }
-}
+#include "DAHENG_CAMERA_DRIVERS.h"
+
+/***************************************************************************************************
+Camera Private Functions And Variables
+****************************************************************************************************/
+
+// Helper macros
+#define MAKE_COLOR(r, g, b)  ( ((b) << 16) | ((g) << 8) | (r) )
+
+
+void GX_STDC OnFrameCallbackFun(GX_FRAME_CALLBACK_PARAM *pFrame); // Frame callback function for GxIAPI
+void ProcessFrame(struct camera_s *cam, GX_FRAME_CALLBACK_PARAM *pFrame); // Shared by the callback and polling modes
+int CVICALLBACK PollingThreadFunction(void *functionData); // Polling acquisition thread (GXGetImage)
+int StartPollingThread(struct camera_s *cam);
+void StopPollingThread(struct camera_s *cam);
+void UpdateDeliveryStats(struct camera_s *cam, double now);
+int ApplyStreamBufferPolicy(struct camera_s *cam);
+void StartStreamStatsSampler(struct camera_s *cam);
+int CVICALLBACK LatencyDumpTimerCallback(int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2);
+void RecordStageLatency(struct camera_s *cam, int stage, int64_t fromTicks, int64_t toTicks);
+void StopStreamStatsSampler(struct camera_s *cam);
+int CVICALLBACK StreamStatsTimerCallback(int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2);
+double SampleHostCpuPercent(struct camera_s *cam);
+int SizeAcqBuffers(struct camera_s *cam, int mode, int64_t *bytes);
+void ReleaseAcqBuffers(struct camera_s *cam);
+void ReturnAcqBufferBytes(int64_t bytes);
+void ResetStreamQueueMetrics(struct camera_s *cam);
+int SuspendAcquisition(struct camera_s *cam);
+GX_STATUS ResumeAcquisition(struct camera_s *cam);
+GX_STATUS RestartAcquisition(struct camera_s *cam);
+void DiscardDisplayBitmap(struct camera_s *cam);
+void GX_STDC OnDeviceOfflineCallback(void *pUserParam); // GxIAPI offline event
+GX_STATUS RegisterOfflineCallback(struct camera_s *cam);
+void StartReconnectThread(struct camera_s *cam);
+void StopReconnectThread(struct camera_s *cam);
+int CVICALLBACK ReconnectThreadFunction(void *functionData);
+int ReconnectFind(void *device);
+int ReconnectOpen(void *device);
+int ReconnectRestore(void *device);
+int ReconnectStart(void *device);
+void ReconnectClose(void *device);
+GX_STATUS ReadCaptureGeometry(struct camera_s *cam);
+GX_STATUS ApplyCaptureGeometry(struct camera_s *cam, const struct capture_geometry_s *geometry);
+GX_STATUS SetIntAligned(struct camera_s *cam, GX_FEATURE_ID featureID, int64_t value);
+GX_STATUS ApplyBandwidthPlan(void);
+void ReplanCameraBandwidth(struct camera_s *cam);
+void ReplanAfterExposure(struct camera_s *cam);
+int IsBandwidthPlanned(struct camera_s *cam);
+void MeasureMaxFrameRate(struct camera_s *cam);
+struct rate_settings_s;
+void SaveRateSettings(struct camera_s *cam, struct rate_settings_s *saved);
+void RestoreRateSettings(struct camera_s *cam, const struct rate_settings_s *saved);
+int ConfigureTrigger(struct camera_s *cam);
+GX_STATUS ConfigureChunkData(struct camera_s *cam);
+void ReadFrameChunks(struct camera_s *cam, GX_FRAME_CALLBACK_PARAM *pFrame, double *exposureTime, double *gain);
+void StartClockSync(struct camera_s *cam);
+void StopClockSync(struct camera_s *cam);
+int SampleDeviceClock(struct camera_s *cam);
+int CVICALLBACK ClockSyncTimerCallback(int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2);
+GX_STATUS ConfigureExposureEvents(struct camera_s *cam);
+void UnregisterExposureEvents(struct camera_s *cam);
+void ResetExposureEvents(struct camera_s *cam);
+void GX_STDC OnExposureEndEvent(GX_FEATURE_ID_CMD nFeatureID, void *pUserParam); // GxIAPI ExposureEnd event
+void StartEventThread(struct camera_s *cam);
+void StopEventThread(struct camera_s *cam);
+int CVICALLBACK EventThreadFunction(void *functionData);
+void TriggerAddRefFrame(void *item);
+void TriggerReleaseFrame(void *item);
+void FrameSyncConsumer(struct camera_s *cam, struct frame_s *frame, void *userData); // Pushes frames into cam->FrameSync
+void FrameSyncReleaseFrame(void *item, void *userData);
+
+GX_STATUS SetPixelFormat8bit(struct camera_s *cam);
+GX_STATUS SetPixelFormatBits(struct camera_s *cam, int bits, int packed);
+GX_STATUS GX_STDC GXInitLib(void);
+GX_STATUS EnumerateDevices(uint32_t timeoutMs, GX_DEVICE_BASE_INFO **info, uint32_t *count);
+int FindCachedDevice(const char *serialNumber);
+int CVICALLBACK BringUpThreadFunction(void *functionData);
+void SetBringUpError(struct camera_s *cam, GX_STATUS emStatus, const char *what);
+void UnPrepareForShowImg(struct camera_s *cam);
+int PrepareForShowImg(struct camera_s *cam);
+int PrepareForShowColorImg(struct camera_s *cam);
+int PrepareForShowMonoImg(struct camera_s *cam);
+int AllocateDisplayBuffers(struct camera_s *cam, size_t bytes);
+void ReleaseDisplayFrames(struct camera_s *cam);
+int PrepareConversion(struct camera_s *cam);
+void ReleaseConversion(struct camera_s *cam);
+void ConvertBand(void *context, int firstRow, int lastRow, int worker);
+
+// One frame to convert, shared by the workers of cam->ConvertPool
+struct convert_job_s {
+	
+	const void *Src;				// 8 or 16 bits per pixel, rows SrcStride bytes apart
+	int SrcBits;					// 8, or the significant bits of 16-bit pixels
+	int SrcStride;
+	const uint8_t *Lut;				// Tone LUT of 2^SrcBits entries, NULL = none (8 bits only)
+	unsigned char *Dst;				// Bitmap rows, bottom-up
+	int Width;
+	int Height;
+	int RowBytes;
+	int Color;						// Demosaic, otherwise flip only
+	int Pattern;
+	int Quality;
+	int Kernel;
+	struct demosaic_lines_s *Lines;	// One per worker
+	atomic_long_t Failed;
+};
+int SaveBufferAsBMP(const char* fileName, struct camera_s *cam);
+
+static const struct reconnect_ops_s CameraReconnectOps = {
+	ReconnectFind, ReconnectOpen, ReconnectRestore, ReconnectStart, ReconnectClose, GetHostTimeMs
+};
+
+/***************************************************************************************************
+Return Defines
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+/***************************************************************************************************
+Camera open and close functions.
+
+Discovery is done once: the library is initialized on the first OpenDevice, one enumeration is read
+with GXGetAllDeviceBaseInfo and cached, and every camera is then opened directly by serial number
+(GX_OPEN_SN). No device is opened just to read its serial number, so cameras owned by other
+processes are left alone. The cache is only refreshed when a serial number is not in it (a camera
+plugged in after the first enumeration) or by RefreshDeviceList.
+****************************************************************************************************/
+
+int GxLibInitialized = FALSE;
+GX_DEVICE_BASE_INFO *DeviceInfoCache = NULL;
+uint32_t DeviceInfoCount = 0;
+atomic_long_t DeviceListLock = 0; // OpenDevice may run on several threads (BringUpCameras)
+
+// Enumerate the bus, *info is malloc'ed (free it), *count may be 0
+GX_STATUS EnumerateDevices(uint32_t timeoutMs, GX_DEVICE_BASE_INFO **info, uint32_t *count) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	uint32_t  nDevNum  = 0;
+	
+	*info  = NULL;
+	*count = 0;
+	
+	emStatus = GXUpdateDeviceList(&nDevNum, timeoutMs);
+	if (emStatus != GX_STATUS_SUCCESS || nDevNum == 0) return emStatus;
+	
+	size_t nSize = nDevNum * sizeof(GX_DEVICE_BASE_INFO);
+	*info = (GX_DEVICE_BASE_INFO *)malloc(nSize);
+	if (*info == NULL) return GX_STATUS_ERROR;
+	
+	emStatus = GXGetAllDeviceBaseInfo(*info, &nSize);
+	if (emStatus != GX_STATUS_SUCCESS) {
+		free(*info);
+		*info = NULL;
+		return emStatus;
+	}
+	
+	*count = nDevNum;
+	return GX_STATUS_SUCCESS;
+}
+
+GX_STATUS RefreshDeviceList(void) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	
+	if (!GxLibInitialized) {
+		
+		emStatus = GXInitLib();
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+		
+		GxLibInitialized = TRUE;
+	}
+	
+	free(DeviceInfoCache);
+	DeviceInfoCache = NULL;
+	DeviceInfoCount = 0;
+	
+	return EnumerateDevices(1000, &DeviceInfoCache, &DeviceInfoCount);
+}
+
+int FindCachedDevice(const char *serialNumber) {
+	
+	for (uint32_t i = 0; i < DeviceInfoCount; i++)
+		if (strcmp(DeviceInfoCache[i].szSN, serialNumber) == 0) return (int)i;
+	
+	return -1;
+}
+
+GX_STATUS OpenDevice(struct camera_s *cam) {
+	
+    GX_STATUS   emStatus      = GX_STATUS_SUCCESS;
+    GX_OPEN_PARAM stOpenParam = {0};
+	double      startMs       = GetHostTimeMs();
+	
+    // We want to match this camera's serial number
+    // (Ensure cam->SerialNumber is set to the desired serial before calling!)
+    const char* desiredSerial = (const char*)cam->SerialNumber;
+
+    // Enumerate once, later cameras use the cached list. Held for up to one enumeration.
+	while (ATOMIC_COMPARE_EXCHANGE(&DeviceListLock, 1, 0) != 0) Delay(0.001);
+	
+    if (!GxLibInitialized || FindCachedDevice(desiredSerial) < 0) emStatus = RefreshDeviceList();
+	
+	int devNum = (int)DeviceInfoCount;
+	int index  = FindCachedDevice(desiredSerial);
+	int found  = index >= 0;
+	
+	if (found) cam->DeviceClass = DeviceInfoCache[index].deviceClass;
+	
+	ATOMIC_STORE(&DeviceListLock, 0);
+	
+    if (emStatus != GX_STATUS_SUCCESS)
+    {
+        SetBringUpError(cam, emStatus, "Failed to enumerate devices.");
+        return emStatus;
+    }
+
+    // Check how many devices we found
+    if (devNum == 0)
+    {
+        SetBringUpError(cam, GX_STATUS_SUCCESS, "No cameras detected!");
+        return GX_STATUS_NOT_FOUND_DEVICE;
+    }
+	
+    if (!found)
+    {
+        SetBringUpError(cam, GX_STATUS_SUCCESS, "No camera with the specified serial number was found!");
+        return GX_STATUS_NOT_FOUND_DEVICE;
+    }
+
+    // If our camera struct is already open, close it first
+    if (cam->Device != NULL)
+    {
+        emStatus = GXCloseDevice(cam->Device);
+        if (emStatus != GX_STATUS_SUCCESS)
+        {
+            SetBringUpError(cam, emStatus, "Failed to close previously open camera handle.");
+            return emStatus;
+        }
+        cam->Device = NULL;
+    }
+
+    // Open it directly by serial number
+    stOpenParam.accessMode = GX_ACCESS_EXCLUSIVE;
+    stOpenParam.openMode   = GX_OPEN_SN;
+    stOpenParam.pszContent = (char *)desiredSerial;
+
+    emStatus = GXOpenDevice(&stOpenParam, &cam->Device);
+    if (emStatus != GX_STATUS_SUCCESS)
+    {
+        cam->Device = NULL;
+        SetBringUpError(cam, emStatus, "Failed to open the camera (in use by another process?).");
+        return emStatus;
+    }
+	
+    cam->DevOpened = 1;
+	
+	// Get told when the camera drops off the bus
+	ReconnectInit(&cam->Reconnect, &CameraReconnectOps, cam);
+	
+	// Not fatal, the camera runs without reconnection
+	emStatus = RegisterOfflineCallback(cam);
+	if (emStatus != GX_STATUS_SUCCESS) printf("Camera %s: offline callback not registered (%d).\n", cam->SerialNumber, emStatus);
+	
+	cam->OpenTimeMs = GetHostTimeMs() - startMs;
+
+    return GX_STATUS_SUCCESS;
+}
+
+/***************************************************************************************************
+Parallel bring-up. One task per camera on a thread pool runs OpenDevice and InitDevice, so startup
+takes as long as the slowest camera instead of the sum of all of them. Every camera keeps its own
+result (BringUpStatus, BringUpMs), a camera that fails does not stop the others.
+Returns the number of cameras that came up.
+****************************************************************************************************/
+
+int CVICALLBACK BringUpThreadFunction(void *functionData) {
+	
+	struct camera_s *cam = (struct camera_s *)functionData;
+	double startMs = GetHostTimeMs();
+	
+	cam->BringUpError[0] = 0;
+	
+	cam->BringUpStatus = OpenDevice(cam);
+	if (cam->BringUpStatus == GX_STATUS_SUCCESS) {
+		cam->BringUpStatus = InitDevice(cam);
+		if (cam->BringUpStatus != GX_STATUS_SUCCESS) SetBringUpError(cam, cam->BringUpStatus, "Failed to configure the camera.");
+	}
+	
+	cam->BringUpMs = GetHostTimeMs() - startMs;
+	return 0;
+}
+
+// Worker threads must not open popups: the message is kept in the camera and printed,
+// the UI thread shows it after BringUpCameras
+void SetBringUpError(struct camera_s *cam, GX_STATUS emStatus, const char *what) {
+	
+	char detail[160] = "";
+	size_t nSize = sizeof(detail);
+	
+	if (emStatus != GX_STATUS_SUCCESS && GXGetLastError(&emStatus, detail, &nSize) != GX_STATUS_SUCCESS) detail[0] = 0;
+	
+	if (detail[0]) sprintf(cam->BringUpError, "%.90s\n%.159s", what, detail);
+	else sprintf(cam->BringUpError, "%.250s", what);
+	
+	printf("Camera %s: %s\n", cam->SerialNumber, cam->BringUpError);
+}
+
+int BringUpCameras(struct camera_s **cams, int numCams) {
+	
+	CmtThreadPoolHandle pool = 0;
+	int ready = 0;
+	
+	if (numCams <= 0) return 0;
+	
+	// One enumeration up front, the tasks then only open their own camera
+	if (RefreshDeviceList() != GX_STATUS_SUCCESS) printf("BringUpCameras: enumeration failed, every camera retries it.\n");
+	
+	if (CmtNewThreadPool(numCams, &pool) < 0) pool = 0;
+	
+	for (int i = 0; i < numCams; i++) {
+		
+		cams[i]->BringUpStatus     = GX_STATUS_ERROR;
+		cams[i]->BringUpFunctionId = 0;
+		
+		// No pool (or no thread): bring this one up right here
+		if (pool == 0 || CmtScheduleThreadPoolFunction(pool, BringUpThreadFunction, cams[i], &cams[i]->BringUpFunctionId) < 0) {
+			cams[i]->BringUpFunctionId = 0;
+			BringUpThreadFunction(cams[i]);
+		}
+	}
+	
+	for (int i = 0; i < numCams; i++) {
+		
+		if (cams[i]->BringUpFunctionId != 0) {
+			CmtWaitForThreadPoolFunctionCompletion(pool, cams[i]->BringUpFunctionId, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+			CmtReleaseThreadPoolFunctionID(pool, cams[i]->BringUpFunctionId);
+			cams[i]->BringUpFunctionId = 0;
+		}
+		
+		if (cams[i]->BringUpStatus == GX_STATUS_SUCCESS) ready++;
+		
+		printf("Camera %s: %s in %.0f ms (open %.0f ms).\n", cams[i]->SerialNumber,
+			   cams[i]->BringUpStatus == GX_STATUS_SUCCESS ? "ready" : "FAILED", cams[i]->BringUpMs, cams[i]->OpenTimeMs);
+	}
+	
+	if (pool) CmtDiscardThreadPool(pool);
+	
+	return ready;
+}
+
+void CloseDevice(struct camera_s *cam) {
+	
+    GX_STATUS emStatus;
+	
+	// A reconnect in progress would reopen the camera behind our back
+	StopReconnectThread(cam);
+
+    // Kill the timer if running
+    if (cam->timerId > 0)
+        DiscardAsyncTimer(cam->timerId);
+
+    // If snapping, stop
+    if (cam->IsSnap) {
+		
+		StopStreamStatsSampler(cam);
+		
+		if (cam->LatencyDumpTimerId > 0) {
+			DiscardAsyncTimer(cam->LatencyDumpTimerId);
+			cam->LatencyDumpTimerId = 0;
+		}
+		
+        if (cam->ActiveAcquisitionMode == ACQ_MODE_POLLING) StopPollingThread(cam);
+        emStatus = GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_STOP);
+        if (cam->ActiveAcquisitionMode == ACQ_MODE_CALLBACK) GXUnregisterCaptureCallback(cam->Device);
+        cam->IsSnap = 0;
+        UnPrepareForShowImg(cam);
+		ReleaseAcqBuffers(cam);
+    }
+	
+	// A triggered frame nobody picked up, and frames still waiting for a partner, hold references into our pool
+	TriggerWaitClose(&cam->Trigger);
+	if (cam->FrameSync) FrameSyncFlush(cam->FrameSync);
+	
+	// The frame pool and the bitmap outlive Stop/Start, free them with the device
+	DiscardDisplayBitmap(cam);
+	FramePoolDestroy(&cam->Pool);
+
+    // If open, close
+    if (cam->DevOpened) {
+		
+		StopEventThread(cam);
+		UnregisterExposureEvents(cam);
+		StopClockSync(cam);
+		
+		if (cam->OfflineCallback) {
+			GXUnregisterDeviceOfflineCallback(cam->Device, cam->OfflineCallback);
+			cam->OfflineCallback = NULL;
+		}
+		
+        emStatus = GXCloseDevice(cam->Device);
+        cam->DevOpened = 0;
+        cam->Device    = NULL;
+    }
+}
+
+/***************************************************************************************************
+Offline detection and automatic reconnect (RECONNECT.h). The SDK's offline callback only starts the
+state machine, a thread of the default thread pool per camera then runs it, so a camera that is
+being searched for never blocks the other cameras, the display timer or the SDK threads:
+
+ 1. The dead handle is closed (stream suspended, callbacks unregistered).
+ 2. The camera is searched for by SerialNumber every Reconnect.RetryIntervalMs and reopened.
+ 3. The last known geometry and every InitDevice parameter in struct camera_s are applied again,
+    and the bandwidth plan if the camera is part of one.
+ 4. Acquisition is restarted if it was running, in-place: pool, bitmap and statistics are kept.
+
+Time from the offline event to the restarted stream is kept in cam->Reconnect.
+****************************************************************************************************/
+
+GX_STATUS RegisterOfflineCallback(struct camera_s *cam) {
+	
+	cam->OfflineCallback = NULL;
+	
+	return GXRegisterDeviceOfflineCallback(cam->Device, cam, OnDeviceOfflineCallback, &cam->OfflineCallback);
+}
+
+void GX_STDC OnDeviceOfflineCallback(void *pUserParam) {
+	
+	struct camera_s *cam = (struct camera_s *)pUserParam;
+	if (!cam) return;
+	
+	if (!ReconnectOffline(&cam->Reconnect)) return; // Already recovering
+	
+	printf("Camera %s went offline.\n", cam->SerialNumber);
+	
+	if (cam->AutoReconnect) StartReconnectThread(cam);
+}
+
+void SimulateDeviceOffline(struct camera_s *cam) {
+	
+	if (cam->DevOpened) OnDeviceOfflineCallback(cam);
+}
+
+void StartReconnectThread(struct camera_s *cam) {
+	
+	// The previous outage's thread has finished (the state was ONLINE again), release it
+	StopReconnectThread(cam);
+	
+	cam->ReconnectRun = 1;
+	
+	if (CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, ReconnectThreadFunction, cam, &cam->ReconnectFunctionId) < 0) {
+		
+		cam->ReconnectRun        = 0;
+		cam->ReconnectFunctionId = 0;
+		printf("Camera %s: reconnect thread not started.\n", cam->SerialNumber);
+	}
+}
+
+void StopReconnectThread(struct camera_s *cam) {
+	
+	if (cam->ReconnectFunctionId == 0) return;
+	
+	cam->ReconnectRun = 0;
+	
+	CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, cam->ReconnectFunctionId, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	CmtReleaseThreadPoolFunctionID(DEFAULT_THREAD_POOL_HANDLE, cam->ReconnectFunctionId);
+	
+	cam->ReconnectFunctionId = 0;
+}
+
+int CVICALLBACK ReconnectThreadFunction(void *functionData) {
+	
+	struct camera_s *cam = (struct camera_s *)functionData;
+	
+	while (cam->ReconnectRun) {
+		
+		int state = ReconnectStep(&cam->Reconnect);
+		
+		if (state == RECONNECT_ONLINE) {
+			printf("Camera %s back online after %.0f ms (%d attempts).\n", cam->SerialNumber, cam->Reconnect.LastRecoveryMs, cam->Reconnect.Attempts);
+			break;
+		}
+		
+		if (state == RECONNECT_FAILED) {
+			printf("Camera %s: not found after %d attempts, giving up.\n", cam->SerialNumber, cam->Reconnect.Attempts);
+			break;
+		}
+		
+		// Searching: wait for the next attempt without spinning
+		if (state == RECONNECT_SEARCHING) Delay(0.01);
+	}
+	
+	return 0;
+}
+
+void GetReconnectStats(struct camera_s *cam, int *state, long *recoveries, double *lastRecoveryMs, double *maxRecoveryMs) {
+	
+	if (state)          *state          = ReconnectState(&cam->Reconnect);
+	if (recoveries)     *recoveries     = cam->Reconnect.Recoveries;
+	if (lastRecoveryMs) *lastRecoveryMs = cam->Reconnect.LastRecoveryMs;
+	if (maxRecoveryMs)  *maxRecoveryMs  = cam->Reconnect.MaxRecoveryMs;
+}
+
+// Is the serial number on the bus again? Short enumeration timeout, the thread retries anyway.
+int ReconnectFind(void *device) {
+	
+	struct camera_s *cam = (struct camera_s *)device;
+	GX_DEVICE_BASE_INFO *pBaseInfo = NULL;
+	uint32_t nDevNum = 0;
+	int found = FALSE;
+	
+	// Own list, the shared cache is left to OpenDevice (reconnect threads run in parallel)
+	if (EnumerateDevices(200, &pBaseInfo, &nDevNum) != GX_STATUS_SUCCESS) return FALSE;
+	
+	for (uint32_t i = 0; i < nDevNum && !found; i++)
+		if (strcmp(pBaseInfo[i].szSN, (const char *)cam->SerialNumber) == 0) found = TRUE;
+	
+	free(pBaseInfo);
+	return found;
+}
+
+int ReconnectOpen(void *device) {
+	
+	struct camera_s *cam = (struct camera_s *)device;
+	GX_OPEN_PARAM stOpenParam = {0};
+	
+	stOpenParam.accessMode = GX_ACCESS_EXCLUSIVE;
+	stOpenParam.openMode   = GX_OPEN_SN;
+	stOpenParam.pszContent = (char *)cam->SerialNumber;
+	
+	if (GXOpenDevice(&stOpenParam, &cam->Device) != GX_STATUS_SUCCESS) {
+		cam->Device = NULL;
+		return CANCEL;
+	}
+	
+	cam->DevOpened = 1;
+	
+	if (RegisterOfflineCallback(cam) != GX_STATUS_SUCCESS) return CANCEL;
+	
+	return OK;
+}
+
+int ReconnectRestore(void *device) {
+	
+	struct camera_s *cam = (struct camera_s *)device;
+	struct capture_geometry_s geometry = cam->Geometry;
+	
+	// Geometry first, InitDevice reads it back with the payload
+	if (ApplyCaptureGeometry(cam, &geometry) != GX_STATUS_SUCCESS) return CANCEL;
+	if (InitDevice(cam) != GX_STATUS_SUCCESS) return CANCEL;
+	
+	// The device clock restarted
+	cam->HasCaptureOffset = 0;
+	
+	// Frames queued on the old clock go, the stream aligns again with its next frame
+	if (cam->FrameSync) {
+		FrameSyncRealign(cam->FrameSync, cam->FrameSyncStream);
+		cam->FrameSyncTimeBase = FRAME_TIME_NONE;
+	}
+	
+	ReplanCameraBandwidth(cam);
+	
+	return OK;
+}
+
+int ReconnectStart(void *device) {
+	
+	struct camera_s *cam = (struct camera_s *)device;
+	
+	if (!cam->ResumeAfterReconnect) return OK;
+	
+	if (cam->ActiveAcquisitionMode == ACQ_MODE_CALLBACK && GXRegisterCaptureCallback(cam->Device, cam, OnFrameCallbackFun) != GX_STATUS_SUCCESS) return CANCEL;
+	
+	ResumeAcquisition(cam);
+	if (!cam->IsSnap) return CANCEL;
+	
+	cam->ResumeAfterReconnect = 0;
+	return OK;
+}
+
+// The handle may belong to a device that is gone, errors are expected and ignored
+void ReconnectClose(void *device) {
+	
+	struct camera_s *cam = (struct camera_s *)device;
+	
+	if (SuspendAcquisition(cam)) cam->ResumeAfterReconnect = 1;
+	
+	StopEventThread(cam);
+	StopClockSync(cam);
+	
+	if (cam->Device != NULL) {
+		
+		if (cam->ActiveAcquisitionMode == ACQ_MODE_CALLBACK) GXUnregisterCaptureCallback(cam->Device);
+		UnregisterExposureEvents(cam);
+		
+		if (cam->OfflineCallback) {
+			GXUnregisterDeviceOfflineCallback(cam->Device, cam->OfflineCallback);
+			cam->OfflineCallback = NULL;
+		}
+		
+		GXCloseDevice(cam->Device);
+	}
+	
+	cam->Device    = NULL;
+	cam->DevOpened = 0;
+}
+
+/***************************************************************************************************
+Start / Stop Image Acquisition Functions.
+
+cam->AcquisitionMode selects how frames are delivered, read once at StartCameraAcquisition:
+ ACQ_MODE_CALLBACK  GXRegisterCaptureCallback, frames are processed on the SDK's internal thread.
+ ACQ_MODE_POLLING   One thread owned by us per camera calls GXGetImage with PollTimeoutMs, its
+                    priority (PollThreadPriority) and CPU affinity (PollThreadAffinity) are ours to set.
+****************************************************************************************************/
+
+void StartCameraAcquisition (struct camera_s *cam) {
+	
+    GX_STATUS emStatus = GX_STATUS_ERROR;
+	
+	if (!cam->DevOpened) return; // Camera did not come up
+
+    // PrepareForShowImg sets up the frame pool (reused if it still fits),
+    // plus creates the LabWindows bitmap handle
+    if (PrepareForShowImg(cam) != OK) {
+
+        MessagePopup("Camera Error", "Fail to allocate resources for image!");
+        return;
+    }
+
+	// Reset the zero-copy counter and the delivery statistics
+	cam->CopyBytesSaved = 0;
+	cam->AcqStartTime   = Timer();
+	memset(&cam->Delivery, 0, sizeof(cam->Delivery));
+	FrameMetadataReset(&cam->Metadata);
+	ResetExposureEvents(cam);
+	cam->HasCaptureOffset = 0;
+	for (int i = 0; i < LATENCY_STAGES; i++) LatencyHistReset(&cam->StageLatency[i]);
+	
+	cam->ActiveAcquisitionMode = (cam->AcquisitionMode == ACQ_MODE_POLLING) ? ACQ_MODE_POLLING : ACQ_MODE_CALLBACK;
+
+    // Register frame callback with the camera as user pointer (the polling thread is started after AcquisitionStart)
+	if (cam->ActiveAcquisitionMode == ACQ_MODE_CALLBACK) {
+		
+	    emStatus = GXRegisterCaptureCallback(cam->Device, cam, OnFrameCallbackFun);
+	    if (emStatus != GX_STATUS_SUCCESS) {
+			
+	        UnPrepareForShowImg(cam);
+	        ShowErrorString(emStatus);
+	        return;
+	    }
+	}
+
+    // Stream buffer handling (newest-only / oldest-first) and number of SDK buffers
+    emStatus = ApplyStreamBufferPolicy(cam);
+	
+    if (emStatus != GX_STATUS_SUCCESS) {
+		
+        UnPrepareForShowImg(cam);
+        ShowErrorString(emStatus);
+        return;
+    }
+
+    // Send AcquisitionStart command
+    emStatus = GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_START);
+	
+    if (emStatus != GX_STATUS_SUCCESS) {
+        UnPrepareForShowImg(cam);
+		ReleaseAcqBuffers(cam);
+        ShowErrorString(emStatus);
+        return;
+    }
+	
+	ResetStreamQueueMetrics(cam);
+	
+	// Polling mode: start our own acquisition thread
+	if (cam->ActiveAcquisitionMode == ACQ_MODE_POLLING && StartPollingThread(cam) != OK) {
+		
+		GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_STOP);
+        UnPrepareForShowImg(cam);
+		ReleaseAcqBuffers(cam);
+        MessagePopup("Camera Error", "Fail to start the polling acquisition thread!");
+        return;
+	}
+
+    cam->IsSnap = 1; // true
+	
+	StartStreamStatsSampler(cam);
+	
+	if (cam->LatencyDumpIntervalMs > 0 && cam->LatencyDumpTimerId <= 0) {
+		int timerId = NewAsyncTimer(cam->LatencyDumpIntervalMs / 1000.0, -1, 1, (AsyncTimerCallbackPtr)LatencyDumpTimerCallback, cam);
+		cam->LatencyDumpTimerId = (timerId > 0) ? timerId : 0;
+	}
+}
+
+
+void StopCameraAcquisition (struct camera_s *cam) {
+	
+    GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	
+	if (!cam->DevOpened) return;
+	
+	StopStreamStatsSampler(cam);
+	
+	if (cam->LatencyDumpTimerId > 0) {
+		DiscardAsyncTimer(cam->LatencyDumpTimerId);
+		cam->LatencyDumpTimerId = 0;
+	}
+	
+	// Polling mode: the thread must be gone before the stream stops
+	if (cam->ActiveAcquisitionMode == ACQ_MODE_POLLING) StopPollingThread(cam);
+
+    // Send AcquisitionStop command
+    emStatus = GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_STOP);
+    GX_VERIFY(emStatus);
+
+    // Unregister frame callback
+	if (cam->ActiveAcquisitionMode == ACQ_MODE_CALLBACK) {
+	    emStatus = GXUnregisterCaptureCallback(cam->Device);
+	    GX_VERIFY(emStatus);
+	}
+	
+    // Stop the timer FIRST, so no callbacks can run
+	// Kill the timer 
+    if (cam->timerId > 0)
+    {
+        DiscardAsyncTimer(cam->timerId);
+        cam->timerId = 0;
+    }
+	
+    cam->IsSnap = 0;
+
+    // Release memory
+    UnPrepareForShowImg(cam);
+	ReleaseAcqBuffers(cam);
+}
+
+/***************************************************************************************************
+Function to save a frame to a BMP. Caution, these files are large!
+
+Helper function to write a BMP file from a buffer that already 
+has the correct row alignment/padding. 
+For 24-bit color: rowBytes = ((width * 3) + 3) & ~3
+For 8-bit mono:  rowBytes = (width + 3) & ~3, plus a grayscale palette.
+
+Return 0 on success, -1 on failure
+****************************************************************************************************/
+
+int SaveBufferAsBMP(const char* fileName, struct camera_s *cam) {
+	
+    int width  = (int)cam->ImageWidth; 
+    int height = (int)cam->ImageHeight; 
+    int bitsPerPixel = cam->IsColorFilter ? 24 : 8;
+    int rowBytes = cam->IsColorFilter ? (((width * 3) + 3) & ~3) : ((width + 3) & ~3);
+
+    FILE *fp = fopen(fileName, "wb");
+    if (!fp) return -1;
+
+    uint32_t imageSize = rowBytes * height;
+
+    // Prepare file header
+    cam->BmpFile.bfType    = 0x4D42; // 'BM'
+    cam->BmpFile.bfOffBits = sizeof(cam->BmpFile) + 40; // 40 = size of standard BITMAPINFOHEADER
+    uint32_t paletteSize   = 0;
+
+    // If 8-bit, we need a 256-color palette
+    if (bitsPerPixel == 8) {
+        paletteSize = 256 * 4;
+        cam->BmpFile.bfOffBits += paletteSize; 
+    }
+
+    cam->BmpFile.bfSize      = cam->BmpFile.bfOffBits + imageSize;
+    cam->BmpFile.bfReserved1 = 0;
+    cam->BmpFile.bfReserved2 = 0;
+
+    // Prepare the standard 40-byte info header
+    // (remove that extra int32_t biColorTable[256] from your struct or do not rely on it)
+    BmpInfoHeader infoHeader;
+    memset(&infoHeader, 0, sizeof(infoHeader));
+    infoHeader.biSize        = 40;        // *** Must be exactly 40 for BITMAPINFOHEADER ***
+    infoHeader.biWidth       = width;
+    infoHeader.biHeight      = height;
+    infoHeader.biPlanes      = 1;
+    infoHeader.biBitCount    = (uint16_t)bitsPerPixel;
+    infoHeader.biCompression = 0;         // BI_RGB
+    infoHeader.biSizeImage   = imageSize;
+
+    // Write file header
+    fwrite(&cam->BmpFile, 1, sizeof(cam->BmpFile), fp);
+    // Write the standard 40-byte info header
+    fwrite(&infoHeader, 1, 40, fp);
+
+    // If 8-bit, write a grayscale palette (256 BGRA entries)
+    if (bitsPerPixel == 8) {
+        for (int i = 0; i < 256; i++) {
+            unsigned char bgra[4];
+            bgra[0] = (unsigned char)i; // B
+            bgra[1] = (unsigned char)i; // G
+            bgra[2] = (unsigned char)i; // R
+            bgra[3] = 0;                // A (unused)
+            fwrite(bgra, 1, 4, fp);
+        }
+    }
+
+    // Finally write pixel data
+    fwrite(cam->ImgBuffer, 1, imageSize, fp);
+
+    fclose(fp);
+    return 0;
+}
+
+/***************************************************************************************************
+The GxIAPI frame callback. This is called from the camera driver thread
+whenever a new frame is ready. We take a free frame from cam->Pool, decode the data into it, offer it
+to the registered frame consumers and publish it to the display through cam->Display. The display
+timer then picks up the newest frame as cam->ImgBuffer (the BMP image, i.e. can be drawn to a
+canvas, saved to file, ETC). A frame is never written while a consumer or the display still holds it.
+
+pFrame->pImgBuf belongs to us until the callback returns, so the conversion/flip reads straight
+from it. The frame is only copied into frame->Raw when the camera asks to keep raw frames.
+****************************************************************************************************/
+
+void GX_STDC OnFrameCallbackFun(GX_FRAME_CALLBACK_PARAM *pFrame) {
+	
+    if (pFrame == NULL) return;
+
+    struct camera_s *cam = (struct camera_s*)pFrame->pUserParam;
+    if (!cam) return; // Camera object is not passed correctly
+	
+	ProcessFrame(cam, pFrame);
+}
+
+/***************************************************************************************************
+Frame processing, the same for both acquisition modes. Runs on the SDK callback thread or on the
+polling thread, pFrame->pImgBuf is only valid until it returns.
+
+Every delivered frame is recorded in cam->Metadata first, incomplete ones included (they are counted
+there and not displayed).
+****************************************************************************************************/
+
+void ProcessFrame(struct camera_s *cam, GX_FRAME_CALLBACK_PARAM *pFrame) {
+	
+	int64_t deliveredTicks = GetHostTicks();
+	double hostTimeMs = HostTicksToUs(deliveredTicks) / 1000.0;
+	
+	double exposureTime = -1;
+	double gain = -1;
+	ReadFrameChunks(cam, pFrame, &exposureTime, &gain);
+	
+	FrameMetadataRecord(&cam->Metadata, pFrame->nFrameID, pFrame->nTimestamp, hostTimeMs, pFrame->status, pFrame->nPixelFormat, exposureTime, gain);
+	
+	if (pFrame->status != 0) return;
+	
+	UpdateDeliveryStats(cam, hostTimeMs);
+	
+    // Ensure that the driver buffer is valid
+    if (pFrame->pImgBuf == NULL) {
+        // Log the error
+        MessagePopup("Error", "pImgBuf is NULL. Check memory allocation.");
+        return;
+    }
+
+    // Log an error if image size is zero or negative
+    if (pFrame->nImgSize <= 0) {
+        MessagePopup("Error", "Invalid image size in frame callback.");
+        return;
+	}
+	
+	// Take a free frame. If every frame is still held the pool applies its drop policy
+	// and we drop this one instead of overwriting a frame somebody is using.
+	struct frame_s *frame = FramePoolAcquire(&cam->Pool);
+	if (frame == NULL) return;
+	
+	// Source of the conversion: the driver buffer, or our copy of it
+	unsigned char *rawData = (unsigned char *)pFrame->pImgBuf;
+	
+	if (cam->KeepRawFrames && frame->Raw != NULL && (size_t)pFrame->nImgSize <= cam->Pool.RawCapacity) {
+		memcpy(frame->Raw, pFrame->pImgBuf, pFrame->nImgSize);
+		frame->RawSize = (size_t)pFrame->nImgSize;
+		rawData = frame->Raw;
+	}
+	else {
+		// Count the copy we skipped (memcpy reads and writes every byte)
+		ATOMIC_ADD64(&cam->CopyBytesSaved, 2 * (int64_t)pFrame->nImgSize);
+		frame->RawSize = 0;
+	}
+	
+	int64_t copiedTicks = GetHostTicks();
+
+    int width  = (int)cam->ImageWidth; 
+    int height = (int)cam->ImageHeight; 
+	int bitsPerPixel = cam->IsColorFilter ? 24 : 8;
+    int rowBytes = cam->IsColorFilter ? (((width * 3) + 3) & ~3) : ((width + 3) & ~3);
+	
+	unsigned char *imgBuffer = frame->Data;
+	
+	// 10/12-bit formats: unpack to 16 bits per pixel, the conversion below maps them to 8 bits with the tone LUT
+	int packed   = 0;
+	int bitDepth = PixelFormatBits((int)pFrame->nPixelFormat, &packed);
+	size_t pixels = (size_t)width * height;
+	
+	// The size the buffers were filled with, cam->ImageWidth/Height can change before the frame is saved
+	frame->Width     = width;
+	frame->Height    = height;
+	frame->BitDepth  = bitDepth > 0 ? bitDepth : 8;
+	frame->Raw16Size = 0;
+	
+	if (bitDepth > 8) {
+		
+		if (frame->Raw16 == NULL || pixels * sizeof(uint16_t) > cam->Pool.Raw16Capacity
+			|| (size_t)pFrame->nImgSize < PixelFormatBytes((int)pFrame->nPixelFormat, pixels)) {
+			FrameRelease(frame);
+			return;
+		}
+		
+		PixelUnpack(rawData, frame->Raw16, pixels, bitDepth, packed);
+		
+		frame->Raw16Size = pixels * sizeof(uint16_t);
+	}
+	
+	// Tone LUT of the source depth, only rebuilt when a setting changed. 10/12 bits always need one (it also drops the low bits).
+	int srcBits = bitDepth > 8 ? bitDepth : 8;
+	double gamma = cam->ToneGamma > 0 ? cam->ToneGamma : 1.0;
+	
+	if (ToneLutUpdate(&cam->ToneLut, srcBits, gamma, cam->ToneContrast, cam->ToneLightness) != OK && srcBits > 8) {
+		FrameRelease(frame);
+		return;
+	}
+
+	// Color: LUT + demosaic to RGB, mono: LUT + flip. One pass to bottom-up bitmap rows, in bands on the conversion threads.
+	struct convert_job_s job = {0};
+	
+	job.Src       = srcBits > 8 ? (const void *)frame->Raw16 : (const void *)rawData;
+	job.SrcBits   = srcBits;
+	job.SrcStride = srcBits > 8 ? width * (int)sizeof(uint16_t) : width;
+	job.Lut       = srcBits > 8 ? cam->ToneLut.Table : ToneLutTable(&cam->ToneLut);
+	job.Dst       = imgBuffer;
+	job.Width     = width;
+	job.Height    = height;
+	job.RowBytes  = rowBytes;
+	job.Color     = cam->IsColorFilter;
+	job.Pattern   = (int)cam->PixelColorFilter;
+	job.Quality   = cam->DemosaicQuality;
+	job.Kernel    = cam->DemosaicKernel;
+	job.Lines     = cam->DemosaicLines;
+	
+	if (TilePoolRun(&cam->ConvertPool, height, cam->ConvertBandRows, ConvertBand, &job) != OK || ATOMIC_LOAD(&job.Failed)) {
+		
+		// Mono: the pool could not run, the flip needs no line buffers and runs whole on this thread
+		if (!job.Color) {
+			ConvertBand(&job, 0, height, 0);
+		}
+		// Color, no line buffers (or a frame they do not fit): the SDK converts a whole 8-bit frame, without the tone curve
+		else if (srcBits > 8) {
+			FrameRelease(frame);
+			return;
+		}
+		else {
+			DxRaw8toRGB24 (rawData, imgBuffer, (VxUint32)width, (VxUint32)height, RAW2RGB_NEIGHBOUR, (DX_PIXEL_COLOR_FILTER)cam->PixelColorFilter, TRUE);
+		}
+	}
+	
+	int64_t convertedTicks = GetHostTicks();
+	
+	// Frame information
+	frame->DataSize    = (size_t)rowBytes * height;
+	frame->FrameID     = pFrame->nFrameID;
+	frame->Timestamp   = pFrame->nTimestamp;
+	frame->HostTimeMs  = hostTimeMs;
+	frame->ExposureTime = exposureTime;
+	frame->Gain         = gain;
+	
+	// Capture time on the host clock. Without the clock sync fit: the frame that arrived quickest gives the best offset
+	double deviceTimeMs = (double)pFrame->nTimestamp * (1000.0 / (double)cam->TimestampTickFrequency);
+	if (!cam->HasCaptureOffset || hostTimeMs - deviceTimeMs < cam->CaptureOffsetMs) {
+		cam->CaptureOffsetMs  = hostTimeMs - deviceTimeMs;
+		cam->HasCaptureOffset = 1;
+	}
+	DeviceTimestampToHostMs(cam, pFrame->nTimestamp, &frame->CaptureTimeMs);
+	
+	// When the exposure ended, if its event is already in (GetExposureEndTime finds later ones)
+	frame->ExposureEndTimestamp = 0;
+	frame->ExposureEndTimeMs    = -1;
+	if (cam->ExposureEndCallback && ExposureEventJoin(&cam->ExposureEnd, pFrame->nFrameID, &frame->ExposureEndTimestamp)) {
+		DeviceTimestampToHostMs(cam, frame->ExposureEndTimestamp, &frame->ExposureEndTimeMs);
+	}
+	
+	frame->DeliveredTicks = deliveredTicks;
+	frame->CopiedTicks    = copiedTicks;
+	frame->ConvertedTicks = convertedTicks;
+	
+	LatencyHistRecord(&cam->StageLatency[LATENCY_STAGE_CAPTURE], (hostTimeMs - frame->CaptureTimeMs) * 1000.0);
+	RecordStageLatency(cam, LATENCY_STAGE_COPY, deliveredTicks, copiedTicks);
+	RecordStageLatency(cam, LATENCY_STAGE_CONVERT, copiedTicks, convertedTicks);
+	frame->PixelFormat = pFrame->nPixelFormat;
+	
+	// A TriggerAndWait is waiting for exactly this frame
+	TriggerWaitDeliver(&cam->Trigger, frame, frame->HostTimeMs);
+	
+	// Offer the frame to the consumers, each takes its own reference if it keeps it
+	for (int i = 0; i < cam->NumFrameConsumers; i++) {
+		cam->FrameConsumers[i].Callback(cam, frame, cam->FrameConsumers[i].UserData);
+	}
+	
+	// Hand the complete frame to the display. The display now owns our reference.
+	TripleBufferSetBack(&cam->Display, frame);
+	TripleBufferPublish(&cam->Display);
+	
+	// We got back either an empty slot or a frame the display never picked up (or has moved past)
+	FrameRelease((struct frame_s *)TripleBufferBack(&cam->Display));
+	TripleBufferSetBack(&cam->Display, NULL);
+	
+	//static int g_frameIndex = 0;  // keeps incrementing on each callback
+    //char filename[256];
+    //sprintf(filename, "C:\\temp\\frame_%04d.bmp", g_frameIndex++);
+	
+	//int rc = SaveBufferAsBMP(filename, cam);
+}
+
+/***************************************************************************************************
+Polling acquisition thread. One per camera, owned by us instead of the SDK: waits for the next frame
+with GXGetImage and runs it through the same ProcessFrame as the capture callback.
+GXGetImage copies the frame into PollBuffer (PayLoadSize bytes), which is reused for every frame.
+****************************************************************************************************/
+
+int StartPollingThread(struct camera_s *cam) {
+	
+	size_t bytes = (size_t)cam->PayLoadSize;
+	if (cam->StandIn != NULL && (size_t)cam->StandIn->ImageBytes > bytes) bytes = (size_t)cam->StandIn->ImageBytes;
+	
+	cam->PollBuffer = (unsigned char *)malloc(bytes);
+	if (cam->PollBuffer == NULL) return CANCEL;
+	
+	if (CmtNewThreadPool(1, &cam->PollThreadPool) < 0) {
+		
+		free(cam->PollBuffer);
+		cam->PollBuffer = NULL;
+		return CANCEL;
+	}
+	
+	cam->PollThreadRun = 1;
+	
+	if (CmtScheduleThreadPoolFunctionAdv(cam->PollThreadPool, PollingThreadFunction, cam, cam->PollThreadPriority,
+										 NULL, 0, NULL, 0, &cam->PollThreadFunctionId) < 0) {
+		
+		cam->PollThreadRun = 0;
+		CmtDiscardThreadPool(cam->PollThreadPool);
+		cam->PollThreadPool = 0;
+		free(cam->PollBuffer);
+		cam->PollBuffer = NULL;
+		return CANCEL;
+	}
+	
+	return OK;
+}
+
+void StopPollingThread(struct camera_s *cam) {
+	
+	if (cam->PollThreadPool == 0) return;
+	
+	// The thread notices within one GXGetImage timeout
+	cam->PollThreadRun = 0;
+	
+	CmtWaitForThreadPoolFunctionCompletion(cam->PollThreadPool, cam->PollThreadFunctionId, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	CmtReleaseThreadPoolFunctionID(cam->PollThreadPool, cam->PollThreadFunctionId);
+	CmtDiscardThreadPool(cam->PollThreadPool);
+	
+	cam->PollThreadPool       = 0;
+	cam->PollThreadFunctionId = 0;
+	
+	free(cam->PollBuffer);
+	cam->PollBuffer = NULL;
+}
+
+int CVICALLBACK PollingThreadFunction(void *functionData) {
+	
+	struct camera_s *cam = (struct camera_s *)functionData;
+	
+	GX_FRAME_DATA stFrameData;
+	GX_FRAME_CALLBACK_PARAM stFrame;
+	GX_STATUS emStatus;
+	
+	uint32_t timeout = (cam->PollTimeoutMs > 0) ? (uint32_t)cam->PollTimeoutMs : 500;
+	
+	// Pin the thread to the requested CPUs
+	if (cam->PollThreadAffinity != 0) SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)cam->PollThreadAffinity);
+	
+	while (cam->PollThreadRun) {
+		
+		memset(&stFrameData, 0, sizeof(stFrameData));
+		stFrameData.pImgBuf = cam->PollBuffer;
+		
+		if (cam->StandIn != NULL) emStatus = GxStandInGetImage(cam->StandIn, &stFrameData, timeout);
+		else emStatus = GXGetImage(cam->Device, &stFrameData, timeout);
+		
+		// Nothing arrived within the timeout, just check whether we should stop
+		if (emStatus == GX_STATUS_TIMEOUT) continue;
+		
+		if (emStatus != GX_STATUS_SUCCESS) {
+			cam->PollErrors++;
+			Sleep(1); // Don't spin on a persistent error
+			continue;
+		}
+		
+		// Same layout the capture callback gets
+		stFrame.pUserParam   = cam;
+		stFrame.status       = stFrameData.nStatus;
+		stFrame.pImgBuf      = stFrameData.pImgBuf;
+		stFrame.nImgSize     = stFrameData.nImgSize;
+		stFrame.nWidth       = stFrameData.nWidth;
+		stFrame.nHeight      = stFrameData.nHeight;
+		stFrame.nPixelFormat = stFrameData.nPixelFormat;
+		stFrame.nFrameID     = stFrameData.nFrameID;
+		stFrame.nTimestamp   = stFrameData.nTimestamp;
+		
+		ProcessFrame(cam, &stFrame);
+	}
+	
+	return 0;
+}
+
+/***************************************************************************************************
+Delivery statistics. Frame rate and jitter (standard deviation of the host-side interval between
+delivered frames) since StartCameraAcquisition, used to compare the callback and polling modes.
+****************************************************************************************************/
+
+double GetHostTimeMs(void) {
+	
+	return HostTicksToUs(GetHostTicks()) / 1000.0;
+}
+
+int64_t GetHostTicks(void) {
+	
+	LARGE_INTEGER counter;
+	
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+double HostTicksToUs(int64_t ticks) {
+	
+	static double usPerTick = 0;
+	
+	if (usPerTick == 0) {
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		usPerTick = 1000000.0 / (double)frequency.QuadPart;
+	}
+	
+	return (double)ticks * usPerTick;
+}
+
+// Welford's running mean/variance of the interval, only touched by the delivering thread
+void UpdateDeliveryStats(struct camera_s *cam, double now) {
+	
+	if (cam->Delivery.Frames > 0) {
+		
+		double interval = now - cam->Delivery.LastTimeMs;
+		double delta    = interval - cam->Delivery.MeanIntervalMs;
+		
+		cam->Delivery.Intervals++;
+		cam->Delivery.MeanIntervalMs += delta / (double)cam->Delivery.Intervals;
+		cam->Delivery.M2             += delta * (interval - cam->Delivery.MeanIntervalMs);
+	}
+	else cam->Delivery.FirstTimeMs = now;
+	
+	cam->Delivery.LastTimeMs = now;
+	cam->Delivery.Frames++;
+}
+
+void GetDeliveryStats(struct camera_s *cam, double *framesPerSecond, double *meanIntervalMs, double *jitterMs) {
+	
+	struct delivery_stats_s stats = cam->Delivery; // Snapshot, the delivering thread keeps going
+	
+	double elapsed = stats.LastTimeMs - stats.FirstTimeMs;
+	
+	if (framesPerSecond) *framesPerSecond = (elapsed > 0) ? (double)(stats.Frames - 1) * 1000.0 / elapsed : 0;
+	if (meanIntervalMs)  *meanIntervalMs  = stats.MeanIntervalMs;
+	if (jitterMs)        *jitterMs        = (stats.Intervals > 1) ? sqrt(stats.M2 / (double)(stats.Intervals - 1)) : 0;
+}
+
+/***************************************************************************************************
+Acquisition mode benchmark. Feeds ProcessFrame from a stand-in GxIAPI source (GX_STANDIN.h) at
+frameRate for `seconds` in each mode: through OnFrameCallbackFun on the source thread, then through
+the polling thread with the camera's PollThreadPriority and PollThreadAffinity. loadThreads busy
+threads compete for the CPUs meanwhile. Prints the delivered frame rate, the interval jitter, the
+longest interval and the frames dropped in each mode.
+The camera must be open and not acquiring. Its frame size, pixel format, frame pool and conversion
+settings are used, no frame comes from the device. Returns OK, or CANCEL if a mode could not run.
+****************************************************************************************************/
+
+int BenchmarkAcquisitionModes(struct camera_s *cam, double frameRate, double seconds, int loadThreads) {
+	
+	const char *modeNames[2] = {"callback", "polling"};
+	struct gx_standin_s source;
+	int width  = (int)cam->ImageWidth;
+	int height = (int)cam->ImageHeight;
+	int32_t imageBytes = (int32_t)PixelFormatBytes((int)cam->PixelFormat, (size_t)width * height);
+	int result = OK;
+	
+	if (!cam->DevOpened || cam->IsSnap || frameRate <= 0 || seconds <= 0) {
+		printf("BenchmarkAcquisitionModes: camera %s must be open and stopped.\n", cam->SerialNumber);
+		return CANCEL;
+	}
+	
+	if (PrepareForShowImg(cam) != OK) return CANCEL;
+	
+	if (GxStandInLoadStart(loadThreads) != OK) {
+		printf("BenchmarkAcquisitionModes: %d load threads not started.\n", loadThreads);
+		UnPrepareForShowImg(cam);
+		return CANCEL;
+	}
+	
+	printf("Camera %s: %dx%d frames at %.1f fps from a stand-in source, %d load threads\n", cam->SerialNumber, width, height, frameRate, loadThreads);
+	
+	for (int mode = ACQ_MODE_CALLBACK; mode <= ACQ_MODE_POLLING; mode++) {
+		
+		struct frame_window_stats_s window;
+		double fps = 0, meanMs = 0, jitterMs = 0;
+		
+		memset(&cam->Delivery, 0, sizeof(cam->Delivery));
+		FrameMetadataReset(&cam->Metadata);
+		cam->ActiveAcquisitionMode = mode;
+		
+		if (mode == ACQ_MODE_CALLBACK) {
+			
+			if (GxStandInStart(&source, width, height, (int32_t)cam->PixelFormat, imageBytes, frameRate, OnFrameCallbackFun, cam) != OK) {
+				result = CANCEL;
+				break;
+			}
+		}
+		else {
+			
+			if (GxStandInStart(&source, width, height, (int32_t)cam->PixelFormat, imageBytes, frameRate, NULL, NULL) != OK) {
+				result = CANCEL;
+				break;
+			}
+			
+			cam->StandIn = &source;
+			
+			if (StartPollingThread(cam) != OK) {
+				cam->StandIn = NULL;
+				GxStandInStop(&source);
+				result = CANCEL;
+				break;
+			}
+		}
+		
+		Delay(seconds);
+		
+		// The polling thread first, it must not wait on a stopped source
+		if (mode == ACQ_MODE_POLLING) StopPollingThread(cam);
+		GxStandInStop(&source);
+		cam->StandIn = NULL;
+		
+		GetDeliveryStats(cam, &fps, &meanMs, &jitterMs);
+		FrameMetadataQuery(&cam->Metadata, FRAME_METADATA_MAX_WINDOW, &window);
+		
+		printf("  %-8s %.1f fps, interval %.3f ms, jitter %.3f ms, max %.3f ms (last %d frames), %ld of %ld frames dropped\n",
+			   modeNames[mode], fps, meanMs, jitterMs, window.MaxIntervalMs, window.Frames,
+			   (long)ATOMIC_LOAD(&source.Dropped), (long)ATOMIC_LOAD(&source.Generated));
+	}
+	
+	GxStandInLoadStop();
+	
+	cam->ActiveAcquisitionMode = ACQ_MODE_CALLBACK;
+	UnPrepareForShowImg(cam);
+	
+	return result;
+}
+
+/***************************************************************************************************
+Frame metadata statistics over the last `window` delivered frames: dropped frames (gaps in the frame
+IDs), incomplete frames, drop rate and inter-frame interval jitter. Returns the frames in the window.
+Safe to call from any thread while acquiring.
+****************************************************************************************************/
+
+int GetFrameWindowStats(struct camera_s *cam, int window, struct frame_window_stats_s *stats) {
+	
+	return FrameMetadataQuery(&cam->Metadata, window, stats);
+}
+
+/***************************************************************************************************
+Prepare/unprepare to show image
+****************************************************************************************************/
+
+int PrepareForShowImg(struct camera_s *cam) {
+
+	if (cam->IsColorFilter) {
+		// Allocate buffer for showing color image.
+		if (PrepareForShowColorImg(cam) != OK) {
+			UnPrepareForShowImg(cam);
+			return CANCEL;
+		}
+	}
+	else {
+		// Allocate buffer for showing mono image.
+		if (PrepareForShowMonoImg(cam) != OK) {
+			UnPrepareForShowImg(cam);
+			return CANCEL;
+		}
+	}
+	
+    // Compute rowBytes
+    int rowBytes = 0;
+    if (cam->BmpInfo.biBitCount == 24) rowBytes = ((cam->BmpInfo.biWidth * 3) + 3) & ~3;
+    else rowBytes = (cam->BmpInfo.biWidth + 3) & ~3; // 8-bit
+	
+    size_t totalBytes = (size_t)rowBytes * cam->BmpInfo.biHeight;
+	
+    // Same size as last time: keep the bitmap, NewBitmap of a large frame takes tens of ms
+    if (cam->BitmapHandle && cam->BitmapWidth == cam->BmpInfo.biWidth && cam->BitmapHeight == cam->BmpInfo.biHeight
+		&& cam->BitmapDepth == cam->BmpInfo.biBitCount) {
+		
+		int *colorTablePtr = (cam->BmpInfo.biBitCount == 8) ? cam->BmpInfo.biColorTable : NULL;
+		
+		if (SetBitmapData(cam->BitmapHandle, rowBytes, cam->BmpInfo.biBitCount, colorTablePtr, cam->ImgBuffer, NULL) >= 0) return OK;
+    }
+	
+	DiscardDisplayBitmap(cam);
+
+    // Create the LabWindows/CVI bitmap
+    int error = NewBitmap(
+        rowBytes,           		// bytesPerRow (24-bit color => 3width, aligned)
+        cam->BmpInfo.biBitCount,	// 24 for color, 8 for mono
+        cam->BmpInfo.biWidth,
+        cam->BmpInfo.biHeight,
+        cam->BmpInfo.biColorTable,  // grayscale palette if mono
+        cam->ImgBuffer,     		// pointer to image data
+        NULL,               		// no mask
+        &cam->BitmapHandle
+    );
+	
+    if (error < 0) {
+        ReleaseDisplayFrames(cam);
+        cam->BitmapHandle = 0;
+        return CANCEL; // error
+    }
+	
+	cam->BitmapWidth  = cam->BmpInfo.biWidth;
+	cam->BitmapHeight = cam->BmpInfo.biHeight;
+	cam->BitmapDepth  = cam->BmpInfo.biBitCount;
+
+    return OK; // success
+}
+
+//allocate memory for showing color image.
+int PrepareForShowColorImg(struct camera_s *cam) {
+	
+	memset(cam->BmpBuf, 0, sizeof(cam->BmpBuf));
+	
+	//Initialize bitmap header
+	//cam->BmpInfo					= (BITMAPINFO *)cam->BmpBuf;
+	cam->BmpInfo.biSize				= sizeof(BITMAPINFOHEADER);
+	cam->BmpInfo.biWidth			= (LONG)cam->ImageWidth;
+	cam->BmpInfo.biHeight			= (LONG)cam->ImageHeight;	
+
+	cam->BmpInfo.biPlanes			= 1;
+	cam->BmpInfo.biBitCount			= 24; 
+	cam->BmpInfo.biCompression		= BI_RGB;
+	cam->BmpInfo.biSizeImage		= 0;
+	cam->BmpInfo.biXPelsPerMeter	= 0;
+	cam->BmpInfo.biYPelsPerMeter	= 0;
+	cam->BmpInfo.biClrUsed			= 0;
+	cam->BmpInfo.biClrImportant		= 0;
+	
+	int width = (int)cam->ImageWidth;
+	int height = (int)cam->ImageHeight;
+	int rowBytes = ((width * 3) + 3) & ~3;
+	
+	// Allocate memory for showing converted color images. 3 bytes per pixel, rows aligned to 4 bytes.
+    if (AllocateDisplayBuffers(cam, (size_t)rowBytes * height) != OK) return CANCEL;
+	
+	return PrepareConversion(cam);
+}
+
+//allocate memory for showing mono image.
+int PrepareForShowMonoImg(struct camera_s *cam) {
+	
+	memset(cam->BmpBuf, 0, sizeof(cam->BmpBuf));
+	
+	//Initialize bitmap header
+	//cam->BmpInfo					= (BITMAPINFO *)cam->BmpBuf;
+	cam->BmpInfo.biSize				= sizeof(BITMAPINFOHEADER);
+	cam->BmpInfo.biWidth			= (LONG)cam->ImageWidth;
+	cam->BmpInfo.biHeight			= (LONG)cam->ImageHeight;	
+
+	cam->BmpInfo.biPlanes			= 1;
+	cam->BmpInfo.biBitCount			= 8;  
+	cam->BmpInfo.biCompression		= BI_RGB;
+	cam->BmpInfo.biSizeImage		= 0;
+	cam->BmpInfo.biXPelsPerMeter	= 0;
+	cam->BmpInfo.biYPelsPerMeter	= 0;
+	cam->BmpInfo.biClrUsed			= 0;
+	cam->BmpInfo.biClrImportant		= 0;
+
+	if (!cam->IsColorFilter) {
+		// If using mono cameras,you need to initialize color palette first.
+		for(int i = 0; i < 256; i++) {
+			// MAKE_COLOR(r, g, b) -> uses 0x00BBGGRR in CVI
+			cam->BmpInfo.biColorTable[i] = MAKE_COLOR(i, i, i);
+		}
+	}
+	
+	int width = (int)cam->ImageWidth;
+	int height = (int)cam->ImageHeight;
+	int rowBytes = (width + 3) & ~3;
+	
+	// Allocate memory for showing converted mono images, rows aligned to 4 bytes
+    if (AllocateDisplayBuffers(cam, (size_t)rowBytes * height) != OK) return CANCEL;
+	
+	return PrepareConversion(cam);
+}
+
+//set up the frame pool and the frame callback -> display timer triple buffer.
+//The pool is only reallocated when it no longer fits, otherwise the preallocated frames are reused.
+int AllocateDisplayBuffers(struct camera_s *cam, size_t bytes) {
+	
+	// Raw frames (PayLoadSize, 8 bits/pixel for color Bayer or mono) are only kept if asked for,
+	// the frame callback converts straight from the driver buffer otherwise.
+	size_t rawBytes = cam->KeepRawFrames ? (size_t)cam->PayLoadSize : 0;
+	
+	// 10/12-bit frames are also kept unpacked to 16 bits per pixel, the display gets them through the tone LUT
+	size_t pixels     = (size_t)cam->ImageWidth * (size_t)cam->ImageHeight;
+	size_t raw16Bytes = cam->ActiveBitDepth > 8 ? pixels * sizeof(uint16_t) : 0;
+	
+	cam->Pool.DropPolicy    = cam->FrameDropPolicy;
+	cam->Pool.WaitTimeoutMs = cam->FrameWaitTimeoutMs;
+	
+	if (!FramePoolFits(&cam->Pool, cam->FramePoolSize, bytes, rawBytes, raw16Bytes)) {
+		
+		FramePoolDestroy(&cam->Pool);
+		
+		if (FramePoolCreate(&cam->Pool, cam->FramePoolSize, bytes, rawBytes, raw16Bytes) != OK) return CANCEL;
+	}
+	
+	// The display starts out showing a blank frame, the other two slots are empty
+	struct frame_s *blank = FramePoolAcquire(&cam->Pool);
+	if (blank == NULL) return CANCEL;
+	
+	memset(blank->Data, 0, bytes);
+	blank->DataSize  = bytes;
+	blank->Width     = (int)cam->ImageWidth;
+	blank->Height    = (int)cam->ImageHeight;
+	blank->Raw16Size = 0;
+	
+	TripleBufferInit(&cam->Display, NULL, NULL, blank);
+	cam->ImgBuffer = blank->Data;
+	
+	return OK;
+}
+
+//give every frame held by the display back to the pool.
+void ReleaseDisplayFrames(struct camera_s *cam) {
+	
+	for (int i = 0; i < 3; i++) FrameRelease((struct frame_s *)TripleBufferSlot(&cam->Display, i));
+	
+	TripleBufferInit(&cam->Display, NULL, NULL, NULL);
+	cam->ImgBuffer = NULL;
+	
+	ReleaseConversion(cam);
+}
+
+//start the conversion threads and give each its demosaic line buffers.
+//Nothing here is fatal: fewer threads, or DxRaw8toRGB24 without line buffers.
+int PrepareConversion(struct camera_s *cam) {
+	
+	int threads = cam->ConvertThreads > 0 ? cam->ConvertThreads : TilePoolProcessors();
+	if (threads > TILE_POOL_MAX_THREADS) threads = TILE_POOL_MAX_THREADS;
+	
+	if (cam->ConvertPool.Threads != threads) {
+		
+		TilePoolDestroy(&cam->ConvertPool);
+		
+		if (threads > 1 && TilePoolCreate(&cam->ConvertPool, threads) != OK) {
+			printf("Camera %s: no conversion threads, converting on the frame callback thread\n", cam->SerialNumber);
+		}
+	}
+	
+	if (cam->IsColorFilter) {
+		
+		int workers = cam->ConvertPool.Threads > 1 ? cam->ConvertPool.Threads : 1;
+		
+		for (int i = 0; i < workers; i++) {
+			
+			if (DemosaicLinesAlloc(&cam->DemosaicLines[i], (int)cam->ImageWidth) != OK) {
+				
+				// Run on the workers that have them (the callback thread first)
+				TilePoolDestroy(&cam->ConvertPool);
+				if (i > 1) TilePoolCreate(&cam->ConvertPool, i);
+				break;
+			}
+		}
+	}
+	
+	return OK;
+}
+
+void ReleaseConversion(struct camera_s *cam) {
+	
+	TilePoolDestroy(&cam->ConvertPool);
+	
+	for (int i = 0; i < TILE_POOL_MAX_THREADS; i++) DemosaicLinesFree(&cam->DemosaicLines[i]);
+	
+	ToneLutFree(&cam->ToneLut);
+}
+
+//convert source rows firstRow..lastRow-1 of a frame, on any worker of cam->ConvertPool.
+//The demosaic reads the halo rows around the band from the source, bands never wait for each other.
+void ConvertBand(void *context, int firstRow, int lastRow, int worker) {
+	
+	struct convert_job_s *job = (struct convert_job_s *)context;
+	
+	if (job->Color) {
+		
+		if (DemosaicRows(job->Src, job->SrcBits, job->Lut, job->Width, job->Height, job->SrcStride, job->Dst, job->RowBytes, TRUE, job->Pattern,
+						 job->Quality, job->Kernel, firstRow, lastRow, &job->Lines[worker]) != OK) {
+			ATOMIC_STORE(&job->Failed, 1);
+		}
+		return;
+	}
+	
+	for (int y = firstRow; y < lastRow; y++) {
+		DemosaicMapRow((const uint8_t *)job->Src + (size_t)y * job->SrcStride, job->SrcBits, job->Lut, job->Width,
+					   job->Dst + (size_t)(job->Height - 1 - y) * job->RowBytes);
+	}
+}
+
+void UnPrepareForShowImg(struct camera_s *cam) {
+	
+	// Frames go back to the pool, the pool and the bitmap are kept for the next acquisition
+    ReleaseDisplayFrames(cam);
+}
+
+void DiscardDisplayBitmap(struct camera_s *cam) {
+	
+    if (cam->BitmapHandle) {
+		
+        DiscardBitmap(cam->BitmapHandle);
+        cam->BitmapHandle = 0;
+    }
+	
+	cam->BitmapWidth  = 0;
+	cam->BitmapHeight = 0;
+	cam->BitmapDepth  = 0;
+}
+
+/***************************************************************************************************
+Frame consumers. Called from the frame callback with every new frame (display, recorder, analysis...).
+A consumer that wants to keep the frame beyond the call takes a reference with FrameAddRef and gives
+it back with FrameRelease, no copy is made. Register consumers before starting the acquisition.
+****************************************************************************************************/
+
+int RegisterFrameConsumer(struct camera_s *cam, FrameConsumerCallback callback, void *userData) {
+	
+	if (callback == NULL || cam->NumFrameConsumers >= MAX_FRAME_CONSUMERS) return CANCEL;
+	
+	cam->FrameConsumers[cam->NumFrameConsumers].Callback = callback;
+	cam->FrameConsumers[cam->NumFrameConsumers].UserData = userData;
+	cam->NumFrameConsumers++;
+	
+	return OK;
+}
+
+void UnregisterFrameConsumer(struct camera_s *cam, FrameConsumerCallback callback) {
+	
+	for (int i = 0; i < cam->NumFrameConsumers; i++) {
+		
+		if (cam->FrameConsumers[i].Callback != callback) continue;
+		
+		// Keep the list packed
+		for (int j = i; j < cam->NumFrameConsumers - 1; j++) cam->FrameConsumers[j] = cam->FrameConsumers[j + 1];
+		
+		cam->NumFrameConsumers--;
+		return;
+	}
+}
+
+/***************************************************************************************************
+Stream buffer policy. The SDK queues completed frames in its acquisition buffers until ProcessFrame
+takes them:
+ GX_DS_STREAM_BUFFER_HANDLING_MODE_NEWEST_ONLY   Only the newest frame is delivered, older ones are
+                                                 dropped. Lowest latency, for live alignment work.
+ GX_DS_STREAM_BUFFER_HANDLING_MODE_OLDEST_FIRST  Every frame is delivered in order, a slow consumer
+                                                 falls behind. For recording.
+Newest-only needs only a few acquisition buffers, oldest-first needs enough to ride out stalls.
+
+The mode can only be written while the stream is stopped. SetStreamBufferPolicy on a running camera
+stops and restarts the stream around it, the frame callback / polling thread, the frame pool and the
+display stay as they are.
+****************************************************************************************************/
+
+// On failure the camera keeps its previous mode, buffer count and memory reservation
+int ApplyStreamBufferPolicy(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	int mode = cam->StreamBufferMode ? cam->StreamBufferMode : GX_DS_STREAM_BUFFER_HANDLING_MODE_OLDEST_FIRST;
+	int64_t previousMode = 0, bytes = 0;
+	
+	int restoreMode = (GXGetEnum(cam->Device, GX_DS_ENUM_STREAM_BUFFER_HANDLING_MODE, &previousMode) == GX_STATUS_SUCCESS && previousMode != mode);
+	
+	emStatus = GXSetEnum(cam->Device, GX_DS_ENUM_STREAM_BUFFER_HANDLING_MODE, mode);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	// Reserved next to the current buffers, which stay until the camera has taken the new count
+	int count = SizeAcqBuffers(cam, mode, &bytes);
+	
+	if (count == 0) emStatus = GX_STATUS_OUT_OF_RANGE; // Memory budget used up by the other cameras
+	else emStatus = GXSetAcqusitionBufferNumber(cam->Device, (uint64_t)count);
+	
+	if (emStatus != GX_STATUS_SUCCESS) {
+		
+		ReturnAcqBufferBytes(bytes);
+		if (restoreMode) GXSetEnum(cam->Device, GX_DS_ENUM_STREAM_BUFFER_HANDLING_MODE, previousMode);
+		return emStatus;
+	}
+	
+	// Commit: the new reservation replaces the previous one
+	ReleaseAcqBuffers(cam);
+	cam->AcqBufferBytes       = bytes;
+	cam->ActiveAcqBufferCount = count;
+	
+	return GX_STATUS_SUCCESS;
+}
+
+/***************************************************************************************************
+Acquisition buffer sizing. Called every time the stream starts, so a new ROI or pixel format (new
+PayLoadSize) or frame rate gives a new count:
+ newest-only   ACQ_BUFFER_MIN, older frames are dropped anyway
+ oldest-first  enough frames to absorb a host stall of BufferBurstMs at the current frame rate
+The count is then capped by what is left of the memory budget shared by all cameras; 0 when not
+even two buffers fit, the stream is then not started. The camera's current reservation counts as
+free, *bytes is reserved in addition to it and ApplyStreamBufferPolicy swaps the two.
+****************************************************************************************************/
+
+int64_t AcqBufferBudgetBytes = ACQ_BUFFER_DEFAULT_BUDGET;
+volatile int64_t AcqBufferReservedBytes = 0; // Sum of AcqBufferBytes of all cameras
+
+void SetAcqBufferMemoryBudget(int64_t bytes) {
+	
+	AcqBufferBudgetBytes = (bytes > 0) ? bytes : ACQ_BUFFER_DEFAULT_BUDGET;
+}
+
+int SizeAcqBuffers(struct camera_s *cam, int mode, int64_t *bytes) {
+	
+	double frameRate = 0;
+	int burstMs = (cam->BufferBurstMs > 0) ? cam->BufferBurstMs : ACQ_BUFFER_DEFAULT_BURST_MS;
+	int count = ACQ_BUFFER_MIN;
+	
+	*bytes = 0;
+	
+	// Payload of the current ROI / pixel format
+	GXGetInt(cam->Device, GX_INT_PAYLOAD_SIZE, &cam->PayLoadSize);
+	int64_t payload = (cam->PayLoadSize > 0) ? cam->PayLoadSize : 1;
+	
+	if (GXGetFloat(cam->Device, GX_FLOAT_CURRENT_ACQUISITION_FRAME_RATE, &frameRate) != GX_STATUS_SUCCESS || frameRate <= 0)
+		frameRate = 30;
+	
+	if (cam->AcqBufferCount > 0) count = cam->AcqBufferCount;
+	else if (mode != GX_DS_STREAM_BUFFER_HANDLING_MODE_NEWEST_ONLY) {
+		count = (int)ceil(frameRate * burstMs / 1000.0) + 1; // +1 for the frame being filled
+		if (count < ACQ_BUFFER_MIN) count = ACQ_BUFFER_MIN;
+	}
+	
+	// Stay under the budget left by the other cameras. Cameras can start together, the reservation
+	// only lands if no other camera reserved in between, otherwise it is sized again.
+	int requested = count;
+	int64_t reserved = ATOMIC_LOAD64(&AcqBufferReservedBytes);
+	
+	for (;;) {
+		
+		int64_t available = AcqBufferBudgetBytes - reserved + cam->AcqBufferBytes;
+		int64_t fits = (available > 0) ? available / payload : 0;
+		
+		count = (requested > fits) ? (int)fits : requested;
+		
+		// One being filled and one delivered is the least the stream runs with
+		if (count < 2) {
+			printf("Camera %s: %d acquisition buffers requested, the memory budget has room for %lld.\n", cam->SerialNumber, requested, (long long)fits);
+			return 0;
+		}
+		
+		int64_t previous = ATOMIC_COMPARE_EXCHANGE64(&AcqBufferReservedBytes, reserved + (int64_t)count * payload, reserved);
+		if (previous == reserved) break;
+		
+		reserved = previous;
+	}
+	
+	if (count < requested)
+		printf("Camera %s: %d acquisition buffers requested, only %d fit in the memory budget.\n", cam->SerialNumber, requested, count);
+	
+	*bytes = (int64_t)count * payload;
+	
+	printf("Camera %s: %d acquisition buffers (%.1f fps, %d ms burst, %.1f MB), %.1f MB of %.1f MB budget left.\n",
+		   cam->SerialNumber, count, frameRate, burstMs, *bytes / 1048576.0,
+		   (AcqBufferBudgetBytes - reserved + cam->AcqBufferBytes - *bytes) / 1048576.0, AcqBufferBudgetBytes / 1048576.0);
+	
+	return count;
+}
+
+void ReleaseAcqBuffers(struct camera_s *cam) {
+	
+	ReturnAcqBufferBytes(cam->AcqBufferBytes);
+	cam->AcqBufferBytes       = 0;
+	cam->ActiveAcqBufferCount = 0;
+}
+
+void ReturnAcqBufferBytes(int64_t bytes) {
+	
+	if (bytes != 0) ATOMIC_ADD64(&AcqBufferReservedBytes, -bytes);
+}
+
+GX_STATUS SetStreamBufferPolicy(struct camera_s *cam, int mode, int bufferCount) {
+	
+	int previousMode  = cam->StreamBufferMode;
+	int previousCount = cam->AcqBufferCount;
+	
+	cam->StreamBufferMode = mode;
+	cam->AcqBufferCount   = bufferCount;
+	
+	if (!SuspendAcquisition(cam)) return GX_STATUS_SUCCESS; // Applied by StartCameraAcquisition
+	
+	// The policy is applied on the way back up. If it is refused the camera runs on with the previous one.
+	GX_STATUS emStatus = ResumeAcquisition(cam);
+	
+	if (emStatus != GX_STATUS_SUCCESS) {
+		cam->StreamBufferMode = previousMode;
+		cam->AcqBufferCount   = previousCount;
+	}
+	
+	return emStatus;
+}
+
+void ResetStreamQueueMetrics(struct camera_s *cam) {
+	
+	int64_t delivered = 0;
+	
+	// Works whether the SDK counter restarts with the stream or not
+	if (GXGetInt(cam->Device, GX_DS_INT_DELIVERED_FRAME_COUNT, &delivered) != GX_STATUS_SUCCESS) delivered = 0;
+	
+	cam->DeliveredFrameBase  = delivered - (int64_t)ATOMIC_LOAD(&cam->Metadata.Frames);
+	cam->DisplayedFrameAgeMs = 0;
+}
+
+// queueDepth: frames the SDK has completed that ProcessFrame has not taken yet
+// displayedFrameAgeMs: time from capture to the draw of the frame on screen
+void GetStreamQueueMetrics(struct camera_s *cam, int64_t *queueDepth, double *displayedFrameAgeMs) {
+	
+	int64_t delivered = 0;
+	
+	if (queueDepth) {
+		
+		*queueDepth = 0;
+		
+		if (cam->IsSnap && GXGetInt(cam->Device, GX_DS_INT_DELIVERED_FRAME_COUNT, &delivered) == GX_STATUS_SUCCESS) {
+			*queueDepth = delivered - cam->DeliveredFrameBase - (int64_t)ATOMIC_LOAD(&cam->Metadata.Frames);
+			if (*queueDepth < 0) *queueDepth = 0;
+		}
+	}
+	
+	if (displayedFrameAgeMs) *displayedFrameAgeMs = cam->DisplayedFrameAgeMs;
+}
+
+/***************************************************************************************************
+In-place restart, for settings the camera only takes with the stream stopped (geometry, buffer
+policy). SuspendAcquisition stops the stream and nothing else: the frame callback registration,
+the display timer (paused), the statistics, the frame pool and the bitmap stay. ResumeAcquisition
+rebuilds the display frames and bitmap only if the image size changed, re-sizes the SDK buffers and
+restarts the stream. The time the stream was down goes to cam->LastReconfigureMs.
+
+If ResumeAcquisition fails the camera is left stopped, call StopCameraAcquisition to clean up.
+****************************************************************************************************/
+
+int SuspendAcquisition(struct camera_s *cam) {
+	
+	if (!cam->IsSnap) return FALSE;
+	
+	cam->LastReconfigureMs = GetHostTimeMs();
+	
+	// The display timer skips the camera while the stream is down
+	cam->IsSnap = 0;
+	if (cam->timerId > 0) SetAsyncTimerAttribute(cam->timerId, ASYNC_ATTR_ENABLED, 0);
+	
+	if (cam->ActiveAcquisitionMode == ACQ_MODE_POLLING) StopPollingThread(cam);
+	
+	GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_STOP);
+	
+	return TRUE;
+}
+
+GX_STATUS ResumeAcquisition(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = RestartAcquisition(cam);
+	
+	// Also on failure, SuspendAcquisition left the stop time here
+	cam->LastReconfigureMs = GetHostTimeMs() - cam->LastReconfigureMs;
+	
+	return emStatus;
+}
+
+GX_STATUS RestartAcquisition(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	
+	// Display frames and bitmap only depend on the image size
+	if (cam->BmpInfo.biWidth != (LONG)cam->ImageWidth || cam->BmpInfo.biHeight != (LONG)cam->ImageHeight) {
+		
+		ReleaseDisplayFrames(cam);
+		
+		if (PrepareForShowImg(cam) != OK) {
+			MessagePopup("Camera Error", "Fail to allocate resources for image!");
+			return GX_STATUS_ERROR;
+		}
+	}
+	
+	emStatus = ApplyStreamBufferPolicy(cam);
+	if (emStatus != GX_STATUS_SUCCESS) printf("Camera %s: stream buffer policy not applied (%d), keeping the previous one.\n", cam->SerialNumber, emStatus);
+	
+	ResetExposureEvents(cam);
+	
+	GX_STATUS startStatus = GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_START);
+	if (startStatus != GX_STATUS_SUCCESS) return startStatus;
+	
+	ResetStreamQueueMetrics(cam);
+	
+	if (cam->ActiveAcquisitionMode == ACQ_MODE_POLLING && StartPollingThread(cam) != OK) {
+		GXSendCommand(cam->Device, GX_COMMAND_ACQUISITION_STOP);
+		return GX_STATUS_ERROR;
+	}
+	
+	cam->IsSnap = 1;
+	if (cam->timerId > 0) SetAsyncTimerAttribute(cam->timerId, ASYNC_ATTR_ENABLED, 1);
+	
+	return emStatus;
+}
+
+/***************************************************************************************************
+Live settings. Exposure and gain are taken by the camera while streaming, no restart needed.
+Values are clamped to the camera's range, cam->ExposureTime / cam->Gain hold what was applied.
+****************************************************************************************************/
+
+GX_STATUS SetExposureTime(struct camera_s *cam, double exposureUs) {
+	
+	GX_FLOAT_RANGE range = {0};
+	
+	if (GXGetFloatRange(cam->Device, GX_FLOAT_EXPOSURE_TIME, &range) == GX_STATUS_SUCCESS) {
+		if (exposureUs < range.dMin) exposureUs = range.dMin;
+		if (exposureUs > range.dMax) exposureUs = range.dMax;
+	}
+	
+	GX_STATUS emStatus = GXSetFloat(cam->Device, GX_FLOAT_EXPOSURE_TIME, exposureUs);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	GXGetFloat(cam->Device, GX_FLOAT_EXPOSURE_TIME, &cam->ExposureTime);
+	
+	// A longer exposure can lower the frame rate the bandwidth plan counted on
+	ReplanAfterExposure(cam);
+	
+	return GX_STATUS_SUCCESS;
+}
+
+GX_STATUS SetGain(struct camera_s *cam, double gainDb) {
+	
+	GX_FLOAT_RANGE range = {0};
+	
+	if (GXGetFloatRange(cam->Device, GX_FLOAT_GAIN, &range) == GX_STATUS_SUCCESS) {
+		if (gainDb < range.dMin) gainDb = range.dMin;
+		if (gainDb > range.dMax) gainDb = range.dMax;
+	}
+	
+	GX_STATUS emStatus = GXSetFloat(cam->Device, GX_FLOAT_GAIN, gainDb);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	GXGetFloat(cam->Device, GX_FLOAT_GAIN, &cam->Gain);
+	
+	return GX_STATUS_SUCCESS;
+}
+
+/***************************************************************************************************
+Reconfiguration benchmark. Prints the mean and worst time of a live exposure change, an in-place
+restart (SuspendAcquisition / ResumeAcquisition, same geometry) and a full StopCameraAcquisition /
+StartCameraAcquisition. The camera must be acquiring; the full restart resets its statistics.
+****************************************************************************************************/
+
+void BenchmarkReconfigure(struct camera_s *cam, int iterations) {
+	
+	double totalMs[3] = {0}, maxMs[3] = {0};
+	const char *names[3] = {"Live exposure", "In-place restart", "Stop/Start"};
+	double exposure = cam->ExposureTime;
+	
+	if (!cam->IsSnap) {
+		printf("BenchmarkReconfigure: camera %s is not acquiring.\n", cam->SerialNumber);
+		return;
+	}
+	
+	if (iterations <= 0) iterations = 10;
+	
+	for (int n = 0; n < iterations && cam->IsSnap; n++) {
+		
+		double t[4];
+		
+		t[0] = GetHostTimeMs();
+		SetExposureTime(cam, (n & 1) ? exposure : exposure * 0.9);
+		t[1] = GetHostTimeMs();
+		
+		SuspendAcquisition(cam);
+		ResumeAcquisition(cam);
+		t[2] = GetHostTimeMs();
+		
+		// StopCameraAcquisition discards the display timer, keep it
+		int displayTimerId = cam->timerId;
+		cam->timerId = 0;
+		StopCameraAcquisition(cam);
+		StartCameraAcquisition(cam);
+		cam->timerId = displayTimerId;
+		t[3] = GetHostTimeMs();
+		
+		for (int i = 0; i < 3; i++) {
+			double ms = t[i + 1] - t[i];
+			totalMs[i] += ms;
+			if (ms > maxMs[i]) maxMs[i] = ms;
+		}
+	}
+	
+	SetExposureTime(cam, exposure);
+	
+	printf("Camera %s reconfiguration, %d runs:\n", cam->SerialNumber, iterations);
+	for (int i = 0; i < 3; i++) printf("  %-17s mean %8.2f ms   max %8.2f ms\n", names[i], totalMs[i] / iterations, maxMs[i]);
+}
+
+/***************************************************************************************************
+Capture geometry: readout window (OffsetX/Y, Width/Height), binning and decimation. A smaller window
+or binning cuts the payload, so the link carries more frames per second.
+
+While acquiring the stream is suspended and resumed around the change (SuspendAcquisition). The
+frame pool is only reallocated if the new frames no longer fit (payload grew), the bitmap only if
+the image size changed, and the SDK acquisition buffers are resized to the new payload. The crosshair stays on the same sensor pixel,
+clipped to the new window.
+
+Values are rounded down to the camera's increments and clamped to its limits, cam->Geometry holds
+what was actually applied.
+****************************************************************************************************/
+
+GX_STATUS SetIntAligned(struct camera_s *cam, GX_FEATURE_ID featureID, int64_t value) {
+	
+	GX_INT_RANGE range = {0};
+	
+	GX_STATUS emStatus = GXGetIntRange(cam->Device, featureID, &range);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	if (range.nInc > 1) value = range.nMin + (value - range.nMin) / range.nInc * range.nInc;
+	if (value < range.nMin) value = range.nMin;
+	if (value > range.nMax) value = range.nMax;
+	
+	return GXSetInt(cam->Device, featureID, value);
+}
+
+GX_STATUS ReadCaptureGeometry(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	int       implemented = FALSE;
+	struct capture_geometry_s *g = &cam->Geometry;
+	
+	emStatus = GXGetInt(cam->Device, GX_INT_OFFSET_X, &g->OffsetX);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXGetInt(cam->Device, GX_INT_OFFSET_Y, &g->OffsetY);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	g->Width  = cam->ImageWidth;
+	g->Height = cam->ImageHeight;
+	g->BinningH = g->BinningV = g->DecimationH = g->DecimationV = 1;
+	
+	// Binning and decimation are optional features
+	if (GXIsImplemented(cam->Device, GX_INT_BINNING_HORIZONTAL, &implemented) == GX_STATUS_SUCCESS && implemented) {
+		GXGetInt(cam->Device, GX_INT_BINNING_HORIZONTAL, &g->BinningH);
+		GXGetInt(cam->Device, GX_INT_BINNING_VERTICAL, &g->BinningV);
+	}
+	
+	if (GXIsImplemented(cam->Device, GX_INT_DECIMATION_HORIZONTAL, &implemented) == GX_STATUS_SUCCESS && implemented) {
+		GXGetInt(cam->Device, GX_INT_DECIMATION_HORIZONTAL, &g->DecimationH);
+		GXGetInt(cam->Device, GX_INT_DECIMATION_VERTICAL, &g->DecimationV);
+	}
+	
+	if (g->BinningH < 1) g->BinningH = 1;
+	if (g->BinningV < 1) g->BinningV = 1;
+	if (g->DecimationH < 1) g->DecimationH = 1;
+	if (g->DecimationV < 1) g->DecimationV = 1;
+	
+	return GX_STATUS_SUCCESS;
+}
+
+// Stream must be stopped. Binning/decimation first (they change WidthMax/HeightMax), then the
+// offsets go to 0 so any width/height is accepted, then width/height, then the new offsets.
+GX_STATUS ApplyCaptureGeometry(struct camera_s *cam, const struct capture_geometry_s *geometry) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	int       implemented = FALSE;
+	
+	if (GXIsImplemented(cam->Device, GX_INT_BINNING_HORIZONTAL, &implemented) == GX_STATUS_SUCCESS && implemented) {
+		
+		emStatus = SetIntAligned(cam, GX_INT_BINNING_HORIZONTAL, geometry->BinningH > 0 ? geometry->BinningH : 1);
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+		
+		emStatus = SetIntAligned(cam, GX_INT_BINNING_VERTICAL, geometry->BinningV > 0 ? geometry->BinningV : 1);
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	}
+	else if (geometry->BinningH > 1 || geometry->BinningV > 1) return GX_STATUS_NOT_IMPLEMENTED;
+	
+	if (GXIsImplemented(cam->Device, GX_INT_DECIMATION_HORIZONTAL, &implemented) == GX_STATUS_SUCCESS && implemented) {
+		
+		emStatus = SetIntAligned(cam, GX_INT_DECIMATION_HORIZONTAL, geometry->DecimationH > 0 ? geometry->DecimationH : 1);
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+		
+		emStatus = SetIntAligned(cam, GX_INT_DECIMATION_VERTICAL, geometry->DecimationV > 0 ? geometry->DecimationV : 1);
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	}
+	else if (geometry->DecimationH > 1 || geometry->DecimationV > 1) return GX_STATUS_NOT_IMPLEMENTED;
+	
+	emStatus = GXSetInt(cam->Device, GX_INT_OFFSET_X, 0);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetInt(cam->Device, GX_INT_OFFSET_Y, 0);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = SetIntAligned(cam, GX_INT_WIDTH, geometry->Width);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = SetIntAligned(cam, GX_INT_HEIGHT, geometry->Height);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = SetIntAligned(cam, GX_INT_OFFSET_X, geometry->OffsetX);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = SetIntAligned(cam, GX_INT_OFFSET_Y, geometry->OffsetY);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	return GX_STATUS_SUCCESS;
+}
+
+GX_STATUS SetCaptureGeometry(struct camera_s *cam, const struct capture_geometry_s *geometry) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	struct capture_geometry_s old = cam->Geometry;
+	
+	if (geometry == NULL) return GX_STATUS_INVALID_PARAMETER;
+	
+	// Crosshair position on the sensor, in full resolution pixels
+	int64_t oldScaleX = old.BinningH * old.DecimationH;
+	int64_t oldScaleY = old.BinningV * old.DecimationV;
+	int64_t sensorX = (old.OffsetX + cam->CrosshairX) * oldScaleX;
+	int64_t sensorY = (old.OffsetY + cam->CrosshairY) * oldScaleY;
+	
+	int wasSnapping = SuspendAcquisition(cam);
+	
+	emStatus = ApplyCaptureGeometry(cam, geometry);
+	if (emStatus != GX_STATUS_SUCCESS) {
+		printf("Camera %s: capture geometry not applied (%d), restoring the previous one.\n", cam->SerialNumber, emStatus);
+		ApplyCaptureGeometry(cam, &old);
+	}
+	
+	// What the camera actually took
+	GXGetInt(cam->Device, GX_INT_WIDTH, &cam->ImageWidth);
+	GXGetInt(cam->Device, GX_INT_HEIGHT, &cam->ImageHeight);
+	GXGetInt(cam->Device, GX_INT_PAYLOAD_SIZE, &cam->PayLoadSize);
+	ReadCaptureGeometry(cam);
+	
+	GXGetInt(cam->Device, GX_INT_AAROI_OFFSETX, &cam->RoiX);
+	GXGetInt(cam->Device, GX_INT_AAROI_OFFSETY, &cam->RoiY);
+	GXGetInt(cam->Device, GX_INT_AAROI_WIDTH,   &cam->RoiW);
+	GXGetInt(cam->Device, GX_INT_AAROI_HEIGHT,  &cam->RoiH);
+	
+	// Same sensor pixel in the new window
+	int64_t x = sensorX / (cam->Geometry.BinningH * cam->Geometry.DecimationH) - cam->Geometry.OffsetX;
+	int64_t y = sensorY / (cam->Geometry.BinningV * cam->Geometry.DecimationV) - cam->Geometry.OffsetY;
+	
+	if (x < 0) x = 0;
+	if (x > cam->ImageWidth) x = cam->ImageWidth;
+	if (y < 0) y = 0;
+	if (y > cam->ImageHeight) y = cam->ImageHeight;
+	
+	cam->CrosshairX = (unsigned int)x;
+	cam->CrosshairY = (unsigned int)y;
+	
+	// The payload changed, so did the link share of every camera planned with this one
+	ReplanCameraBandwidth(cam);
+	
+	printf("Camera %s: %lldx%lld at (%lld, %lld), binning %lldx%lld, decimation %lldx%lld, %.1f MB/frame\n",
+		   cam->SerialNumber, (long long)cam->ImageWidth, (long long)cam->ImageHeight,
+		   (long long)cam->Geometry.OffsetX, (long long)cam->Geometry.OffsetY,
+		   (long long)cam->Geometry.BinningH, (long long)cam->Geometry.BinningV,
+		   (long long)cam->Geometry.DecimationH, (long long)cam->Geometry.DecimationV, cam->PayLoadSize / 1048576.0);
+	
+	if (wasSnapping) {
+		
+		GX_STATUS resumeStatus = ResumeAcquisition(cam);
+		if (resumeStatus != GX_STATUS_SUCCESS) return resumeStatus;
+	}
+	
+	return emStatus;
+}
+
+// Keeps binning/decimation, centers a width x height window on the crosshair (shifted inside the sensor at the edges)
+GX_STATUS SetCaptureWindowAroundCrosshair(struct camera_s *cam, int64_t width, int64_t height) {
+	
+	struct capture_geometry_s geometry = cam->Geometry;
+	int64_t widthMax  = cam->ImageWidth;
+	int64_t heightMax = cam->ImageHeight;
+	
+	GXGetInt(cam->Device, GX_INT_WIDTH_MAX,  &widthMax);
+	GXGetInt(cam->Device, GX_INT_HEIGHT_MAX, &heightMax);
+	
+	if (width  > widthMax)  width  = widthMax;
+	if (height > heightMax) height = heightMax;
+	
+	int64_t centerX = cam->Geometry.OffsetX + cam->CrosshairX;
+	int64_t centerY = cam->Geometry.OffsetY + cam->CrosshairY;
+	
+	geometry.Width   = width;
+	geometry.Height  = height;
+	geometry.OffsetX = centerX - width / 2;
+	geometry.OffsetY = centerY - height / 2;
+	
+	if (geometry.OffsetX < 0) geometry.OffsetX = 0;
+	if (geometry.OffsetY < 0) geometry.OffsetY = 0;
+	if (geometry.OffsetX + width  > widthMax)  geometry.OffsetX = widthMax - width;
+	if (geometry.OffsetY + height > heightMax) geometry.OffsetY = heightMax - height;
+	
+	return SetCaptureGeometry(cam, &geometry);
+}
+
+/***************************************************************************************************
+Bandwidth planning for cameras sharing one link (BANDWIDTH_PLANNER.h). PlanCameraBandwidth remembers
+the cameras and the budget, measures every camera's fastest frame rate, plans, and applies all
+frame rates (AcquisitionFrameRateMode = On) and link throughput limits in one pass.
+SetCaptureGeometry plans again, measuring only its own camera, when the payload of one of these
+cameras changes. SetExposureTime plans again only when the new exposure holds its camera below the
+planned rate; the other cameras keep their cached MaxFrameRate and are never switched to free run.
+****************************************************************************************************/
+
+struct camera_s *PlannedCameras[BANDWIDTH_PLAN_MAX_CAMERAS];
+int NumPlannedCameras = 0;
+double PlannedLinkBudget = 0;
+
+// Frame rate and link settings of a camera before a plan changed them, put back when the plan fails
+struct rate_settings_s {
+	
+	int64_t RateMode;
+	double Rate;
+	int HasLimit;
+	int64_t LimitMode;
+	int64_t Limit;
+	double PlannedFrameRate;
+	int64_t PlannedThroughput;
+	double MaxFrameRate;
+};
+
+void SaveRateSettings(struct camera_s *cam, struct rate_settings_s *saved) {
+	
+	int implemented = FALSE;
+	
+	memset(saved, 0, sizeof(*saved));
+	
+	GXGetEnum(cam->Device, GX_ENUM_ACQUISITION_FRAME_RATE_MODE, &saved->RateMode);
+	GXGetFloat(cam->Device, GX_FLOAT_ACQUISITION_FRAME_RATE, &saved->Rate);
+	
+	if (GXIsImplemented(cam->Device, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, &implemented) == GX_STATUS_SUCCESS && implemented) {
+		
+		saved->HasLimit  = TRUE;
+		saved->LimitMode = -1;
+		
+		if (GXIsImplemented(cam->Device, GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE, &implemented) == GX_STATUS_SUCCESS && implemented)
+			GXGetEnum(cam->Device, GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE, &saved->LimitMode);
+		
+		GXGetInt(cam->Device, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, &saved->Limit);
+	}
+	
+	saved->PlannedFrameRate  = cam->PlannedFrameRate;
+	saved->PlannedThroughput = cam->PlannedThroughput;
+	saved->MaxFrameRate      = cam->MaxFrameRate;
+}
+
+// Best effort, the plan already failed on this link
+void RestoreRateSettings(struct camera_s *cam, const struct rate_settings_s *saved) {
+	
+	GXSetFloat(cam->Device, GX_FLOAT_ACQUISITION_FRAME_RATE, saved->Rate);
+	GXSetEnum(cam->Device, GX_ENUM_ACQUISITION_FRAME_RATE_MODE, saved->RateMode);
+	
+	if (saved->HasLimit) {
+		GXSetInt(cam->Device, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, saved->Limit);
+		if (saved->LimitMode >= 0) GXSetEnum(cam->Device, GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE, saved->LimitMode);
+	}
+	
+	cam->PlannedFrameRate  = saved->PlannedFrameRate;
+	cam->PlannedThroughput = saved->PlannedThroughput;
+	cam->MaxFrameRate      = saved->MaxFrameRate;
+}
+
+// Fastest rate with the current geometry and exposure: what the camera runs at unthrottled.
+// The rate mode is switched off only for the read and put back as it was.
+void MeasureMaxFrameRate(struct camera_s *cam) {
+	
+	int64_t rateMode = GX_ACQUISITION_FRAME_RATE_MODE_OFF;
+	double maxFps = 0;
+	
+	GXGetEnum(cam->Device, GX_ENUM_ACQUISITION_FRAME_RATE_MODE, &rateMode);
+	
+	if (rateMode != GX_ACQUISITION_FRAME_RATE_MODE_OFF) GXSetEnum(cam->Device, GX_ENUM_ACQUISITION_FRAME_RATE_MODE, GX_ACQUISITION_FRAME_RATE_MODE_OFF);
+	if (GXGetFloat(cam->Device, GX_FLOAT_CURRENT_ACQUISITION_FRAME_RATE, &maxFps) != GX_STATUS_SUCCESS) maxFps = 0;
+	if (rateMode != GX_ACQUISITION_FRAME_RATE_MODE_OFF) GXSetEnum(cam->Device, GX_ENUM_ACQUISITION_FRAME_RATE_MODE, rateMode);
+	
+	cam->MaxFrameRate = maxFps;
+}
+
+int IsBandwidthPlanned(struct camera_s *cam) {
+	
+	for (int i = 0; i < NumPlannedCameras; i++) if (PlannedCameras[i] == cam) return TRUE;
+	
+	return FALSE;
+}
+
+GX_STATUS PlanCameraBandwidth(struct camera_s **cams, int numCams, double linkBudgetBytesPerSec) {
+	
+	if (numCams < 1 || numCams > BANDWIDTH_PLAN_MAX_CAMERAS || linkBudgetBytesPerSec <= 0) return GX_STATUS_INVALID_PARAMETER;
+	
+	for (int i = 0; i < numCams; i++) {
+		if (cams[i] == NULL || !cams[i]->DevOpened) return GX_STATUS_INVALID_PARAMETER;
+		PlannedCameras[i] = cams[i];
+	}
+	
+	NumPlannedCameras = numCams;
+	PlannedLinkBudget = linkBudgetBytesPerSec;
+	
+	for (int i = 0; i < numCams; i++) MeasureMaxFrameRate(cams[i]);
+	
+	return ApplyBandwidthPlan();
+}
+
+void RemoveFromBandwidthPlan(struct camera_s *cam) {
+	
+	int n = 0;
+	
+	for (int i = 0; i < NumPlannedCameras; i++) if (PlannedCameras[i] != cam) PlannedCameras[n++] = PlannedCameras[i];
+	
+	if (n == NumPlannedCameras) return;
+	
+	NumPlannedCameras = n;
+	
+	if (n > 0 && ApplyBandwidthPlan() != GX_STATUS_SUCCESS) printf("Bandwidth plan not applied after removing camera %s.\n", cam->SerialNumber);
+}
+
+void ReplanCameraBandwidth(struct camera_s *cam) {
+	
+	if (!IsBandwidthPlanned(cam)) return;
+	
+	MeasureMaxFrameRate(cam);
+	
+	GX_STATUS emStatus = ApplyBandwidthPlan();
+	if (emStatus != GX_STATUS_SUCCESS) printf("Bandwidth plan not applied (%d).\n", emStatus);
+}
+
+// With the rate mode on, the current rate is the planned rate unless the exposure no longer fits
+// in its frame period. Only then is the plan redone, giving the freed share to the other cameras.
+void ReplanAfterExposure(struct camera_s *cam) {
+	
+	double currentFps = 0;
+	
+	if (!IsBandwidthPlanned(cam) || cam->PlannedFrameRate <= 0) return;
+	if (GXGetFloat(cam->Device, GX_FLOAT_CURRENT_ACQUISITION_FRAME_RATE, &currentFps) != GX_STATUS_SUCCESS) return;
+	if (currentFps <= 0 || currentFps >= cam->PlannedFrameRate * 0.999) return;
+	
+	cam->MaxFrameRate = currentFps;
+	
+	GX_STATUS emStatus = ApplyBandwidthPlan();
+	if (emStatus != GX_STATUS_SUCCESS) printf("Bandwidth plan not applied (%d).\n", emStatus);
+}
+
+GX_STATUS ApplyBandwidthPlan(void) {
+	
+	struct bandwidth_request_s requests[BANDWIDTH_PLAN_MAX_CAMERAS];
+	struct bandwidth_plan_s plans[BANDWIDTH_PLAN_MAX_CAMERAS];
+	struct rate_settings_s saved[BANDWIDTH_PLAN_MAX_CAMERAS];
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	
+	for (int i = 0; i < NumPlannedCameras; i++) SaveRateSettings(PlannedCameras[i], &saved[i]);
+	
+	for (int i = 0; i < NumPlannedCameras; i++) {
+		
+		struct camera_s *cam = PlannedCameras[i];
+		GX_INT_RANGE linkRange = {0};
+		int implemented = FALSE;
+		
+		GXGetInt(cam->Device, GX_INT_PAYLOAD_SIZE, &cam->PayLoadSize);
+		
+		// Measured by PlanCameraBandwidth / ReplanCameraBandwidth, lowered by ReplanAfterExposure
+		requests[i].PayloadBytes       = cam->PayLoadSize;
+		requests[i].RequestedFps       = cam->TargetFrameRate;
+		requests[i].MaxFps             = cam->MaxFrameRate;
+		requests[i].LinkMaxBytesPerSec = 0;
+		requests[i].Weight             = cam->BandwidthWeight;
+		
+		if (GXIsImplemented(cam->Device, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, &implemented) == GX_STATUS_SUCCESS && implemented
+			&& GXGetIntRange(cam->Device, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, &linkRange) == GX_STATUS_SUCCESS)
+			requests[i].LinkMaxBytesPerSec = (double)linkRange.nMax;
+	}
+	
+	int limited = BandwidthPlan(requests, NumPlannedCameras, PlannedLinkBudget, BANDWIDTH_DEFAULT_OVERHEAD, plans);
+	if (limited < 0) {
+		for (int i = 0; i < NumPlannedCameras; i++) RestoreRateSettings(PlannedCameras[i], &saved[i]);
+		return GX_STATUS_INVALID_PARAMETER;
+	}
+	
+	for (int i = 0; i < NumPlannedCameras; i++) {
+		
+		struct camera_s *cam = PlannedCameras[i];
+		GX_FLOAT_RANGE fpsRange = {0};
+		int implemented = FALSE;
+		double fps = plans[i].Fps;
+		double currentFps = 0;
+		
+		if (GXGetFloatRange(cam->Device, GX_FLOAT_ACQUISITION_FRAME_RATE, &fpsRange) == GX_STATUS_SUCCESS) {
+			if (fps < fpsRange.dMin) fps = fpsRange.dMin;
+			if (fps > fpsRange.dMax) fps = fpsRange.dMax;
+		}
+		
+		emStatus = GXSetEnum(cam->Device, GX_ENUM_ACQUISITION_FRAME_RATE_MODE, GX_ACQUISITION_FRAME_RATE_MODE_ON);
+		if (emStatus != GX_STATUS_SUCCESS) break;
+		
+		emStatus = GXSetFloat(cam->Device, GX_FLOAT_ACQUISITION_FRAME_RATE, fps);
+		if (emStatus != GX_STATUS_SUCCESS) break;
+		
+		// The throughput limit also spreads the packets of a frame, so bursts of two cameras do not collide
+		if (GXIsImplemented(cam->Device, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, &implemented) == GX_STATUS_SUCCESS && implemented) {
+			
+			if (GXIsImplemented(cam->Device, GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE, &implemented) == GX_STATUS_SUCCESS && implemented)
+				GXSetEnum(cam->Device, GX_ENUM_DEVICE_LINK_THROUGHPUT_LIMIT_MODE, GX_DEVICE_LINK_THROUGHPUT_LIMIT_MODE_ON);
+			
+			emStatus = SetIntAligned(cam, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, (int64_t)plans[i].BytesPerSec);
+			if (emStatus != GX_STATUS_SUCCESS) break;
+			
+			GXGetInt(cam->Device, GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT, &cam->PlannedThroughput);
+		}
+		else cam->PlannedThroughput = (int64_t)plans[i].BytesPerSec;
+		
+		cam->PlannedFrameRate = fps;
+		
+		// What the camera settled on, exposure may still hold it below the planned rate
+		GXGetFloat(cam->Device, GX_FLOAT_CURRENT_ACQUISITION_FRAME_RATE, &currentFps);
+		
+		printf("Camera %s: %.1f fps planned (%.1f wanted, %.1f now), %.1f MB/s%s\n", cam->SerialNumber, fps,
+			   requests[i].RequestedFps > 0 ? requests[i].RequestedFps : requests[i].MaxFps, currentFps,
+			   cam->PlannedThroughput / 1048576.0, plans[i].Limited ? ", limited by the link budget" : "");
+	}
+	
+	// A half applied plan is worse than the old one: every camera goes back to what it had
+	if (emStatus != GX_STATUS_SUCCESS) {
+		
+		printf("Bandwidth plan failed (%d), previous frame rates and link limits restored.\n", emStatus);
+		
+		for (int i = 0; i < NumPlannedCameras; i++) RestoreRateSettings(PlannedCameras[i], &saved[i]);
+		return emStatus;
+	}
+	
+	return GX_STATUS_SUCCESS;
+}
+
+/***************************************************************************************************
+Stream statistics sampler. An async timer per camera reads the GX_DS_INT_* counters every
+StreamStatsIntervalMs and records them, with the host CPU load, in cam->StreamStats (STREAM_STATS.h).
+It runs on the async timer thread and never touches the frame path.
+****************************************************************************************************/
+
+static const int StreamCounterFeatures[STREAM_COUNTERS] = {
+	GX_DS_INT_DELIVERED_FRAME_COUNT,
+	GX_DS_INT_LOST_FRAME_COUNT,
+	GX_DS_INT_INCOMPLETE_FRAME_COUNT,
+	GX_DS_INT_DELIVERED_PACKET_COUNT,
+	GX_DS_INT_RESEND_PACKET_COUNT,
+	GX_DS_INT_RESCUED_PACKED_COUNT,
+	GX_DS_INT_RESEND_COMMAND_COUNT,
+	GX_DS_INT_UNEXPECTED_PACKED_COUNT,
+	GX_DS_INT_MISSING_BLOCKID_COUNT
+};
+
+void StartStreamStatsSampler(struct camera_s *cam) {
+	
+	if (cam->StreamStatsIntervalMs < 0 || cam->StreamStatsTimerId > 0) return;
+	
+	double intervalMs = (cam->StreamStatsIntervalMs > 0) ? cam->StreamStatsIntervalMs : 1000;
+	
+	StreamStatsReset(&cam->StreamStats);
+	SampleHostCpuPercent(cam); // Baseline for the first sample
+	
+	int timerId = NewAsyncTimer(intervalMs / 1000.0, -1, 1, (AsyncTimerCallbackPtr)StreamStatsTimerCallback, cam);
+	
+	if (timerId <= 0) printf("Camera %s: stream statistics sampler not started (%d).\n", cam->SerialNumber, timerId);
+	else cam->StreamStatsTimerId = timerId;
+}
+
+void StopStreamStatsSampler(struct camera_s *cam) {
+	
+	if (cam->StreamStatsTimerId <= 0) return;
+	
+	DiscardAsyncTimer(cam->StreamStatsTimerId);
+	cam->StreamStatsTimerId = 0;
+}
+
+int CVICALLBACK StreamStatsTimerCallback(int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2) {
+	
+	struct camera_s *cam = (struct camera_s *)callbackData;
+	int64_t counters[STREAM_COUNTERS] = {0};
+	unsigned int available = 0;
+	
+	if (event != EVENT_TIMER_TICK || cam == NULL || !cam->IsSnap) return 0;
+	
+	for (int i = 0; i < STREAM_COUNTERS; i++) {
+		if (GXGetInt(cam->Device, StreamCounterFeatures[i], &counters[i]) == GX_STATUS_SUCCESS) available |= 1u << i;
+	}
+	
+	StreamStatsRecord(&cam->StreamStats, GetHostTimeMs(), counters, available, SampleHostCpuPercent(cam));
+	
+	return 0;
+}
+
+// Whole-machine CPU load since the previous call (GetSystemTimes), -1 if unavailable
+double SampleHostCpuPercent(struct camera_s *cam) {
+	
+	FILETIME idleTime, kernelTime, userTime;
+	
+	if (!GetSystemTimes(&idleTime, &kernelTime, &userTime)) return -1;
+	
+	uint64_t idle  = ((uint64_t)idleTime.dwHighDateTime << 32) | idleTime.dwLowDateTime;
+	uint64_t total = (((uint64_t)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime)  // Kernel time includes idle time
+				   + (((uint64_t)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime);
+	
+	double load = -1;
+	
+	if (cam->CpuTotalTicks != 0 && total > cam->CpuTotalTicks) {
+		load = 100.0 * (1.0 - (double)(idle - cam->CpuIdleTicks) / (double)(total - cam->CpuTotalTicks));
+	}
+	
+	cam->CpuIdleTicks  = idle;
+	cam->CpuTotalTicks = total;
+	
+	return load;
+}
+
+int GetStreamStats(struct camera_s *cam, int maxSamples, struct stream_stats_sample_s *samples) {
+	
+	return StreamStatsQuery(&cam->StreamStats, maxSamples, samples);
+}
+
+/***************************************************************************************************
+Per-stage latency. ProcessFrame stamps every frame with QueryPerformanceCounter ticks at delivery,
+after the raw copy and after the conversion, the display timer at SetBitmapData and around
+CanvasDrawBitmap. Each stage feeds a lock-free histogram (LATENCY_HIST.h), which is a few QPC reads
+and atomic increments per frame. The sensor -> delivery stage uses the device timestamp mapped onto
+the host clock (frame->CaptureTimeMs).
+****************************************************************************************************/
+
+void RecordStageLatency(struct camera_s *cam, int stage, int64_t fromTicks, int64_t toTicks) {
+	
+	LatencyHistRecord(&cam->StageLatency[stage], HostTicksToUs(toTicks - fromTicks));
+}
+
+void GetStageLatency(struct camera_s *cam, int stage, double *p50Ms, double *p99Ms, double *p999Ms) {
+	
+	if (stage < 0 || stage >= LATENCY_STAGES) return;
+	
+	struct latency_hist_s *hist = &cam->StageLatency[stage];
+	
+	if (p50Ms)  *p50Ms  = LatencyHistPercentile(hist, 50) / 1000.0;
+	if (p99Ms)  *p99Ms  = LatencyHistPercentile(hist, 99) / 1000.0;
+	if (p999Ms) *p999Ms = LatencyHistPercentile(hist, 99.9) / 1000.0;
+}
+
+void DumpLatencyHistograms(struct camera_s *cam) {
+	
+	static const char *stageNames[LATENCY_STAGES] = { "capture", "copy", "convert", "queue", "set bitmap", "draw", "total" };
+	double p50, p99, p999;
+	
+	printf("Camera %s latency (ms)      p50      p99     p999   frames\n", cam->SerialNumber);
+	
+	for (int i = 0; i < LATENCY_STAGES; i++) {
+		
+		GetStageLatency(cam, i, &p50, &p99, &p999);
+		printf("  %-12s %20.3f %8.3f %8.3f %8ld\n", stageNames[i], p50, p99, p999, LatencyHistCount(&cam->StageLatency[i]));
+	}
+	
+	// The capture stage is only as good as the device clock mapping
+	struct clock_sync_stats_s clock;
+	GetClockSyncStats(cam, &clock);
+	
+	if (clock.Used > 0) printf("  device clock drift %.2f ppm, residual rms %.1f us, max %.1f us (%d of %d latches)\n",
+							   clock.DriftPpm, clock.ResidualRmsUs, clock.ResidualMaxUs, clock.Used, clock.Samples);
+}
+
+int CVICALLBACK LatencyDumpTimerCallback(int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2) {
+	
+	if (event == EVENT_TIMER_TICK && callbackData != NULL) DumpLatencyHistograms((struct camera_s *)callbackData);
+	
+	return 0;
+}
+
+/***************************************************************************************************
+Chunk data. With auto exposure or auto gain on, the values change from frame to frame and reading them
+with GXGetFloat while streaming stalls the stream, and still does not say which frame they belong to.
+With chunk mode the camera appends them to every image and ReadFrameChunks takes them from the payload.
+
+This GxIAPI only names the FrameID / Timestamp / CounterValue selectors, the exposure time and gain
+entries and their ChunkIDs are model specific: set cam->ChunkExposureTime / cam->ChunkGain from the
+camera's XML. Without them (or with a camera that has no chunk mode) auto values stay unknown (-1),
+manual values are taken from the settings.
+****************************************************************************************************/
+
+GX_STATUS ConfigureChunkData(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	int implemented = 0;
+	
+	int autoMode = cam->GainMode != 0 || cam->ExposureTimeMode != 0;
+	int wanted   = (cam->ChunkData == 2 || (cam->ChunkData == 1 && autoMode))
+				   && (cam->ChunkExposureTime.Selector != 0 || cam->ChunkGain.Selector != 0);
+	
+	cam->ChunkActive    = FALSE;
+	cam->ChunkBigEndian = cam->DeviceClass == GX_DEVICE_CLASS_GEV;
+	cam->ChunkErrors    = 0;
+	
+	if (GXIsImplemented(cam->Device, GX_BOOL_CHUNKMODE_ACTIVE, &implemented) != GX_STATUS_SUCCESS || !implemented) return GX_STATUS_SUCCESS;
+	
+	if (!wanted) return GXSetBool(cam->Device, GX_BOOL_CHUNKMODE_ACTIVE, FALSE);
+	
+	emStatus = GXSetBool(cam->Device, GX_BOOL_CHUNKMODE_ACTIVE, TRUE);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	const struct chunk_value_s *values[2] = {&cam->ChunkExposureTime, &cam->ChunkGain};
+	
+	for (int i = 0; i < 2; i++) {
+		
+		if (values[i]->Selector == 0) continue;
+		
+		emStatus = GXSetEnum(cam->Device, GX_ENUM_CHUNK_SELECTOR, values[i]->Selector);
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+		
+		emStatus = GXSetBool(cam->Device, GX_BOOL_CHUNK_ENABLE, TRUE);
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	}
+	
+	cam->ChunkActive = TRUE;
+	
+	return GX_STATUS_SUCCESS;
+}
+
+// Exposure time and gain of the frame, -1 = unknown. Frame path, no device access.
+void ReadFrameChunks(struct camera_s *cam, GX_FRAME_CALLBACK_PARAM *pFrame, double *exposureTime, double *gain) {
+	
+	struct chunk_entry_s chunks[CHUNK_MAX_ENTRIES];
+	
+	*exposureTime = cam->ExposureTimeMode == 0 ? cam->ExposureTime : -1;
+	*gain         = cam->GainMode == 0 ? cam->Gain : -1;
+	
+	if (!cam->ChunkActive || pFrame->status != 0 || pFrame->pImgBuf == NULL || pFrame->nImgSize <= 0) return;
+	
+	const uint8_t *payload = (const uint8_t *)pFrame->pImgBuf;
+	size_t imageBytes = PixelFormatBytes((int)pFrame->nPixelFormat, (size_t)pFrame->nWidth * pFrame->nHeight);
+	
+	int numChunks = ChunkParse(payload, (size_t)pFrame->nImgSize, imageBytes, cam->ChunkBigEndian, chunks, CHUNK_MAX_ENTRIES);
+	
+	if (numChunks < 0) {
+		cam->ChunkErrors++;
+		return;
+	}
+	
+	int i = ChunkFind(chunks, numChunks, cam->ChunkExposureTime.ID);
+	if (cam->ChunkExposureTime.Selector != 0 && i >= 0) ChunkReadFloat(payload, &chunks[i], cam->ChunkBigEndian, exposureTime);
+	
+	i = ChunkFind(chunks, numChunks, cam->ChunkGain.ID);
+	if (cam->ChunkGain.Selector != 0 && i >= 0) ChunkReadFloat(payload, &chunks[i], cam->ChunkBigEndian, gain);
+}
+
+/***************************************************************************************************
+Device clock sync (CLOCK_SYNC.h). Every ClockSyncIntervalMs an async timer latches the device
+timestamp counter (GX_COMMAND_TIMESTAMP_LATCH) between two host clock reads and reads the latched
+value back (GX_INT_TIMESTAMP_LATCH_VALUE). The fit of the last latches gives offset and drift of the
+device clock against GetHostTicks, DeviceTimestampToHostMs then maps any frame timestamp in O(1).
+Until the first latch, or on a camera without latch, the minimum-latency offset of ProcessFrame is used.
+****************************************************************************************************/
+
+void StartClockSync(struct camera_s *cam) {
+	
+	// Restarted by InitDevice after a reconnect, the device clock started over
+	StopClockSync(cam);
+	ClockSyncInit(&cam->ClockSync, cam->TimestampTickFrequency);
+	
+	if (cam->ClockSyncIntervalMs < 0) return;
+	
+	for (int i = 0; i < CLOCK_SYNC_STARTUP_SAMPLES; i++) {
+		if (SampleDeviceClock(cam) != OK) {
+			printf("Camera %s: no timestamp latch, frame times use the receive time offset.\n", cam->SerialNumber);
+			return;
+		}
+	}
+	
+	double intervalMs = (cam->ClockSyncIntervalMs > 0) ? cam->ClockSyncIntervalMs : CLOCK_SYNC_DEFAULT_INTERVAL_MS;
+	
+	int timerId = NewAsyncTimer(intervalMs / 1000.0, -1, 1, (AsyncTimerCallbackPtr)ClockSyncTimerCallback, cam);
+	
+	if (timerId <= 0) printf("Camera %s: clock sync timer not started (%d).\n", cam->SerialNumber, timerId);
+	else cam->ClockSyncTimerId = timerId;
+}
+
+void StopClockSync(struct camera_s *cam) {
+	
+	if (cam->ClockSyncTimerId <= 0) return;
+	
+	DiscardAsyncTimer(cam->ClockSyncTimerId);
+	cam->ClockSyncTimerId = 0;
+}
+
+int SampleDeviceClock(struct camera_s *cam) {
+	
+	int64_t latched = 0;
+	
+	double beforeUs = HostTicksToUs(GetHostTicks());
+	if (GXSendCommand(cam->Device, GX_COMMAND_TIMESTAMP_LATCH) != GX_STATUS_SUCCESS) return CANCEL;
+	double afterUs  = HostTicksToUs(GetHostTicks());
+	
+	if (GXGetInt(cam->Device, GX_INT_TIMESTAMP_LATCH_VALUE, &latched) != GX_STATUS_SUCCESS) return CANCEL;
+	
+	ClockSyncAddSample(&cam->ClockSync, (uint64_t)latched, beforeUs, afterUs);
+	
+	return OK;
+}
+
+int CVICALLBACK ClockSyncTimerCallback(int reserved, int timerId, int event, void *callbackData, int eventData1, int eventData2) {
+	
+	struct camera_s *cam = (struct camera_s *)callbackData;
+	
+	if (event != EVENT_TIMER_TICK || cam == NULL || !cam->DevOpened) return 0;
+	
+	SampleDeviceClock(cam);
+	
+	return 0;
+}
+
+int DeviceTimestampToHostMs(struct camera_s *cam, uint64_t timestamp, double *hostTimeMs) {
+	
+	double hostUs = 0;
+	
+	if (ClockSyncToHostUs(&cam->ClockSync, timestamp, &hostUs)) {
+		*hostTimeMs = hostUs / 1000.0;
+		return TRUE;
+	}
+	
+	if (!cam->HasCaptureOffset) return FALSE;
+	
+	*hostTimeMs = (double)timestamp * (1000.0 / (double)cam->TimestampTickFrequency) + cam->CaptureOffsetMs;
+	return TRUE;
+}
+
+void GetClockSyncStats(struct camera_s *cam, struct clock_sync_stats_s *stats) {
+	
+	ClockSyncStats(&cam->ClockSync, stats);
+}
+
+/***************************************************************************************************
+Exposure-end events (EXPOSURE_EVENTS.h). The camera reports the end of every exposure with its frame
+ID and device timestamp. The SDK calls OnExposureEndEvent on its event thread, the event data can only
+be read there, so the callback reads the two values, files them by frame ID and returns.
+
+A thread of the default thread pool per camera watches the device event queue (GXGetEventNumInQueue).
+When the callbacks fall more than EVENT_QUEUE_MAX_BACKLOG events behind, the queued events are too old
+to be joined to a frame still in flight, GXFlushEvent throws them away so the next ones are current.
+
+ProcessFrame joins the event of its frame, the time goes into frame->ExposureEndTimeMs on the host
+clock (the same mapping as CaptureTimeMs). An event arriving after its frame is still found later
+with GetExposureEndTime.
+****************************************************************************************************/
+
+GX_STATUS ConfigureExposureEvents(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	int implemented = 0;
+	
+	// InitDevice run again on the same device (ReconnectClose already dropped the old one)
+	UnregisterExposureEvents(cam);
+	
+	if (!cam->ExposureEvents) return GX_STATUS_SUCCESS;
+	
+	if (GXIsImplemented(cam->Device, GX_ENUM_EVENT_SELECTOR, &implemented) != GX_STATUS_SUCCESS || !implemented) {
+		printf("Camera %s: no event channel, frames carry no exposure end time.\n", cam->SerialNumber);
+		return GX_STATUS_SUCCESS;
+	}
+	
+	emStatus = GXSetEnum(cam->Device, GX_ENUM_EVENT_SELECTOR, GX_ENUM_EVENT_SELECTOR_EXPOSUREEND);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetEnum(cam->Device, GX_ENUM_EVENT_NOTIFICATION, GX_ENUM_EVENT_NOTIFICATION_ON);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	ExposureEventReset(&cam->ExposureEnd);
+	
+	emStatus = GXRegisterFeatureCallback(cam->Device, cam, OnExposureEndEvent, GX_INT_EVENT_EXPOSUREEND, &cam->ExposureEndCallback);
+	if (emStatus != GX_STATUS_SUCCESS) {
+		cam->ExposureEndCallback = NULL;
+		return emStatus;
+	}
+	
+	cam->EventQueueMax = 0;
+	cam->EventsFlushed = 0;
+	
+	StartEventThread(cam);
+	
+	return GX_STATUS_SUCCESS;
+}
+
+void UnregisterExposureEvents(struct camera_s *cam) {
+	
+	if (cam->ExposureEndCallback == NULL) return;
+	
+	GXSetEnum(cam->Device, GX_ENUM_EVENT_SELECTOR, GX_ENUM_EVENT_SELECTOR_EXPOSUREEND);
+	GXSetEnum(cam->Device, GX_ENUM_EVENT_NOTIFICATION, GX_ENUM_EVENT_NOTIFICATION_OFF);
+	GXUnregisterFeatureCallback(cam->Device, GX_INT_EVENT_EXPOSUREEND, cam->ExposureEndCallback);
+	
+	cam->ExposureEndCallback = NULL;
+}
+
+// Before AcquisitionStart: the frame IDs may start over, events of the last run must not match them
+void ResetExposureEvents(struct camera_s *cam) {
+	
+	if (cam->ExposureEndCallback == NULL) return;
+	
+	GXFlushEvent(cam->Device);
+	ExposureEventReset(&cam->ExposureEnd);
+}
+
+void GX_STDC OnExposureEndEvent(GX_FEATURE_ID_CMD nFeatureID, void *pUserParam) {
+	
+	struct camera_s *cam = (struct camera_s *)pUserParam;
+	int64_t frameID   = 0;
+	int64_t timestamp = 0;
+	
+	if (!cam || nFeatureID != GX_INT_EVENT_EXPOSUREEND) return;
+	
+	if (GXGetInt(cam->Device, GX_INT_EVENT_EXPOSUREEND_FRAMEID, &frameID) != GX_STATUS_SUCCESS) return;
+	if (GXGetInt(cam->Device, GX_INT_EVENT_EXPOSUREEND_TIMESTAMP, &timestamp) != GX_STATUS_SUCCESS) return;
+	
+	ExposureEventRecord(&cam->ExposureEnd, (uint64_t)frameID, (uint64_t)timestamp);
+}
+
+void StartEventThread(struct camera_s *cam) {
+	
+	if (cam->EventFunctionId != 0) return;
+	
+	cam->EventThreadRun = 1;
+	
+	if (CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, EventThreadFunction, cam, &cam->EventFunctionId) < 0) {
+		
+		cam->EventThreadRun  = 0;
+		cam->EventFunctionId = 0;
+		printf("Camera %s: event queue thread not started.\n", cam->SerialNumber);
+	}
+}
+
+void StopEventThread(struct camera_s *cam) {
+	
+	if (cam->EventFunctionId == 0) return;
+	
+	cam->EventThreadRun = 0;
+	
+	CmtWaitForThreadPoolFunctionCompletion(DEFAULT_THREAD_POOL_HANDLE, cam->EventFunctionId, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	CmtReleaseThreadPoolFunctionID(DEFAULT_THREAD_POOL_HANDLE, cam->EventFunctionId);
+	
+	cam->EventFunctionId = 0;
+}
+
+int CVICALLBACK EventThreadFunction(void *functionData) {
+	
+	struct camera_s *cam = (struct camera_s *)functionData;
+	
+	while (cam->EventThreadRun) {
+		
+		uint32_t queued = 0;
+		
+		if (GXGetEventNumInQueue(cam->Device, &queued) == GX_STATUS_SUCCESS) {
+			
+			if (queued > cam->EventQueueMax) cam->EventQueueMax = queued;
+			
+			if (queued > EVENT_QUEUE_MAX_BACKLOG && GXFlushEvent(cam->Device) == GX_STATUS_SUCCESS) cam->EventsFlushed += queued;
+		}
+		
+		Delay(EVENT_QUEUE_POLL_MS / 1000.0);
+	}
+	
+	return 0;
+}
+
+int GetExposureEndTime(struct camera_s *cam, uint64_t frameID, double *hostTimeMs) {
+	
+	uint64_t timestamp = 0;
+	
+	if (!ExposureEventLookup(&cam->ExposureEnd, frameID, &timestamp)) return FALSE;
+	
+	return DeviceTimestampToHostMs(cam, timestamp, hostTimeMs);
+}
+
+/***************************************************************************************************
+Trigger mode. With TriggerMode = GX_TRIGGER_MODE_ON the camera only exposes a frame per trigger, on a
+software command or an edge on LINE0..3, so nothing is streamed that is not asked for.
+
+TriggerAndWait arms the camera, fires the software trigger (hardware sources are fired externally) and
+waits up to timeoutMs for the next complete frame. ProcessFrame hands that frame over through
+cam->Trigger with a reference taken for the caller, see TRIGGER_WAIT.h. The latency from the trigger
+to the frame reaching ProcessFrame goes into cam->Trigger.Stats.
+****************************************************************************************************/
+
+int ConfigureTrigger(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	
+	if (cam->TriggerMode != GX_TRIGGER_MODE_ON) return GXSetEnum(cam->Device, GX_ENUM_TRIGGER_MODE, GX_TRIGGER_MODE_OFF);
+	
+	emStatus = GXSetEnum(cam->Device, GX_ENUM_TRIGGER_SELECTOR, GX_ENUM_TRIGGER_SELECTOR_FRAME_START);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetEnum(cam->Device, GX_ENUM_TRIGGER_MODE, GX_TRIGGER_MODE_ON);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetEnum(cam->Device, GX_ENUM_TRIGGER_SOURCE, cam->TriggerSource);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	if (cam->TriggerSource != GX_TRIGGER_SOURCE_SOFTWARE) {
+		emStatus = GXSetEnum(cam->Device, GX_ENUM_TRIGGER_ACTIVATION, cam->TriggerActivation);
+		if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	}
+	
+	// One frame in flight at a time
+	if (cam->Trigger.Sync == NULL && TriggerWaitInit(&cam->Trigger, TriggerAddRefFrame, TriggerReleaseFrame) != OK) return GX_STATUS_ERROR;
+	
+	memset(&cam->Trigger.Stats, 0, sizeof(cam->Trigger.Stats));
+	
+	return GX_STATUS_SUCCESS;
+}
+
+GX_STATUS TriggerAndWait(struct camera_s *cam, int timeoutMs, struct frame_s **frame) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	void *triggered = NULL;
+	
+	*frame = NULL;
+	
+	if (!cam->IsSnap || cam->TriggerMode != GX_TRIGGER_MODE_ON || cam->Trigger.Sync == NULL) return GX_STATUS_INVALID_CALL;
+	
+	// Releases a frame that arrived after an earlier timeout, it is not ours
+	TriggerWaitArm(&cam->Trigger);
+	
+	double triggerTimeMs = GetHostTimeMs();
+	
+	if (cam->TriggerSource == GX_TRIGGER_SOURCE_SOFTWARE) {
+		
+		emStatus = GXSendCommand(cam->Device, GX_COMMAND_TRIGGER_SOFTWARE);
+		if (emStatus != GX_STATUS_SUCCESS) {
+			TriggerWaitDisarm(&cam->Trigger);
+			return emStatus;
+		}
+	}
+	
+	if (TriggerWaitFor(&cam->Trigger, triggerTimeMs, timeoutMs, &triggered) != OK) return GX_STATUS_TIMEOUT;
+	
+	*frame = (struct frame_s *)triggered;
+	
+	return GX_STATUS_SUCCESS;
+}
+
+void TriggerAddRefFrame(void *item) {
+	
+	FrameAddRef((struct frame_s *)item);
+}
+
+void TriggerReleaseFrame(void *item) {
+	
+	FrameRelease((struct frame_s *)item);
+}
+
+void GetTriggerLatencyStats(struct camera_s *cam, double *meanMs, double *jitterMs, double *maxMs) {
+	
+	TriggerWaitLatency(&cam->Trigger, meanMs, jitterMs, maxMs);
+}
+
+/***************************************************************************************************
+Multi-camera frame pairing. Every attached camera pushes its frames, timestamped by its own clock, into
+a shared frame_sync_s which emits one frame per camera captured within the tolerance, see FRAME_SYNC.h.
+The synchronizer holds a frame reference while the frame is queued, a set callback that keeps a frame
+takes its own reference.
+****************************************************************************************************/
+
+int InitCameraFrameSync(struct frame_sync_s *sync, struct camera_s **cams, int numCams, double toleranceUs, FrameSetCallback onSet, void *userData) {
+	
+	if (FrameSyncInit(sync, numCams, 0, toleranceUs, onSet, FrameSyncReleaseFrame, userData) != OK) return CANCEL;
+	
+	for (int i = 0; i < numCams; i++) {
+		if (AttachFrameSync(cams[i], sync, i) != OK) return CANCEL;
+	}
+	
+	return OK;
+}
+
+int AttachFrameSync(struct camera_s *cam, struct frame_sync_s *sync, int stream) {
+	
+	if (sync == NULL || stream < 0 || stream >= sync->NumStreams) return CANCEL;
+	
+	cam->FrameSync         = sync;
+	cam->FrameSyncStream   = stream;
+	cam->FrameSyncTimeBase = FRAME_TIME_NONE;
+	
+	UnregisterFrameConsumer(cam, FrameSyncConsumer);
+	return RegisterFrameConsumer(cam, FrameSyncConsumer, sync);
+}
+
+void FrameSyncConsumer(struct camera_s *cam, struct frame_s *frame, void *userData) {
+	
+	struct frame_sync_s *sync = (struct frame_sync_s *)userData;
+	
+	// Device ticks -> microseconds, the synchronizer maps each camera clock onto the host clock.
+	// With the clock sync fit the capture time is on the host clock already, drift included.
+	double timeUs = (double)frame->Timestamp * (1000000.0 / (double)cam->TimestampTickFrequency);
+	int timeBase  = FRAME_TIME_TICKS;
+	
+	if (cam->ClockSync.Valid) {
+		timeUs   = frame->CaptureTimeMs * 1000.0;
+		timeBase = FRAME_TIME_HOST;
+	}
+	
+	// Never mix time bases in one stream. Host times need no offset: aligning them with the host receive
+	// time would add this camera's delivery latency to every frame.
+	if (timeBase != cam->FrameSyncTimeBase) {
+		
+		FrameSyncRealign(sync, cam->FrameSyncStream);
+		if (timeBase == FRAME_TIME_HOST) FrameSyncSetOffset(sync, cam->FrameSyncStream, 0);
+		
+		cam->FrameSyncTimeBase = timeBase;
+	}
+	
+	FrameAddRef(frame);
+	FrameSyncPush(sync, cam->FrameSyncStream, timeUs, frame->HostTimeMs * 1000.0, frame->FrameID, frame);
+}
+
+void FrameSyncReleaseFrame(void *item, void *userData) {
+	
+	FrameRelease((struct frame_s *)item);
+}
+
+/***************************************************************************************************
+Camera Initilization.
+
+Initilizes camera to a preset known state. Prepares it for proper image capturing.
+
+Loads parameters from device to struct.
+
+Loads parameters Gain and Exposure from struct to device.
+****************************************************************************************************/
+
+GX_STATUS InitDevice(struct camera_s *cam) {
+	
+	GX_STATUS emStatus = GX_STATUS_SUCCESS;
+
+    // AcquisitionMode = Continuous
+    emStatus = GXSetEnum(cam->Device, GX_ENUM_ACQUISITION_MODE, GX_ACQ_MODE_CONTINUOUS);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+
+    // TriggerMode = Off, or triggered on TriggerSource
+    emStatus = ConfigureTrigger(cam);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+
+    // 8-bit pixel format, or the 10/12-bit format asked for
+	if (cam->PixelBitDepth > 8) emStatus = SetPixelFormatBits(cam, cam->PixelBitDepth, cam->PackedPixels);
+	else emStatus = SetPixelFormat8bit(cam);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXGetEnum(cam->Device, GX_ENUM_PIXEL_FORMAT, &cam->PixelFormat);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	int packed = 0;
+	cam->ActiveBitDepth = PixelFormatBits((int)cam->PixelFormat, &packed);
+	if (cam->ActiveBitDepth <= 0) cam->ActiveBitDepth = 8;
+	
+    // Exposure time / gain chunks, before the payload size (they make it bigger)
+    emStatus = ConfigureChunkData(cam);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+    // Exposure-end events
+    emStatus = ConfigureExposureEvents(cam);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+    // Payload size
+    emStatus = GXGetInt(cam->Device, GX_INT_PAYLOAD_SIZE, &cam->PayLoadSize);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+
+    // Width, Height
+    emStatus = GXGetInt(cam->Device, GX_INT_WIDTH, &cam->ImageWidth);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+
+    emStatus = GXGetInt(cam->Device, GX_INT_HEIGHT, &cam->ImageHeight);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+    // Offsets, binning and decimation of the readout window
+    emStatus = ReadCaptureGeometry(cam);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+
+    // Device timestamp clock, needed to put the frame timestamps of several cameras on one time base
+    if (GXGetInt(cam->Device, GX_INT_TIMESTAMP_TICK_FREQUENCY, &cam->TimestampTickFrequency) != GX_STATUS_SUCCESS || cam->TimestampTickFrequency <= 0)
+		cam->TimestampTickFrequency = 1000000000; // MER2 default, 1ns ticks
+	
+    // Map that clock onto the host clock (latched in the background)
+    StartClockSync(cam);
+
+    // IsColorFilter?
+    emStatus = GXIsImplemented(cam->Device, GX_ENUM_PIXEL_COLOR_FILTER, &cam->IsColorFilter);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+    // ROI
+    GXGetInt(cam->Device, GX_INT_AAROI_OFFSETX, &cam->RoiX);
+    GXGetInt(cam->Device, GX_INT_AAROI_OFFSETY, &cam->RoiY);
+    GXGetInt(cam->Device, GX_INT_AAROI_WIDTH,   &cam->RoiW);
+    GXGetInt(cam->Device, GX_INT_AAROI_HEIGHT,  &cam->RoiH);
+
+    // Gray
+    GXGetInt(cam->Device, GX_INT_GRAY_VALUE, &cam->Gray);
+
+    // If color filter, get it
+    if (cam->IsColorFilter) GXGetEnum(cam->Device, GX_ENUM_PIXEL_COLOR_FILTER, &cam->PixelColorFilter);
+	
+	// Configure Gain Mode
+	if (cam->GainMode == 0) emStatus = GXSetEnum(cam->Device, GX_ENUM_GAIN_AUTO, GX_GAIN_AUTO_OFF);
+	else if (cam->GainMode == 1) emStatus = GXSetEnum(cam->Device, GX_ENUM_GAIN_AUTO, GX_GAIN_AUTO_CONTINUOUS);
+	else if (cam->GainMode == 2) emStatus = GXSetEnum(cam->Device, GX_ENUM_GAIN_AUTO, GX_GAIN_AUTO_ONCE);
+	else return CANCEL;
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetFloat(cam->Device,GX_FLOAT_GAIN,cam->Gain);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetFloat(cam->Device, GX_FLOAT_AUTO_GAIN_MIN, cam->AutoGainMin);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetFloat(cam->Device, GX_FLOAT_AUTO_GAIN_MAX, cam->AutoGainMax);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	// Configure Exposure Time Mode 
+	if (cam->ExposureTimeMode == 0) emStatus = GXSetEnum(cam->Device, GX_ENUM_EXPOSURE_AUTO, GX_EXPOSURE_AUTO_OFF);
+	else if (cam->ExposureTimeMode == 1) emStatus = GXSetEnum(cam->Device, GX_ENUM_EXPOSURE_AUTO, GX_EXPOSURE_AUTO_CONTINUOUS);
+	else if (cam->ExposureTimeMode == 2) emStatus = GXSetEnum(cam->Device, GX_ENUM_EXPOSURE_AUTO, GX_EXPOSURE_AUTO_ONCE);
+	else return CANCEL;
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus = GXSetFloat(cam->Device, GX_FLOAT_EXPOSURE_TIME, cam->ExposureTime);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus =GXSetFloat(cam->Device, GX_FLOAT_AUTO_EXPOSURE_TIME_MIN, cam->AutoExposureTimeMin);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+	emStatus =GXSetFloat(cam->Device, GX_FLOAT_AUTO_EXPOSURE_TIME_MAX, cam->AutoExposureTimeMax);
+	if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+    return emStatus;
+}
+
+/***************************************************************************************************
+Set pixel format to 8-Bit
+If you don't know the device supports which kind of pixel format,
+you could use following function to set the pixel format to 8-bit.
+****************************************************************************************************/
+
+GX_STATUS SetPixelFormat8bit(struct camera_s *cam) {
+	
+    GX_STATUS emStatus   = GX_STATUS_SUCCESS;
+    int64_t   nPixelSize = 0;
+	uint32_t  nEnumEntry  = 0;
+    size_t    nBufferSize = 0;
+	
+	GX_ENUM_DESCRIPTION *pEnumDescription = NULL;
+
+    // PixelSize is bits per pixel
+	// Get the feature PixelSize, this feature indicates the depth of the pixel values in the acquired images in bits per pixel
+    emStatus = GXGetEnum(cam->Device, GX_ENUM_PIXEL_SIZE, &nPixelSize);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+
+    // If the PixelSize is 8bit then return, or set the PixelSize to 8bit.
+    if (nPixelSize == GX_PIXEL_SIZE_BPP8) return GX_STATUS_SUCCESS;
+	
+	else {
+		
+	    // We want to find an 8-bit format among the supported pixel formats
+		// Get the enumeration entry of the pixel format the device supports.
+	    emStatus = GXGetEnumEntryNums(cam->Device, GX_ENUM_PIXEL_FORMAT, &nEnumEntry);
+	    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+
+		// Allocate memory for getting the enumeration entry of the pixel format.
+	    nBufferSize = nEnumEntry * sizeof(GX_ENUM_DESCRIPTION);
+	    pEnumDescription = (GX_ENUM_DESCRIPTION*) malloc(nBufferSize);
+	    
+		if (!pEnumDescription) return CANCEL;
+
+	    emStatus = GXGetEnumDescription(cam->Device, GX_ENUM_PIXEL_FORMAT, pEnumDescription, &nBufferSize);
+	
+	    if (emStatus != GX_STATUS_SUCCESS) {
+			if (pEnumDescription != NULL) {
+	        	free(pEnumDescription);
+			}
+			return emStatus;
+	    }
+
+	    // Try each supported format to see if it's 8-bit
+		// A loop to visit every enumeration entry node once to find which enumeration entry node is 8bit and then set pixel format to its value
+	    for (uint32_t i = 0; i < nEnumEntry; i++) {
+		
+	        if ((pEnumDescription[i].nValue & GX_PIXEL_8BIT) == GX_PIXEL_8BIT)
+	        {
+	            emStatus = GXSetEnum(cam->Device, GX_ENUM_PIXEL_FORMAT, pEnumDescription[i].nValue);
+	            break;
+	        }
+	    }
+	}
+
+    free(pEnumDescription);
+    return emStatus;
+}
+
+/***************************************************************************************************
+Set a 10 or 12-bit pixel format. The packed variant (2 pixels in 3 bytes) is taken if asked for and
+the camera has it, the 16 bits per pixel one otherwise, and the other way round.
+Returns GX_STATUS_NOT_IMPLEMENTED if the camera has neither.
+****************************************************************************************************/
+
+GX_STATUS SetPixelFormatBits(struct camera_s *cam, int bits, int packed) {
+	
+    GX_STATUS emStatus    = GX_STATUS_SUCCESS;
+	uint32_t  nEnumEntry  = 0;
+    size_t    nBufferSize = 0;
+	int64_t   best        = -1;
+	
+	GX_ENUM_DESCRIPTION *pEnumDescription = NULL;
+	
+    emStatus = GXGetEnumEntryNums(cam->Device, GX_ENUM_PIXEL_FORMAT, &nEnumEntry);
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+    nBufferSize = nEnumEntry * sizeof(GX_ENUM_DESCRIPTION);
+    pEnumDescription = (GX_ENUM_DESCRIPTION*) malloc(nBufferSize);
+	
+	if (!pEnumDescription) return CANCEL;
+	
+    emStatus = GXGetEnumDescription(cam->Device, GX_ENUM_PIXEL_FORMAT, pEnumDescription, &nBufferSize);
+	
+    if (emStatus != GX_STATUS_SUCCESS) {
+		free(pEnumDescription);
+		return emStatus;
+    }
+	
+	for (uint32_t i = 0; i < nEnumEntry; i++) {
+		
+		int isPacked = 0;
+		
+		if (PixelFormatBits((int)pEnumDescription[i].nValue, &isPacked) != bits) continue;
+		
+		// Exact match wins, otherwise keep the first format of that depth
+		if (isPacked == (packed != 0)) {
+			best = pEnumDescription[i].nValue;
+			break;
+		}
+		
+		if (best < 0) best = pEnumDescription[i].nValue;
+	}
+	
+    free(pEnumDescription);
+	
+	if (best < 0) {
+		printf("Camera %s: no %d-bit pixel format\n", cam->SerialNumber, bits);
+		return GX_STATUS_NOT_IMPLEMENTED;
+	}
+	
+    return GXSetEnum(cam->Device, GX_ENUM_PIXEL_FORMAT, best);
+}
+
+
+
+/***************************************************************************************************
+Zero-copy statistics. Returns the memory traffic (bytes per second, read + write) the frame callback
+saved since the acquisition started by not copying every frame into a raw buffer.
+****************************************************************************************************/
+
+double GetCopyBytesSavedPerSecond(struct camera_s *cam) {
+	
+	double elapsed = Timer() - cam->AcqStartTime;
+	
+	if (!cam->IsSnap || elapsed <= 0) return 0;
+	
+	return (double)cam->CopyBytesSaved / elapsed;
+}
+
+/***************************************************************************************************
+Save the full bit depth of a 10/12-bit frame as a 16-bit binary PGM (P5, big-endian samples, maxval
+1023 / 4095). Bayer frames are saved as the raw mosaic. The display BMP only has 8 bits (tone LUT).
+
+Return OK on success, CANCEL on failure
+****************************************************************************************************/
+
+int SaveFrameRaw16(const char *fileName, struct frame_s *frame, struct camera_s *cam) {
+	
+	if (frame == NULL) return CANCEL;
+	
+	// The frame's own size, the camera may have a new ROI since it was captured
+	int width  = frame->Width;
+	int height = frame->Height;
+	size_t pixels = (size_t)width * height;
+	
+	if (width <= 0 || height <= 0 || frame->Raw16 == NULL || frame->BitDepth <= 8 || frame->Raw16Size < pixels * sizeof(uint16_t)) return CANCEL;
+	
+	FILE *fp = fopen(fileName, "wb");
+	if (!fp) return CANCEL;
+	
+	fprintf(fp, "P5\n%d %d\n%d\n", width, height, (1 << frame->BitDepth) - 1);
+	
+	// One row at a time, swapped to big-endian
+	unsigned char *row = (unsigned char *)malloc((size_t)width * 2);
+	
+	if (row == NULL) {
+		fclose(fp);
+		return CANCEL;
+	}
+	
+	for (int y = 0; y < height; y++) {
+		
+		const uint16_t *src = frame->Raw16 + (size_t)y * width;
+		
+		for (int x = 0; x < width; x++) {
+			row[2 * x]     = (unsigned char)(src[x] >> 8);
+			row[2 * x + 1] = (unsigned char)(src[x] & 0xFF);
+		}
+		
+		fwrite(row, 1, (size_t)width * 2, fp);
+	}
+	
+	free(row);
+	fclose(fp);
+	return OK;
+}
+
+/***************************************************************************************************
+Unpack benchmark. Times the scalar, SIMD and SDK (DxRaw10PackedToRaw16 / DxRaw12PackedToRaw16)
+unpacking of a packed width x height frame of random data, prints MPixel/s of each and checks that
+all three give the same 16-bit values. Use the sensor size, e.g. 4024 x 3036 for a 12 MP camera.
+
+Return OK if the results match, CANCEL otherwise
+****************************************************************************************************/
+
+int BenchmarkPixelUnpack(int width, int height, int bits, int iterations) {
+	
+	if (width <= 0 || height <= 0 || (bits != 10 && bits != 12)) return CANCEL;
+	if (iterations <= 0) iterations = 10;
+	
+	size_t pixels = (size_t)width * height;
+	size_t packedBytes = (pixels * 3 + 1) / 2;
+	
+	uint8_t  *src       = (uint8_t *)malloc(packedBytes);
+	uint16_t *scalarOut = (uint16_t *)malloc(pixels * sizeof(uint16_t));
+	uint16_t *simdOut   = (uint16_t *)malloc(pixels * sizeof(uint16_t));
+	uint16_t *sdkOut    = (uint16_t *)malloc(pixels * sizeof(uint16_t));
+	
+	if (!src || !scalarOut || !simdOut || !sdkOut) {
+		free(src);
+		free(scalarOut);
+		free(simdOut);
+		free(sdkOut);
+		return CANCEL;
+	}
+	
+	int result = OK;
+	
+	srand(1);
+	for (size_t i = 0; i < packedBytes; i++) src[i] = (uint8_t)rand();
+	
+	double scalarMs = 0, simdMs = 0, sdkMs = 0;
+	
+	for (int n = 0; n < iterations; n++) {
+		
+		int64_t t0 = GetHostTicks();
+		
+		if (bits == 12) PixelUnpack12Scalar(src, scalarOut, pixels);
+		else PixelUnpack10Scalar(src, scalarOut, pixels);
+		
+		int64_t t1 = GetHostTicks();
+		
+		PixelUnpack(src, simdOut, pixels, bits, TRUE);
+		
+		int64_t t2 = GetHostTicks();
+		
+		if (bits == 12) DxRaw12PackedToRaw16(src, sdkOut, (VxUint32)width, (VxUint32)height);
+		else DxRaw10PackedToRaw16(src, sdkOut, (VxUint32)width, (VxUint32)height);
+		
+		int64_t t3 = GetHostTicks();
+		
+		scalarMs += HostTicksToUs(t1 - t0) / 1000.0;
+		simdMs   += HostTicksToUs(t2 - t1) / 1000.0;
+		sdkMs    += HostTicksToUs(t3 - t2) / 1000.0;
+	}
+	
+	double mpix = (double)pixels * iterations / 1000.0; // MPixel/s = pixels / ms / 1000
+	
+	printf("Unpack %d-bit packed %dx%d, %d runs\n", bits, width, height, iterations);
+	printf("  scalar  %8.1f MPixel/s\n", scalarMs > 0 ? mpix / scalarMs : 0);
+	printf("  %-7s %8.1f MPixel/s\n", PixelUnpackHasSimd() ? "SSSE3" : "(none)", simdMs > 0 ? mpix / simdMs : 0);
+	printf("  SDK     %8.1f MPixel/s\n", sdkMs > 0 ? mpix / sdkMs : 0);
+	
+	if (memcmp(scalarOut, simdOut, pixels * sizeof(uint16_t)) != 0) {
+		printf("  SIMD result differs from scalar\n");
+		result = CANCEL;
+	}
+	
+	if (memcmp(scalarOut, sdkOut, pixels * sizeof(uint16_t)) != 0) {
+		printf("  SDK result differs from scalar\n");
+		result = CANCEL;
+	}
+	
+	free(src);
+	free(scalarOut);
+	free(simdOut);
+	free(sdkOut);
+	return result;
+}
+
+/***************************************************************************************************
+Demosaic benchmark. Times every demosaic kernel this build and CPU have (scalar, SSE2, AVX2) in both
+qualities and DxRaw8toRGB24 on a width x height BAYERRG frame of random data and prints MPixel/s of
+each. Every SIMD kernel must give the scalar result exactly, for all four Bayer patterns.
+
+Return OK if the results match, CANCEL otherwise
+****************************************************************************************************/
+
+int BenchmarkDemosaic(int width, int height, int iterations) {
+	
+	if (width < 2 || height < 2) return CANCEL;
+	if (iterations <= 0) iterations = 10;
+	
+	size_t pixels   = (size_t)width * height;
+	size_t rowBytes = DemosaicRowBytes(width);
+	
+	uint8_t *src       = (uint8_t *)malloc(pixels);
+	uint8_t *scalarOut = (uint8_t *)malloc(rowBytes * height);
+	uint8_t *out       = (uint8_t *)malloc(rowBytes * height);
+	struct demosaic_lines_s lines = {0};
+	
+	if (!src || !scalarOut || !out || DemosaicLinesAlloc(&lines, width) != OK) {
+		free(src);
+		free(scalarOut);
+		free(out);
+		DemosaicLinesFree(&lines);
+		return CANCEL;
+	}
+	
+	int result = OK;
+	int best = DemosaicBestKernel();
+	double mpix = (double)pixels * iterations / 1000.0; // MPixel/s = pixels / ms / 1000
+	
+	srand(1);
+	for (size_t i = 0; i < pixels; i++) src[i] = (uint8_t)rand();
+	
+	printf("Demosaic %dx%d, %d runs, best kernel %s\n", width, height, iterations, DemosaicKernelName(best));
+	
+	for (int quality = DEMOSAIC_BILINEAR; quality <= DEMOSAIC_NEAREST; quality++) {
+		
+		for (int kernel = DEMOSAIC_KERNEL_SCALAR; kernel <= best; kernel++) {
+			
+			double ms = 0;
+			
+			for (int n = 0; n < iterations; n++) {
+				
+				int64_t t0 = GetHostTicks();
+				DemosaicRows(src, 8, NULL, width, height, width, out, (int)rowBytes, TRUE, 1, quality, kernel, 0, height, &lines);
+				ms += HostTicksToUs(GetHostTicks() - t0) / 1000.0;
+			}
+			
+			printf("  %-8s %-6s %8.1f MPixel/s\n", quality == DEMOSAIC_NEAREST ? "nearest" : "bilinear", DemosaicKernelName(kernel), ms > 0 ? mpix / ms : 0);
+		}
+		
+		// Golden result of every pattern is the scalar kernel
+		for (int pattern = 1; pattern <= 4; pattern++) {
+			
+			DemosaicRows(src, 8, NULL, width, height, width, scalarOut, (int)rowBytes, TRUE, pattern, quality, DEMOSAIC_KERNEL_SCALAR, 0, height, &lines);
+			
+			for (int kernel = DEMOSAIC_KERNEL_SCALAR + 1; kernel <= best; kernel++) {
+				
+				DemosaicRows(src, 8, NULL, width, height, width, out, (int)rowBytes, TRUE, pattern, quality, kernel, 0, height, &lines);
+				
+				if (memcmp(scalarOut, out, rowBytes * height) != 0) {
+					printf("  %s result differs from scalar (pattern %d, quality %d)\n", DemosaicKernelName(kernel), pattern, quality);
+					result = CANCEL;
+				}
+			}
+		}
+	}
+	
+	double sdkMs = 0;
+	
+	for (int n = 0; n < iterations; n++) {
+		
+		int64_t t0 = GetHostTicks();
+		DxRaw8toRGB24(src, out, (VxUint32)width, (VxUint32)height, RAW2RGB_NEIGHBOUR, BAYERRG, TRUE);
+		sdkMs += HostTicksToUs(GetHostTicks() - t0) / 1000.0;
+	}
+	
+	printf("  SDK      %-6s %8.1f MPixel/s\n", "", sdkMs > 0 ? mpix / sdkMs : 0);
+	
+	free(src);
+	free(scalarOut);
+	free(out);
+	DemosaicLinesFree(&lines);
+	return result;
+}
+
+/***************************************************************************************************
+Tone conversion benchmark. Converts a width x height BAYERRG frame of random bits-deep data (8, 10 or
+12, 16-bit pixels above 8) with a gamma/contrast/lightness LUT two ways, on one thread:
+
+ separate   the LUT maps the frame to an 8-bit plane, the demosaic reads that plane
+ fused      DemosaicRows applies the LUT while it reads the raw rows (what the frame callback does)
+
+and prints MPixel/s and the frame memory each touches. Both must give the same image.
+
+Return OK if the results match, CANCEL otherwise
+****************************************************************************************************/
+
+int BenchmarkToneConversion(int width, int height, int bits, int iterations) {
+	
+	if (width < 2 || height < 2 || (bits != 8 && bits != 10 && bits != 12)) return CANCEL;
+	if (iterations <= 0) iterations = 10;
+	
+	size_t pixels     = (size_t)width * height;
+	size_t rowBytes   = DemosaicRowBytes(width);
+	int pixelBytes    = bits > 8 ? (int)sizeof(uint16_t) : 1;
+	
+	uint8_t *src      = (uint8_t *)malloc(pixels * pixelBytes);
+	uint8_t *plane    = (uint8_t *)malloc(pixels);
+	uint8_t *separate = (uint8_t *)malloc(rowBytes * height);
+	uint8_t *fused    = (uint8_t *)malloc(rowBytes * height);
+	struct demosaic_lines_s lines = {0};
+	struct tone_lut_s lut = {0};
+	
+	if (!src || !plane || !separate || !fused || DemosaicLinesAlloc(&lines, width) != OK || ToneLutUpdate(&lut, bits, 2.2, 20, 10) != OK) {
+		free(src);
+		free(plane);
+		free(separate);
+		free(fused);
+		DemosaicLinesFree(&lines);
+		ToneLutFree(&lut);
+		return CANCEL;
+	}
+	
+	srand(1);
+	for (size_t i = 0; i < pixels; i++) {
+		if (bits > 8) ((uint16_t *)src)[i] = (uint16_t)(rand() & ((1 << bits) - 1));
+		else src[i] = (uint8_t)rand();
+	}
+	
+	int result = OK;
+	int srcStride = width * pixelBytes;
+	double separateMs = 0, fusedMs = 0;
+	
+	for (int n = 0; n < iterations; n++) {
+		
+		int64_t t0 = GetHostTicks();
+		
+		for (int y = 0; y < height; y++) DemosaicMapRow(src + (size_t)y * srcStride, bits, lut.Table, width, plane + (size_t)y * width);
+		DemosaicRows(plane, 8, NULL, width, height, width, separate, (int)rowBytes, TRUE, BAYERRG, DEMOSAIC_BILINEAR, DEMOSAIC_KERNEL_AUTO, 0, height, &lines);
+		
+		int64_t t1 = GetHostTicks();
+		
+		DemosaicRows(src, bits, lut.Table, width, height, srcStride, fused, (int)rowBytes, TRUE, BAYERRG, DEMOSAIC_BILINEAR, DEMOSAIC_KERNEL_AUTO, 0, height, &lines);
+		
+		int64_t t2 = GetHostTicks();
+		
+		separateMs += HostTicksToUs(t1 - t0) / 1000.0;
+		fusedMs    += HostTicksToUs(t2 - t1) / 1000.0;
+	}
+	
+	double mpix = (double)pixels * iterations / 1000.0; // MPixel/s = pixels / ms / 1000
+	double srcMB = (double)pixels * pixelBytes / 1e6;
+	double dstMB = (double)rowBytes * height / 1e6;
+	double planeMB = (double)pixels / 1e6;
+	
+	printf("Tone conversion %d-bit %dx%d, %d runs, %s\n", bits, width, height, iterations, DemosaicKernelName(DemosaicBestKernel()));
+	printf("  separate %8.1f MPixel/s  %6.1f MB per frame\n", separateMs > 0 ? mpix / separateMs : 0, srcMB + 2 * planeMB + dstMB);
+	printf("  fused    %8.1f MPixel/s  %6.1f MB per frame\n", fusedMs > 0 ? mpix / fusedMs : 0, srcMB + dstMB);
+	
+	if (memcmp(separate, fused, rowBytes * height) != 0) {
+		printf("  fused result differs from separate\n");
+		result = CANCEL;
+	}
+	
+	free(src);
+	free(plane);
+	free(separate);
+	free(fused);
+	DemosaicLinesFree(&lines);
+	ToneLutFree(&lut);
+	return result;
+}
+
+/***************************************************************************************************
+Conversion thread scaling. Demosaics a width x height BAYERRG frame of random data the way the frame
+callback does (ConvertBand on a tile pool, default band size) on 1, 2, ... maxThreads threads and
+prints MPixel/s, the speedup over 1 thread and the bands stolen. Every result must be byte for byte
+the 1-thread one. maxThreads 0 = one per processor.
+
+Return OK if the results match, CANCEL otherwise
+****************************************************************************************************/
+
+int BenchmarkConvertThreads(int width, int height, int maxThreads, int iterations) {
+	
+	if (width < 2 || height < 2) return CANCEL;
+	if (iterations <= 0) iterations = 10;
+	if (maxThreads <= 0) maxThreads = TilePoolProcessors();
+	if (maxThreads > TILE_POOL_MAX_THREADS) maxThreads = TILE_POOL_MAX_THREADS;
+	
+	size_t pixels   = (size_t)width * height;
+	size_t rowBytes = DemosaicRowBytes(width);
+	
+	uint8_t *src      = (uint8_t *)malloc(pixels);
+	uint8_t *firstOut = (uint8_t *)malloc(rowBytes * height);
+	uint8_t *out      = (uint8_t *)malloc(rowBytes * height);
+	struct demosaic_lines_s *lines = (struct demosaic_lines_s *)calloc(TILE_POOL_MAX_THREADS, sizeof(struct demosaic_lines_s));
+	
+	int result = (src && firstOut && out && lines) ? OK : CANCEL;
+	
+	for (int i = 0; i < maxThreads && result == OK; i++) {
+		if (DemosaicLinesAlloc(&lines[i], width) != OK) result = CANCEL;
+	}
+	
+	if (result != OK) {
+		free(src);
+		free(firstOut);
+		free(out);
+		if (lines) for (int i = 0; i < TILE_POOL_MAX_THREADS; i++) DemosaicLinesFree(&lines[i]);
+		free(lines);
+		return CANCEL;
+	}
+	
+	srand(1);
+	for (size_t i = 0; i < pixels; i++) src[i] = (uint8_t)rand();
+	
+	struct convert_job_s job = {0};
+	
+	job.Src       = src;
+	job.SrcBits   = 8;
+	job.SrcStride = width;
+	job.Width     = width;
+	job.Height    = height;
+	job.RowBytes  = (int)rowBytes;
+	job.Color     = TRUE;
+	job.Pattern   = BAYERRG;
+	job.Quality   = DEMOSAIC_BILINEAR;
+	job.Kernel    = DEMOSAIC_KERNEL_AUTO;
+	job.Lines     = lines;
+	
+	double mpix = (double)pixels * iterations / 1000.0; // MPixel/s = pixels / ms / 1000
+	double oneThreadMs = 0;
+	
+	printf("Conversion threads, demosaic %dx%d %s, %d runs\n", width, height, DemosaicKernelName(DemosaicBestKernel()), iterations);
+	
+	for (int threads = 1; threads <= maxThreads; threads++) {
+		
+		struct tile_pool_s pool;
+		
+		if (TilePoolCreate(&pool, threads) != OK) {
+			printf("  %2d threads: could not start them\n", threads);
+			result = CANCEL;
+			break;
+		}
+		
+		job.Dst = (threads == 1) ? firstOut : out;
+		
+		double ms = 0;
+		long stolen = 0;
+		
+		for (int n = 0; n < iterations; n++) {
+			
+			int64_t t0 = GetHostTicks();
+			TilePoolRun(&pool, height, 0, ConvertBand, &job);
+			ms += HostTicksToUs(GetHostTicks() - t0) / 1000.0;
+			
+			for (int i = 0; i < threads; i++) stolen += pool.Worker[i].Stolen;
+		}
+		
+		TilePoolDestroy(&pool);
+		
+		if (threads == 1) oneThreadMs = ms;
+		
+		printf("  %2d threads %8.1f MPixel/s  x%.2f  %.1f bands stolen per frame\n", threads, ms > 0 ? mpix / ms : 0,
+			   ms > 0 ? oneThreadMs / ms : 0, (double)stolen / iterations);
+		
+		if (ATOMIC_LOAD(&job.Failed) || (threads > 1 && memcmp(firstOut, out, rowBytes * height) != 0)) {
+			printf("  %2d threads: result differs from 1 thread\n", threads);
+			result = CANCEL;
+		}
+	}
+	
+	free(src);
+	free(firstOut);
+	free(out);
+	for (int i = 0; i < TILE_POOL_MAX_THREADS; i++) DemosaicLinesFree(&lines[i]);
+	free(lines);
+	return result;
+}
+
+/***************************************************************************************************
+Camera Error Handling Functions.
+****************************************************************************************************/
+
+int VERIFY_STATUS_RET (GX_STATUS emStatus) {
+	
+    if (emStatus != GX_STATUS_SUCCESS) return emStatus;
+	
+    else return GX_STATUS_SUCCESS;
+}
+
+// Show error info from GxIAPI
+void ShowErrorString(GX_STATUS emErrorStatus) {
+	
+	char*  pchErrorInfo = NULL;
+    size_t nSize        = 0;
+    GX_STATUS emStatus  = GX_STATUS_ERROR;
+
+    // Get length
+    emStatus = GXGetLastError(&emErrorStatus, NULL, &nSize);
+    if (emStatus != GX_STATUS_SUCCESS || nSize == 0) {
+		
+        MessagePopup("Error", "Failed to retrieve error info length.");
+        return;
+    }
+
+    pchErrorInfo = (char*)malloc(nSize);
+    if (!pchErrorInfo) {
+		
+        MessagePopup("Error", "Memory allocation failed for error string.");
+        return;
+    }
+
+    // Get actual error info
+    emStatus = GXGetLastError(&emErrorStatus, pchErrorInfo, &nSize);
+    if (emStatus != GX_STATUS_SUCCESS) MessagePopup("Error", "Fail to call GXGetLastError!");
+    else MessagePopup("GxIAPI Error", pchErrorInfo);
+
+    free(pchErrorInfo);
+}
+
+/***************************************************************************************************
+The async timer callback: picks up the newest complete frame from cam->Display and draws it.
+Nothing is redrawn when the frame callback has not published a new frame since the last tick.
+
+The correct panelHandle and canvasControl must be set in order to display the image!
+****************************************************************************************************/
+
+void CVICALLBACK UpdateCameraCallback(int reserved, int timerId, int event, struct camera_s *cam, int eventData1, int eventData2) {
+	
+    if (cam->IsSnap && cam->BitmapHandle) {
+		
+		// Take the newest complete frame, never blocks the frame callback
+		int isNewFrame = 0;
+		struct frame_s *frame = (struct frame_s *)TripleBufferFront(&cam->Display, &isNewFrame);
+		if (!isNewFrame || frame == NULL) return;
+		
+		cam->ImgBuffer = frame->Data;
+		cam->DisplayedFrameAgeMs = GetHostTimeMs() - frame->CaptureTimeMs;
+		
+		// Canvas Control Information
+    	int panelHandle      = cam->panelHandle;
+    	int canvasControl    = cam->canvasControl;
+		
+        // Grab local copies (cast 64-bit to int if safe)
+        int width        = (int)cam->BmpInfo.biWidth;
+        int height       = (int)cam->BmpInfo.biHeight;
+        int bitsPerPixel = (int)cam->BmpInfo.biBitCount;
+		
+        // Use GetBitmapInfo to check the nandle is truly valid
+        int error = GetBitmapInfo(cam->BitmapHandle, NULL, NULL, NULL);
+
+        if (GetBitmapInfo(cam->BitmapHandle, NULL, NULL, NULL) < 0) {
+			
+            // If GetBitmapInfo fails, the handle is invalid (or something is wrong)
+            printf("GetBitmapInfo failed for camera's bitmap handle. Error = %d\n", error);
+            return;
+        }
+		
+        // Compute rowBytes
+        int rowBytes = (bitsPerPixel == 24) ? (((width * 3) + 3) & ~3) : ((width + 3) & ~3);  // For 8-bit
+
+        // For 8-bit images, use cam->BmpInfo.biColorTable;
+        // For 24-bit images, pass NULL for the colorTable parameter.
+        int *colorTablePtr = (bitsPerPixel == 8) ? cam->BmpInfo.biColorTable : NULL;
+
+        int64_t setBitmapTicks = GetHostTicks();
+		RecordStageLatency(cam, LATENCY_STAGE_QUEUE, frame->ConvertedTicks, setBitmapTicks);
+
+        // Update the existing bitmap handle with new frame data
+        // SetBitmapData signature:
+        //     int SetBitmapData(int bitmapID,
+        //                       int bytesPerRow,
+        //                       int pixelDepth,
+        //                       int colorTable[],    // or NULL for 24-bit
+        //                       unsigned char bits[], // pointer to pixel data
+        //                       unsigned char mask[]); // or NULL for no mask
+        error = SetBitmapData(
+                        cam->BitmapHandle,
+                        rowBytes,
+                        bitsPerPixel,
+                        colorTablePtr,
+                        cam->ImgBuffer,
+                        NULL   // no mask
+                    );
+        if (error < 0)
+        {
+            // Not fatal, but we can log something
+            printf("SetBitmapData failed: %d\n", error);
+        }
+
+        int64_t drawTicks = GetHostTicks();
+		RecordStageLatency(cam, LATENCY_STAGE_SET_BITMAP, setBitmapTicks, drawTicks);
+
+        // Now draw it onto the canvas
+        CanvasDrawBitmap(panelHandle,
+                         canvasControl,
+                         cam->BitmapHandle,
+                         VAL_ENTIRE_OBJECT, // source rect
+                         VAL_ENTIRE_OBJECT  // dest rect
+        );
+		
+		int64_t drawnTicks = GetHostTicks();
+		RecordStageLatency(cam, LATENCY_STAGE_DRAW, drawTicks, drawnTicks);
+		RecordStageLatency(cam, LATENCY_STAGE_TOTAL, frame->DeliveredTicks, drawnTicks);
+		
+		
+        // Draw the crosshair lines
+		if (cam->UseCrosshair == 1) {
+			
+			int width, height, scaled_crosshair_x, scaled_crosshair_y;
+			
+			// Set the pen width and color.
+			SetCtrlAttribute(panelHandle, canvasControl, ATTR_PEN_COLOR, cam->CrosshairColor);
+			SetCtrlAttribute(panelHandle, canvasControl, ATTR_PEN_WIDTH, cam->CrosshairThickness);
+
+		    // 1) Get the canvas width and height
+		    GetCtrlAttribute (panelHandle, canvasControl, ATTR_WIDTH,  &width);
+		    GetCtrlAttribute (panelHandle, canvasControl, ATTR_HEIGHT, &height);
+
+		    // 2) Make sure the cam->CrosshairX / CrosshairY are within the valid image range
+		    if (cam->CrosshairX > cam->ImageWidth) cam->CrosshairX = (int)cam->ImageWidth;
+		    if (cam->CrosshairY > cam->ImageHeight) cam->CrosshairY = (int)cam->ImageHeight;
+
+		    // 3) Scale from full-resolution space [0 .. ImageWidth] to canvas space [0 .. width]
+		    //    and [0 .. ImageHeight] to [0 .. height].
+		    //    (Use a float cast to avoid integer division issues.)
+		    scaled_crosshair_x = (int)( (float)cam->CrosshairX / (float)cam->ImageWidth  * (float)width );
+		    scaled_crosshair_y = (int)( (float)cam->CrosshairY / (float)cam->ImageHeight * (float)height );
+
+		    // 4) Clip scaled coordinates again just to ensure they are not outside the Canvas
+		    if (scaled_crosshair_x < 0)        scaled_crosshair_x = 0;
+		    else if (scaled_crosshair_x > width)  scaled_crosshair_x = width;
+
+		    if (scaled_crosshair_y < 0)        scaled_crosshair_y = 0;
+		    else if (scaled_crosshair_y > height) scaled_crosshair_y = height;
+			
+			
+			// Horizontal line in the camera's canvas:
+			CanvasDrawLine (panelHandle, canvasControl, MakePoint(scaled_crosshair_x - cam->CrosshairSize, scaled_crosshair_y), MakePoint(scaled_crosshair_x + cam->CrosshairSize, scaled_crosshair_y));
+			// Vertical line in the camera's canvas:
+			CanvasDrawLine (panelHandle, canvasControl, MakePoint(scaled_crosshair_x, scaled_crosshair_y - cam->CrosshairSize), MakePoint(scaled_crosshair_x, scaled_crosshair_y + cam->CrosshairSize));
+			
+			
+		}
+    }
+}
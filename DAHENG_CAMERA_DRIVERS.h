@@ -1,143 +1,415 @@
-#include "GxIAPI.h" // Camera Includes 
-#include "DxImageProc.h" // Camera Includes 
-#include "camera_test_program.h"
-#include <ansi_c.h>
-#include <cvirte.h>      
-#include <userint.h>
-#include "toolbox.h"
-#include "CALLBACK.h"
-#include <stdlib.h>
-#include <time.h>
-#include <string.h>
-#include "asynctmr.h"
-
-
-/***************************************************************************************************
-The BMP File Struct. Used to display and save BMP images.
-****************************************************************************************************/
-
-#pragma pack(push, 1)  // ensure structures are byte-aligned
-
-// BMP File Header
-typedef struct bmp_file_header{
-    uint16_t bfType;        // "BM"
-    uint32_t bfSize;        // file size in bytes
-    uint16_t bfReserved1;   // reserved, must be 0
-    uint16_t bfReserved2;   // reserved, must be 0
-    uint32_t bfOffBits;     // offset in bytes to bitmap data
-} BmpFileHeader;
-
-// BMP Info Header (a.k.a. DIB header)
-typedef struct bmp_info_header {
-    uint32_t biSize;          	// size of this header (40 bytes)
-    int32_t  biWidth;         	// image width
-    int32_t  biHeight;        	// image height
-    uint16_t biPlanes;        	// # of color planes, must be 1
-    uint16_t biBitCount;      	// bits per pixel (24 = RGB24, 8 = mono)
-    uint32_t biCompression;   	// 0 = BI_RGB (no compression)
-    uint32_t biSizeImage;     	// size of raw bitmap data
-    int32_t  biXPelsPerMeter; 	// pixels per meter in X
-    int32_t  biYPelsPerMeter; 	// pixels per meter in Y
-	int32_t  biColorTable[256];	// MAKE_COLOR(r, g, b) -> uses 0x00BBGGRR in CVI. If 8-bit, build a grayscale color table for LabWindows.
-    uint32_t biClrUsed;       	// # of colors in the palette
-    uint32_t biClrImportant;  	// # of important colors
-} BmpInfoHeader;
-
-#pragma pack(pop)
-
-/***************************************************************************************************
-Camera Struct. This struct holds everything about the camera: connection, buffers, etc.
-****************************************************************************************************/
-
-struct camera_s {
-	
-    // Flags
-    int DevOpened;       // 0=FALSE, 1=TRUE
-    int IsSnap;          // 0=not snapping, 1=snap started
-    int IsColorFilter;   // 0=mono, 1=color
-    int ImplementAutoGain;
-    int ImplementAutoShutter;
-    int ImplementLight;
-
-    // Timer ID from LabWindows async timer
-    int timerId;
-	
-	// Camera ID
-	unsigned char SerialNumber[2048];
-
-    // Camera parameters
-    int64_t Gray;
-    int64_t RoiX;
-    int64_t RoiY;
-    int64_t RoiW;
-    int64_t RoiH;
-	
-	// Camera Gain parameters
-	double  Gain;
-	int GainMode; // 0 for disabled, 1 for enabled
-    double  AutoGainMin;
-    double  AutoGainMax;
-	
-	// Camera Exposure parameters
-	double  ExposureTime;
-	int ExposureTimeMode; // 0 for disabled, 1 for enabled
-    double  AutoExposureTimeMin;
-    double  AutoExposureTimeMax;
-	
-    double  AutoShutterMin;
-    double  AutoShutterMax;
-    int64_t ImageWidth;
-    int64_t ImageHeight;
-    int64_t PayLoadSize;
-    int64_t PixelColorFilter;
-	
-	// Crosshair Settings
-	int UseCrosshair; 			// 0=FALSE, 1=TRUE
-	int CrosshairSize;  		// length from center
-	int CrosshairThickness;  		// Thickness of the crosshair line
-	int CrosshairColor; 		// RGB value is a 4-byte integer with the hexadecimal format 0x00RRGGBB.
-	unsigned int CrosshairX;	// Position On Image (x)
-	unsigned int CrosshairY;	// Position On Image (y)
-	
-	// Variables for real-time image display
-	int panelHandle;
-    int canvasControl;
-	
-
-    // Buffers for image data
-    unsigned char *RawBuffer;  	// Received from camera
-    unsigned char *ImgBuffer;   // Color-converted/flipped data
-	unsigned char BmpBuf[2048]; // The buffer for showing image
-
-    // LabWindows/CVI Bitmap handle for drawing
-    int BitmapHandle;
-
-    // Windows GxIAPI handle
-    GX_DEV_HANDLE Device;
-	
-	// Bmp Header And Info Structs 
-	BmpInfoHeader BmpInfo;
-	BmpFileHeader BmpFile;
-    
-    // Auto modes
-    GX_EXPOSURE_AUTO_ENTRY AutoShutterMode;
-    GX_GAIN_AUTO_ENTRY     AutoGainMode;
-} cameraOne, cameraTwo;
-
-/***************************************************************************************************
-Camera Public Functions And Variables
-****************************************************************************************************/
-
-GX_STATUS OpenDevice   (struct camera_s *cam);
-void CloseDevice  (struct camera_s *cam);
-GX_STATUS InitDevice   (struct camera_s *cam);
-void StartCameraAcquisition (struct camera_s *cam); // Called when the start acquisition button pressed
-void StopCameraAcquisition (struct camera_s *cam); // Called when the stop acquisition button pressed
-int VERIFY_STATUS_RET (GX_STATUS emStatus);
-void ShowErrorString(GX_STATUS emErrorStatus);
-void CVICALLBACK UpdateCameraCallback(int reserved, int timerId, int event, struct camera_s *cam, int eventData1, int eventData2); // Display image on canvas
-
-
-
-
-
+#include "GxIAPI.h" // Camera Includes 
+#include "DxImageProc.h" // Camera Includes 
+#include "camera_test_program.h"
+#include <ansi_c.h>
+#include <cvirte.h>      
+#include <userint.h>
+#include "toolbox.h"
+#include "CALLBACK.h"
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <utility.h>
+#include "asynctmr.h"
+#include "TRIPLE_BUFFER.h"
+#include "FRAME_POOL.h"
+#include "FRAME_METADATA.h"
+#include "FRAME_SYNC.h"
+#include "STREAM_STATS.h"
+#include "LATENCY_HIST.h"
+#include "PIXEL_UNPACK.h"
+#include "BANDWIDTH_PLANNER.h"
+#include "RECONNECT.h"
+#include "CHUNK_PARSER.h"
+#include "EXPOSURE_EVENTS.h"
+#include "CLOCK_SYNC.h"
+#include "DEMOSAIC.h"
+#include "TILE_POOL.h"
+#include "TONE_LUT.h"
+#include "GX_STANDIN.h"
+#include "TRIGGER_WAIT.h"
+
+
+/***************************************************************************************************
+The BMP File Struct. Used to display and save BMP images.
+****************************************************************************************************/
+
+#pragma pack(push, 1)  // ensure structures are byte-aligned
+
+// BMP File Header
+typedef struct bmp_file_header{
+    uint16_t bfType;        // "BM"
+    uint32_t bfSize;        // file size in bytes
+    uint16_t bfReserved1;   // reserved, must be 0
+    uint16_t bfReserved2;   // reserved, must be 0
+    uint32_t bfOffBits;     // offset in bytes to bitmap data
+} BmpFileHeader;
+
+// BMP Info Header (a.k.a. DIB header)
+typedef struct bmp_info_header {
+    uint32_t biSize;          	// size of this header (40 bytes)
+    int32_t  biWidth;         	// image width
+    int32_t  biHeight;        	// image height
+    uint16_t biPlanes;        	// # of color planes, must be 1
+    uint16_t biBitCount;      	// bits per pixel (24 = RGB24, 8 = mono)
+    uint32_t biCompression;   	// 0 = BI_RGB (no compression)
+    uint32_t biSizeImage;     	// size of raw bitmap data
+    int32_t  biXPelsPerMeter; 	// pixels per meter in X
+    int32_t  biYPelsPerMeter; 	// pixels per meter in Y
+	int32_t  biColorTable[256];	// MAKE_COLOR(r, g, b) -> uses 0x00BBGGRR in CVI. If 8-bit, build a grayscale color table for LabWindows.
+    uint32_t biClrUsed;       	// # of colors in the palette
+    uint32_t biClrImportant;  	// # of important colors
+} BmpInfoHeader;
+
+#pragma pack(pop)
+
+/***************************************************************************************************
+Frame Consumers. Called with every new frame, see RegisterFrameConsumer.
+****************************************************************************************************/
+
+#define MAX_FRAME_CONSUMERS 4
+
+struct camera_s;
+
+typedef void (*FrameConsumerCallback)(struct camera_s *cam, struct frame_s *frame, void *userData);
+
+struct frame_consumer_s {
+	FrameConsumerCallback Callback;
+	void *UserData;
+};
+
+/***************************************************************************************************
+Acquisition modes, see StartCameraAcquisition.
+****************************************************************************************************/
+
+#define ACQ_MODE_CALLBACK	0	// Frames delivered by GXRegisterCaptureCallback on the SDK's thread
+#define ACQ_MODE_POLLING	1	// Frames pulled with GXGetImage by our own thread
+
+// Host-side delivery statistics of the frames reaching ProcessFrame
+struct delivery_stats_s {
+	int64_t Frames;
+	int64_t Intervals;
+	double FirstTimeMs;
+	double LastTimeMs;
+	double MeanIntervalMs;
+	double M2;					// Sum of squared interval deviations (Welford)
+};
+
+/***************************************************************************************************
+SDK acquisition buffers, sized by StartCameraAcquisition unless AcqBufferCount is set.
+****************************************************************************************************/
+
+#define ACQ_BUFFER_DEFAULT_BUDGET	(256LL * 1024 * 1024)	// Bytes, shared by all open cameras, see SetAcqBufferMemoryBudget
+#define ACQ_BUFFER_DEFAULT_BURST_MS	250						// Host stall the buffers absorb in oldest-first mode
+#define ACQ_BUFFER_MIN				3						// One being filled, one delivered, one spare
+
+// Device event queue, see ConfigureExposureEvents
+#define EVENT_QUEUE_POLL_MS			10		// GXGetEventNumInQueue period
+#define EVENT_QUEUE_MAX_BACKLOG		64		// Events behind before the queue is flushed (< EXPOSURE_EVENT_TABLE_SIZE)
+
+// Device clock sync, see StartClockSync
+#define CLOCK_SYNC_DEFAULT_INTERVAL_MS	1000	// Timestamp latch period
+#define CLOCK_SYNC_STARTUP_SAMPLES		4		// Latches taken right away, so the first frames are mapped
+
+// Time base of the frames a camera pushes into its FrameSync stream
+#define FRAME_TIME_NONE				0		// Nothing pushed yet
+#define FRAME_TIME_TICKS			1		// Device ticks, aligned to the host clock by the synchronizer
+#define FRAME_TIME_HOST				2		// Clock sync fit, on the host clock already
+
+/***************************************************************************************************
+Frame pipeline stages, each with a latency histogram per camera (see GetStageLatency).
+****************************************************************************************************/
+
+#define LATENCY_STAGE_CAPTURE		0	// Sensor (device timestamp) -> driver delivery
+#define LATENCY_STAGE_COPY			1	// Delivery -> raw copy done
+#define LATENCY_STAGE_CONVERT		2	// Raw copy -> demosaic / flip done
+#define LATENCY_STAGE_QUEUE			3	// Converted -> picked up for SetBitmapData by the display
+#define LATENCY_STAGE_SET_BITMAP	4	// SetBitmapData -> CanvasDrawBitmap
+#define LATENCY_STAGE_DRAW			5	// CanvasDrawBitmap
+#define LATENCY_STAGE_TOTAL			6	// Delivery -> drawn
+#define LATENCY_STAGES				7
+
+// Sensor readout window. Offsets and sizes are in output pixels, i.e. after binning and decimation:
+// one output pixel covers Binning x Decimation sensor pixels in each direction.
+struct capture_geometry_s {
+	int64_t OffsetX;
+	int64_t OffsetY;
+	int64_t Width;
+	int64_t Height;
+	int64_t BinningH;			// 1 = off
+	int64_t BinningV;
+	int64_t DecimationH;		// 1 = off
+	int64_t DecimationV;
+};
+
+/***************************************************************************************************
+Camera Struct. This struct holds everything about the camera: connection, buffers, etc.
+****************************************************************************************************/
+
+struct camera_s {
+	
+    // Flags
+    int DevOpened;       // 0=FALSE, 1=TRUE
+    int IsSnap;          // 0=not snapping, 1=snap started
+    int IsColorFilter;   // 0=mono, 1=color
+    int ImplementAutoGain;
+    int ImplementAutoShutter;
+    int ImplementLight;
+
+    // Timer ID from LabWindows async timer
+    int timerId;
+	
+	// Camera ID
+	unsigned char SerialNumber[2048];
+
+    // Camera parameters
+    int64_t Gray;
+    int64_t RoiX;
+    int64_t RoiY;
+    int64_t RoiW;
+    int64_t RoiH;
+	struct capture_geometry_s Geometry; // Readout window, see SetCaptureGeometry
+	
+	// Frame rate and link share, see PlanCameraBandwidth
+	double TargetFrameRate;			// Wanted frame rate, 0 = as fast as the link allows
+	double BandwidthWeight;			// Share of a congested link, 0 = 1
+	double PlannedFrameRate;		// Set by the planner (GX_FLOAT_ACQUISITION_FRAME_RATE)
+	double MaxFrameRate;			// Fastest rate the planner last measured, lowered by longer exposures
+	int64_t PlannedThroughput;		// Set by the planner (GX_INT_DEVICE_LINK_THROUGHPUT_LIMIT), bytes/s
+	
+	// Camera Gain parameters
+	double  Gain;
+	int GainMode; // 0 for disabled, 1 for enabled
+    double  AutoGainMin;
+    double  AutoGainMax;
+	
+	// Camera Exposure parameters
+	double  ExposureTime;
+	int ExposureTimeMode; // 0 for disabled, 1 for enabled
+    double  AutoExposureTimeMin;
+    double  AutoExposureTimeMax;
+	
+	// Chunk data, the exposure time and gain of every frame sent along with it, see ConfigureChunkData
+	int ChunkData;					// 0 = off, 1 = while auto gain or auto exposure is on, 2 = always
+	struct chunk_value_s ChunkExposureTime; // Selector and ChunkID of the model (GenICam XML), 0 = not sent
+	struct chunk_value_s ChunkGain;
+	int ChunkActive;				// Chunk mode is on in the device (set by InitDevice)
+	int ChunkBigEndian;				// GigE Vision byte order, USB3 Vision chunks are little-endian
+	int64_t ChunkErrors;			// Frames whose chunk trailer did not parse
+	
+    double  AutoShutterMin;
+    double  AutoShutterMax;
+    int64_t ImageWidth;
+    int64_t ImageHeight;
+    int64_t PayLoadSize;
+    int64_t PixelColorFilter;
+	
+	// Pixel format, applied by InitDevice
+	int PixelBitDepth;				// 8 (default, 0 = 8), 10 or 12 bits per pixel
+	int PackedPixels;				// 1 = prefer the packed 10/12-bit formats (less link bandwidth), 0 = 16 bits per pixel
+	int64_t PixelFormat;			// GX_ENUM_PIXEL_FORMAT in use
+	int ActiveBitDepth;				// Significant bits of PixelFormat
+	
+	// Color conversion (DEMOSAIC.h)
+	int DemosaicQuality;			// DEMOSAIC_BILINEAR (default) or DEMOSAIC_NEAREST
+	int DemosaicKernel;				// DEMOSAIC_KERNEL_AUTO (default) or a fixed one, e.g. DEMOSAIC_KERNEL_SCALAR
+	
+	// Display tone curve (TONE_LUT.h), applied to the raw values during the conversion. Can be changed while acquiring.
+	double ToneGamma;				// 0.1 .. 10, 0 or 1 = none
+	int ToneContrast;				// -50 .. 100, 0 = none
+	int ToneLightness;				// -150 .. 150, 0 = none
+	struct tone_lut_s ToneLut;		// Rebuilt by the frame callback when the settings or the bit depth change
+	
+	// Conversion threads (TILE_POOL.h): the frame is converted in row bands, the frame callback thread is one of the workers
+	int ConvertThreads;				// 0 = one per processor, 1 = the frame callback thread only
+	int ConvertBandRows;			// Rows per band, 0 = TilePoolRun default
+	struct tile_pool_s ConvertPool;
+	struct demosaic_lines_s DemosaicLines[TILE_POOL_MAX_THREADS];	// Line buffers of each worker
+	
+	// Crosshair Settings
+	int UseCrosshair; 			// 0=FALSE, 1=TRUE
+	int CrosshairSize;  		// length from center
+	int CrosshairThickness;  		// Thickness of the crosshair line
+	int CrosshairColor; 		// RGB value is a 4-byte integer with the hexadecimal format 0x00RRGGBB.
+	unsigned int CrosshairX;	// Position On Image (x)
+	unsigned int CrosshairY;	// Position On Image (y)
+	
+	// Variables for real-time image display
+	int panelHandle;
+    int canvasControl;
+	
+
+    // Buffers for image data
+    unsigned char *ImgBuffer;   // Color-converted/flipped data currently shown (Data of the display's front frame)
+	struct triple_buffer_s Display; // Frames handed from the frame callback to the display timer
+	unsigned char BmpBuf[2048]; // The buffer for showing image
+	
+	// Frame pool, preallocated and reused across Stop/Start
+	struct frame_pool_s Pool;
+	int FramePoolSize;				// Frames in the pool, 0 = FRAME_POOL_DEFAULT_FRAMES
+	int FrameDropPolicy;			// FRAME_POOL_DROP_NEWEST or FRAME_POOL_WAIT, applied when every frame is held
+	int FrameWaitTimeoutMs;			// Longest wait for a free frame with FRAME_POOL_WAIT
+	
+	// Consumers of every new frame (recorder, analysis...)
+	struct frame_consumer_s FrameConsumers[MAX_FRAME_CONSUMERS];
+	int NumFrameConsumers;
+	
+	// Acquisition mode, read at StartCameraAcquisition
+	int AcquisitionMode;			// ACQ_MODE_CALLBACK or ACQ_MODE_POLLING
+	int ActiveAcquisitionMode;		// Mode of the running acquisition
+	int PollThreadPriority;			// THREAD_PRIORITY_xxx of the polling thread (0 = normal)
+	unsigned int PollThreadAffinity; // CPU mask of the polling thread, 0 = any CPU
+	int PollTimeoutMs;				// GXGetImage timeout, 0 = 500ms
+	volatile int PollThreadRun;		// Cleared to stop the polling thread
+	int PollErrors;					// GXGetImage failures other than timeouts
+	CmtThreadPoolHandle PollThreadPool;
+	CmtThreadFunctionID PollThreadFunctionId;
+	unsigned char *PollBuffer;		// GXGetImage destination, PayLoadSize bytes
+	struct gx_standin_s *StandIn;	// Polling thread reads this instead of the camera, see BenchmarkAcquisitionModes
+	struct delivery_stats_s Delivery;
+	
+	// ID, timestamps and status of every delivered frame, for drop/jitter detection
+	struct frame_metadata_ring_s Metadata;
+	
+	// Stream buffering, latency vs completeness, see SetStreamBufferPolicy
+	int StreamBufferMode;			// GX_DS_STREAM_BUFFER_HANDLING_MODE_NEWEST_ONLY (live) or _OLDEST_FIRST (recording), 0 = OLDEST_FIRST
+	int AcqBufferCount;				// SDK acquisition buffers (GXSetAcqusitionBufferNumber), 0 = sized from payload, frame rate and BufferBurstMs
+	int BufferBurstMs;				// Host stall to absorb without drops, 0 = ACQ_BUFFER_DEFAULT_BURST_MS
+	int ActiveAcqBufferCount;		// Buffer count of the running acquisition
+	int64_t AcqBufferBytes;			// Our share of the acquisition buffer budget
+	int64_t DeliveredFrameBase;		// GX_DS_INT_DELIVERED_FRAME_COUNT minus frames processed at start
+	double CaptureOffsetMs;			// Smallest host - device time seen, maps timestamps onto the host clock
+	int HasCaptureOffset;
+	double DisplayedFrameAgeMs;		// Capture-to-draw time of the frame on screen
+	
+	// GX_DS_* stream counters, sampled in the background while acquiring
+	struct stream_stats_ring_s StreamStats;
+	double StreamStatsIntervalMs;	// Sampling period, 0 = 1000ms, < 0 = no sampling
+	int StreamStatsTimerId;
+	uint64_t CpuIdleTicks;			// Previous GetSystemTimes, for the CPU load of each sample
+	uint64_t CpuTotalTicks;
+	
+	// Per-stage latency of the frame pipeline
+	struct latency_hist_s StageLatency[LATENCY_STAGES];
+	double LatencyDumpIntervalMs;	// Period of the printed percentiles, 0 = no dump
+	int LatencyDumpTimerId;
+	
+	// Trigger mode, applied by InitDevice
+	int TriggerMode;				// GX_TRIGGER_MODE_OFF (free running) or GX_TRIGGER_MODE_ON
+	int TriggerSource;				// GX_TRIGGER_SOURCE_SOFTWARE or GX_TRIGGER_SOURCE_LINE0..3
+	int TriggerActivation;			// GX_TRIGGER_ACTIVATION_RISINGEDGE or _FALLINGEDGE, hardware lines only
+	struct trigger_wait_s Trigger;	// Triggered frame, ProcessFrame -> TriggerAndWait. Stats: Trigger.Stats
+	
+	// Multi-camera frame pairing, see AttachFrameSync
+	struct frame_sync_s *FrameSync;	// NULL = not paired with other cameras
+	int FrameSyncStream;			// Stream index of this camera in FrameSync
+	int FrameSyncTimeBase;			// FRAME_TIME_xxx of the frames pushed so far
+	int64_t TimestampTickFrequency;	// Device timestamp ticks per second (GX_INT_TIMESTAMP_TICK_FREQUENCY)
+	
+	// Device clock -> host clock mapping, see StartClockSync
+	double ClockSyncIntervalMs;		// Latch period, 0 = CLOCK_SYNC_DEFAULT_INTERVAL_MS, < 0 = no clock sync
+	struct clock_sync_s ClockSync;	// Offset and drift fitted from the latches
+	int ClockSyncTimerId;
+	
+	// Exposure-end events, every frame gets the time its exposure ended, see ConfigureExposureEvents
+	int ExposureEvents;				// 1 = subscribe to the ExposureEnd event
+	struct exposure_event_table_s ExposureEnd; // Events by frame ID, filled on the SDK's event thread
+	GX_FEATURE_CALLBACK_HANDLE ExposureEndCallback;
+	volatile int EventThreadRun;	// Cleared to stop the event queue thread
+	CmtThreadFunctionID EventFunctionId;
+	uint32_t EventQueueMax;			// Deepest device event queue seen
+	int64_t EventsFlushed;			// Events thrown away with GXFlushEvent, too late to be joined
+	
+	// Offline detection and automatic reconnect, see RECONNECT.h
+	int AutoReconnect;				// 1 = find, reopen and restart the camera when it drops offline
+	struct reconnect_s Reconnect;	// Reconnect.RetryIntervalMs / MaxAttempts may be set before OpenDevice
+	GX_EVENT_CALLBACK_HANDLE OfflineCallback;
+	int ResumeAfterReconnect;		// Acquisition was running when the camera dropped
+	volatile int ReconnectRun;		// Cleared to stop the reconnect thread
+	CmtThreadFunctionID ReconnectFunctionId;
+	
+	// Zero-copy frame path
+	int KeepRawFrames;				// 0=convert straight from the driver buffer, 1=also keep a copy of every frame in frame->Raw
+	volatile int64_t CopyBytesSaved;	// Bytes not copied into a raw buffer since the acquisition started
+	double AcqStartTime;			// Timer() value when the acquisition started
+
+    // LabWindows/CVI Bitmap handle for drawing
+    int BitmapHandle;
+	int BitmapWidth;				// Size of BitmapHandle, it is kept across Stop/Start while it still fits
+	int BitmapHeight;
+	int BitmapDepth;
+	double LastReconfigureMs;		// Time the last in-place restart kept the stream down
+
+    // Windows GxIAPI handle
+    GX_DEV_HANDLE Device;
+	GX_DEVICE_CLASS DeviceClass;	// GX_DEVICE_CLASS_GEV, _U3V...
+	double OpenTimeMs;				// Time OpenDevice took, enumeration included
+	GX_STATUS BringUpStatus;		// Result of OpenDevice + InitDevice in BringUpCameras
+	char BringUpError[256];			// Why it failed, shown by the UI thread (OpenDevice runs on workers)
+	double BringUpMs;				// Time both took for this camera
+	CmtThreadFunctionID BringUpFunctionId;
+	
+	// Bmp Header And Info Structs 
+	BmpInfoHeader BmpInfo;
+	BmpFileHeader BmpFile;
+    
+    // Auto modes
+    GX_EXPOSURE_AUTO_ENTRY AutoShutterMode;
+    GX_GAIN_AUTO_ENTRY     AutoGainMode;
+}; // Allocated by the camera registry (CAMERA_REGISTRY.h)
+
+/***************************************************************************************************
+Camera Public Functions And Variables
+****************************************************************************************************/
+
+GX_STATUS OpenDevice   (struct camera_s *cam);
+GX_STATUS RefreshDeviceList(void); // Enumerate the cameras again (OpenDevice does it once, and for unknown serial numbers)
+int BringUpCameras(struct camera_s **cams, int numCams); // Open + init all cameras in parallel, returns how many came up
+void CloseDevice  (struct camera_s *cam);
+GX_STATUS InitDevice   (struct camera_s *cam);
+void StartCameraAcquisition (struct camera_s *cam); // Called when the start acquisition button pressed
+void StopCameraAcquisition (struct camera_s *cam); // Called when the stop acquisition button pressed
+int RegisterFrameConsumer(struct camera_s *cam, FrameConsumerCallback callback, void *userData); // Call before StartCameraAcquisition
+void UnregisterFrameConsumer(struct camera_s *cam, FrameConsumerCallback callback);
+void GetDeliveryStats(struct camera_s *cam, double *framesPerSecond, double *meanIntervalMs, double *jitterMs); // Compare callback vs polling mode
+int BenchmarkAcquisitionModes(struct camera_s *cam, double frameRate, double seconds, int loadThreads); // Callback vs polling on a stand-in source under load, camera open and stopped
+int GetFrameWindowStats(struct camera_s *cam, int window, struct frame_window_stats_s *stats); // Drop rate / jitter over the last frames
+int GetStreamStats(struct camera_s *cam, int maxSamples, struct stream_stats_sample_s *samples); // Newest samples of the GX_DS_* counters, oldest first
+void SetAcqBufferMemoryBudget(int64_t bytes); // Acquisition buffer memory of all cameras together
+GX_STATUS SetCaptureGeometry(struct camera_s *cam, const struct capture_geometry_s *geometry); // ROI / binning / decimation, also while acquiring
+GX_STATUS SetCaptureWindowAroundCrosshair(struct camera_s *cam, int64_t width, int64_t height); // Window of that size centered on the crosshair
+GX_STATUS PlanCameraBandwidth(struct camera_s **cams, int numCams, double linkBudgetBytesPerSec); // Frame rates/throughput limits of cameras sharing a link
+void RemoveFromBandwidthPlan(struct camera_s *cam); // The others share its part of the link
+void SimulateDeviceOffline(struct camera_s *cam); // Handle an offline event as if the SDK reported it (measures recovery time)
+void GetReconnectStats(struct camera_s *cam, int *state, long *recoveries, double *lastRecoveryMs, double *maxRecoveryMs);
+int GetExposureEndTime(struct camera_s *cam, uint64_t frameID, double *hostTimeMs); // Exposure end of a frame on the host clock, FALSE if no event
+int DeviceTimestampToHostMs(struct camera_s *cam, uint64_t timestamp, double *hostTimeMs); // Device ticks -> GetHostTimeMs time base, FALSE if not mapped yet
+void GetClockSyncStats(struct camera_s *cam, struct clock_sync_stats_s *stats); // Drift, residual error of the device clock fit
+GX_STATUS SetExposureTime(struct camera_s *cam, double exposureUs); // Applied live, also while acquiring
+GX_STATUS SetGain(struct camera_s *cam, double gainDb); // Applied live, also while acquiring
+void BenchmarkReconfigure(struct camera_s *cam, int iterations); // Live vs in-place restart vs Stop/Start, camera must be acquiring
+GX_STATUS SetStreamBufferPolicy(struct camera_s *cam, int mode, int bufferCount); // Also while acquiring, the frame buffers are kept
+void GetStreamQueueMetrics(struct camera_s *cam, int64_t *queueDepth, double *displayedFrameAgeMs);
+GX_STATUS TriggerAndWait(struct camera_s *cam, int timeoutMs, struct frame_s **frame); // Trigger mode: fire (software) / wait for the next frame, FrameRelease it when done
+void GetTriggerLatencyStats(struct camera_s *cam, double *meanMs, double *jitterMs, double *maxMs);
+int AttachFrameSync(struct camera_s *cam, struct frame_sync_s *sync, int stream); // Pair this camera's frames with other cameras
+int InitCameraFrameSync(struct frame_sync_s *sync, struct camera_s **cams, int numCams, double toleranceUs, FrameSetCallback onSet, void *userData);
+double GetHostTimeMs(void); // High resolution host clock (QueryPerformanceCounter), milliseconds
+int64_t GetHostTicks(void); // Same clock, raw QueryPerformanceCounter ticks
+double HostTicksToUs(int64_t ticks);
+void GetStageLatency(struct camera_s *cam, int stage, double *p50Ms, double *p99Ms, double *p999Ms); // LATENCY_STAGE_xxx percentiles
+void DumpLatencyHistograms(struct camera_s *cam);
+double GetCopyBytesSavedPerSecond(struct camera_s *cam); // Memory traffic saved by the zero-copy frame path
+int SaveFrameRaw16(const char *fileName, struct frame_s *frame, struct camera_s *cam); // 10/12-bit frame as a 16-bit PGM, OK or CANCEL
+int BenchmarkPixelUnpack(int width, int height, int bits, int iterations); // Scalar vs SIMD vs SDK unpack speed, OK if all results match
+int BenchmarkDemosaic(int width, int height, int iterations); // Demosaic kernels vs DxRaw8toRGB24 speed, OK if the SIMD results match the scalar one
+int BenchmarkConvertThreads(int width, int height, int maxThreads, int iterations); // Demosaic speed on 1..maxThreads threads, OK if every result matches 1 thread
+int BenchmarkToneConversion(int width, int height, int bits, int iterations); // Fused LUT + demosaic vs a separate LUT pass, OK if both give the same image
+int VERIFY_STATUS_RET (GX_STATUS emStatus);
+void ShowErrorString(GX_STATUS emErrorStatus);
+void CVICALLBACK UpdateCameraCallback(int reserved, int timerId, int event, struct camera_s *cam, int eventData1, int eventData2); // Display image on canvas
+
+
+
+
+
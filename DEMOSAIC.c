@@ -0,0 +1,436 @@
+#include "DEMOSAIC.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(DEMOSAIC_SSE2) || defined(DEMOSAIC_AVX2)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+/***************************************************************************************************
+Demosaic Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define DEMOSAIC_AVG(a, b)	(uint8_t)(((unsigned int)(a) + (unsigned int)(b) + 1) >> 1)
+
+// DX_PIXEL_COLOR_FILTER
+#define DEMOSAIC_BAYER_RG	1
+#define DEMOSAIC_BAYER_GB	2
+#define DEMOSAIC_BAYER_GR	3
+#define DEMOSAIC_BAYER_BG	4
+
+const uint8_t* DemosaicLoadLine(struct demosaic_lines_s *lines, const uint8_t *src, int srcBits, const uint8_t *lut, int width, int height, int srcStride, int row);
+void DemosaicInterleave(const uint8_t *r, const uint8_t *g, const uint8_t *b, int width, uint8_t *dst, size_t rowBytes);
+int DemosaicCpuKernel(void);
+
+/***************************************************************************************************
+Line buffers
+****************************************************************************************************/
+
+int DemosaicLinesAlloc(struct demosaic_lines_s *lines, int width) {
+	
+	if (width <= 0) return CANCEL;
+	if (lines->Memory != NULL && lines->Width >= width) return OK;
+	
+	DemosaicLinesFree(lines);
+	
+	size_t lineBytes = (size_t)width + 2 * DEMOSAIC_LINE_PAD;
+	
+	lines->Memory = (uint8_t *)malloc(6 * lineBytes);
+	if (lines->Memory == NULL) return CANCEL;
+	
+	for (int i = 0; i < 3; i++) {
+		lines->Line[i]    = lines->Memory + i * lineBytes + DEMOSAIC_LINE_PAD;
+		lines->LineRow[i] = -1;
+		lines->Channel[i] = lines->Memory + (3 + i) * lineBytes + DEMOSAIC_LINE_PAD;
+	}
+	
+	lines->Width = width;
+	return OK;
+}
+
+void DemosaicLinesFree(struct demosaic_lines_s *lines) {
+	
+	free(lines->Memory);
+	memset(lines, 0, sizeof(*lines));
+}
+
+size_t DemosaicRowBytes(int width) {
+	
+	return ((size_t)width * 3 + 3) & ~(size_t)3;
+}
+
+void DemosaicMapRow(const void *src, int srcBits, const uint8_t *lut, int width, uint8_t *dst) {
+	
+	if (srcBits > 8) {
+		
+		const uint16_t *from = (const uint16_t *)src;
+		unsigned int mask = (1u << srcBits) - 1;
+		
+		for (int x = 0; x < width; x++) dst[x] = lut[from[x] & mask];
+	}
+	else if (lut != NULL) {
+		
+		const uint8_t *from = (const uint8_t *)src;
+		
+		for (int x = 0; x < width; x++) dst[x] = lut[from[x]];
+	}
+	else memcpy(dst, src, (size_t)width);
+}
+
+// Source row (mirrored at the edges) in a padded line. Rows y-1, y, y+1 go to different lines (row % 3).
+const uint8_t* DemosaicLoadLine(struct demosaic_lines_s *lines, const uint8_t *src, int srcBits, const uint8_t *lut, int width, int height, int srcStride, int row) {
+	
+	if (row < 0) row = -row;
+	if (row >= height) row = 2 * height - 2 - row;
+	
+	int slot = row % 3;
+	uint8_t *line = lines->Line[slot];
+	
+	if (lines->LineRow[slot] == row) return line;
+	
+	DemosaicMapRow(src + (size_t)row * srcStride, srcBits, lut, width, line);
+	line[-1]    = line[1];
+	line[width] = line[width - 2];
+	
+	lines->LineRow[slot] = row;
+	return line;
+}
+
+void DemosaicInterleave(const uint8_t *r, const uint8_t *g, const uint8_t *b, int width, uint8_t *dst, size_t rowBytes) {
+	
+	uint8_t *out = dst;
+	
+	for (int x = 0; x < width; x++, out += 3) {
+		out[0] = b[x];
+		out[1] = g[x];
+		out[2] = r[x];
+	}
+	
+	for (size_t i = (size_t)width * 3; i < rowBytes; i++) dst[i] = 0;
+}
+
+/***************************************************************************************************
+Scalar kernels, the reference for the SIMD ones.
+
+phase is the column parity of the row's own color (R on R/G rows, B on G/B rows), own/other are the
+R or B line accordingly.
+****************************************************************************************************/
+
+void DemosaicBilinearRowScalar(const uint8_t *up, const uint8_t *row, const uint8_t *down, int from, int width, int phase,
+							   uint8_t *own, uint8_t *green, uint8_t *other) {
+	
+	for (int x = from; x < width; x++) {
+		
+		if ((x & 1) == phase) {
+			own[x]   = row[x];
+			green[x] = DEMOSAIC_AVG(DEMOSAIC_AVG(up[x], down[x]), DEMOSAIC_AVG(row[x - 1], row[x + 1]));
+			other[x] = DEMOSAIC_AVG(DEMOSAIC_AVG(up[x - 1], down[x + 1]), DEMOSAIC_AVG(up[x + 1], down[x - 1]));
+		}
+		else {
+			own[x]   = DEMOSAIC_AVG(row[x - 1], row[x + 1]);
+			green[x] = row[x];
+			other[x] = DEMOSAIC_AVG(up[x], down[x]);
+		}
+	}
+}
+
+void DemosaicNearestRowScalar(const uint8_t *red, int redPhase, const uint8_t *green, int greenPhase, const uint8_t *blue, int bluePhase,
+							  int from, int width, uint8_t *r, uint8_t *g, uint8_t *b) {
+	
+	for (int x = from; x < width; x++) {
+		
+		int pair = x & ~1;
+		
+		r[x] = red[pair | redPhase];
+		g[x] = green[pair | greenPhase];
+		b[x] = blue[pair | bluePhase];
+	}
+}
+
+/***************************************************************************************************
+SSE2 kernels, 16 pixels per step. The even/odd choice is a byte mask (0x00FF or 0xFF00 per 16-bit
+lane), the steps start at even x so lane parity is pixel parity.
+****************************************************************************************************/
+
+#ifdef DEMOSAIC_SSE2
+
+int DemosaicBilinearRowSse2(const uint8_t *up, const uint8_t *row, const uint8_t *down, int width, int phase,
+							uint8_t *own, uint8_t *green, uint8_t *other) {
+	
+	const __m128i mask = _mm_set1_epi16(phase ? (short)0xFF00 : 0x00FF);
+	int x = 0;
+	
+	for (; x + 16 <= width; x += 16) {
+		
+		__m128i left   = _mm_loadu_si128((const __m128i *)(row + x - 1));
+		__m128i center = _mm_loadu_si128((const __m128i *)(row + x));
+		__m128i right  = _mm_loadu_si128((const __m128i *)(row + x + 1));
+		__m128i upC    = _mm_loadu_si128((const __m128i *)(up + x));
+		__m128i downC  = _mm_loadu_si128((const __m128i *)(down + x));
+		__m128i upL    = _mm_loadu_si128((const __m128i *)(up + x - 1));
+		__m128i upR    = _mm_loadu_si128((const __m128i *)(up + x + 1));
+		__m128i downL  = _mm_loadu_si128((const __m128i *)(down + x - 1));
+		__m128i downR  = _mm_loadu_si128((const __m128i *)(down + x + 1));
+		
+		__m128i horizontal = _mm_avg_epu8(left, right);
+		__m128i vertical   = _mm_avg_epu8(upC, downC);
+		__m128i cross      = _mm_avg_epu8(vertical, horizontal);
+		__m128i diagonal   = _mm_avg_epu8(_mm_avg_epu8(upL, downR), _mm_avg_epu8(upR, downL));
+		
+		_mm_storeu_si128((__m128i *)(own + x),   _mm_or_si128(_mm_and_si128(mask, center), _mm_andnot_si128(mask, horizontal)));
+		_mm_storeu_si128((__m128i *)(green + x), _mm_or_si128(_mm_and_si128(mask, cross), _mm_andnot_si128(mask, center)));
+		_mm_storeu_si128((__m128i *)(other + x), _mm_or_si128(_mm_and_si128(mask, diagonal), _mm_andnot_si128(mask, vertical)));
+	}
+	
+	return x;
+}
+
+// Copy the even (phase 0) or odd (phase 1) byte of every pair into both bytes
+#define DEMOSAIC_SSE2_PAIR(v, phase) \
+	((phase) ? _mm_or_si128(_mm_srli_epi16((v), 8), _mm_slli_epi16(_mm_srli_epi16((v), 8), 8)) \
+			 : _mm_or_si128(_mm_and_si128((v), _mm_set1_epi16(0x00FF)), _mm_slli_epi16((v), 8)))
+
+int DemosaicNearestRowSse2(const uint8_t *red, int redPhase, const uint8_t *green, int greenPhase, const uint8_t *blue, int bluePhase,
+						   int width, uint8_t *r, uint8_t *g, uint8_t *b) {
+	
+	int x = 0;
+	
+	for (; x + 16 <= width; x += 16) {
+		
+		__m128i vr = _mm_loadu_si128((const __m128i *)(red + x));
+		__m128i vg = _mm_loadu_si128((const __m128i *)(green + x));
+		__m128i vb = _mm_loadu_si128((const __m128i *)(blue + x));
+		
+		_mm_storeu_si128((__m128i *)(r + x), DEMOSAIC_SSE2_PAIR(vr, redPhase));
+		_mm_storeu_si128((__m128i *)(g + x), DEMOSAIC_SSE2_PAIR(vg, greenPhase));
+		_mm_storeu_si128((__m128i *)(b + x), DEMOSAIC_SSE2_PAIR(vb, bluePhase));
+	}
+	
+	return x;
+}
+
+#endif
+
+/***************************************************************************************************
+AVX2 kernels, the SSE2 ones 32 pixels wide. Everything is per byte or per 16-bit lane, nothing
+crosses the 128-bit halves.
+****************************************************************************************************/
+
+#ifdef DEMOSAIC_AVX2
+
+int DemosaicBilinearRowAvx2(const uint8_t *up, const uint8_t *row, const uint8_t *down, int width, int phase,
+							uint8_t *own, uint8_t *green, uint8_t *other) {
+	
+	const __m256i mask = _mm256_set1_epi16(phase ? (short)0xFF00 : 0x00FF);
+	int x = 0;
+	
+	for (; x + 32 <= width; x += 32) {
+		
+		__m256i left   = _mm256_loadu_si256((const __m256i *)(row + x - 1));
+		__m256i center = _mm256_loadu_si256((const __m256i *)(row + x));
+		__m256i right  = _mm256_loadu_si256((const __m256i *)(row + x + 1));
+		__m256i upC    = _mm256_loadu_si256((const __m256i *)(up + x));
+		__m256i downC  = _mm256_loadu_si256((const __m256i *)(down + x));
+		__m256i upL    = _mm256_loadu_si256((const __m256i *)(up + x - 1));
+		__m256i upR    = _mm256_loadu_si256((const __m256i *)(up + x + 1));
+		__m256i downL  = _mm256_loadu_si256((const __m256i *)(down + x - 1));
+		__m256i downR  = _mm256_loadu_si256((const __m256i *)(down + x + 1));
+		
+		__m256i horizontal = _mm256_avg_epu8(left, right);
+		__m256i vertical   = _mm256_avg_epu8(upC, downC);
+		__m256i cross      = _mm256_avg_epu8(vertical, horizontal);
+		__m256i diagonal   = _mm256_avg_epu8(_mm256_avg_epu8(upL, downR), _mm256_avg_epu8(upR, downL));
+		
+		_mm256_storeu_si256((__m256i *)(own + x),   _mm256_blendv_epi8(horizontal, center, mask));
+		_mm256_storeu_si256((__m256i *)(green + x), _mm256_blendv_epi8(center, cross, mask));
+		_mm256_storeu_si256((__m256i *)(other + x), _mm256_blendv_epi8(vertical, diagonal, mask));
+	}
+	
+	return x;
+}
+
+#define DEMOSAIC_AVX2_PAIR(v, phase) \
+	((phase) ? _mm256_or_si256(_mm256_srli_epi16((v), 8), _mm256_slli_epi16(_mm256_srli_epi16((v), 8), 8)) \
+			 : _mm256_or_si256(_mm256_and_si256((v), _mm256_set1_epi16(0x00FF)), _mm256_slli_epi16((v), 8)))
+
+int DemosaicNearestRowAvx2(const uint8_t *red, int redPhase, const uint8_t *green, int greenPhase, const uint8_t *blue, int bluePhase,
+						   int width, uint8_t *r, uint8_t *g, uint8_t *b) {
+	
+	int x = 0;
+	
+	for (; x + 32 <= width; x += 32) {
+		
+		__m256i vr = _mm256_loadu_si256((const __m256i *)(red + x));
+		__m256i vg = _mm256_loadu_si256((const __m256i *)(green + x));
+		__m256i vb = _mm256_loadu_si256((const __m256i *)(blue + x));
+		
+		_mm256_storeu_si256((__m256i *)(r + x), DEMOSAIC_AVX2_PAIR(vr, redPhase));
+		_mm256_storeu_si256((__m256i *)(g + x), DEMOSAIC_AVX2_PAIR(vg, greenPhase));
+		_mm256_storeu_si256((__m256i *)(b + x), DEMOSAIC_AVX2_PAIR(vb, bluePhase));
+	}
+	
+	return x;
+}
+
+#endif
+
+/***************************************************************************************************
+CPU detection. AVX2 also needs the OS to save the YMM registers (OSXSAVE + XCR0 bits 1 and 2).
+****************************************************************************************************/
+
+int DemosaicCpuKernel(void) {
+	
+#if defined(DEMOSAIC_SSE2) || defined(DEMOSAIC_AVX2)
+	int info[4] = {0};
+	int kernel = DEMOSAIC_KERNEL_SCALAR;
+	
+#ifdef _MSC_VER
+	__cpuid(info, 1);
+#else
+	unsigned int a, b, c, d;
+	if (!__get_cpuid(1, &a, &b, &c, &d)) return DEMOSAIC_KERNEL_SCALAR;
+	info[2] = (int)c;
+	info[3] = (int)d;
+#endif
+	
+#ifdef DEMOSAIC_SSE2
+	if (info[3] & (1 << 26)) kernel = DEMOSAIC_KERNEL_SSE2; // EDX bit 26 = SSE2
+#endif
+	
+#ifdef DEMOSAIC_AVX2
+	if ((info[2] & (1 << 27)) && (info[2] & (1 << 28))) { // ECX bit 27 = OSXSAVE, bit 28 = AVX
+		
+		unsigned long long xcr0;
+		int leaf7[4] = {0};
+		
+#ifdef _MSC_VER
+		xcr0 = _xgetbv(0);
+		__cpuidex(leaf7, 7, 0);
+#else
+		unsigned int lo, hi;
+		__asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		xcr0 = ((unsigned long long)hi << 32) | lo;
+		__cpuid_count(7, 0, a, b, c, d);
+		leaf7[1] = (int)b;
+#endif
+		
+		if ((xcr0 & 6) == 6 && (leaf7[1] & (1 << 5))) kernel = DEMOSAIC_KERNEL_AVX2; // EBX bit 5 = AVX2
+	}
+#endif
+	
+	return kernel;
+#else
+	return DEMOSAIC_KERNEL_SCALAR;
+#endif
+}
+
+int DemosaicBestKernel(void) {
+	
+	static int best = -1;
+	
+	if (best < 0) best = DemosaicCpuKernel();
+	
+	return best;
+}
+
+const char* DemosaicKernelName(int kernel) {
+	
+	switch (kernel) {
+		case DEMOSAIC_KERNEL_AVX2:   return "AVX2";
+		case DEMOSAIC_KERNEL_SSE2:   return "SSE2";
+		case DEMOSAIC_KERNEL_SCALAR: return "scalar";
+		default:                     return "auto";
+	}
+}
+
+/***************************************************************************************************
+Rows firstRow..lastRow-1 of the source, any band of the image
+****************************************************************************************************/
+
+int DemosaicRows(const void *source, int srcBits, const uint8_t *lut, int width, int height, int srcStride, uint8_t *dst, int dstStride, int flip,
+				 int pattern, int quality, int kernel, int firstRow, int lastRow, struct demosaic_lines_s *lines) {
+	
+	const uint8_t *src = (const uint8_t *)source;
+	
+	if (src == NULL || dst == NULL || width < 2 || height < 2 || lines->Memory == NULL || lines->Width < width) return CANCEL;
+	if (srcBits < 8 || srcBits > 16 || (srcBits > 8 && lut == NULL)) return CANCEL;
+	if (pattern < DEMOSAIC_BAYER_RG || pattern > DEMOSAIC_BAYER_BG || firstRow < 0 || lastRow > height) return CANCEL;
+	
+	// A kernel this build or CPU does not have falls back to the best one that is there
+	if (kernel == DEMOSAIC_KERNEL_AUTO || kernel > DemosaicBestKernel()) kernel = DemosaicBestKernel();
+	
+	// Row and column of R in the top-left 2x2 block, B is diagonally across
+	int redRow  = (pattern == DEMOSAIC_BAYER_GB || pattern == DEMOSAIC_BAYER_BG);
+	int redCol  = (pattern == DEMOSAIC_BAYER_GR || pattern == DEMOSAIC_BAYER_BG);
+	int blueRow = !redRow;
+	int blueCol = !redCol;
+	
+	size_t rowBytes = DemosaicRowBytes(width);
+	uint8_t *r = lines->Channel[0];
+	uint8_t *g = lines->Channel[1];
+	uint8_t *b = lines->Channel[2];
+	
+	// Lines of another frame or band
+	for (int i = 0; i < 3; i++) lines->LineRow[i] = -1;
+	
+	for (int y = firstRow; y < lastRow; y++) {
+		
+		int x = 0;
+		
+		if (quality == DEMOSAIC_NEAREST) {
+			
+			int top = y & ~1;
+			const uint8_t *quad[2];
+			
+			quad[0] = DemosaicLoadLine(lines, src, srcBits, lut, width, height, srcStride, top);
+			quad[1] = DemosaicLoadLine(lines, src, srcBits, lut, width, height, srcStride, top + 1);
+			
+			const uint8_t *red   = quad[redRow];
+			const uint8_t *green = quad[y & 1];
+			const uint8_t *blue  = quad[blueRow];
+			int greenPhase = ((y & 1) == redRow) ? !redCol : redCol;
+			
+#ifdef DEMOSAIC_AVX2
+			if (kernel == DEMOSAIC_KERNEL_AVX2) x = DemosaicNearestRowAvx2(red, redCol, green, greenPhase, blue, blueCol, width, r, g, b);
+#endif
+#ifdef DEMOSAIC_SSE2
+			if (kernel == DEMOSAIC_KERNEL_SSE2) x = DemosaicNearestRowSse2(red, redCol, green, greenPhase, blue, blueCol, width, r, g, b);
+#endif
+			DemosaicNearestRowScalar(red, redCol, green, greenPhase, blue, blueCol, x, width, r, g, b);
+		}
+		else {
+			
+			const uint8_t *up   = DemosaicLoadLine(lines, src, srcBits, lut, width, height, srcStride, y - 1);
+			const uint8_t *row  = DemosaicLoadLine(lines, src, srcBits, lut, width, height, srcStride, y);
+			const uint8_t *down = DemosaicLoadLine(lines, src, srcBits, lut, width, height, srcStride, y + 1);
+			
+			int redLine = (y & 1) == redRow;
+			int phase   = redLine ? redCol : blueCol;
+			uint8_t *own   = redLine ? r : b;
+			uint8_t *other = redLine ? b : r;
+			
+#ifdef DEMOSAIC_AVX2
+			if (kernel == DEMOSAIC_KERNEL_AVX2) x = DemosaicBilinearRowAvx2(up, row, down, width, phase, own, g, other);
+#endif
+#ifdef DEMOSAIC_SSE2
+			if (kernel == DEMOSAIC_KERNEL_SSE2) x = DemosaicBilinearRowSse2(up, row, down, width, phase, own, g, other);
+#endif
+			DemosaicBilinearRowScalar(up, row, down, x, width, phase, own, g, other);
+		}
+		
+		uint8_t *out = dst + (size_t)(flip ? height - 1 - y : y) * dstStride;
+		DemosaicInterleave(r, g, b, width, out, rowBytes);
+	}
+	
+	return OK;
+}
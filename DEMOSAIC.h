@@ -0,0 +1,92 @@
+#ifndef DEMOSAIC_H
+#define DEMOSAIC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/***************************************************************************************************
+Bayer demosaic, raw 8-bit -> BGR24 the way the CVI bitmap takes it: rows padded to 4 bytes and, with
+flip, bottom-up (source row y lands in row height-1-y), the same layout DxRaw8toRGB24(..., TRUE) fills.
+Patterns are the DX_PIXEL_COLOR_FILTER values (BAYERRG = 1 .. BAYERBG = 4), named after the top-left
+2x2 block of the sensor.
+
+ Bilinear  R/B pixel:  own = c         G = avg(avg(up, down), avg(left, right))   other = avg of the diagonals
+           G pixel:    left/right color = avg(left, right)    up/down color = avg(up, down)
+ Nearest   every pixel takes the R, B of its 2x2 block and the G of its own row in that block
+
+avg(a, b) is (a + b + 1) >> 1, the rounding of pavgb, so the SSE2 and AVX2 kernels give exactly the
+scalar result. Edges mirror the image (row -1 = row 1), which keeps the Bayer phase.
+
+Rows are converted through per-thread line buffers (struct demosaic_lines_s): every source row is
+read once into a padded 8-bit line, the kernels write the R, G, B lines of a row, which are then
+interleaved into the destination. DemosaicRows converts any band of rows, the halo rows above and
+below a band are read from the source as needed.
+
+The source is 8 bits per pixel, or 16 (10/12-bit values) with a tone LUT of 2^srcBits entries
+(TONE_LUT.h). The LUT is applied while a row is read into its line, so tone mapping, demosaic, flip
+and padding are one pass: the raw frame is read once and the bitmap written once.
+****************************************************************************************************/
+
+// Quality
+#define DEMOSAIC_BILINEAR		0
+#define DEMOSAIC_NEAREST		1
+
+// Kernels
+#define DEMOSAIC_KERNEL_AUTO	0		// Fastest one the CPU runs
+#define DEMOSAIC_KERNEL_SCALAR	1
+#define DEMOSAIC_KERNEL_SSE2	2
+#define DEMOSAIC_KERNEL_AVX2	3
+
+#define DEMOSAIC_LINE_PAD		32		// Bytes around every line, the widest load is 32 bytes
+
+// SIMD kernels need a compiler with the intrinsics, define DEMOSAIC_NO_SIMD to leave them out
+#if !defined(DEMOSAIC_NO_SIMD) && (defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))))
+#define DEMOSAIC_SSE2 1
+#endif
+#if !defined(DEMOSAIC_NO_SIMD) && (defined(__AVX2__) || (defined(_MSC_VER) && _MSC_VER >= 1700 && (defined(_M_IX86) || defined(_M_X64))))
+#define DEMOSAIC_AVX2 1
+#endif
+
+// Working memory of one converting thread
+struct demosaic_lines_s {
+	
+	uint8_t *Memory;
+	int Width;					// Widest row the lines hold
+	uint8_t *Line[3];			// Padded source rows, Line[i][-1] and Line[i][Width] mirror the neighbours
+	int LineRow[3];				// Source row held by each line, -1 = none
+	uint8_t *Channel[3];		// R, G, B of the row being converted
+};
+
+/***************************************************************************************************
+Demosaic Public Functions
+****************************************************************************************************/
+
+int    DemosaicLinesAlloc (struct demosaic_lines_s *lines, int width); // Keeps the buffers if they are wide enough, OK or CANCEL
+void   DemosaicLinesFree  (struct demosaic_lines_s *lines);
+size_t DemosaicRowBytes   (int width); // BGR24 row, padded to 4 bytes
+
+int DemosaicRows (const void *src, int srcBits, const uint8_t *lut, int width, int height, int srcStride, uint8_t *dst, int dstStride, int flip,
+				  int pattern, int quality, int kernel, int firstRow, int lastRow, struct demosaic_lines_s *lines); // Strides in bytes, lut NULL = none (8 bits only), OK or CANCEL
+void DemosaicMapRow (const void *src, int srcBits, const uint8_t *lut, int width, uint8_t *dst); // One row to 8 bits through the LUT, a copy without one
+int DemosaicBestKernel (void); // DEMOSAIC_KERNEL_AVX2 / _SSE2 / _SCALAR, what DEMOSAIC_KERNEL_AUTO picks
+const char* DemosaicKernelName (int kernel);
+
+// Row kernels, R/G/B of one row. The SIMD ones return the pixels done, the scalar one finishes the row.
+void DemosaicBilinearRowScalar (const uint8_t *up, const uint8_t *row, const uint8_t *down, int from, int width, int phase,
+								uint8_t *own, uint8_t *green, uint8_t *other);
+void DemosaicNearestRowScalar  (const uint8_t *red, int redPhase, const uint8_t *green, int greenPhase, const uint8_t *blue, int bluePhase,
+								int from, int width, uint8_t *r, uint8_t *g, uint8_t *b);
+#ifdef DEMOSAIC_SSE2
+int DemosaicBilinearRowSse2 (const uint8_t *up, const uint8_t *row, const uint8_t *down, int width, int phase,
+							 uint8_t *own, uint8_t *green, uint8_t *other);
+int DemosaicNearestRowSse2  (const uint8_t *red, int redPhase, const uint8_t *green, int greenPhase, const uint8_t *blue, int bluePhase,
+							 int width, uint8_t *r, uint8_t *g, uint8_t *b);
+#endif
+#ifdef DEMOSAIC_AVX2
+int DemosaicBilinearRowAvx2 (const uint8_t *up, const uint8_t *row, const uint8_t *down, int width, int phase,
+							 uint8_t *own, uint8_t *green, uint8_t *other);
+int DemosaicNearestRowAvx2  (const uint8_t *red, int redPhase, const uint8_t *green, int greenPhase, const uint8_t *blue, int bluePhase,
+							 int width, uint8_t *r, uint8_t *g, uint8_t *b);
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+#include "EXPOSURE_EVENTS.h"
+#include <string.h>
+
+/***************************************************************************************************
+Exposure Events Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+/***************************************************************************************************
+Writer side
+****************************************************************************************************/
+
+void ExposureEventReset(struct exposure_event_table_s *table) {
+	
+	memset(table->Slots, 0, sizeof(table->Slots));
+	
+	ATOMIC_STORE(&table->Events, 0);
+	ATOMIC_STORE(&table->Joined, 0);
+	ATOMIC_STORE(&table->Unmatched, 0);
+}
+
+void ExposureEventRecord(struct exposure_event_table_s *table, uint64_t frameID, uint64_t timestamp) {
+	
+	struct exposure_event_s *slot = &table->Slots[frameID & (EXPOSURE_EVENT_TABLE_SIZE - 1)];
+	
+	ATOMIC_INCREMENT(&slot->Sequence); // Odd, readers stay out
+	
+	slot->FrameID   = frameID;
+	slot->Timestamp = timestamp;
+	slot->Valid     = TRUE;
+	
+	ATOMIC_INCREMENT(&slot->Sequence); // Even, published
+	
+	ATOMIC_INCREMENT(&table->Events);
+}
+
+/***************************************************************************************************
+Reader side
+****************************************************************************************************/
+
+int ExposureEventLookup(struct exposure_event_table_s *table, uint64_t frameID, uint64_t *timestamp) {
+	
+	struct exposure_event_s *slot = &table->Slots[frameID & (EXPOSURE_EVENT_TABLE_SIZE - 1)];
+	struct exposure_event_s copy;
+	
+	for (;;) {
+		
+		long sequence = ATOMIC_LOAD(&slot->Sequence);
+		if (sequence & 1) continue; // Being written, a few stores long
+		
+		copy.FrameID   = slot->FrameID;
+		copy.Timestamp = slot->Timestamp;
+		copy.Valid     = slot->Valid;
+		
+		if (ATOMIC_LOAD(&slot->Sequence) == sequence) break;
+	}
+	
+	if (!copy.Valid || copy.FrameID != frameID) return FALSE;
+	
+	*timestamp = copy.Timestamp;
+	return TRUE;
+}
+
+int ExposureEventJoin(struct exposure_event_table_s *table, uint64_t frameID, uint64_t *timestamp) {
+	
+	if (ExposureEventLookup(table, frameID, timestamp)) {
+		ATOMIC_INCREMENT(&table->Joined);
+		return TRUE;
+	}
+	
+	ATOMIC_INCREMENT(&table->Unmatched);
+	return FALSE;
+}
@@ -0,0 +1,49 @@
+#ifndef EXPOSURE_EVENTS_H
+#define EXPOSURE_EVENTS_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Exposure-end events by frame ID. The camera sends an ExposureEnd event (frame ID + device timestamp)
+the moment the sensor stops integrating, the frame itself follows after readout and transfer. The
+events are kept in a table indexed by frame ID, so the frame path finds the event of its frame with
+one lookup, whichever of the two arrived first.
+
+ slot = FrameID % EXPOSURE_EVENT_TABLE_SIZE
+
+A slot is overwritten when the frame ID TABLE_SIZE further arrives, a frame looked up later than that
+finds no event. One writer (the SDK's event thread), any number of readers: every slot carries a
+sequence number, odd while it is written, readers retry when it changed under them.
+****************************************************************************************************/
+
+#define EXPOSURE_EVENT_TABLE_SIZE	256		// Power of two, frames an event is kept for
+
+struct exposure_event_s {
+	
+	atomic_long_t Sequence;		// Odd while the writer is in the slot
+	uint64_t FrameID;			// GX_INT_EVENT_EXPOSUREEND_FRAMEID
+	uint64_t Timestamp;			// GX_INT_EVENT_EXPOSUREEND_TIMESTAMP, device ticks
+	int Valid;
+};
+
+struct exposure_event_table_s {
+	
+	struct exposure_event_s Slots[EXPOSURE_EVENT_TABLE_SIZE];
+	
+	// Totals since the last reset
+	atomic_long_t Events;		// Events recorded
+	atomic_long_t Joined;		// Frames that found their event
+	atomic_long_t Unmatched;	// Frames that did not (event lost, late or not sent)
+};
+
+/***************************************************************************************************
+Exposure Events Public Functions
+****************************************************************************************************/
+
+void ExposureEventReset  (struct exposure_event_table_s *table); // Not thread safe, call before events arrive
+void ExposureEventRecord (struct exposure_event_table_s *table, uint64_t frameID, uint64_t timestamp); // Event thread
+int  ExposureEventLookup (struct exposure_event_table_s *table, uint64_t frameID, uint64_t *timestamp); // TRUE if the event is there
+int  ExposureEventJoin   (struct exposure_event_table_s *table, uint64_t frameID, uint64_t *timestamp); // Lookup for a delivered frame, counted
+
+#endif
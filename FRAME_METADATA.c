@@ -0,0 +1,141 @@
+#include "FRAME_METADATA.h"
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+/***************************************************************************************************
+Writer side
+****************************************************************************************************/
+
+void FrameMetadataReset(struct frame_metadata_ring_s *ring) {
+	
+	memset(ring->Entries, 0, sizeof(ring->Entries));
+	
+	ring->LastFrameID    = 0;
+	ring->HasLastFrameID = 0;
+	
+	ATOMIC_STORE(&ring->Head, 0);
+	ATOMIC_STORE(&ring->Frames, 0);
+	ATOMIC_STORE(&ring->DroppedFrames, 0);
+	ATOMIC_STORE(&ring->IncompleteFrames, 0);
+}
+
+void FrameMetadataRecord(struct frame_metadata_ring_s *ring, uint64_t frameID, uint64_t timestamp, double hostTimeMs, int status, int pixelFormat,
+						 double exposureTime, double gain) {
+	
+	long head = ATOMIC_LOAD(&ring->Head);
+	struct frame_metadata_s *entry = &ring->Entries[(unsigned long)head & (FRAME_METADATA_RING_SIZE - 1)];
+	
+	// A gap in the frame IDs means frames were lost before reaching us. An ID going backwards
+	// means the camera restarted counting, that is not a drop.
+	int missing = 0;
+	
+	if (ring->HasLastFrameID && frameID > ring->LastFrameID + 1) {
+		
+		uint64_t gap = frameID - ring->LastFrameID - 1;
+		missing = (gap > 0x7FFFFFFF) ? 0x7FFFFFFF : (int)gap;
+	}
+	
+	ring->LastFrameID    = frameID;
+	ring->HasLastFrameID = 1;
+	
+	entry->FrameID     = frameID;
+	entry->Timestamp   = timestamp;
+	entry->HostTimeMs  = hostTimeMs;
+	entry->Status      = status;
+	entry->PixelFormat = pixelFormat;
+	entry->Missing     = missing;
+	entry->ExposureTime = exposureTime;
+	entry->Gain         = gain;
+	
+	// Publish the entry (full barrier)
+	ATOMIC_STORE(&ring->Head, head + 1);
+	
+	ATOMIC_INCREMENT(&ring->Frames);
+	if (missing) ATOMIC_ADD(&ring->DroppedFrames, missing);
+	if (status != 0) ATOMIC_INCREMENT(&ring->IncompleteFrames);
+}
+
+/***************************************************************************************************
+Reader side
+****************************************************************************************************/
+
+int FrameMetadataLatest(struct frame_metadata_ring_s *ring, int age, struct frame_metadata_s *entry) {
+	
+	if (age < 0 || age >= FRAME_METADATA_MAX_WINDOW) return 0;
+	
+	for (;;) {
+		
+		long head = ATOMIC_LOAD(&ring->Head);
+		if (age >= head) return 0;
+		
+		*entry = ring->Entries[(unsigned long)(head - 1 - age) & (FRAME_METADATA_RING_SIZE - 1)];
+		
+		// Still valid if the writer did not wrap onto it while we copied
+		if (ATOMIC_LOAD(&ring->Head) - head < FRAME_METADATA_RING_SIZE - age - 1) return 1;
+	}
+}
+
+int FrameMetadataQuery(struct frame_metadata_ring_s *ring, int window, struct frame_window_stats_s *stats) {
+	
+	struct frame_metadata_s *local = NULL;
+	long head, count;
+	
+	memset(stats, 0, sizeof(*stats));
+	
+	if (window > FRAME_METADATA_MAX_WINDOW) window = FRAME_METADATA_MAX_WINDOW;
+	if (window <= 0) return 0;
+	
+	local = (struct frame_metadata_s *)malloc(sizeof(struct frame_metadata_s) * (size_t)window);
+	if (local == NULL) return 0;
+	
+	// Copy the window, retry if the writer lapped the oldest entries meanwhile
+	for (;;) {
+		
+		head  = ATOMIC_LOAD(&ring->Head);
+		count = (head < window) ? head : window;
+		
+		for (long i = 0; i < count; i++) {
+			local[i] = ring->Entries[(unsigned long)(head - count + i) & (FRAME_METADATA_RING_SIZE - 1)];
+		}
+		
+		// (the entry being written next overwrites index Head - FRAME_METADATA_RING_SIZE)
+		if (ATOMIC_LOAD(&ring->Head) - head < FRAME_METADATA_RING_SIZE - count) break;
+	}
+	
+	// Drops and incomplete frames. The first entry's gap happened before the window.
+	double sum = 0, sumSquares = 0;
+	int intervals = 0;
+	
+	for (long i = 0; i < count; i++) {
+		
+		if (local[i].Status != 0) stats->IncompleteFrames++;
+		if (i > 0) stats->DroppedFrames += local[i].Missing;
+		
+		if (i > 0) {
+			
+			double interval = local[i].HostTimeMs - local[i - 1].HostTimeMs;
+			
+			sum        += interval;
+			sumSquares += interval * interval;
+			intervals++;
+			
+			if (interval > stats->MaxIntervalMs) stats->MaxIntervalMs = interval;
+		}
+	}
+	
+	stats->Frames = (int)count;
+	
+	if (count + stats->DroppedFrames > 0) stats->DropRate = (double)stats->DroppedFrames / (double)(count + stats->DroppedFrames);
+	
+	if (intervals > 0) {
+		
+		stats->MeanIntervalMs = sum / intervals;
+		
+		double variance = sumSquares / intervals - stats->MeanIntervalMs * stats->MeanIntervalMs;
+		stats->JitterMs = (variance > 0) ? sqrt(variance) : 0;
+	}
+	
+	free(local);
+	return (int)count;
+}
@@ -0,0 +1,72 @@
+#ifndef FRAME_METADATA_H
+#define FRAME_METADATA_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Per-frame metadata ring. Every frame delivered by the driver (complete or not) is recorded with its
+frame ID, device timestamp, host receive time, status and (when known) exposure time and gain in a
+fixed-size ring per camera.
+
+Gaps in the frame IDs are counted as dropped frames, incomplete frames are counted separately.
+FrameMetadataQuery reports drop rate and inter-frame interval jitter over the last N frames, so a
+saturated link shows up as a rising drop rate / jitter.
+
+One writer (the thread delivering frames), any number of readers. Readers never block the writer,
+they copy the window and retry if the writer lapped them meanwhile.
+****************************************************************************************************/
+
+#define FRAME_METADATA_RING_SIZE	1024	// Power of two
+#define FRAME_METADATA_MAX_WINDOW	(FRAME_METADATA_RING_SIZE - 64) // Leave room for the writer while a reader copies
+
+struct frame_metadata_s {
+	
+	uint64_t FrameID;			// pFrame->nFrameID
+	uint64_t Timestamp;			// pFrame->nTimestamp, device ticks
+	double HostTimeMs;			// Host receive time (GetHostTimeMs)
+	int Status;					// GX_FRAME_STATUS_SUCCESS or GX_FRAME_STATUS_INCOMPLETE
+	int PixelFormat;			// pFrame->nPixelFormat
+	int Missing;				// Frame IDs skipped right before this frame (dropped frames)
+	double ExposureTime;		// us, from the chunk data or the manual setting, -1 = unknown
+	double Gain;				// dB, the same
+};
+
+struct frame_metadata_ring_s {
+	
+	struct frame_metadata_s Entries[FRAME_METADATA_RING_SIZE];
+	atomic_long_t Head;			// Entries written so far, the next one goes to Head % FRAME_METADATA_RING_SIZE
+	
+	// Writer state
+	uint64_t LastFrameID;
+	int HasLastFrameID;
+	
+	// Totals since the last reset
+	atomic_long_t Frames;
+	atomic_long_t DroppedFrames;
+	atomic_long_t IncompleteFrames;
+};
+
+// Result of FrameMetadataQuery
+struct frame_window_stats_s {
+	
+	int Frames;					// Frames delivered in the window
+	int IncompleteFrames;		// Of which incomplete
+	int DroppedFrames;			// Frame IDs missing in the window
+	double DropRate;			// DroppedFrames / (Frames + DroppedFrames)
+	double MeanIntervalMs;		// Mean host-side interval between delivered frames
+	double JitterMs;			// Standard deviation of that interval
+	double MaxIntervalMs;		// Longest interval in the window
+};
+
+/***************************************************************************************************
+Frame Metadata Public Functions
+****************************************************************************************************/
+
+void FrameMetadataReset  (struct frame_metadata_ring_s *ring); // Not thread safe, call before delivering frames
+void FrameMetadataRecord (struct frame_metadata_ring_s *ring, uint64_t frameID, uint64_t timestamp, double hostTimeMs, int status, int pixelFormat,
+						  double exposureTime, double gain);
+int  FrameMetadataQuery  (struct frame_metadata_ring_s *ring, int window, struct frame_window_stats_s *stats); // Returns the frames in the window
+int  FrameMetadataLatest (struct frame_metadata_ring_s *ring, int age, struct frame_metadata_s *entry); // age 0 = newest, returns 0 if not available
+
+#endif
@@ -0,0 +1,231 @@
+#include "FRAME_POOL.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/***************************************************************************************************
+Frame Pool Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+// The pool's own reference to each of its frames, consumer references count in the low bits
+#define FRAME_POOL_REF			0x10000
+#define FRAME_CONSUMERS(refs)	((refs) & (FRAME_POOL_REF - 1))
+
+void FramePoolSleep(int ms);
+void FrameFree(struct frame_s *frame);
+
+/***************************************************************************************************
+Aligned allocation. The original malloc pointer is stored right in front of the aligned block.
+****************************************************************************************************/
+
+void* AlignedAlloc(size_t bytes) {
+	
+	unsigned char *raw = (unsigned char *)malloc(bytes + FRAME_POOL_ALIGNMENT + sizeof(void *));
+	if (raw == NULL) return NULL;
+	
+	uintptr_t aligned = ((uintptr_t)raw + sizeof(void *) + FRAME_POOL_ALIGNMENT - 1) & ~(uintptr_t)(FRAME_POOL_ALIGNMENT - 1);
+	((void **)aligned)[-1] = raw;
+	
+	return (void *)aligned;
+}
+
+void AlignedFree(void *ptr) {
+	
+	if (ptr) free(((void **)ptr)[-1]);
+}
+
+void FramePoolSleep(int ms) {
+	
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+void FrameFree(struct frame_s *frame) {
+	
+	AlignedFree(frame->Data);
+	AlignedFree(frame->Raw);
+	AlignedFree(frame->Raw16);
+	AlignedFree(frame);
+}
+
+/***************************************************************************************************
+Create / destroy. Not thread safe against FramePoolAcquire: call them while no acquisition is running.
+Consumers may keep holding and releasing frames of the old pool meanwhile.
+A pool must start out zeroed (the camera struct is), Create releases the frames of the previous pool.
+****************************************************************************************************/
+
+int FramePoolCreate(struct frame_pool_s *pool, int count, size_t dataBytes, size_t rawBytes, size_t raw16Bytes) {
+	
+	if (count <= 0) count = FRAME_POOL_DEFAULT_FRAMES;
+	if (count > FRAME_POOL_MAX_FRAMES) count = FRAME_POOL_MAX_FRAMES;
+	
+	// Frames of a previous pool go to whoever still holds them
+	FramePoolDestroy(pool);
+	
+	// Keep the policy, everything else starts from scratch
+	int dropPolicy    = pool->DropPolicy;
+	int waitTimeoutMs = pool->WaitTimeoutMs;
+	
+	memset(pool, 0, sizeof(*pool));
+	
+	pool->DropPolicy    = dropPolicy;
+	pool->WaitTimeoutMs = waitTimeoutMs;
+	pool->DataCapacity  = dataBytes;
+	pool->RawCapacity   = rawBytes;
+	pool->Raw16Capacity = raw16Bytes;
+	
+	for (int i = 0; i < count; i++) {
+		
+		struct frame_s *frame = (struct frame_s *)AlignedAlloc(sizeof(struct frame_s));
+		if (frame == NULL) {
+			FramePoolDestroy(pool);
+			return CANCEL;
+		}
+		
+		memset(frame, 0, sizeof(*frame));
+		pool->Frames[i] = frame;
+		pool->Count     = i + 1;
+		
+		frame->RefCount = FRAME_POOL_REF;
+		frame->Index    = i;
+		frame->Pool     = pool;
+		frame->Data     = (unsigned char *)AlignedAlloc(dataBytes);
+		
+		if (rawBytes > 0)   frame->Raw   = (unsigned char *)AlignedAlloc(rawBytes);
+		if (raw16Bytes > 0) frame->Raw16 = (uint16_t *)AlignedAlloc(raw16Bytes);
+		
+		if (frame->Data == NULL || (rawBytes > 0 && frame->Raw == NULL) || (raw16Bytes > 0 && frame->Raw16 == NULL)) {
+			FramePoolDestroy(pool);
+			return CANCEL;
+		}
+		
+		// Touch the memory once now instead of on the first frames
+		memset(frame->Data, 0, dataBytes);
+		if (frame->Raw) memset(frame->Raw, 0, rawBytes);
+		if (frame->Raw16) memset(frame->Raw16, 0, raw16Bytes);
+	}
+	
+	pool->Count = count;
+	
+	return OK;
+}
+
+void FramePoolDestroy(struct frame_pool_s *pool) {
+	
+	// Drop the pool's reference: free frames go now, held ones with their last FrameRelease
+	for (int i = 0; i < pool->Count; i++) {
+		
+		struct frame_s *frame = pool->Frames[i];
+		
+		frame->Pool = NULL;
+		if (ATOMIC_ADD(&frame->RefCount, -FRAME_POOL_REF) == FRAME_POOL_REF) FrameFree(frame);
+		
+		pool->Frames[i] = NULL;
+	}
+	
+	pool->Count         = 0;
+	pool->DataCapacity  = 0;
+	pool->RawCapacity   = 0;
+	pool->Raw16Capacity = 0;
+}
+
+int FramePoolFits(struct frame_pool_s *pool, int count, size_t dataBytes, size_t rawBytes, size_t raw16Bytes) {
+	
+	if (count <= 0) count = FRAME_POOL_DEFAULT_FRAMES;
+	if (count > FRAME_POOL_MAX_FRAMES) count = FRAME_POOL_MAX_FRAMES;
+	
+	return pool->Count == count && pool->DataCapacity >= dataBytes && pool->RawCapacity >= rawBytes && pool->Raw16Capacity >= raw16Bytes;
+}
+
+long FramePoolInUse(struct frame_pool_s *pool) {
+	
+	long inUse = 0;
+	
+	for (int i = 0; i < pool->Count; i++) {
+		if (FRAME_CONSUMERS(ATOMIC_LOAD(&pool->Frames[i]->RefCount)) != 0) inUse++;
+	}
+	
+	return inUse;
+}
+
+/***************************************************************************************************
+Acquire / reference counting. Thread safe, lock-free.
+****************************************************************************************************/
+
+struct frame_s* FramePoolAcquire(struct frame_pool_s *pool) {
+	
+	if (pool->Count == 0) return NULL;
+	
+	int waitedMs = 0;
+	int counted  = FALSE;
+	
+	for (;;) {
+		
+		// Round-robin search, so frames are reused in order and a just released frame stays cold
+		long start = ATOMIC_INCREMENT(&pool->NextSearch);
+		
+		for (int n = 0; n < pool->Count; n++) {
+			
+			struct frame_s *frame = pool->Frames[(unsigned long)(start + n) % (unsigned long)pool->Count];
+			
+			if (ATOMIC_COMPARE_EXCHANGE(&frame->RefCount, FRAME_POOL_REF + 1, FRAME_POOL_REF) == FRAME_POOL_REF) {
+				
+				long inUse = FramePoolInUse(pool);
+				long peak  = ATOMIC_LOAD(&pool->PeakInUse);
+				
+				while (inUse > peak) {
+					long seen = ATOMIC_COMPARE_EXCHANGE(&pool->PeakInUse, inUse, peak);
+					if (seen == peak) break;
+					peak = seen;
+				}
+				
+				return frame;
+			}
+		}
+		
+		// Every frame is held by somebody
+		if (!counted) {
+			ATOMIC_INCREMENT(&pool->Exhausted);
+			counted = TRUE;
+		}
+		
+		if (pool->DropPolicy != FRAME_POOL_WAIT || waitedMs >= pool->WaitTimeoutMs) break;
+		
+		FramePoolSleep(1);
+		waitedMs++;
+	}
+	
+	ATOMIC_INCREMENT(&pool->Dropped);
+	return NULL;
+}
+
+void FrameAddRef(struct frame_s *frame) {
+	
+	if (frame) ATOMIC_INCREMENT(&frame->RefCount);
+}
+
+// Never touches the pool: the pool may be gone (resized, camera closed) while consumers hold frames
+void FrameRelease(struct frame_s *frame) {
+	
+	if (frame == NULL) return;
+	
+	long refs = ATOMIC_DECREMENT(&frame->RefCount);
+	
+	if (refs == 0) FrameFree(frame); // Last holder of a frame the pool let go of
+	else if (FRAME_CONSUMERS(refs) == FRAME_POOL_REF - 1) {
+		ATOMIC_INCREMENT(&frame->RefCount);
+		printf("FrameRelease: frame %d released too many times.\n", frame->Index);
+	}
+}
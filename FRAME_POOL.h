@@ -0,0 +1,99 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Frame Pool. A fixed set of preallocated, aligned frames per camera.
+
+Every frame carries a reference count. FramePoolAcquire hands out a free frame with one reference,
+each consumer that wants to keep the frame (display, recorder, analysis...) takes its own reference
+with FrameAddRef, and the frame goes back to the pool when the last FrameRelease drops it to zero.
+A frame is never written while anyone still holds it: when every frame is held the pool counts
+the exhaustion and applies its drop policy instead.
+
+Every frame is a separate allocation and the pool owns it through a reference of its own. Destroying
+(or resizing) the pool drops that reference: free frames are freed right away, frames a consumer
+still holds stay valid and are freed by their last FrameRelease.
+****************************************************************************************************/
+
+#define FRAME_POOL_MAX_FRAMES		16	// Upper limit of frames per pool
+#define FRAME_POOL_DEFAULT_FRAMES	6	// Used when the camera does not ask for a size
+#define FRAME_POOL_ALIGNMENT		64	// Frame buffers start on a cache line
+
+// Drop policies, applied when every frame of the pool is held
+#define FRAME_POOL_DROP_NEWEST		0	// Drop the incoming frame right away (never blocks the caller)
+#define FRAME_POOL_WAIT				1	// Wait up to WaitTimeoutMs for a consumer to release a frame, then drop
+
+struct frame_pool_s;
+
+struct frame_s {
+	
+	unsigned char *Data;			// Display image (color-converted/flipped, BMP row layout)
+	unsigned char *Raw;				// Raw frame as received from the camera, NULL unless the pool keeps raw frames
+	uint16_t *Raw16;				// 10/12-bit frame unpacked to 16 bits, NULL for 8-bit formats
+	size_t DataSize;				// Valid bytes in Data
+	size_t RawSize;					// Valid bytes in Raw
+	size_t Raw16Size;				// Valid bytes in Raw16
+	int BitDepth;					// Significant bits per pixel of the frame (8, 10, 12)
+	
+	// Frame information
+	uint64_t FrameID;				// pFrame->nFrameID
+	uint64_t Timestamp;				// pFrame->nTimestamp, device ticks
+	double HostTimeMs;				// GetHostTimeMs() when the frame reached us
+	double CaptureTimeMs;			// Timestamp on the host clock (estimated, excludes the time spent queued)
+	uint64_t ExposureEndTimestamp;	// Device ticks of the ExposureEnd event, 0 = no event (yet)
+	double ExposureEndTimeMs;		// The same on the host clock, -1 = unknown
+	int64_t DeliveredTicks;			// GetHostTicks() when the driver delivered the frame
+	int64_t CopiedTicks;			// ... after the raw copy (or the decision not to copy)
+	int64_t ConvertedTicks;			// ... after the color conversion / flip
+	int Width;
+	int Height;
+	int PixelFormat;
+	double ExposureTime;			// us, from the chunk data or the manual setting, -1 = unknown
+	double Gain;					// dB, the same
+	
+	// Ownership
+	atomic_long_t RefCount;			// Consumer references, + the pool's own while the pool keeps the frame
+	int Index;						// Position in the pool
+	struct frame_pool_s *Pool;		// NULL once the pool let go of the frame
+};
+
+struct frame_pool_s {
+	
+	struct frame_s *Frames[FRAME_POOL_MAX_FRAMES];
+	int Count;						// Frames allocated
+	size_t DataCapacity;			// Bytes allocated for every frame's Data
+	size_t RawCapacity;				// Bytes allocated for every frame's Raw, 0 if raw frames are not kept
+	size_t Raw16Capacity;			// Bytes allocated for every frame's Raw16, 0 for 8-bit formats
+	
+	// Exhaustion handling
+	int DropPolicy;					// FRAME_POOL_DROP_NEWEST or FRAME_POOL_WAIT
+	int WaitTimeoutMs;				// Used by FRAME_POOL_WAIT
+	
+	// Statistics
+	atomic_long_t NextSearch;		// Where the next acquire starts looking
+	atomic_long_t PeakInUse;		// Most frames held at once (FramePoolInUse at an acquire)
+	atomic_long_t Exhausted;		// Acquires that found every frame held
+	atomic_long_t Dropped;			// Acquires that gave up (frame dropped)
+};
+
+/***************************************************************************************************
+Frame Pool Public Functions. Create/Destroy return OK (1) on success, CANCEL (-1) on failure.
+****************************************************************************************************/
+
+int  FramePoolCreate  (struct frame_pool_s *pool, int count, size_t dataBytes, size_t rawBytes, size_t raw16Bytes);
+void FramePoolDestroy (struct frame_pool_s *pool);
+int  FramePoolFits    (struct frame_pool_s *pool, int count, size_t dataBytes, size_t rawBytes, size_t raw16Bytes); // TRUE if the pool can be reused as is
+long FramePoolInUse   (struct frame_pool_s *pool); // Frames currently held by a consumer
+
+struct frame_s* FramePoolAcquire (struct frame_pool_s *pool); // NULL when the frame must be dropped
+void FrameAddRef  (struct frame_s *frame);
+void FrameRelease (struct frame_s *frame);
+
+void* AlignedAlloc (size_t bytes); // FRAME_POOL_ALIGNMENT (cache line) aligned, free with AlignedFree
+void  AlignedFree  (void *ptr);
+
+#endif
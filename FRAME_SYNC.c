@@ -0,0 +1,205 @@
+#include "FRAME_SYNC.h"
+#include <string.h>
+
+/***************************************************************************************************
+Frame Sync Private Functions And Variables
+****************************************************************************************************/
+
+#define CANCEL      -1
+#define OK			1
+
+void FrameSyncLock(struct frame_sync_s *sync);
+void FrameSyncUnlock(struct frame_sync_s *sync);
+void FrameSyncDiscardHead(struct frame_sync_s *sync, int stream);
+void FrameSyncMatch(struct frame_sync_s *sync);
+
+void FrameSyncLock(struct frame_sync_s *sync) {
+	
+	while (ATOMIC_COMPARE_EXCHANGE(&sync->Lock, 1, 0) != 0) {
+		// Held only for a few queue operations, just spin
+	}
+}
+
+void FrameSyncUnlock(struct frame_sync_s *sync) {
+	
+	ATOMIC_STORE(&sync->Lock, 0);
+}
+
+/***************************************************************************************************
+Setup
+****************************************************************************************************/
+
+int FrameSyncInit(struct frame_sync_s *sync, int numStreams, int queueDepth, double toleranceUs,
+				  FrameSetCallback onSet, FrameSyncReleaseCallback onRelease, void *userData) {
+	
+	if (numStreams < 1 || numStreams > FRAME_SYNC_MAX_STREAMS || toleranceUs < 0) return CANCEL;
+	
+	if (queueDepth <= 0 || queueDepth > FRAME_SYNC_QUEUE_SIZE) queueDepth = FRAME_SYNC_QUEUE_SIZE;
+	
+	memset(sync, 0, sizeof(*sync));
+	
+	sync->NumStreams  = numStreams;
+	sync->QueueDepth  = queueDepth;
+	sync->ToleranceUs = toleranceUs;
+	sync->AutoAlign   = 1;
+	sync->DriftGain   = 0.05;
+	sync->OnSet       = onSet;
+	sync->OnRelease   = onRelease;
+	sync->UserData    = userData;
+	
+	return OK;
+}
+
+void FrameSyncSetOffset(struct frame_sync_s *sync, int stream, double offsetUs) {
+	
+	if (stream < 0 || stream >= sync->NumStreams) return;
+	
+	FrameSyncLock(sync);
+	sync->Streams[stream].OffsetUs = offsetUs;
+	sync->Streams[stream].Aligned  = 1;
+	FrameSyncUnlock(sync);
+}
+
+// Frames queued on the old time base cannot pair with anything on the new one
+void FrameSyncRealign(struct frame_sync_s *sync, int stream) {
+	
+	if (stream < 0 || stream >= sync->NumStreams) return;
+	
+	FrameSyncLock(sync);
+	
+	while (sync->Streams[stream].Count > 0) FrameSyncDiscardHead(sync, stream);
+	
+	sync->Streams[stream].OffsetUs = 0;
+	sync->Streams[stream].Aligned  = 0;
+	
+	FrameSyncUnlock(sync);
+}
+
+/***************************************************************************************************
+Matching
+****************************************************************************************************/
+
+void FrameSyncDiscardHead(struct frame_sync_s *sync, int stream) {
+	
+	struct frame_sync_stream_s *s = &sync->Streams[stream];
+	
+	if (sync->OnRelease) sync->OnRelease(s->Queue[s->Head].Item, sync->UserData);
+	
+	s->Head = (s->Head + 1) % sync->QueueDepth;
+	s->Count--;
+}
+
+void FrameSyncPush(struct frame_sync_s *sync, int stream, double timeUs, double hostTimeUs, uint64_t frameID, void *item) {
+	
+	if (stream < 0 || stream >= sync->NumStreams) {
+		if (sync->OnRelease) sync->OnRelease(item, sync->UserData);
+		return;
+	}
+	
+	FrameSyncLock(sync);
+	
+	struct frame_sync_stream_s *s = &sync->Streams[stream];
+	
+	// First frame of the stream: put its clock on the host time base
+	if (!s->Aligned) {
+		s->OffsetUs = sync->AutoAlign ? hostTimeUs - timeUs : 0;
+		s->Aligned  = 1;
+	}
+	
+	// Bounded queue: the oldest frame makes room
+	if (s->Count == sync->QueueDepth) {
+		FrameSyncDiscardHead(sync, stream);
+		s->Overflowed++;
+	}
+	
+	struct frame_sync_entry_s *entry = &s->Queue[(s->Head + s->Count) % sync->QueueDepth];
+	
+	entry->TimeUs  = timeUs + s->OffsetUs;
+	entry->FrameID = frameID;
+	entry->Item    = item;
+	
+	s->Count++;
+	s->Frames++;
+	
+	FrameSyncMatch(sync);
+	
+	FrameSyncUnlock(sync);
+}
+
+// Emit sets / discard unmatchable heads until some stream runs out of frames
+void FrameSyncMatch(struct frame_sync_s *sync) {
+	
+	for (;;) {
+		
+		int minStream = 0;
+		double minTime = 0, maxTime = 0;
+		
+		for (int i = 0; i < sync->NumStreams; i++) {
+			
+			struct frame_sync_stream_s *s = &sync->Streams[i];
+			
+			if (s->Count == 0) return; // Wait for this stream
+			
+			double t = s->Queue[s->Head].TimeUs;
+			
+			if (i == 0 || t < minTime) { minTime = t; minStream = i; }
+			if (i == 0 || t > maxTime) maxTime = t;
+		}
+		
+		// The oldest head is too old for the newest one, and every later frame is newer still
+		if (maxTime - minTime > sync->ToleranceUs) {
+			sync->Streams[minStream].Unmatched++;
+			FrameSyncDiscardHead(sync, minStream);
+			continue;
+		}
+		
+		// Matched set
+		struct frame_set_s set;
+		double sum = 0;
+		
+		set.NumStreams = sync->NumStreams;
+		set.SkewUs     = maxTime - minTime;
+		
+		for (int i = 0; i < sync->NumStreams; i++) {
+			
+			struct frame_sync_stream_s *s = &sync->Streams[i];
+			
+			set.Entries[i] = s->Queue[s->Head];
+			sum += set.Entries[i].TimeUs;
+			s->Matched++;
+		}
+		
+		set.TimeUs = sum / sync->NumStreams;
+		
+		// Follow the drift: pull every stream a little towards the set's mean time
+		if (sync->DriftGain > 0) {
+			for (int i = 0; i < sync->NumStreams; i++) {
+				sync->Streams[i].OffsetUs -= sync->DriftGain * (set.Entries[i].TimeUs - set.TimeUs);
+			}
+		}
+		
+		sync->Sets++;
+		sync->SkewSumUs += set.SkewUs;
+		if (set.SkewUs > sync->MaxSkewUs) sync->MaxSkewUs = set.SkewUs;
+		
+		if (sync->OnSet) sync->OnSet(&set, sync->UserData);
+		
+		for (int i = 0; i < sync->NumStreams; i++) FrameSyncDiscardHead(sync, i);
+	}
+}
+
+void FrameSyncFlush(struct frame_sync_s *sync) {
+	
+	FrameSyncLock(sync);
+	
+	for (int i = 0; i < sync->NumStreams; i++) {
+		while (sync->Streams[i].Count > 0) FrameSyncDiscardHead(sync, i);
+	}
+	
+	FrameSyncUnlock(sync);
+}
+
+double FrameSyncMeanSkewUs(struct frame_sync_s *sync) {
+	
+	return (sync->Sets > 0) ? sync->SkewSumUs / (double)sync->Sets : 0;
+}
@@ -0,0 +1,95 @@
+#ifndef FRAME_SYNC_H
+#define FRAME_SYNC_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Multi-camera frame synchronizer. Pairs the frames of N independent camera streams into matched
+frame sets: one frame per stream, all captured within ToleranceUs of each other.
+
+Each stream pushes its frames (capture time in its own clock + frame ID) into a bounded queue.
+Every stream clock gets an offset into a common time base: set once from the host receive time of
+the first frame (AutoAlign), then nudged after every matched set so that slow clock drift between
+the cameras is tracked (DriftGain). A set is emitted as soon as the queue heads of all streams lie
+within the tolerance. Otherwise the oldest head can never be matched (every other stream is already
+past it) and is discarded. Each frame enters and leaves its queue once and every decision looks at
+the N queue heads only, so the cost per frame is constant for a given number of cameras.
+
+Pushes may come from several camera threads at once, they are serialized by a spin lock. The set
+and release callbacks run inside that lock and must not block.
+****************************************************************************************************/
+
+#define FRAME_SYNC_MAX_STREAMS		16
+#define FRAME_SYNC_QUEUE_SIZE		32	// Upper limit of the per-stream queue depth
+
+struct frame_sync_entry_s {
+	
+	double TimeUs;				// Capture time in the common time base (stream time + stream offset)
+	uint64_t FrameID;
+	void *Item;					// Caller's frame (e.g. struct frame_s *)
+};
+
+struct frame_sync_stream_s {
+	
+	struct frame_sync_entry_s Queue[FRAME_SYNC_QUEUE_SIZE];
+	int Head;					// Oldest entry
+	int Count;
+	
+	double OffsetUs;			// Stream clock -> common time base
+	int Aligned;				// OffsetUs has been set
+	
+	// Statistics
+	int64_t Frames;
+	int64_t Matched;
+	int64_t Unmatched;			// Discarded, no partner within the tolerance
+	int64_t Overflowed;			// Discarded, the queue was full
+};
+
+// One matched frame set, Entries[i] belongs to stream i
+struct frame_set_s {
+	
+	int NumStreams;
+	struct frame_sync_entry_s Entries[FRAME_SYNC_MAX_STREAMS];
+	double SkewUs;				// Latest minus earliest capture time of the set
+	double TimeUs;				// Mean capture time of the set
+};
+
+typedef void (*FrameSetCallback)(struct frame_set_s *set, void *userData); // Take a reference to keep an item
+typedef void (*FrameSyncReleaseCallback)(void *item, void *userData); // Item leaves the synchronizer
+
+struct frame_sync_s {
+	
+	int NumStreams;
+	int QueueDepth;				// Per-stream queue depth, <= FRAME_SYNC_QUEUE_SIZE
+	double ToleranceUs;			// Largest skew accepted in a set
+	int AutoAlign;				// Align each stream to the host clock with its first frame
+	double DriftGain;			// 0..1, how fast the stream offsets follow the matched sets (0 = no drift tracking)
+	
+	struct frame_sync_stream_s Streams[FRAME_SYNC_MAX_STREAMS];
+	
+	FrameSetCallback OnSet;
+	FrameSyncReleaseCallback OnRelease;
+	void *UserData;
+	
+	atomic_long_t Lock;
+	
+	// Statistics
+	int64_t Sets;
+	double SkewSumUs;
+	double MaxSkewUs;
+};
+
+/***************************************************************************************************
+Frame Sync Public Functions. FrameSyncInit returns OK (1) on success, CANCEL (-1) on bad parameters.
+****************************************************************************************************/
+
+int  FrameSyncInit  (struct frame_sync_s *sync, int numStreams, int queueDepth, double toleranceUs,
+					 FrameSetCallback onSet, FrameSyncReleaseCallback onRelease, void *userData);
+void FrameSyncPush  (struct frame_sync_s *sync, int stream, double timeUs, double hostTimeUs, uint64_t frameID, void *item);
+void FrameSyncSetOffset (struct frame_sync_s *sync, int stream, double offsetUs); // Known offset, disables AutoAlign for the stream
+void FrameSyncRealign   (struct frame_sync_s *sync, int stream); // The stream clock restarted or changed: release its queue, align again
+void FrameSyncFlush (struct frame_sync_s *sync); // Release everything still queued
+double FrameSyncMeanSkewUs (struct frame_sync_s *sync);
+
+#endif
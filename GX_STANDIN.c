@@ -0,0 +1,488 @@
+#include "GX_STANDIN.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/***************************************************************************************************
+Stand-in GxIAPI Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+// Source thread and the wake-up of GxStandInGetImage. Windows: an auto-reset event set for every
+// queued frame. Elsewhere: a condition variable under a mutex.
+struct gx_standin_sync_s {
+#ifdef _WIN32
+	HANDLE Thread;
+	HANDLE FrameReady;
+#else
+	pthread_t Thread;
+	pthread_mutex_t Lock;
+	pthread_cond_t FrameReady;
+#endif
+	int Started;					// The source thread runs
+};
+
+atomic_long_t LoadRun = 0;
+int NumLoadThreads = 0;
+
+#ifdef _WIN32
+HANDLE LoadThreads[GX_STANDIN_MAX_LOAD];
+#else
+pthread_t LoadThreads[GX_STANDIN_MAX_LOAD];
+#endif
+
+void GxStandInSleepUntil(struct gx_standin_s *source, double dueUs);
+void GxStandInDeliver(struct gx_standin_s *source, uint64_t frameId, double dueUs);
+void GxStandInSource(struct gx_standin_s *source);
+void GxStandInTriggerSource(struct gx_standin_s *source);
+int GxStandInLaunch(struct gx_standin_s *source);
+void GxStandInLoad(void);
+
+#ifdef _WIN32
+DWORD WINAPI GxStandInThreadFunction(LPVOID parameter);
+DWORD WINAPI GxStandInLoadThreadFunction(LPVOID parameter);
+#else
+void* GxStandInThreadFunction(void *parameter);
+void* GxStandInLoadThreadFunction(void *parameter);
+#endif
+
+double GxStandInNowUs(void) {
+	
+#ifdef _WIN32
+	static double usPerTick = 0;
+	LARGE_INTEGER counter;
+	
+	if (usPerTick == 0) {
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		usPerTick = 1000000.0 / (double)frequency.QuadPart;
+	}
+	
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * usPerTick;
+#else
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec * 1e6 + now.tv_nsec / 1000.0;
+#endif
+}
+
+/***************************************************************************************************
+Source thread. Sleeps to the next frame, then hands over every frame that fell due since the last
+one. Of frames that piled up (a slow callback, the thread preempted), only the newest
+GX_STANDIN_BUFFERS are kept, as in the SDK's buffer queue; the older ones are dropped.
+****************************************************************************************************/
+
+// Sleep in 1 ms steps while far off, then yield until due
+void GxStandInSleepUntil(struct gx_standin_s *source, double dueUs) {
+	
+	for (;;) {
+		
+		double remainingUs = dueUs - GxStandInNowUs();
+		
+		if (remainingUs <= 0 || !ATOMIC_LOAD(&source->Run)) return;
+	
+#ifdef _WIN32
+		Sleep(remainingUs > 2000 ? 1 : 0);
+#else
+		if (remainingUs > 2000) usleep(1000);
+		else sched_yield();
+#endif
+	}
+}
+
+void GxStandInDeliver(struct gx_standin_s *source, uint64_t frameId, double dueUs) {
+	
+	struct gx_standin_sync_s *sync = (struct gx_standin_sync_s *)source->Sync;
+	uint64_t timestamp = (uint64_t)(dueUs * 1000.0);
+	
+	if (source->Callback != NULL) {
+		
+		GX_FRAME_CALLBACK_PARAM frame;
+		unsigned char *buffer = source->Buffers[frameId & (GX_STANDIN_BUFFERS - 1)];
+		
+		memcpy(buffer, &frameId, sizeof(frameId) <= (size_t)source->ImageBytes ? sizeof(frameId) : (size_t)source->ImageBytes);
+		
+		memset(&frame, 0, sizeof(frame));
+		frame.pUserParam   = source->UserParam;
+		frame.status       = GX_FRAME_STATUS_SUCCESS;
+		frame.pImgBuf      = buffer;
+		frame.nImgSize     = source->ImageBytes;
+		frame.nWidth       = source->Width;
+		frame.nHeight      = source->Height;
+		frame.nPixelFormat = source->PixelFormat;
+		frame.nFrameID     = frameId;
+		frame.nTimestamp   = timestamp;
+		
+		source->Callback(&frame);
+		return;
+	}
+	
+	long head = ATOMIC_LOAD(&source->Head);
+	
+	// Queue full: GxStandInGetImage is not keeping up
+	if (head - ATOMIC_LOAD(&source->Tail) >= GX_STANDIN_BUFFERS) {
+		ATOMIC_INCREMENT(&source->Dropped);
+		return;
+	}
+	
+	long slot = head & (GX_STANDIN_BUFFERS - 1);
+	
+	memcpy(source->Buffers[slot], &frameId, sizeof(frameId) <= (size_t)source->ImageBytes ? sizeof(frameId) : (size_t)source->ImageBytes);
+	source->FrameIds[slot]   = frameId;
+	source->Timestamps[slot] = timestamp;
+	
+#ifdef _WIN32
+	ATOMIC_INCREMENT(&source->Head);
+	SetEvent(sync->FrameReady);
+#else
+	pthread_mutex_lock(&sync->Lock);
+	ATOMIC_INCREMENT(&source->Head);
+	pthread_cond_signal(&sync->FrameReady);
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+}
+
+void GxStandInSource(struct gx_standin_s *source) {
+	
+	double periodUs = 1e6 / source->FrameRate;
+	double startUs  = GxStandInNowUs();
+	uint64_t next   = 0;
+	
+	while (ATOMIC_LOAD(&source->Run)) {
+		
+		GxStandInSleepUntil(source, startUs + next * periodUs);
+		if (!ATOMIC_LOAD(&source->Run)) break;
+		
+		// Newest frame that fell due by now
+		uint64_t last = (uint64_t)((GxStandInNowUs() - startUs) / periodUs);
+		
+		for (; next <= last && ATOMIC_LOAD(&source->Run); next++) {
+			
+			ATOMIC_INCREMENT(&source->Generated);
+			
+			if (last - next >= GX_STANDIN_BUFFERS) ATOMIC_INCREMENT(&source->Dropped);
+			else GxStandInDeliver(source, next + 1, startUs + next * periodUs);
+		}
+	}
+}
+
+// Trigger mode: idles until a trigger is pending, then delivers its frame when due
+void GxStandInTriggerSource(struct gx_standin_s *source) {
+	
+	uint64_t frameId = 0;
+	
+	while (ATOMIC_LOAD(&source->Run)) {
+		
+		if (ATOMIC_LOAD(&source->TriggerPending) != 1) {
+#ifdef _WIN32
+			Sleep(0);
+#else
+			usleep(100);
+#endif
+			continue;
+		}
+		
+		double dueUs = source->TriggerDueUs;
+		
+		GxStandInSleepUntil(source, dueUs);
+		if (!ATOMIC_LOAD(&source->Run)) break;
+		
+		// Exposed: the next trigger is accepted while this frame is delivered
+		ATOMIC_STORE(&source->TriggerPending, 0);
+		
+		ATOMIC_INCREMENT(&source->Generated);
+		GxStandInDeliver(source, ++frameId, dueUs);
+	}
+}
+
+#ifdef _WIN32
+DWORD WINAPI GxStandInThreadFunction(LPVOID parameter) {
+#else
+void* GxStandInThreadFunction(void *parameter) {
+#endif
+
+	struct gx_standin_s *source = (struct gx_standin_s *)parameter;
+	
+	if (source->Triggered) GxStandInTriggerSource(source);
+	else GxStandInSource(source);
+	return 0;
+}
+
+// Buffers, wake-up and the source thread of a source whose settings are filled in
+int GxStandInLaunch(struct gx_standin_s *source) {
+	
+	struct gx_standin_sync_s *sync = (struct gx_standin_sync_s *)calloc(1, sizeof(struct gx_standin_sync_s));
+	if (sync == NULL) return CANCEL;
+	
+	source->Sync = sync;
+	
+#ifdef _WIN32
+	sync->FrameReady = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (sync->FrameReady == NULL) {
+		GxStandInStop(source);
+		return CANCEL;
+	}
+#else
+	pthread_mutex_init(&sync->Lock, NULL);
+	pthread_cond_init(&sync->FrameReady, NULL);
+#endif
+
+	// A fixed noise image, only the frame ID in the first bytes changes
+	uint32_t seed = 1;
+	
+	for (int i = 0; i < GX_STANDIN_BUFFERS; i++) {
+		
+		source->Buffers[i] = (unsigned char *)malloc((size_t)source->ImageBytes);
+		
+		if (source->Buffers[i] == NULL) {
+			GxStandInStop(source);
+			return CANCEL;
+		}
+		
+		for (int32_t j = 0; j < source->ImageBytes; j++) {
+			seed = seed * 1664525u + 1013904223u;
+			source->Buffers[i][j] = (unsigned char)(seed >> 24);
+		}
+	}
+	
+	ATOMIC_STORE(&source->Run, 1);
+	
+	// Normal priority: in callback mode the frames are processed on this thread
+#ifdef _WIN32
+	sync->Thread  = CreateThread(NULL, 0, GxStandInThreadFunction, source, 0, NULL);
+	sync->Started = sync->Thread != NULL;
+#else
+	sync->Started = pthread_create(&sync->Thread, NULL, GxStandInThreadFunction, source) == 0;
+#endif
+
+	if (!sync->Started) {
+		GxStandInStop(source);
+		return CANCEL;
+	}
+	
+	return OK;
+}
+
+/***************************************************************************************************
+Stand-in GxIAPI Public Functions
+****************************************************************************************************/
+
+int GxStandInStart(struct gx_standin_s *source, int width, int height, int32_t pixelFormat, int32_t imageBytes,
+				   double frameRate, GXCaptureCallBack callback, void *userParam) {
+	
+	memset(source, 0, sizeof(*source));
+	
+	if (width <= 0 || height <= 0 || imageBytes <= 0 || frameRate <= 0) return CANCEL;
+	
+	source->Width       = width;
+	source->Height      = height;
+	source->PixelFormat = pixelFormat;
+	source->ImageBytes  = imageBytes;
+	source->FrameRate   = frameRate;
+	source->Callback    = callback;
+	source->UserParam   = userParam;
+	
+	return GxStandInLaunch(source);
+}
+
+int GxStandInStartTriggered(struct gx_standin_s *source, int width, int height, int32_t pixelFormat, int32_t imageBytes,
+							double latencyMs, GXCaptureCallBack callback, void *userParam) {
+	
+	memset(source, 0, sizeof(*source));
+	
+	if (width <= 0 || height <= 0 || imageBytes <= 0 || latencyMs < 0) return CANCEL;
+	
+	source->Width            = width;
+	source->Height           = height;
+	source->PixelFormat      = pixelFormat;
+	source->ImageBytes       = imageBytes;
+	source->Triggered        = TRUE;
+	source->TriggerLatencyMs = latencyMs;
+	source->Callback         = callback;
+	source->UserParam        = userParam;
+	
+	return GxStandInLaunch(source);
+}
+
+GX_STATUS GxStandInSendTrigger(struct gx_standin_s *source) {
+	
+	if (!source->Triggered || !ATOMIC_LOAD(&source->Run)) return GX_STATUS_INVALID_CALL;
+	
+	// Still busy with the previous trigger: ignored, like a trigger during the exposure
+	if (ATOMIC_COMPARE_EXCHANGE(&source->TriggerPending, 2, 0) != 0) return GX_STATUS_SUCCESS;
+	
+	source->TriggerDueUs = GxStandInNowUs() + source->TriggerLatencyMs * 1000.0;
+	ATOMIC_STORE(&source->TriggerPending, 1);
+	
+	return GX_STATUS_SUCCESS;
+}
+
+// Generated and Dropped stay readable after the source stopped
+void GxStandInStop(struct gx_standin_s *source) {
+	
+	struct gx_standin_sync_s *sync = (struct gx_standin_sync_s *)source->Sync;
+	
+	ATOMIC_STORE(&source->Run, 0);
+	
+	if (sync != NULL) {
+	
+#ifdef _WIN32
+		if (sync->Started) {
+			WaitForSingleObject(sync->Thread, INFINITE);
+			CloseHandle(sync->Thread);
+		}
+		
+		if (sync->FrameReady != NULL) CloseHandle(sync->FrameReady);
+#else
+		if (sync->Started) pthread_join(sync->Thread, NULL);
+		
+		pthread_mutex_destroy(&sync->Lock);
+		pthread_cond_destroy(&sync->FrameReady);
+#endif
+
+		free(sync);
+		source->Sync = NULL;
+	}
+	
+	for (int i = 0; i < GX_STANDIN_BUFFERS; i++) {
+		free(source->Buffers[i]);
+		source->Buffers[i] = NULL;
+	}
+}
+
+// The polling thread must be gone before GxStandInStop
+GX_STATUS GxStandInGetImage(struct gx_standin_s *source, GX_FRAME_DATA *frameData, uint32_t timeoutMs) {
+	
+	struct gx_standin_sync_s *sync = (struct gx_standin_sync_s *)source->Sync;
+	
+	if (frameData == NULL || frameData->pImgBuf == NULL) return GX_STATUS_INVALID_PARAMETER;
+	if (sync == NULL || source->Callback != NULL) return GX_STATUS_INVALID_CALL;
+	
+	double deadlineUs = GxStandInNowUs() + timeoutMs * 1000.0;
+	
+	while (ATOMIC_LOAD(&source->Head) == ATOMIC_LOAD(&source->Tail)) {
+		
+		double remainingUs = deadlineUs - GxStandInNowUs();
+		
+		if (remainingUs <= 0 || !ATOMIC_LOAD(&source->Run)) return GX_STATUS_TIMEOUT;
+	
+#ifdef _WIN32
+		WaitForSingleObject(sync->FrameReady, (DWORD)(remainingUs / 1000.0) + 1);
+#else
+		struct timespec until;
+		
+		clock_gettime(CLOCK_REALTIME, &until);
+		until.tv_sec  += (time_t)(remainingUs / 1e6);
+		until.tv_nsec += (long)((remainingUs - (double)(time_t)(remainingUs / 1e6) * 1e6) * 1000.0);
+		if (until.tv_nsec >= 1000000000L) {
+			until.tv_sec++;
+			until.tv_nsec -= 1000000000L;
+		}
+		
+		pthread_mutex_lock(&sync->Lock);
+		if (ATOMIC_LOAD(&source->Head) == ATOMIC_LOAD(&source->Tail)) pthread_cond_timedwait(&sync->FrameReady, &sync->Lock, &until);
+		pthread_mutex_unlock(&sync->Lock);
+#endif
+	}
+	
+	long slot = ATOMIC_LOAD(&source->Tail) & (GX_STANDIN_BUFFERS - 1);
+	
+	memcpy(frameData->pImgBuf, source->Buffers[slot], (size_t)source->ImageBytes);
+	
+	frameData->nStatus      = GX_FRAME_STATUS_SUCCESS;
+	frameData->nWidth       = source->Width;
+	frameData->nHeight      = source->Height;
+	frameData->nPixelFormat = source->PixelFormat;
+	frameData->nImgSize     = source->ImageBytes;
+	frameData->nFrameID     = source->FrameIds[slot];
+	frameData->nTimestamp   = source->Timestamps[slot];
+	
+	// The slot is free again for the source thread
+	ATOMIC_INCREMENT(&source->Tail);
+	
+	return GX_STATUS_SUCCESS;
+}
+
+/***************************************************************************************************
+Load threads. Each one spins on floating point work at normal priority until GxStandInLoadStop.
+****************************************************************************************************/
+
+void GxStandInLoad(void) {
+	
+	volatile double sink = 1.0;
+	
+	while (ATOMIC_LOAD(&LoadRun)) {
+		for (int i = 0; i < 100000; i++) sink = sink * 1.0000001 + 1e-9;
+	}
+}
+
+#ifdef _WIN32
+DWORD WINAPI GxStandInLoadThreadFunction(LPVOID parameter) {
+#else
+void* GxStandInLoadThreadFunction(void *parameter) {
+#endif
+
+	(void)parameter;
+	GxStandInLoad();
+	return 0;
+}
+
+int GxStandInLoadStart(int threads) {
+	
+	GxStandInLoadStop();
+	
+	if (threads <= 0) return OK;
+	if (threads > GX_STANDIN_MAX_LOAD) threads = GX_STANDIN_MAX_LOAD;
+	
+	ATOMIC_STORE(&LoadRun, 1);
+	
+	for (int i = 0; i < threads; i++) {
+	
+#ifdef _WIN32
+		LoadThreads[i] = CreateThread(NULL, 0, GxStandInLoadThreadFunction, NULL, 0, NULL);
+		if (LoadThreads[i] == NULL) break;
+#else
+		if (pthread_create(&LoadThreads[i], NULL, GxStandInLoadThreadFunction, NULL) != 0) break;
+#endif
+
+		NumLoadThreads++;
+	}
+	
+	if (NumLoadThreads < threads) {
+		GxStandInLoadStop();
+		return CANCEL;
+	}
+	
+	return OK;
+}
+
+void GxStandInLoadStop(void) {
+	
+	ATOMIC_STORE(&LoadRun, 0);
+	
+	for (int i = 0; i < NumLoadThreads; i++) {
+	
+#ifdef _WIN32
+		WaitForSingleObject(LoadThreads[i], INFINITE);
+		CloseHandle(LoadThreads[i]);
+#else
+		pthread_join(LoadThreads[i], NULL);
+#endif
+	}
+	
+	NumLoadThreads = 0;
+}
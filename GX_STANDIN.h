@@ -0,0 +1,78 @@
+#ifndef GX_STANDIN_H
+#define GX_STANDIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "GxIAPI.h"
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Stand-in GxIAPI frame source. Makes synthetic frames at a fixed rate on its own thread, the way the
+SDK's stream thread does, so the callback and polling acquisition modes can be compared without a
+camera, against a frame clock we know:
+ callback  GxStandInStart with a GXCaptureCallBack. Every frame is handed to it on the source
+           thread, as GXRegisterCaptureCallback does. Frames that fall due while the callback is
+           still busy are dropped, their IDs are skipped.
+ polling   GxStandInStart without a callback. Frames go into a queue of GX_STANDIN_BUFFERS,
+           GxStandInGetImage takes the oldest one with the contract of GXGetImage (copied into
+           pImgBuf, GX_STATUS_TIMEOUT when none came). A frame that finds the queue full is dropped.
+ triggered GxStandInStartTriggered instead of GxStandInStart: no frame rate, one frame per
+           GxStandInSendTrigger (GX_COMMAND_TRIGGER_SOFTWARE), delivered TriggerLatencyMs later by
+           either of the two ways above. A trigger while the previous frame is still due is ignored,
+           as a camera ignores one during its exposure.
+nTimestamp is the host time the frame fell due (GxStandInNowUs, in ns), nFrameID counts from 1.
+
+GxStandInLoadStart / GxStandInLoadStop run busy threads at normal priority, the controlled load the
+two modes are compared under.
+****************************************************************************************************/
+
+#define GX_STANDIN_BUFFERS		4		// Polling queue depth, power of two
+#define GX_STANDIN_MAX_LOAD		64		// Load threads
+
+struct gx_standin_s {
+	
+	// Frames made
+	int Width;
+	int Height;
+	int32_t PixelFormat;
+	int32_t ImageBytes;
+	double FrameRate;
+	
+	// Software trigger mode
+	int Triggered;					// One frame per GxStandInSendTrigger instead of FrameRate
+	double TriggerLatencyMs;		// Trigger -> frame due
+	atomic_long_t TriggerPending;	// 0 = none, 1 = a frame is due at TriggerDueUs, 2 = being set
+	double TriggerDueUs;
+	
+	GXCaptureCallBack Callback;		// NULL = polling, see GxStandInGetImage
+	void *UserParam;				// pUserParam of the callback
+	
+	// Polling queue, one producer (the source thread) and one consumer
+	unsigned char *Buffers[GX_STANDIN_BUFFERS];
+	uint64_t FrameIds[GX_STANDIN_BUFFERS];
+	uint64_t Timestamps[GX_STANDIN_BUFFERS];
+	atomic_long_t Head;				// Frames queued so far
+	atomic_long_t Tail;				// Frames taken so far
+	
+	atomic_long_t Run;
+	atomic_long_t Generated;		// Frames that fell due
+	atomic_long_t Dropped;			// Of which never delivered
+	void *Sync;						// Thread and wake-up, platform specific
+};
+
+/***************************************************************************************************
+Stand-in GxIAPI Public Functions
+****************************************************************************************************/
+
+int       GxStandInStart    (struct gx_standin_s *source, int width, int height, int32_t pixelFormat, int32_t imageBytes,
+							 double frameRate, GXCaptureCallBack callback, void *userParam); // OK or CANCEL
+int       GxStandInStartTriggered(struct gx_standin_s *source, int width, int height, int32_t pixelFormat, int32_t imageBytes,
+								 double latencyMs, GXCaptureCallBack callback, void *userParam); // OK or CANCEL
+GX_STATUS GxStandInSendTrigger(struct gx_standin_s *source); // As GXSendCommand(GX_COMMAND_TRIGGER_SOFTWARE)
+void      GxStandInStop     (struct gx_standin_s *source);
+GX_STATUS GxStandInGetImage (struct gx_standin_s *source, GX_FRAME_DATA *frameData, uint32_t timeoutMs); // As GXGetImage
+double    GxStandInNowUs    (void); // Host clock of the frame timestamps
+int       GxStandInLoadStart(int threads); // Busy threads, OK or CANCEL
+void      GxStandInLoadStop (void);
+
+#endif
@@ -0,0 +1,102 @@
+#include "LATENCY_HIST.h"
+
+/***************************************************************************************************
+Latency Histogram Private Functions And Variables
+****************************************************************************************************/
+
+int LatencyHistBucket(uint32_t us);
+double LatencyHistBucketValue(int bucket);
+
+// Bucket of a value: exact below LATENCY_HIST_SUB_BUCKETS, then (octave, top 3 bits below the msb)
+int LatencyHistBucket(uint32_t us) {
+	
+	if (us < LATENCY_HIST_SUB_BUCKETS) return (int)us;
+	
+	int msb = 0;
+	uint32_t v = us;
+	
+	if (v >= 1u << 16) { v >>= 16; msb += 16; }
+	if (v >= 1u << 8)  { v >>= 8;  msb += 8; }
+	if (v >= 1u << 4)  { v >>= 4;  msb += 4; }
+	if (v >= 1u << 2)  { v >>= 2;  msb += 2; }
+	if (v >= 1u << 1)  { msb += 1; }
+	
+	int sub = (int)(us >> (msb - LATENCY_HIST_SUB_BITS)) & (LATENCY_HIST_SUB_BUCKETS - 1);
+	
+	return (msb - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_BUCKETS + sub;
+}
+
+// Middle of a bucket's range
+double LatencyHistBucketValue(int bucket) {
+	
+	if (bucket < LATENCY_HIST_SUB_BUCKETS) return (double)bucket;
+	
+	int shift = bucket / LATENCY_HIST_SUB_BUCKETS - 1;
+	int sub   = bucket % LATENCY_HIST_SUB_BUCKETS;
+	double low   = (double)(LATENCY_HIST_SUB_BUCKETS + sub) * (double)(1u << shift);
+	double width = (double)(1u << shift);
+	
+	return low + width / 2;
+}
+
+/***************************************************************************************************
+Record / Query
+****************************************************************************************************/
+
+void LatencyHistReset(struct latency_hist_s *hist) {
+	
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) ATOMIC_STORE(&hist->Buckets[i], 0);
+	
+	ATOMIC_STORE(&hist->Count, 0);
+	ATOMIC_STORE(&hist->MaxUs, 0);
+}
+
+void LatencyHistRecord(struct latency_hist_s *hist, double us) {
+	
+	uint32_t value = (us <= 0) ? 0 : (us >= 2147483647.0) ? 2147483647u : (uint32_t)us;
+	
+	ATOMIC_INCREMENT(&hist->Buckets[LatencyHistBucket(value)]);
+	ATOMIC_INCREMENT(&hist->Count);
+	
+	// Max, only contended when it actually grows
+	long max = ATOMIC_LOAD(&hist->MaxUs);
+	while ((long)value > max) {
+		long previous = ATOMIC_COMPARE_EXCHANGE(&hist->MaxUs, (long)value, max);
+		if (previous == max) break;
+		max = previous;
+	}
+}
+
+double LatencyHistPercentile(struct latency_hist_s *hist, double percentile) {
+	
+	long total = 0;
+	
+	// Sum the buckets rather than trust Count, a recorder may be between its two increments
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) total += ATOMIC_LOAD(&hist->Buckets[i]);
+	
+	if (total == 0) return 0;
+	
+	if (percentile >= 100) return (double)ATOMIC_LOAD(&hist->MaxUs);
+	
+	long rank = (long)(percentile / 100.0 * (double)total);
+	long seen = 0;
+	
+	for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+		
+		seen += ATOMIC_LOAD(&hist->Buckets[i]);
+		
+		if (seen > rank) {
+			// Never report more than the largest value recorded
+			double value = LatencyHistBucketValue(i);
+			double max   = (double)ATOMIC_LOAD(&hist->MaxUs);
+			return (value < max) ? value : max;
+		}
+	}
+	
+	return (double)ATOMIC_LOAD(&hist->MaxUs);
+}
+
+long LatencyHistCount(struct latency_hist_s *hist) {
+	
+	return ATOMIC_LOAD(&hist->Count);
+}
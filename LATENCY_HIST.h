@@ -0,0 +1,36 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Lock-free log-bucketed latency histogram, in microseconds.
+
+Values below 8us get a bucket each, above that every power of two is split into 8 buckets, so a
+bucket is never wider than 1/8 of its value (percentiles within ~6%) and 232 buckets cover up to
+~35 minutes. Recording is one bucket lookup and two atomic increments, any thread may record and
+read at any time. Readers see a histogram that may be a few samples behind, never a torn one.
+****************************************************************************************************/
+
+#define LATENCY_HIST_SUB_BITS		3
+#define LATENCY_HIST_SUB_BUCKETS	(1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_BUCKETS		((31 - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_BUCKETS) // Values up to 2^31-1 us
+
+struct latency_hist_s {
+	
+	atomic_long_t Buckets[LATENCY_HIST_BUCKETS];
+	atomic_long_t Count;
+	atomic_long_t MaxUs;
+};
+
+/***************************************************************************************************
+Latency Histogram Public Functions
+****************************************************************************************************/
+
+void   LatencyHistReset      (struct latency_hist_s *hist);
+void   LatencyHistRecord     (struct latency_hist_s *hist, double us);
+double LatencyHistPercentile (struct latency_hist_s *hist, double percentile); // percentile 0..100, in us, 0 if empty
+long   LatencyHistCount      (struct latency_hist_s *hist);
+
+#endif
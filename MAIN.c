@@ -1,179 +1,227 @@
-#include "MAIN.h"
-
-/***************************************************************************************************
-Panels, global variables, functions 
-****************************************************************************************************/
-
-// Panels
-static int p_main;         // Handle to main panel
-static int p_title;        // Handle to the "TITLEPANEL" (loading panel)
-
-// Functions
-int setupCameras(void); // Set up the three cameras
-void camera_run(void); // Run the camera UI
-
-/***************************************************************************************************
-LabWindows/CVI entry point. The main function, Runs at program start.
-****************************************************************************************************/
-
-void main (void)  {
-	
-    if ((p_main = LoadPanel (0, "camera_test_program.uir", MAIN)) < 0)
-        return;
-    
-    if ((p_title = LoadPanel (0, "camera_test_program.uir", TITLEPANEL)) < 0)
-        return;
-    
-    // Show loading panel
-    DisplayPanel (p_title);
-	
-	SetCtrlVal(p_title, TITLEPANEL_loading_msg, "Configuring Cameras...");
-
-    // Set up cameras
-    if (setupCameras() == CANCEL) {
-		
-        MessagePopup("Fatal Error", "Failed to initialize the camera. Closing.");
-        QuitUserInterface(0);
-        return;
-    }
-    
-    // Hide loading panel, show main panel
-    HidePanel (p_title);
-    DisplayPanel (p_main);
-	SetPanelAttribute (p_main, ATTR_WINDOW_ZOOM, VAL_MAXIMIZE); // center and maximize
-
-    // Start the main UI loop (which calls camera_run logic)
-    camera_run();
-    RunUserInterface ();
-}
-
-/***************************************************************************************************
-Camera SETUP function. Called at program start by the MAIN function. 
-****************************************************************************************************/
-
-int setupCameras(void) {
-	
-    GX_STATUS emStatus = GX_STATUS_SUCCESS;
-	
-	// Settings Camera 1
-	strcpy((char *)cameraOne.SerialNumber, "FCU24100XXX");
-	cameraOne.Gain = 0;
-	cameraOne.GainMode = 0;
-	cameraOne.AutoGainMin = 0;
-	cameraOne.AutoGainMax = 24;
-	cameraOne.ExposureTime = 10000;
-	cameraOne.ExposureTimeMode = 0;
-	cameraOne.AutoExposureTimeMin = 10;
-	cameraOne.AutoExposureTimeMax = 1000000;
-	cameraOne.UseCrosshair = 1;
-	cameraOne.CrosshairSize = 10;
-	cameraOne.CrosshairThickness = 3;
-	cameraOne.CrosshairColor = 16711680;
-	cameraOne.CrosshairX = 2012;
-	cameraOne.CrosshairY = 1518;
-	
-	// Settings Camera 2
-	strcpy((char *)cameraTwo.SerialNumber, "FCU24100XXX");
-	cameraTwo.Gain = 0;
-	cameraTwo.GainMode = 0;
-	cameraTwo.AutoGainMin = 0;
-	cameraTwo.AutoGainMax = 24;
-	cameraTwo.ExposureTime = 10000;
-	cameraTwo.ExposureTimeMode = 0;
-	cameraTwo.AutoExposureTimeMin = 10;
-	cameraTwo.AutoExposureTimeMax = 1000000;
-	cameraTwo.UseCrosshair = 1;
-	cameraTwo.CrosshairSize = 10;
-	cameraTwo.CrosshairThickness = 3;
-	cameraTwo.CrosshairColor = 16711680;
-	cameraTwo.CrosshairX = 2012;
-	cameraTwo.CrosshairY = 1518;
-
-    // Open device
-    if (OpenDevice(&cameraOne) != GX_STATUS_SUCCESS) {
-		
-		MessagePopup("Fatal Error", "Failed to open the camera.");
-        return CANCEL;
-	}
-	
-    if (OpenDevice(&cameraTwo) != GX_STATUS_SUCCESS) {
-		
-		MessagePopup("Fatal Error", "Failed to open the camera.");
-        return CANCEL;
-	}
-
-    // Init camera parameters
-    emStatus = InitDevice(&cameraOne);
-    if (VERIFY_STATUS_RET(emStatus) != GX_STATUS_SUCCESS) return CANCEL;
-    emStatus = InitDevice(&cameraTwo);
-    if (VERIFY_STATUS_RET(emStatus) != GX_STATUS_SUCCESS) return CANCEL;
-
-    return OK;
-}
-
-/***************************************************************************************************
-Camera RUN function. Called at program start by the MAIN function. Handles the camera UI,
-which at this time only consists of a start and stop aquiring images button.
-****************************************************************************************************/
-
-void camera_run(void) {
-	
-    int control, panelHandle;
-	
-	// Set the canvas panel and control
-	cameraOne.panelHandle   = p_main;
-	cameraOne.canvasControl = MAIN_CANVAS_CAM_1;
-	cameraTwo.panelHandle   = p_main;
-	cameraTwo.canvasControl = MAIN_CANVAS_CAM_2;
-	
-	SetCtrlVal(p_main, MAIN_DOT_X_CAM_1, cameraOne.CrosshairX);
-	SetCtrlVal(p_main, MAIN_DOT_Y_CAM_1, cameraOne.CrosshairY);
-	SetCtrlVal(p_main, MAIN_DOT_X_CAM_2, cameraTwo.CrosshairX);
-	SetCtrlVal(p_main, MAIN_DOT_Y_CAM_2, cameraTwo.CrosshairY);
-	
-	
-
-    while (p_main >= 0) {
-		
-        // Wait for user events on this panel
-        GetUserEvent(1, &panelHandle, &control);
-
-        switch (control) {
-			
-            case MAIN_acquisition_start:
-                StartCameraAcquisition(&cameraOne);
-				StartCameraAcquisition(&cameraTwo);
-				
-			    // Create an async timer that fires every 1ms (0.5)
-			    // and calls UpdateCameraCallback
-			    cameraOne.timerId = NewAsyncTimer(0.5, -1, 1, (AsyncTimerCallbackPtr)UpdateCameraCallback, &cameraOne);
-				cameraTwo.timerId = NewAsyncTimer(0.5, -1, 1, (AsyncTimerCallbackPtr)UpdateCameraCallback, &cameraTwo);
-				
-                break;
-            
-            case MAIN_acquisition_stop:
-                StopCameraAcquisition(&cameraOne);
-				StopCameraAcquisition(&cameraTwo);
-                break;
-				
-            case MAIN_DOT_X_CAM_1:
-				if (cameraOne.UseCrosshair == 1) if (GetCtrlVal(panelHandle, MAIN_DOT_X_CAM_1, &cameraOne.CrosshairX) < 0) MessagePopup("Error", "Unable to read value from the textbox.");
-                break;
-				
-            case MAIN_DOT_Y_CAM_1:
-				if (cameraOne.UseCrosshair == 1) if (GetCtrlVal(panelHandle, MAIN_DOT_Y_CAM_1, &cameraOne.CrosshairY) < 0) MessagePopup("Error", "Unable to read value from the textbox.");
-                break;
-				
-            case MAIN_DOT_X_CAM_2:
-				if (cameraTwo.UseCrosshair == 1) if (GetCtrlVal(panelHandle, MAIN_DOT_X_CAM_2, &cameraTwo.CrosshairX) < 0) MessagePopup("Error", "Unable to read value from the textbox.");
-                break;
-				
-            case MAIN_DOT_Y_CAM_2:
-				if (cameraTwo.UseCrosshair == 1) if (GetCtrlVal(panelHandle, MAIN_DOT_Y_CAM_2, &cameraTwo.CrosshairY) < 0) MessagePopup("Error", "Unable to read value from the textbox.");
-                break;
-            
-            default:
-                break;
-        }
-    }
-}
+#include "MAIN.h"
+
+/***************************************************************************************************
+Panels, global variables, functions 
+****************************************************************************************************/
+
+// Panels
+static int p_main;         // Handle to main panel
+static int p_title;        // Handle to the "TITLEPANEL" (loading panel)
+
+// Functions
+int setupCameras(void); // Set up the cameras of the registry
+void ConfigureCamera(struct camera_s *cam);
+void camera_run(void); // Run the camera UI
+
+/***************************************************************************************************
+LabWindows/CVI entry point. The main function, Runs at program start.
+****************************************************************************************************/
+
+void main (void)  {
+	
+    if ((p_main = LoadPanel (0, "camera_test_program.uir", MAIN)) < 0)
+        return;
+    
+    if ((p_title = LoadPanel (0, "camera_test_program.uir", TITLEPANEL)) < 0)
+        return;
+    
+    // Show loading panel
+    DisplayPanel (p_title);
+	
+	SetCtrlVal(p_title, TITLEPANEL_loading_msg, "Configuring Cameras...");
+
+    // Set up cameras
+    if (setupCameras() == CANCEL) {
+		
+        MessagePopup("Fatal Error", "Failed to initialize the camera. Closing.");
+        QuitUserInterface(0);
+        return;
+    }
+    
+    // Hide loading panel, show main panel
+    HidePanel (p_title);
+    DisplayPanel (p_main);
+	SetPanelAttribute (p_main, ATTR_WINDOW_ZOOM, VAL_MAXIMIZE); // center and maximize
+
+    // Start the main UI loop (which calls camera_run logic)
+    camera_run();
+    RunUserInterface ();
+}
+
+/***************************************************************************************************
+Camera SETUP function. Called at program start by the MAIN function. Every serial number in
+CameraSerials gets a camera in the registry, the first MAX_CAMERA_CANVASES are shown on the panel.
+****************************************************************************************************/
+
+static const char *CameraSerials[] = {
+	"FCU24100XXX",
+	"FCU24100YYY",
+};
+
+#define NUM_CAMERAS (int)(sizeof(CameraSerials) / sizeof(CameraSerials[0]))
+
+// Settings shared by every camera
+void ConfigureCamera(struct camera_s *cam) {
+	
+	cam->Gain = 0;
+	cam->GainMode = 0;
+	cam->AutoGainMin = 0;
+	cam->AutoGainMax = 24;
+	cam->ExposureTime = 10000;
+	cam->ExposureTimeMode = 0;
+	cam->AutoExposureTimeMin = 10;
+	cam->AutoExposureTimeMax = 1000000;
+	cam->ChunkData = 1; // Per-frame exposure/gain in the auto modes, needs ChunkExposureTime / ChunkGain of the model
+	cam->UseCrosshair = 1;
+	cam->CrosshairSize = 10;
+	cam->CrosshairThickness = 3;
+	cam->CrosshairColor = 16711680;
+	cam->CrosshairX = 2012;
+	cam->CrosshairY = 1518;
+	cam->TriggerMode = GX_TRIGGER_MODE_OFF;
+	cam->TriggerSource = GX_TRIGGER_SOURCE_SOFTWARE;
+	cam->TriggerActivation = GX_TRIGGER_ACTIVATION_RISINGEDGE;
+	cam->StreamBufferMode = GX_DS_STREAM_BUFFER_HANDLING_MODE_NEWEST_ONLY; // Live preview, show the latest frame
+	cam->AcqBufferCount = 0; // Sized at start
+	cam->PixelBitDepth = 8; // 10/12 for the full sensor depth
+	cam->PackedPixels = TRUE;
+	cam->DemosaicQuality = DEMOSAIC_BILINEAR; // DEMOSAIC_NEAREST for the cheapest preview
+	cam->ConvertThreads = 0; // Frame conversion on every core, the cameras share them
+	cam->ToneGamma = 1.0; // Display tone curve, with ToneContrast / ToneLightness, applied during the conversion
+	cam->TargetFrameRate = 0; // As fast as the shared link allows
+	cam->BandwidthWeight = 1;
+	cam->AutoReconnect = TRUE; // Reopen and restart after a cable/link drop
+	cam->ExposureEvents = TRUE; // Exposure end time of every frame
+}
+
+int setupCameras(void) {
+	
+    GX_STATUS emStatus = GX_STATUS_SUCCESS;
+	struct camera_s *cams[CAMERA_REGISTRY_MAX];
+	struct camera_s *readyCams[CAMERA_REGISTRY_MAX];
+	int numCams  = 0;
+	int numReady = 0;
+	
+	for (int i = 0; i < NUM_CAMERAS; i++) {
+		
+		struct camera_s *cam = CameraRegistryAdd(CameraSerials[i]);
+		
+		if (cam == NULL) {
+			printf("Camera %s not added (duplicate, or more than %d cameras).\n", CameraSerials[i], CAMERA_REGISTRY_MAX);
+			continue;
+		}
+		
+		ConfigureCamera(cam);
+		cams[numCams++] = cam;
+	}
+
+	// Cold-start time of all cameras, enumeration + open + init
+	double startMs = GetHostTimeMs();
+
+    // Open and init all cameras at once, a camera that fails does not stop the others
+	BringUpCameras(cams, numCams);
+	
+	for (int i = 0; i < numCams; i++) {
+		
+		if (cams[i]->BringUpStatus == GX_STATUS_SUCCESS) {
+			readyCams[numReady++] = cams[i];
+			continue;
+		}
+		
+		// The only report of the failure, OpenDevice / InitDevice ran on worker threads
+		char msg[512];
+		sprintf(msg, "Camera %s failed to start (%d), continuing without it.\n\n%s", cams[i]->SerialNumber, cams[i]->BringUpStatus, cams[i]->BringUpError);
+		MessagePopup("Camera Error", msg);
+		
+		CameraRegistryRemove(cams[i]);
+	}
+	
+	if (numReady == 0) {
+		
+		MessagePopup("Fatal Error", "Failed to open the cameras.");
+        return CANCEL;
+	}
+	
+	// The cameras share one USB3 host controller (~350 MB/s usable)
+	emStatus = PlanCameraBandwidth(readyCams, numReady, 350e6);
+	if (emStatus != GX_STATUS_SUCCESS) ShowErrorString(emStatus);
+	
+	printf("%d camera(s) ready in %.0f ms.\n", numReady, GetHostTimeMs() - startMs);
+
+    return OK;
+}
+
+/***************************************************************************************************
+Camera RUN function. Called at program start by the MAIN function. Handles the camera UI,
+which at this time only consists of a start and stop aquiring images button.
+
+The panel has a canvas and crosshair controls for the first MAX_CAMERA_CANVASES cameras of the
+registry, the other cameras acquire without a display.
+****************************************************************************************************/
+
+#define MAX_CAMERA_CANVASES 2
+
+static const int CanvasControls[MAX_CAMERA_CANVASES]    = {MAIN_CANVAS_CAM_1, MAIN_CANVAS_CAM_2};
+static const int CrosshairXControls[MAX_CAMERA_CANVASES] = {MAIN_DOT_X_CAM_1, MAIN_DOT_X_CAM_2};
+static const int CrosshairYControls[MAX_CAMERA_CANVASES] = {MAIN_DOT_Y_CAM_1, MAIN_DOT_Y_CAM_2};
+
+void camera_run(void) {
+	
+    int control, panelHandle;
+	
+	// Set the canvas panel and control
+	for (int i = 0; i < MAX_CAMERA_CANVASES; i++) {
+		
+		struct camera_s *cam = CameraRegistryAt(i);
+		if (cam == NULL) break;
+		
+		cam->panelHandle   = p_main;
+		cam->canvasControl = CanvasControls[i];
+		
+		SetCtrlVal(p_main, CrosshairXControls[i], cam->CrosshairX);
+		SetCtrlVal(p_main, CrosshairYControls[i], cam->CrosshairY);
+	}
+
+    while (p_main >= 0) {
+		
+        // Wait for user events on this panel
+        GetUserEvent(1, &panelHandle, &control);
+
+        switch (control) {
+			
+            case MAIN_acquisition_start:
+				for (int i = 0; i < CameraRegistryCount(); i++) {
+					
+					struct camera_s *cam = CameraRegistryAt(i);
+					
+	                StartCameraAcquisition(cam);
+					
+				    // Create an async timer that fires every 1ms (0.5)
+				    // and calls UpdateCameraCallback, for the cameras with a canvas
+				    if (i < MAX_CAMERA_CANVASES) cam->timerId = NewAsyncTimer(0.5, -1, 1, (AsyncTimerCallbackPtr)UpdateCameraCallback, cam);
+				}
+                break;
+            
+            case MAIN_acquisition_stop:
+				for (int i = 0; i < CameraRegistryCount(); i++) StopCameraAcquisition(CameraRegistryAt(i));
+                break;
+            
+            default:
+				
+				// Crosshair position boxes
+				for (int i = 0; i < MAX_CAMERA_CANVASES; i++) {
+					
+					struct camera_s *cam = CameraRegistryAt(i);
+					if (cam == NULL || cam->UseCrosshair != 1) continue;
+					
+					if (control == CrosshairXControls[i]) {
+						if (GetCtrlVal(panelHandle, CrosshairXControls[i], &cam->CrosshairX) < 0) MessagePopup("Error", "Unable to read value from the textbox.");
+					}
+					else if (control == CrosshairYControls[i]) {
+						if (GetCtrlVal(panelHandle, CrosshairYControls[i], &cam->CrosshairY) < 0) MessagePopup("Error", "Unable to read value from the textbox.");
+					}
+				}
+                break;
+        }
+    }
+}
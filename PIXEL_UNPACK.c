@@ -0,0 +1,248 @@
+#include "PIXEL_UNPACK.h"
+#include <string.h>
+
+#ifdef PIXEL_UNPACK_SIMD
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+/***************************************************************************************************
+Pixel Unpack Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define PIXEL_MONO_FLAG		0x01000000
+#define PIXEL_BITS_MASK		0x00FF0000	// Bits per pixel in the stream (12 for the packed formats)
+
+int PixelCpuHasSsse3(void);
+
+/***************************************************************************************************
+Formats
+****************************************************************************************************/
+
+int PixelFormatBits(int pixelFormat, int *packed) {
+	
+	*packed = FALSE;
+	
+	if (!(pixelFormat & PIXEL_MONO_FLAG)) return 0; // RGB/YUV, not handled here
+	
+	switch (pixelFormat) {
+		
+		case PIXEL_FORMAT_MONO10_PACKED:
+		case PIXEL_FORMAT_BAYER_GR10_PACKED:
+		case PIXEL_FORMAT_BAYER_RG10_PACKED:
+		case PIXEL_FORMAT_BAYER_GB10_PACKED:
+		case PIXEL_FORMAT_BAYER_BG10_PACKED:
+			*packed = TRUE;
+			return 10;
+			
+		case PIXEL_FORMAT_MONO12_PACKED:
+		case PIXEL_FORMAT_BAYER_GR12_PACKED:
+		case PIXEL_FORMAT_BAYER_RG12_PACKED:
+		case PIXEL_FORMAT_BAYER_GB12_PACKED:
+		case PIXEL_FORMAT_BAYER_BG12_PACKED:
+			*packed = TRUE;
+			return 12;
+			
+		case 0x01100003: // Mono10
+		case 0x0110000C: case 0x0110000D: case 0x0110000E: case 0x0110000F: // Bayer xx10
+			return 10;
+			
+		case 0x01100005: // Mono12
+		case 0x01100010: case 0x01100011: case 0x01100012: case 0x01100013: // Bayer xx12
+			return 12;
+	}
+	
+	return ((pixelFormat & PIXEL_BITS_MASK) >> 16 == 8) ? 8 : 16;
+}
+
+size_t PixelFormatBytes(int pixelFormat, size_t pixels) {
+	
+	int packed = FALSE;
+	int bits   = PixelFormatBits(pixelFormat, &packed);
+	
+	if (packed)    return (pixels * 3 + 1) / 2;
+	if (bits > 8)  return pixels * 2;
+	
+	return pixels;
+}
+
+/***************************************************************************************************
+Scalar kernels, the reference for the SIMD ones. An odd pixel count ends with half a group.
+****************************************************************************************************/
+
+void PixelUnpack12Scalar(const uint8_t *src, uint16_t *dst, size_t pixels) {
+	
+	size_t pairs = pixels / 2;
+	
+	for (size_t i = 0; i < pairs; i++, src += 3, dst += 2) {
+		dst[0] = (uint16_t)((src[0] << 4) | (src[1] & 0x0F));
+		dst[1] = (uint16_t)((src[2] << 4) | (src[1] >> 4));
+	}
+	
+	if (pixels & 1) dst[0] = (uint16_t)((src[0] << 4) | (src[1] & 0x0F));
+}
+
+void PixelUnpack10Scalar(const uint8_t *src, uint16_t *dst, size_t pixels) {
+	
+	size_t pairs = pixels / 2;
+	
+	for (size_t i = 0; i < pairs; i++, src += 3, dst += 2) {
+		dst[0] = (uint16_t)((src[0] << 2) | (src[1] & 0x03));
+		dst[1] = (uint16_t)((src[2] << 2) | ((src[1] >> 4) & 0x03));
+	}
+	
+	if (pixels & 1) dst[0] = (uint16_t)((src[0] << 2) | (src[1] & 0x03));
+}
+
+/***************************************************************************************************
+SSSE3 kernels. 12 input bytes (8 pixels) per step, loaded 16 at a time, so the loop stops while 16
+bytes are still readable and the scalar kernel does the tail.
+
+Every pixel gets the 16-bit word (hi << 8 | mid), hi being its own full byte and mid the shared
+middle byte: even pixels (b0, b1), odd pixels (b2, b1). Then
+ 12-bit  even: (w >> 4) & 0x0FF0 | w & 0x000F        odd: w >> 4
+ 10-bit  even: (w >> 6) & 0x03FC | w & 0x0003        odd: (w >> 6) & 0x03FC | (w >> 4) & 0x0003
+****************************************************************************************************/
+
+#ifdef PIXEL_UNPACK_SIMD
+
+void PixelUnpack12Ssse3(const uint8_t *src, uint16_t *dst, size_t pixels) {
+	
+	const __m128i shuffle = _mm_setr_epi8(1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11);
+	const __m128i highMask = _mm_setr_epi16(0x0FF0, 0x0FFF, 0x0FF0, 0x0FFF, 0x0FF0, 0x0FFF, 0x0FF0, 0x0FFF);
+	const __m128i lowMask  = _mm_setr_epi16(0x000F, 0, 0x000F, 0, 0x000F, 0, 0x000F, 0);
+	size_t done = 0;
+	
+	// 8 pixels use 12 bytes, the 16-byte load must stay inside the buffer
+	while (pixels - done >= 16) {
+		
+		__m128i words = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src), shuffle);
+		__m128i value = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(words, 4), highMask), _mm_and_si128(words, lowMask));
+		
+		_mm_storeu_si128((__m128i *)dst, value);
+		
+		src  += 12;
+		dst  += 8;
+		done += 8;
+	}
+	
+	PixelUnpack12Scalar(src, dst, pixels - done);
+}
+
+void PixelUnpack10Ssse3(const uint8_t *src, uint16_t *dst, size_t pixels) {
+	
+	const __m128i shuffle = _mm_setr_epi8(1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11);
+	const __m128i highMask = _mm_set1_epi16(0x03FC);
+	const __m128i evenMask = _mm_setr_epi16(0x0003, 0, 0x0003, 0, 0x0003, 0, 0x0003, 0);
+	const __m128i oddMask  = _mm_setr_epi16(0, 0x0003, 0, 0x0003, 0, 0x0003, 0, 0x0003);
+	size_t done = 0;
+	
+	while (pixels - done >= 16) {
+		
+		__m128i words = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src), shuffle);
+		__m128i value = _mm_and_si128(_mm_srli_epi16(words, 6), highMask);
+		
+		value = _mm_or_si128(value, _mm_and_si128(words, evenMask));
+		value = _mm_or_si128(value, _mm_and_si128(_mm_srli_epi16(words, 4), oddMask));
+		
+		_mm_storeu_si128((__m128i *)dst, value);
+		
+		src  += 12;
+		dst  += 8;
+		done += 8;
+	}
+	
+	PixelUnpack10Scalar(src, dst, pixels - done);
+}
+
+#endif
+
+int PixelCpuHasSsse3(void) {
+	
+#ifdef PIXEL_UNPACK_SIMD
+	int info[4] = {0};
+	
+#ifdef _MSC_VER
+	__cpuid(info, 1);
+#else
+	unsigned int a, b, c, d;
+	if (!__get_cpuid(1, &a, &b, &c, &d)) return FALSE;
+	info[2] = (int)c;
+#endif
+	
+	return (info[2] & (1 << 9)) != 0; // ECX bit 9 = SSSE3
+#else
+	return FALSE;
+#endif
+}
+
+int PixelUnpackHasSimd(void) {
+	
+	static int hasSimd = -1;
+	
+	if (hasSimd < 0) hasSimd = PixelCpuHasSsse3();
+	
+	return hasSimd;
+}
+
+/***************************************************************************************************
+Dispatch / preview
+****************************************************************************************************/
+
+int PixelUnpack(const uint8_t *src, uint16_t *dst, size_t pixels, int bits, int packed) {
+	
+	if (!packed) {
+		
+		if (bits <= 8) {
+			for (size_t i = 0; i < pixels; i++) dst[i] = src[i];
+		}
+		else memcpy(dst, src, pixels * 2); // Already 16 bit, little endian
+		
+		return OK;
+	}
+	
+#ifdef PIXEL_UNPACK_SIMD
+	if (PixelUnpackHasSimd()) {
+		
+		if (bits == 12) { PixelUnpack12Ssse3(src, dst, pixels); return OK; }
+		if (bits == 10) { PixelUnpack10Ssse3(src, dst, pixels); return OK; }
+	}
+#endif
+	
+	if (bits == 12) { PixelUnpack12Scalar(src, dst, pixels); return OK; }
+	if (bits == 10) { PixelUnpack10Scalar(src, dst, pixels); return OK; }
+	
+	return CANCEL;
+}
+
+void PixelRaw16ToPreview8(const uint16_t *src, uint8_t *dst, size_t pixels, int bits) {
+	
+	int shift = (bits > 8) ? bits - 8 : 0;
+	size_t i = 0;
+	
+#ifdef PIXEL_UNPACK_SIMD
+	__m128i count = _mm_cvtsi32_si128(shift);
+	
+	for (; i + 16 <= pixels; i += 16) {
+		
+		__m128i a = _mm_srl_epi16(_mm_loadu_si128((const __m128i *)(src + i)), count);
+		__m128i b = _mm_srl_epi16(_mm_loadu_si128((const __m128i *)(src + i + 8)), count);
+		
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, b));
+	}
+#endif
+	
+	for (; i < pixels; i++) {
+		unsigned int v = (unsigned int)src[i] >> shift;
+		dst[i] = (uint8_t)((v > 255) ? 255 : v);
+	}
+}
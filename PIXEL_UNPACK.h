@@ -0,0 +1,56 @@
+#ifndef PIXEL_UNPACK_H
+#define PIXEL_UNPACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/***************************************************************************************************
+High bit depth pixel formats. 10/12-bit frames arrive either unpacked (one little-endian 16-bit
+word per pixel) or packed, two pixels in three bytes (GigE Vision Mono10Packed / Mono12Packed, the
+layout DxRaw10PackedToRaw16 / DxRaw12PackedToRaw16 read):
+
+ 12-bit packed   byte0 = p0[11:4]   byte1 = p1[3:0] << 4 | p0[3:0]          byte2 = p1[11:4]
+ 10-bit packed   byte0 = p0[9:2]    byte1 = p1[1:0] << 4 | p0[1:0]          byte2 = p1[9:2]
+
+Unpacking writes right-aligned 16-bit values (0..1023 / 0..4095), the same as the SDK functions.
+The SIMD kernels (SSSE3, 8 pixels per step) produce exactly the scalar result, PixelUnpack picks
+them at run time when the CPU has SSSE3. The 8-bit preview keeps the top 8 bits, like
+DxRaw16toRaw8 with DX_BIT_2_9 / DX_BIT_4_11.
+****************************************************************************************************/
+
+// Packed formats, GenICam PFNC codes (the same values as GX_PIXEL_FORMAT_xxx_PACKED in newer GxIAPI)
+#define PIXEL_FORMAT_MONO10_PACKED		0x010C0004
+#define PIXEL_FORMAT_MONO12_PACKED		0x010C0006
+#define PIXEL_FORMAT_BAYER_GR10_PACKED	0x010C0026
+#define PIXEL_FORMAT_BAYER_RG10_PACKED	0x010C0027
+#define PIXEL_FORMAT_BAYER_GB10_PACKED	0x010C0028
+#define PIXEL_FORMAT_BAYER_BG10_PACKED	0x010C0029
+#define PIXEL_FORMAT_BAYER_GR12_PACKED	0x010C002A
+#define PIXEL_FORMAT_BAYER_RG12_PACKED	0x010C002B
+#define PIXEL_FORMAT_BAYER_GB12_PACKED	0x010C002C
+#define PIXEL_FORMAT_BAYER_BG12_PACKED	0x010C002D
+
+// SSSE3 kernels need a compiler with the intrinsics, define PIXEL_UNPACK_NO_SIMD to leave them out
+#if !defined(PIXEL_UNPACK_NO_SIMD) && (defined(__SSSE3__) || (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))))
+#define PIXEL_UNPACK_SIMD 1
+#endif
+
+/***************************************************************************************************
+Pixel Unpack Public Functions
+****************************************************************************************************/
+
+int  PixelFormatBits     (int pixelFormat, int *packed); // Significant bits (8/10/12/16) of a GX pixel format, 0 if not raw/mono
+size_t PixelFormatBytes  (int pixelFormat, size_t pixels); // Bytes of a frame of that many pixels
+
+int  PixelUnpack         (const uint8_t *src, uint16_t *dst, size_t pixels, int bits, int packed); // Any raw format -> 16 bit, OK (1) or CANCEL (-1)
+void PixelUnpack12Scalar (const uint8_t *src, uint16_t *dst, size_t pixels);
+void PixelUnpack10Scalar (const uint8_t *src, uint16_t *dst, size_t pixels);
+int  PixelUnpackHasSimd  (void); // TRUE if PixelUnpack uses the SSSE3 kernels
+#ifdef PIXEL_UNPACK_SIMD
+void PixelUnpack12Ssse3  (const uint8_t *src, uint16_t *dst, size_t pixels);
+void PixelUnpack10Ssse3  (const uint8_t *src, uint16_t *dst, size_t pixels);
+#endif
+
+void PixelRaw16ToPreview8 (const uint16_t *src, uint8_t *dst, size_t pixels, int bits); // Top 8 of the significant bits
+
+#endif
@@ -0,0 +1,135 @@
+#include "RECONNECT.h"
+#include <string.h>
+
+/***************************************************************************************************
+Reconnect Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+void ReconnectRetryLater(struct reconnect_s *reconnect, double nowMs);
+
+void ReconnectRetryLater(struct reconnect_s *reconnect, double nowMs) {
+	
+	double retryMs = (reconnect->RetryIntervalMs > 0) ? reconnect->RetryIntervalMs : RECONNECT_DEFAULT_RETRY_MS;
+	
+	if (reconnect->MaxAttempts > 0 && reconnect->Attempts >= reconnect->MaxAttempts) {
+		ATOMIC_STORE(&reconnect->State, RECONNECT_FAILED);
+		return;
+	}
+	
+	reconnect->NextAttemptMs = nowMs + retryMs;
+	ATOMIC_STORE(&reconnect->State, RECONNECT_SEARCHING);
+}
+
+/***************************************************************************************************
+Setup
+****************************************************************************************************/
+
+void ReconnectInit(struct reconnect_s *reconnect, const struct reconnect_ops_s *ops, void *device) {
+	
+	double retryMs  = reconnect->RetryIntervalMs;
+	int maxAttempts = reconnect->MaxAttempts;
+	
+	memset(reconnect, 0, sizeof(*reconnect));
+	
+	// Settings survive the reset
+	reconnect->RetryIntervalMs = retryMs;
+	reconnect->MaxAttempts     = maxAttempts;
+	reconnect->Ops             = ops;
+	reconnect->Device          = device;
+	
+	ATOMIC_STORE(&reconnect->State, RECONNECT_ONLINE);
+}
+
+void ReconnectReset(struct reconnect_s *reconnect) {
+	
+	reconnect->Attempts = 0;
+	ATOMIC_STORE(&reconnect->State, RECONNECT_ONLINE);
+}
+
+int ReconnectState(struct reconnect_s *reconnect) {
+	
+	return (int)ATOMIC_LOAD(&reconnect->State);
+}
+
+/***************************************************************************************************
+Events / steps
+****************************************************************************************************/
+
+int ReconnectOffline(struct reconnect_s *reconnect) {
+	
+	// Only an online device starts an outage, a second event during recovery is part of the same one
+	if (ATOMIC_COMPARE_EXCHANGE(&reconnect->State, RECONNECT_OFFLINE, RECONNECT_ONLINE) != RECONNECT_ONLINE) return FALSE;
+	
+	reconnect->OfflineTimeMs = reconnect->Ops->NowMs();
+	reconnect->Attempts      = 0;
+	reconnect->Outages++;
+	
+	return TRUE;
+}
+
+int ReconnectStep(struct reconnect_s *reconnect) {
+	
+	const struct reconnect_ops_s *ops = reconnect->Ops;
+	double nowMs = ops->NowMs();
+	
+	switch (ATOMIC_LOAD(&reconnect->State)) {
+		
+		case RECONNECT_OFFLINE:
+			
+			ops->Close(reconnect->Device);
+			reconnect->NextAttemptMs = nowMs;
+			ATOMIC_STORE(&reconnect->State, RECONNECT_SEARCHING);
+			break;
+			
+		case RECONNECT_SEARCHING:
+			
+			if (nowMs < reconnect->NextAttemptMs) break;
+			
+			reconnect->Attempts++;
+			
+			if (!ops->Find(reconnect->Device)) {
+				ReconnectRetryLater(reconnect, nowMs);
+				break;
+			}
+			
+			if (ops->Open(reconnect->Device) == OK) ATOMIC_STORE(&reconnect->State, RECONNECT_RESTORING);
+			else {
+				
+				// A half opened device can still hold the handle or the stream
+				ops->Close(reconnect->Device);
+				ReconnectRetryLater(reconnect, nowMs);
+			}
+			break;
+			
+		case RECONNECT_RESTORING:
+			
+			if (ops->Restore(reconnect->Device) == OK && ops->Start(reconnect->Device) == OK) {
+				
+				double recoveryMs = ops->NowMs() - reconnect->OfflineTimeMs;
+				
+				reconnect->Recoveries++;
+				reconnect->LastRecoveryMs  = recoveryMs;
+				reconnect->MeanRecoveryMs += (recoveryMs - reconnect->MeanRecoveryMs) / reconnect->Recoveries;
+				if (recoveryMs > reconnect->MaxRecoveryMs) reconnect->MaxRecoveryMs = recoveryMs;
+				
+				ATOMIC_STORE(&reconnect->State, RECONNECT_ONLINE);
+			}
+			else {
+				
+				// Dropped again while restoring, or the device refused the parameters
+				ops->Close(reconnect->Device);
+				ReconnectRetryLater(reconnect, ops->NowMs());
+			}
+			break;
+			
+		default:
+			break;
+	}
+	
+	return (int)ATOMIC_LOAD(&reconnect->State);
+}
@@ -0,0 +1,66 @@
+#ifndef RECONNECT_H
+#define RECONNECT_H
+
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Reconnect state machine for a device that can drop offline (cable pulled, GigE link blip):
+
+ ONLINE --offline event--> OFFLINE --close dead handle--> SEARCHING --found and opened--> RESTORING
+ RESTORING --parameters reapplied, acquisition restarted--> ONLINE
+ RESTORING --failed--> SEARCHING (retry)        SEARCHING --MaxAttempts used up--> FAILED
+
+The device and the clock are only reached through the reconnect_ops_s callbacks, so the machine
+runs the same against a camera or a fake device (and fake clock) that drops offline on command.
+ReconnectOffline may be called from any thread (the SDK's offline callback), ReconnectStep from
+one thread only, which may block in the callbacks.
+****************************************************************************************************/
+
+#define RECONNECT_ONLINE		0
+#define RECONNECT_OFFLINE		1
+#define RECONNECT_SEARCHING		2
+#define RECONNECT_RESTORING		3
+#define RECONNECT_FAILED		4
+
+#define RECONNECT_DEFAULT_RETRY_MS	250
+
+struct reconnect_ops_s {
+	int  (*Find)    (void *device);	// TRUE when the device is visible again
+	int  (*Open)    (void *device);	// OK (1) / CANCEL (-1)
+	int  (*Restore) (void *device);	// Reapply the last known parameters, OK / CANCEL
+	int  (*Start)   (void *device);	// Restart acquisition if it was running, OK / CANCEL
+	void (*Close)   (void *device);	// Release the dead handle, must work on a device that is gone
+	double (*NowMs) (void);			// Clock of the recovery times
+};
+
+struct reconnect_s {
+	
+	atomic_long_t State;			// RECONNECT_xxx
+	const struct reconnect_ops_s *Ops;
+	void *Device;
+	
+	double RetryIntervalMs;			// Between two searches, 0 = RECONNECT_DEFAULT_RETRY_MS
+	int MaxAttempts;				// Searches before giving up, 0 = never give up
+	int Attempts;					// Searches of the current outage
+	double NextAttemptMs;
+	
+	// Time to recovery, offline event -> acquisition running again
+	double OfflineTimeMs;
+	long Outages;
+	long Recoveries;
+	double LastRecoveryMs;
+	double MeanRecoveryMs;
+	double MaxRecoveryMs;
+};
+
+/***************************************************************************************************
+Reconnect Public Functions
+****************************************************************************************************/
+
+void ReconnectInit    (struct reconnect_s *reconnect, const struct reconnect_ops_s *ops, void *device);
+int  ReconnectOffline (struct reconnect_s *reconnect); // TRUE if this starts a new outage
+int  ReconnectStep    (struct reconnect_s *reconnect); // One step, returns the new state
+int  ReconnectState   (struct reconnect_s *reconnect);
+void ReconnectReset   (struct reconnect_s *reconnect); // Back to ONLINE, e.g. after FAILED and a manual reopen
+
+#endif
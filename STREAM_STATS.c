@@ -0,0 +1,87 @@
+#include "STREAM_STATS.h"
+#include <string.h>
+
+/***************************************************************************************************
+Stream Stats Private Functions And Variables
+****************************************************************************************************/
+
+#define CANCEL      -1
+#define OK			1
+
+/***************************************************************************************************
+Writer
+****************************************************************************************************/
+
+void StreamStatsReset(struct stream_stats_ring_s *ring) {
+	
+	ATOMIC_STORE(&ring->Head, 0);
+	
+	ring->LastAvailable = 0;
+	ring->LastTimeMs    = 0;
+	ring->HasLast       = 0;
+}
+
+void StreamStatsRecord(struct stream_stats_ring_s *ring, double timeMs, const int64_t *counters, unsigned int available, double hostCpuPercent) {
+	
+	long head = ATOMIC_LOAD(&ring->Head);
+	struct stream_stats_sample_s *sample = &ring->Samples[(unsigned long)head & (STREAM_STATS_HISTORY - 1)];
+	
+	sample->TimeMs         = timeMs;
+	sample->IntervalMs     = ring->HasLast ? timeMs - ring->LastTimeMs : 0;
+	sample->HostCpuPercent = hostCpuPercent;
+	sample->Available      = available;
+	
+	for (int i = 0; i < STREAM_COUNTERS; i++) {
+		
+		sample->Counters[i] = counters[i];
+		sample->Deltas[i]   = 0;
+		sample->Rates[i]    = 0;
+		
+		if (!(available & (1u << i)) || !ring->HasLast || !(ring->LastAvailable & (1u << i))) continue;
+		
+		// A counter going backwards was reset with the stream
+		sample->Deltas[i] = (counters[i] >= ring->Last[i]) ? counters[i] - ring->Last[i] : counters[i];
+		
+		if (sample->IntervalMs > 0) sample->Rates[i] = (double)sample->Deltas[i] * 1000.0 / sample->IntervalMs;
+	}
+	
+	memcpy(ring->Last, counters, sizeof(ring->Last));
+	ring->LastAvailable = available;
+	ring->LastTimeMs    = timeMs;
+	ring->HasLast       = 1;
+	
+	// Publish the sample
+	ATOMIC_INCREMENT(&ring->Head);
+}
+
+/***************************************************************************************************
+Readers
+****************************************************************************************************/
+
+int StreamStatsQuery(struct stream_stats_ring_s *ring, int maxSamples, struct stream_stats_sample_s *samples) {
+	
+	long head, count;
+	
+	if (maxSamples > STREAM_STATS_MAX_QUERY) maxSamples = STREAM_STATS_MAX_QUERY;
+	if (maxSamples <= 0) return 0;
+	
+	// Copy, retry if the writer lapped the oldest samples meanwhile
+	for (;;) {
+		
+		head  = ATOMIC_LOAD(&ring->Head);
+		count = (head < maxSamples) ? head : maxSamples;
+		
+		for (long i = 0; i < count; i++) {
+			samples[i] = ring->Samples[(unsigned long)(head - count + i) & (STREAM_STATS_HISTORY - 1)];
+		}
+		
+		if (ATOMIC_LOAD(&ring->Head) - head < STREAM_STATS_HISTORY - count) break;
+	}
+	
+	return (int)count;
+}
+
+int StreamStatsLatest(struct stream_stats_ring_s *ring, struct stream_stats_sample_s *sample) {
+	
+	return (StreamStatsQuery(ring, 1, sample) == 1) ? OK : CANCEL;
+}
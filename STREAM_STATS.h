@@ -0,0 +1,66 @@
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Stream statistics time series. A sampler (see StartStreamStatsSampler in DAHENG_CAMERA_DRIVERS.c)
+reads the SDK's GX_DS_INT_* stream counters at a fixed rate, off the frame path, and records them
+here together with the host CPU load. Each sample keeps the counter values, the deltas since the
+previous sample and the rates per second, so frame loss can be lined up against load on the host.
+
+Counters the device does not implement (packet counters on USB3...) are left out of Available.
+A counter going backwards (stream restarted) starts counting again from its new value.
+
+One writer (the sampler), any number of readers, same ring scheme as FRAME_METADATA.
+****************************************************************************************************/
+
+#define STREAM_STATS_HISTORY			512		// Samples kept, power of two
+#define STREAM_STATS_MAX_QUERY			(STREAM_STATS_HISTORY - 16) // Leave room for the writer while a reader copies
+
+// Counter indexes
+#define STREAM_COUNTER_DELIVERED_FRAMES		0	// GX_DS_INT_DELIVERED_FRAME_COUNT
+#define STREAM_COUNTER_LOST_FRAMES			1	// GX_DS_INT_LOST_FRAME_COUNT
+#define STREAM_COUNTER_INCOMPLETE_FRAMES	2	// GX_DS_INT_INCOMPLETE_FRAME_COUNT
+#define STREAM_COUNTER_DELIVERED_PACKETS	3	// GX_DS_INT_DELIVERED_PACKET_COUNT
+#define STREAM_COUNTER_RESEND_PACKETS		4	// GX_DS_INT_RESEND_PACKET_COUNT
+#define STREAM_COUNTER_RESCUED_PACKETS		5	// GX_DS_INT_RESCUED_PACKED_COUNT
+#define STREAM_COUNTER_RESEND_COMMANDS		6	// GX_DS_INT_RESEND_COMMAND_COUNT
+#define STREAM_COUNTER_UNEXPECTED_PACKETS	7	// GX_DS_INT_UNEXPECTED_PACKED_COUNT
+#define STREAM_COUNTER_MISSING_BLOCKIDS		8	// GX_DS_INT_MISSING_BLOCKID_COUNT
+#define STREAM_COUNTERS						9
+
+struct stream_stats_sample_s {
+	
+	double TimeMs;							// Host time of the sample (GetHostTimeMs)
+	double IntervalMs;						// Since the previous sample, 0 for the first one
+	double HostCpuPercent;					// Whole-machine CPU load over the interval, -1 = unknown
+	unsigned int Available;					// Bit n set = counter n was read
+	int64_t Counters[STREAM_COUNTERS];		// Raw counter values
+	int64_t Deltas[STREAM_COUNTERS];		// Increase since the previous sample
+	double Rates[STREAM_COUNTERS];			// Deltas per second
+};
+
+struct stream_stats_ring_s {
+	
+	struct stream_stats_sample_s Samples[STREAM_STATS_HISTORY];
+	atomic_long_t Head;						// Samples recorded so far, next slot = Head % STREAM_STATS_HISTORY
+	
+	// Writer state
+	int64_t Last[STREAM_COUNTERS];
+	unsigned int LastAvailable;
+	double LastTimeMs;
+	int HasLast;
+};
+
+/***************************************************************************************************
+Stream Stats Public Functions
+****************************************************************************************************/
+
+void StreamStatsReset  (struct stream_stats_ring_s *ring);
+void StreamStatsRecord (struct stream_stats_ring_s *ring, double timeMs, const int64_t *counters, unsigned int available, double hostCpuPercent);
+int  StreamStatsQuery  (struct stream_stats_ring_s *ring, int maxSamples, struct stream_stats_sample_s *samples); // Newest maxSamples, oldest first, returns the count
+int  StreamStatsLatest (struct stream_stats_ring_s *ring, struct stream_stats_sample_s *sample); // OK (1) or CANCEL (-1) if nothing recorded yet
+
+#endif
@@ -0,0 +1,310 @@
+#include "../BANDWIDTH_PLANNER.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/***************************************************************************************************
+Bandwidth planner test. Hand-checked plans for a link with room for everybody, a congested link
+shared max-min by weight (cameras settling over several rounds), a camera held by its own link
+limit, MaxFps and the default weight. Then random camera sets, where the plan must stay within the
+budget, give every unlimited camera its whole demand and use up the budget when it cuts anybody.
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+#define MB						1e6
+#define RANDOM_PLANS			2000
+
+int Checks   = 0;
+int Failures = 0;
+
+uint32_t RandomState = 1;
+
+double Random(void);
+int Near(double value, double expected);
+void Request(struct bandwidth_request_s *request, int64_t payload, double fps, double weight);
+void TestEverythingFits(void);
+void TestWaterFilling(void);
+void TestLinkLimit(void);
+void TestMaxFps(void);
+void TestDefaultWeight(void);
+void TestRandomPlans(void);
+void TestBadArguments(void);
+
+// Same sequence on every compiler, unlike rand()
+double Random(void) {
+	
+	RandomState = RandomState * 1664525u + 1013904223u;
+	return (RandomState >> 8) / 16777216.0;
+}
+
+int Near(double value, double expected) {
+	
+	return fabs(value - expected) <= 1e-9 * (fabs(expected) > 1 ? fabs(expected) : 1);
+}
+
+void Request(struct bandwidth_request_s *request, int64_t payload, double fps, double weight) {
+	
+	memset(request, 0, sizeof(*request));
+	request->PayloadBytes = payload;
+	request->RequestedFps = fps;
+	request->Weight       = weight;
+}
+
+void TestEverythingFits(void) {
+	
+	struct bandwidth_request_s requests[3];
+	struct bandwidth_plan_s plans[3];
+	
+	Request(&requests[0], 5000000, 30, 1);
+	Request(&requests[1], 2000000, 60, 1);
+	Request(&requests[2], 1000000, 10, 5);
+	
+	// 150 + 120 + 10 MB/s payload, 294 MB/s with the overhead
+	CHECK(BandwidthPlan(requests, 3, 300 * MB, BANDWIDTH_DEFAULT_OVERHEAD, plans) == 0);
+	
+	for (int i = 0; i < 3; i++) {
+		CHECK(Near(plans[i].Fps, requests[i].RequestedFps));
+		CHECK(Near(plans[i].BytesPerSec, requests[i].PayloadBytes * (1 + BANDWIDTH_DEFAULT_OVERHEAD) * requests[i].RequestedFps));
+		CHECK(!plans[i].Limited);
+	}
+}
+
+void TestWaterFilling(void) {
+	
+	struct bandwidth_request_s requests[4];
+	struct bandwidth_plan_s plans[4];
+	
+	// 1 MB frames, no overhead: MB/s = fps. Weights 1:2:1:3 of 140 MB/s, 20 per weight. 10 fits the
+	// first round, 42 only the second (130 left, 21.7 per weight), the unlimited two split the last 88.
+	Request(&requests[0], 1000000, 10, 1);
+	Request(&requests[1], 1000000, 42, 2);
+	Request(&requests[2], 1000000, 0, 1);
+	Request(&requests[3], 1000000, 0, 3);
+	
+	CHECK(BandwidthPlan(requests, 4, 140 * MB, 0, plans) == 2);
+	
+	CHECK(Near(plans[0].BytesPerSec, 10 * MB) && !plans[0].Limited);
+	CHECK(Near(plans[1].BytesPerSec, 42 * MB) && !plans[1].Limited);
+	CHECK(Near(plans[2].BytesPerSec, 22 * MB) && plans[2].Limited);
+	CHECK(Near(plans[3].BytesPerSec, 66 * MB) && plans[3].Limited);
+	CHECK(Near(plans[3].Fps, 66));
+	
+	// A camera wanting more than its weighted share is cut to it, even when others settle below theirs
+	requests[1].Weight = 1;
+	
+	CHECK(BandwidthPlan(requests, 4, 100 * MB, 0, plans) == 3);
+	CHECK(Near(plans[0].BytesPerSec, 10 * MB) && !plans[0].Limited);
+	CHECK(Near(plans[1].BytesPerSec, 18 * MB) && plans[1].Limited);
+	CHECK(Near(plans[3].BytesPerSec, 54 * MB));
+	
+	// Everybody wants more than its share: straight split by weight, the overhead comes out of the frame rate
+	Request(&requests[0], 1000000, 100, 1);
+	Request(&requests[1], 1000000, 100, 3);
+	
+	CHECK(BandwidthPlan(requests, 2, 100 * MB, 0.25, plans) == 2);
+	
+	CHECK(Near(plans[0].BytesPerSec, 25 * MB) && plans[0].Limited);
+	CHECK(Near(plans[1].BytesPerSec, 75 * MB) && plans[1].Limited);
+	CHECK(Near(plans[0].Fps, 20));
+	CHECK(Near(plans[1].Fps, 60));
+}
+
+void TestLinkLimit(void) {
+	
+	struct bandwidth_request_s requests[2];
+	struct bandwidth_plan_s plans[2];
+	
+	// The first camera sits behind a 20 MB/s link: it takes that and is not counted as cut by the budget
+	Request(&requests[0], 1000000, 0, 1);
+	Request(&requests[1], 1000000, 0, 1);
+	requests[0].LinkMaxBytesPerSec = 20 * MB;
+	
+	CHECK(BandwidthPlan(requests, 2, 100 * MB, 0, plans) == 1);
+	
+	CHECK(Near(plans[0].BytesPerSec, 20 * MB) && !plans[0].Limited);
+	CHECK(Near(plans[1].BytesPerSec, 80 * MB) && plans[1].Limited);
+	
+	// Requested rate above what the link carries
+	Request(&requests[0], 1000000, 50, 1);
+	requests[0].LinkMaxBytesPerSec = 20 * MB;
+	
+	CHECK(BandwidthPlan(requests, 1, 100 * MB, 0, plans) == 0);
+	CHECK(Near(plans[0].Fps, 20));
+}
+
+void TestMaxFps(void) {
+	
+	struct bandwidth_request_s requests[3];
+	struct bandwidth_plan_s plans[3];
+	
+	// As fast as possible, as fast as it can, and a request above what it can
+	Request(&requests[0], 1000000, 0, 1);
+	Request(&requests[1], 1000000, 0, 1);
+	Request(&requests[2], 1000000, 60, 1);
+	requests[1].MaxFps = 25;
+	requests[2].MaxFps = 30;
+	
+	CHECK(BandwidthPlan(requests, 3, 200 * MB, 0.05, plans) == 1);
+	
+	CHECK(Near(plans[1].Fps, 25) && !plans[1].Limited);
+	CHECK(Near(plans[2].Fps, 30) && !plans[2].Limited);
+	CHECK(Near(plans[1].BytesPerSec, 26.25 * MB));
+	
+	// The unlimited one gets the rest
+	CHECK(plans[0].Limited);
+	CHECK(Near(plans[0].BytesPerSec, 200 * MB - 26.25 * MB - 31.5 * MB));
+	
+	// A request below MaxFps stays as it is
+	requests[2].RequestedFps = 10;
+	
+	CHECK(BandwidthPlan(requests, 3, 200 * MB, 0.05, plans) == 1);
+	CHECK(Near(plans[2].Fps, 10));
+}
+
+void TestDefaultWeight(void) {
+	
+	struct bandwidth_request_s requests[2];
+	struct bandwidth_plan_s plans[2];
+	
+	// Weight 0 counts as 1
+	Request(&requests[0], 1000000, 0, 0);
+	Request(&requests[1], 1000000, 0, 1);
+	
+	CHECK(BandwidthPlan(requests, 2, 100 * MB, 0, plans) == 2);
+	CHECK(Near(plans[0].BytesPerSec, 50 * MB));
+	CHECK(Near(plans[1].BytesPerSec, 50 * MB));
+	
+	requests[1].Weight = 2;
+	
+	CHECK(BandwidthPlan(requests, 2, 90 * MB, 0, plans) == 2);
+	CHECK(Near(plans[0].BytesPerSec, 30 * MB));
+	CHECK(Near(plans[1].BytesPerSec, 60 * MB));
+	
+	// Negative weights too
+	requests[0].Weight = -3;
+	requests[1].Weight = 1;
+	
+	CHECK(BandwidthPlan(requests, 2, 100 * MB, 0, plans) == 2);
+	CHECK(Near(plans[0].BytesPerSec, 50 * MB));
+}
+
+// Properties every plan must have, whatever the cameras
+void TestRandomPlans(void) {
+	
+	struct bandwidth_request_s requests[BANDWIDTH_PLAN_MAX_CAMERAS];
+	struct bandwidth_plan_s plans[BANDWIDTH_PLAN_MAX_CAMERAS];
+	int overBudget = 0, notUsedUp = 0, shortOfDemand = 0, aboveDemand = 0, badFps = 0, badCount = 0, unfair = 0, congested = 0;
+	
+	for (int n = 0; n < RANDOM_PLANS; n++) {
+		
+		int numCameras = 1 + (int)(Random() * BANDWIDTH_PLAN_MAX_CAMERAS);
+		double budget = (10 + Random() * 1000) * MB;
+		double overhead = Random() * 0.2;
+		
+		for (int i = 0; i < numCameras; i++) {
+			
+			Request(&requests[i], 100000 + (int64_t)(Random() * 20000000), (Random() < 0.3) ? 0 : Random() * 200, Random() * 4);
+			if (Random() < 0.3) requests[i].MaxFps = 1 + Random() * 100;
+			if (Random() < 0.3) requests[i].LinkMaxBytesPerSec = (1 + Random() * 200) * MB;
+		}
+		
+		int limited = BandwidthPlan(requests, numCameras, budget, overhead, plans);
+		
+		double total = 0, smallestLimitedShare = 0;
+		int counted = 0;
+		
+		for (int i = 0; i < numCameras; i++) {
+			
+			const struct bandwidth_request_s *r = &requests[i];
+			double fps = r->RequestedFps;
+			
+			if (r->MaxFps > 0 && (fps <= 0 || fps > r->MaxFps)) fps = r->MaxFps;
+			
+			double demand = (fps > 0) ? r->PayloadBytes * (1 + overhead) * fps : HUGE_VAL;
+			if (r->LinkMaxBytesPerSec > 0 && demand > r->LinkMaxBytesPerSec) demand = r->LinkMaxBytesPerSec;
+			
+			total += plans[i].BytesPerSec;
+			if (plans[i].Limited) counted++;
+			
+			if (plans[i].BytesPerSec > demand * (1 + 1e-9)) aboveDemand++;
+			if (!plans[i].Limited && !Near(plans[i].BytesPerSec, demand)) shortOfDemand++;
+			if (!Near(plans[i].Fps * r->PayloadBytes * (1 + overhead), plans[i].BytesPerSec)) badFps++;
+			
+			// Max-min: a cut camera gets at least as much per weight as any camera that got all it wanted
+			double share = plans[i].BytesPerSec / (r->Weight > 0 ? r->Weight : 1);
+			if (plans[i].Limited && (smallestLimitedShare == 0 || share < smallestLimitedShare)) smallestLimitedShare = share;
+		}
+		
+		for (int i = 0; i < numCameras && smallestLimitedShare > 0; i++) {
+			double share = plans[i].BytesPerSec / (requests[i].Weight > 0 ? requests[i].Weight : 1);
+			if (!plans[i].Limited && share > smallestLimitedShare * (1 + 1e-9)) unfair++;
+		}
+		
+		if (limited != counted) badCount++;
+		if (total > budget * (1 + 1e-9)) overBudget++;
+		if (limited > 0) {
+			congested++;
+			if (!Near(total, budget)) notUsedUp++;
+		}
+	}
+	
+	printf("%d random plans, %d congested: %d over budget, %d congested not using the whole budget, %d above demand, "
+		   "%d unlimited short of demand, %d unfair, %d frame rate mismatches\n",
+		   RANDOM_PLANS, congested, overBudget, notUsedUp, aboveDemand, shortOfDemand, unfair, badFps);
+	
+	CHECK(overBudget == 0);
+	CHECK(notUsedUp == 0);
+	CHECK(aboveDemand == 0);
+	CHECK(shortOfDemand == 0);
+	CHECK(unfair == 0);
+	CHECK(badFps == 0);
+	CHECK(badCount == 0);
+	CHECK(congested > 0 && congested < RANDOM_PLANS);
+}
+
+void TestBadArguments(void) {
+	
+	struct bandwidth_request_s requests[BANDWIDTH_PLAN_MAX_CAMERAS + 1];
+	struct bandwidth_plan_s plans[BANDWIDTH_PLAN_MAX_CAMERAS + 1];
+	
+	for (int i = 0; i <= BANDWIDTH_PLAN_MAX_CAMERAS; i++) Request(&requests[i], 1000000, 30, 1);
+	
+	CHECK(BandwidthPlan(requests, 0, 100 * MB, 0, plans) == CANCEL);
+	CHECK(BandwidthPlan(requests, -1, 100 * MB, 0, plans) == CANCEL);
+	CHECK(BandwidthPlan(requests, BANDWIDTH_PLAN_MAX_CAMERAS + 1, 100 * MB, 0, plans) == CANCEL);
+	CHECK(BandwidthPlan(requests, 2, 0, 0, plans) == CANCEL);
+	CHECK(BandwidthPlan(requests, 2, -100 * MB, 0, plans) == CANCEL);
+	CHECK(BandwidthPlan(requests, 2, 100 * MB, -0.1, plans) == CANCEL);
+	
+	requests[1].PayloadBytes = 0;
+	CHECK(BandwidthPlan(requests, 2, 100 * MB, 0, plans) == CANCEL);
+	
+	requests[1].PayloadBytes = -1000;
+	CHECK(BandwidthPlan(requests, 2, 100 * MB, 0, plans) == CANCEL);
+	
+	// The largest set is fine
+	requests[1].PayloadBytes = 1000000;
+	CHECK(BandwidthPlan(requests, BANDWIDTH_PLAN_MAX_CAMERAS, 1000 * MB, 0, plans) == 0);
+}
+
+int main(void) {
+	
+	TestEverythingFits();
+	TestWaterFilling();
+	TestLinkLimit();
+	TestMaxFps();
+	TestDefaultWeight();
+	TestRandomPlans();
+	TestBadArguments();
+	
+	printf("BANDWIDTH_PLANNER: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
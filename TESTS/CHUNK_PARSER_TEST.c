@@ -0,0 +1,126 @@
+#include "../CHUNK_PARSER.h"
+#include <stdio.h>
+#include <string.h>
+
+/***************************************************************************************************
+Chunk parser test. Builds synthetic payloads (image + chunks) in both byte orders and checks what
+ChunkParse / ChunkFind / ChunkRead* make of them, truncated and foreign payloads included.
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+int Checks   = 0;
+int Failures = 0;
+
+void Put32(uint8_t *p, uint32_t v, int bigEndian);
+void Put64(uint8_t *p, uint64_t v, int bigEndian);
+size_t PutChunk(uint8_t *payload, size_t offset, uint32_t id, const uint8_t *data, uint32_t length, int bigEndian);
+void TestImageAndChunks(int bigEndian);
+void TestImageAsChunk(int bigEndian);
+
+void Put32(uint8_t *p, uint32_t v, int bigEndian) {
+	
+	for (int i = 0; i < 4; i++) p[bigEndian ? 3 - i : i] = (uint8_t)(v >> (8 * i));
+}
+
+void Put64(uint8_t *p, uint64_t v, int bigEndian) {
+	
+	for (int i = 0; i < 8; i++) p[bigEndian ? 7 - i : i] = (uint8_t)(v >> (8 * i));
+}
+
+// Data then the [ID][length] trailer, returns the new end of the payload
+size_t PutChunk(uint8_t *payload, size_t offset, uint32_t id, const uint8_t *data, uint32_t length, int bigEndian) {
+	
+	memcpy(payload + offset, data, length);
+	offset += length;
+	
+	Put32(payload + offset, id, bigEndian);
+	Put32(payload + offset + 4, length, bigEndian);
+	
+	return offset + CHUNK_TRAILER_BYTES;
+}
+
+// 100 byte image, then exposure time (double), gain (double) and a 4 byte counter
+void TestImageAndChunks(int bigEndian) {
+	
+	uint8_t payload[256], data[8];
+	struct chunk_entry_s chunks[CHUNK_MAX_ENTRIES];
+	size_t imageBytes = 100, end = imageBytes;
+	double exposure = 12345.5, gain = 6.25, value = 0;
+	uint64_t bits = 0;
+	int64_t counter = 0;
+	
+	memset(payload, 0xAB, sizeof(payload));
+	
+	memcpy(&bits, &exposure, 8);
+	Put64(data, bits, bigEndian);
+	end = PutChunk(payload, end, 0xA0001, data, 8, bigEndian);
+	
+	memcpy(&bits, &gain, 8);
+	Put64(data, bits, bigEndian);
+	end = PutChunk(payload, end, 0xA0002, data, 8, bigEndian);
+	
+	Put32(data, 77, bigEndian);
+	end = PutChunk(payload, end, 0xA0003, data, 4, bigEndian);
+	
+	int numChunks = ChunkParse(payload, end, imageBytes, bigEndian, chunks, CHUNK_MAX_ENTRIES);
+	CHECK(numChunks == 3);
+	
+	int i = ChunkFind(chunks, numChunks, 0xA0001);
+	CHECK(i >= 0 && ChunkReadFloat(payload, &chunks[i], bigEndian, &value) == OK && value == exposure);
+	
+	i = ChunkFind(chunks, numChunks, 0xA0002);
+	CHECK(i >= 0 && ChunkReadFloat(payload, &chunks[i], bigEndian, &value) == OK && value == gain);
+	
+	i = ChunkFind(chunks, numChunks, 0xA0003);
+	CHECK(i >= 0 && ChunkReadInt(payload, &chunks[i], bigEndian, &counter) == OK && counter == 77);
+	
+	CHECK(ChunkFind(chunks, numChunks, 5) == -1);
+	
+	// Malformed: truncated, wrong image size, more chunks than room
+	CHECK(ChunkParse(payload, end - 1, imageBytes, bigEndian, chunks, CHUNK_MAX_ENTRIES) == CANCEL);
+	CHECK(ChunkParse(payload, end, imageBytes + 4, bigEndian, chunks, CHUNK_MAX_ENTRIES) == CANCEL);
+	CHECK(ChunkParse(payload, end, imageBytes, bigEndian, chunks, 2) == CANCEL);
+	
+	// Chunk mode off: the payload is only the image
+	CHECK(ChunkParse(payload, imageBytes, imageBytes, bigEndian, chunks, CHUNK_MAX_ENTRIES) == 0);
+}
+
+// The image is a chunk of its own (ID 1, 16 bytes), followed by a 4 byte chunk
+void TestImageAsChunk(int bigEndian) {
+	
+	uint8_t payload[64], image[16], data[4];
+	struct chunk_entry_s chunks[CHUNK_MAX_ENTRIES];
+	size_t end = 0;
+	
+	memset(image, 1, sizeof(image));
+	end = PutChunk(payload, end, 1, image, sizeof(image), bigEndian);
+	
+	Put32(data, 9, bigEndian);
+	end = PutChunk(payload, end, 0xB, data, 4, bigEndian);
+	
+	int numChunks = ChunkParse(payload, end, 0, bigEndian, chunks, CHUNK_MAX_ENTRIES);
+	CHECK(numChunks == 2 && chunks[0].ID == 0xB && chunks[1].ID == 1 && chunks[1].Offset == 0);
+	
+	// A length that points before the start of the payload
+	Put32(payload + end - 4, 200, bigEndian);
+	CHECK(ChunkParse(payload, end, 0, bigEndian, chunks, CHUNK_MAX_ENTRIES) == CANCEL);
+}
+
+int main(void) {
+	
+	for (int bigEndian = FALSE; bigEndian <= TRUE; bigEndian++) {
+		TestImageAndChunks(bigEndian);
+		TestImageAsChunk(bigEndian);
+	}
+	
+	printf("CHUNK_PARSER: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
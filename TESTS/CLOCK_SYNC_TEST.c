@@ -0,0 +1,95 @@
+#include "../CLOCK_SYNC.h"
+#include <stdio.h>
+#include <math.h>
+
+/***************************************************************************************************
+Clock sync test. Simulates a device clock running 37 ppm fast with its own zero, latched once a
+second with a jittery host round trip. Every 13th latch is delayed (3 ms round trip) and every 17th
+has a normal round trip but lands 800 us late, the two kinds of outlier ClockSyncFit has to drop.
+Checks the drift estimate and the error of ClockSyncToHostUs half a second past every latch.
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+#define SIM_TICK_FREQUENCY		125e6		// Device ticks per second, nominal
+#define SIM_DRIFT				37e-6		// Device clock rate error
+#define SIM_DEVICE_ZERO_US		123456789.0	// Host time of device tick 0
+#define SIM_LATCHES				200
+#define SIM_MAX_ERROR_US		15.0		// Allowed ClockSyncToHostUs error once the fit settled
+#define SIM_MAX_DRIFT_ERROR_PPM	1.0
+
+int Checks   = 0;
+int Failures = 0;
+
+uint32_t RandomState = 1;
+struct clock_sync_s Sync;
+
+double Random(void);
+uint64_t DeviceTicksAt(double hostUs);
+
+// Same sequence on every compiler, unlike rand()
+double Random(void) {
+	
+	RandomState = RandomState * 1664525u + 1013904223u;
+	return (RandomState >> 8) / 16777216.0;
+}
+
+uint64_t DeviceTicksAt(double hostUs) {
+	
+	return (uint64_t)((hostUs - SIM_DEVICE_ZERO_US) * (1 + SIM_DRIFT) * SIM_TICK_FREQUENCY / 1e6);
+}
+
+int main(void) {
+	
+	struct clock_sync_stats_s stats;
+	double hostUs = 5e8, convertedUs = 0, maxErrorUs = 0;
+	
+	ClockSyncInit(&Sync, (int64_t)SIM_TICK_FREQUENCY);
+	CHECK(ClockSyncToHostUs(&Sync, 0, &convertedUs) == FALSE);
+	
+	for (int k = 0; k < SIM_LATCHES; k++) {
+		
+		hostUs += 1e6 + Random() * 1000;
+		
+		// The latch happens somewhere inside the round trip
+		double roundTripUs = 20 + Random() * 10;
+		if (k % 13 == 0) roundTripUs = 3000;
+		
+		double latchUs = hostUs + roundTripUs * (0.3 + 0.4 * Random());
+		if (k % 17 == 5) latchUs += 800;
+		
+		ClockSyncAddSample(&Sync, DeviceTicksAt(latchUs), hostUs, hostUs + roundTripUs);
+		
+		if (k <= 10) continue;
+		
+		if (!ClockSyncToHostUs(&Sync, DeviceTicksAt(hostUs + 500000), &convertedUs)) {
+			CHECK(FALSE);
+			continue;
+		}
+		
+		double errorUs = fabs(convertedUs - (hostUs + 500000));
+		if (errorUs > maxErrorUs) maxErrorUs = errorUs;
+	}
+	
+	ClockSyncStats(&Sync, &stats);
+	
+	// The fit maps device to host time, so it sees the inverse rate error
+	double trueDriftPpm = (1 / (1 + SIM_DRIFT) - 1) * 1e6;
+	
+	printf("Drift %.3f ppm (true %.3f), residual rms %.2f us, max %.2f us, %d used, %d outliers, conversion error max %.2f us\n",
+		   stats.DriftPpm, trueDriftPpm, stats.ResidualRmsUs, stats.ResidualMaxUs, stats.Used, stats.Outliers, maxErrorUs);
+	
+	CHECK(fabs(stats.DriftPpm - trueDriftPpm) < SIM_MAX_DRIFT_ERROR_PPM);
+	CHECK(maxErrorUs < SIM_MAX_ERROR_US);
+	CHECK(stats.Outliers > 0);
+	
+	printf("CLOCK_SYNC: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
@@ -0,0 +1,325 @@
+#include "../DEMOSAIC.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/***************************************************************************************************
+Demosaic golden-image test. Small raw images with hand-checked BGR results for all four Bayer
+patterns, bilinear and nearest: a 4x4 one, and a 5x3 one converted with flip, whose odd width and
+height put the mirrored edges on the last column and row and need the row padding. Then every
+pattern, quality and flip on 17x5 and 101x57 noise against a per-pixel reference written from the
+formulas in DEMOSAIC.h, converted whole and in bands. Every kernel this build and CPU has must give
+the same bytes, SSE2 and AVX2 included (build with -mavx2 for the AVX2 one).
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+// DX_PIXEL_COLOR_FILTER, the order of the golden tables
+#define TEST_BAYER_RG		1
+#define TEST_BAYER_GB		2
+#define TEST_BAYER_GR		3
+#define TEST_BAYER_BG		4
+
+int Checks   = 0;
+int Failures = 0;
+
+const char *PatternNames[5] = {"", "RG", "GB", "GR", "BG"};
+const char *QualityNames[2] = {"bilinear", "nearest"};
+
+const uint8_t InputA[4][4] = {
+	{ 12, 200,  37,  90},
+	{150,   5, 240,  61},
+	{ 77, 133,  19, 250},
+	{  3,  88, 170,  44}
+};
+
+const uint8_t InputB[3][5] = {
+	{201,  14,  96,  33, 180},
+	{ 45, 222,   8, 160,  71},
+	{130,  59, 247,   2, 115}
+};
+
+// [pattern - 1][quality]: RG bilinear, RG nearest, GB bilinear ... BG nearest
+// 4x4 input A
+const uint8_t Golden4x4[8][48] = {
+	{ // RG bilinear
+		  5, 175,  12,   5, 200,  25,  33, 193,  37,  61,  90,  37,
+		  5, 150,  45,   5, 181,  37,  33, 240,  28,  61, 205,  28,
+		 47, 105,  77,  47, 133,  48,  50, 199,  19,  53, 250,  19,
+		 88,   3,  77,  88, 110,  48,  66, 170,  19,  44, 210,  19
+	},
+	{ // RG nearest
+		  5, 200,  12,   5, 200,  12,  61,  90,  37,  61,  90,  37,
+		  5, 150,  12,   5, 150,  12,  61, 240,  37,  61, 240,  37,
+		 88, 133,  77,  88, 133,  77,  44, 250,  19,  44, 250,  19,
+		 88,   3,  77,  88,   3,  77,  44, 170,  19,  44, 170,  19
+	},
+	{ // GB bilinear
+		200,  12, 150, 200,  15, 195, 145,  37, 240,  90,  49, 240,
+		167,  25, 150, 167,   5, 195, 169,  31, 240, 170,  61, 240,
+		133,  77,  77, 133,  48, 141, 192,  19, 205, 250,  36, 205,
+		133,  83,   3, 133,  88,  87, 192,  43, 170, 250,  44, 170
+	},
+	{ // GB nearest
+		200,  12, 150, 200,  12, 150,  90,  37, 240,  90,  37, 240,
+		200,   5, 150, 200,   5, 150,  90,  61, 240,  90,  61, 240,
+		133,  77,   3, 133,  77,   3, 250,  19, 170, 250,  19, 170,
+		133,  88,   3, 133,  88,   3, 250,  44, 170, 250,  44, 170
+	},
+	{ // GR bilinear
+		150,  12, 200, 195,  15, 200, 240,  37, 145, 240,  49,  90,
+		150,  25, 167, 195,   5, 167, 240,  31, 169, 240,  61, 170,
+		 77,  77, 133, 141,  48, 133, 205,  19, 192, 205,  36, 250,
+		  3,  83, 133,  87,  88, 133, 170,  43, 192, 170,  44, 250
+	},
+	{ // GR nearest
+		150,  12, 200, 150,  12, 200, 240,  37,  90, 240,  37,  90,
+		150,   5, 200, 150,   5, 200, 240,  61,  90, 240,  61,  90,
+		  3,  77, 133,   3,  77, 133, 170,  19, 250, 170,  19, 250,
+		  3,  88, 133,   3,  88, 133, 170,  44, 250, 170,  44, 250
+	},
+	{ // BG bilinear
+		 12, 175,   5,  25, 200,   5,  37, 193,  33,  37,  90,  61,
+		 45, 150,   5,  37, 181,   5,  28, 240,  33,  28, 205,  61,
+		 77, 105,  47,  48, 133,  47,  19, 199,  50,  19, 250,  53,
+		 77,   3,  88,  48, 110,  88,  19, 170,  66,  19, 210,  44
+	},
+	{ // BG nearest
+		 12, 200,   5,  12, 200,   5,  37,  90,  61,  37,  90,  61,
+		 12, 150,   5,  12, 150,   5,  37, 240,  61,  37, 240,  61,
+		 77, 133,  88,  77, 133,  88,  19, 250,  44,  19, 250,  44,
+		 77,   3,  88,  77,   3,  88,  19, 170,  44,  19, 170,  44
+	},
+};
+// 5x3 input B, flipped: source row 2 first, rows padded from 15 to 16 bytes
+const uint8_t Golden5x3[8][48] = {
+	{ // RG bilinear
+		222,  52, 130, 222,  59, 189, 191,  20, 247, 160,   2, 181, 160,  37, 115,   0,
+		222,  45, 166, 222,  32, 169, 191,   8, 172, 160,  29, 160, 160,  71, 148,   0,
+		222,  30, 201, 222,  14, 149, 191,  16,  96, 160,  33, 138, 160,  52, 180,   0
+	},
+	{ // RG nearest
+		222,  59, 130, 222,  59, 130, 160,   2, 247, 160,   2, 247, 160,   2, 115,   0,
+		222,  45, 201, 222,  45, 201, 160,   8,  96, 160,   8,  96, 160,  71, 180,   0,
+		222,  14, 201, 222,  14, 201, 160,  33,  96, 160,  33,  96, 160,  33, 180,   0
+	},
+	{ // GB bilinear
+		 59, 130,  45,  59, 206,  27,  31, 247,   8,   2, 171,  40,   2, 115,  71,   0,
+		 37, 194,  45,  37, 222,  27,  27, 182,   8,  18, 160,  40,  18, 154,  71,   0,
+		 14, 201,  45,  14, 186,  27,  24,  96,   8,  33, 149,  40,  33, 180,  71,   0
+	},
+	{ // GB nearest
+		 59, 130,  45,  59, 130,  45,   2, 247,   8,   2, 247,   8,   2, 115,  71,   0,
+		 14, 222,  45,  14, 222,  45,  33, 160,   8,  33, 160,   8,  33, 160,  71,   0,
+		 14, 201,  45,  14, 201,  45,  33,  96,   8,  33,  96,   8,  33, 180,  71,   0
+	},
+	{ // GR bilinear
+		 45, 130,  59,  27, 206,  59,   8, 247,  31,  40, 171,   2,  71, 115,   2,   0,
+		 45, 194,  37,  27, 222,  37,   8, 182,  27,  40, 160,  18,  71, 154,  18,   0,
+		 45, 201,  14,  27, 186,  14,   8,  96,  24,  40, 149,  33,  71, 180,  33,   0
+	},
+	{ // GR nearest
+		 45, 130,  59,  45, 130,  59,   8, 247,   2,   8, 247,   2,  71, 115,   2,   0,
+		 45, 222,  14,  45, 222,  14,   8, 160,  33,   8, 160,  33,  71, 160,  33,   0,
+		 45, 201,  14,  45, 201,  14,   8,  96,  33,   8,  96,  33,  71, 180,  33,   0
+	},
+	{ // BG bilinear
+		130,  52, 222, 189,  59, 222, 247,  20, 191, 181,   2, 160, 115,  37, 160,   0,
+		166,  45, 222, 169,  32, 222, 172,   8, 191, 160,  29, 160, 148,  71, 160,   0,
+		201,  30, 222, 149,  14, 222,  96,  16, 191, 138,  33, 160, 180,  52, 160,   0
+	},
+	{ // BG nearest
+		130,  59, 222, 130,  59, 222, 247,   2, 160, 247,   2, 160, 115,   2, 160,   0,
+		201,  45, 222, 201,  45, 222,  96,   8, 160,  96,   8, 160, 180,  71, 160,   0,
+		201,  14, 222, 201,  14, 222,  96,  33, 160,  96,  33, 160, 180,  33, 160,   0
+	},
+};
+
+int Convert(const uint8_t *raw, int width, int height, int flip, int pattern, int quality, int kernel, int bands, uint8_t *dst);
+char ColorAt(int pattern, int y, int x);
+int Mirror(int v, int n);
+void Reference(const uint8_t *raw, int width, int height, int flip, int pattern, int quality, uint8_t *dst);
+void TestGolden(const uint8_t *raw, int width, int height, int flip, const uint8_t (*golden)[48]);
+void TestNoise(int width, int height);
+
+// The whole image, in bands of rows when bands > 1
+int Convert(const uint8_t *raw, int width, int height, int flip, int pattern, int quality, int kernel, int bands, uint8_t *dst) {
+	
+	struct demosaic_lines_s lines;
+	int rowBytes = (int)DemosaicRowBytes(width);
+	int status = OK;
+	
+	memset(&lines, 0, sizeof(lines));
+	if (DemosaicLinesAlloc(&lines, width) != OK) return CANCEL;
+	
+	memset(dst, 0xEE, (size_t)rowBytes * height); // Padding must come out 0
+	
+	for (int band = 0; band < bands && status == OK; band++) {
+		status = DemosaicRows(raw, 8, NULL, width, height, width, dst, rowBytes, flip, pattern, quality, kernel,
+							  height * band / bands, height * (band + 1) / bands, &lines);
+	}
+	
+	DemosaicLinesFree(&lines);
+	
+	return status;
+}
+
+// Color of the sensor site, from the name of the top-left 2x2 block
+char ColorAt(int pattern, int y, int x) {
+	
+	const char *block = pattern == TEST_BAYER_RG ? "RGGB" : pattern == TEST_BAYER_GB ? "GBRG" : pattern == TEST_BAYER_GR ? "GRBG" : "BGGR";
+	
+	return block[(y & 1) * 2 + (x & 1)];
+}
+
+// Row -1 = row 1, row n = row n - 2
+int Mirror(int v, int n) {
+	
+	if (v < 0) v = -v;
+	if (v >= n) v = 2 * n - 2 - v;
+	
+	return v;
+}
+
+#define AT(y, x)		raw[Mirror(y, height) * width + Mirror(x, width)]
+#define AVG(a, b)		(((a) + (b) + 1) >> 1)
+
+// One pixel at a time, straight from the formulas in DEMOSAIC.h
+void Reference(const uint8_t *raw, int width, int height, int flip, int pattern, int quality, uint8_t *dst) {
+	
+	int rowBytes = (int)DemosaicRowBytes(width);
+	
+	memset(dst, 0, (size_t)rowBytes * height);
+	
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			
+			int c[256] = {0};
+			char site = ColorAt(pattern, y, x);
+			
+			if (quality == DEMOSAIC_BILINEAR && site != 'G') {
+				c[(int)site] = AT(y, x);
+				c['G'] = AVG(AVG(AT(y - 1, x), AT(y + 1, x)), AVG(AT(y, x - 1), AT(y, x + 1)));
+				c[site == 'R' ? 'B' : 'R'] = AVG(AVG(AT(y - 1, x - 1), AT(y + 1, x + 1)), AVG(AT(y - 1, x + 1), AT(y + 1, x - 1)));
+			}
+			else if (quality == DEMOSAIC_BILINEAR) {
+				c['G'] = AT(y, x);
+				c[(int)ColorAt(pattern, y, x + 1)] = AVG(AT(y, x - 1), AT(y, x + 1));
+				c[(int)ColorAt(pattern, y + 1, x)] = AVG(AT(y - 1, x), AT(y + 1, x));
+			}
+			else {
+				
+				// The 2x2 block of the pixel, the G of its own row
+				for (int dy = 0; dy < 2; dy++) {
+					for (int dx = 0; dx < 2; dx++) {
+						
+						int by = (y & ~1) + dy, bx = (x & ~1) + dx;
+						char blockSite = ColorAt(pattern, by, bx);
+						
+						if (blockSite != 'G' || by == y) c[(int)blockSite] = AT(by, bx);
+					}
+				}
+			}
+			
+			uint8_t *out = dst + (size_t)(flip ? height - 1 - y : y) * rowBytes + 3 * x;
+			out[0] = (uint8_t)c['B'];
+			out[1] = (uint8_t)c['G'];
+			out[2] = (uint8_t)c['R'];
+		}
+	}
+}
+
+void TestGolden(const uint8_t *raw, int width, int height, int flip, const uint8_t (*golden)[48]) {
+	
+	uint8_t out[48], reference[48];
+	
+	for (int pattern = TEST_BAYER_RG; pattern <= TEST_BAYER_BG; pattern++) {
+		for (int quality = DEMOSAIC_BILINEAR; quality <= DEMOSAIC_NEAREST; quality++) {
+			
+			const uint8_t *expected = golden[(pattern - 1) * 2 + quality];
+			
+			// The reference has to agree with the hand-checked table before it is trusted on noise
+			Reference(raw, width, height, flip, pattern, quality, reference);
+			CHECK(memcmp(reference, expected, 48) == 0);
+			
+			for (int kernel = DEMOSAIC_KERNEL_SCALAR; kernel <= DemosaicBestKernel(); kernel++) {
+				
+				int same = Convert(raw, width, height, flip, pattern, quality, kernel, 1, out) == OK && memcmp(out, expected, 48) == 0;
+				
+				if (!same) printf("  %dx%d %s %s %s differs from the golden image\n", width, height, PatternNames[pattern], QualityNames[quality], DemosaicKernelName(kernel));
+				CHECK(same);
+			}
+		}
+	}
+}
+
+void TestNoise(int width, int height) {
+	
+	size_t bytes = DemosaicRowBytes(width) * height;
+	uint8_t *raw = (uint8_t *)malloc((size_t)width * height);
+	uint8_t *reference = (uint8_t *)malloc(bytes);
+	uint8_t *scalar = (uint8_t *)malloc(bytes);
+	uint8_t *out = (uint8_t *)malloc(bytes);
+	uint32_t seed = (uint32_t)(width * 1000 + height);
+	
+	for (int i = 0; i < width * height; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		raw[i] = (uint8_t)(seed >> 24);
+	}
+	
+	for (int pattern = TEST_BAYER_RG; pattern <= TEST_BAYER_BG; pattern++) {
+		for (int quality = DEMOSAIC_BILINEAR; quality <= DEMOSAIC_NEAREST; quality++) {
+			for (int flip = FALSE; flip <= TRUE; flip++) {
+				
+				Reference(raw, width, height, flip, pattern, quality, reference);
+				
+				CHECK(Convert(raw, width, height, flip, pattern, quality, DEMOSAIC_KERNEL_SCALAR, 1, scalar) == OK);
+				CHECK(memcmp(scalar, reference, bytes) == 0);
+				
+				// SIMD == scalar, whole and in bands of odd sizes
+				for (int kernel = DEMOSAIC_KERNEL_SCALAR; kernel <= DemosaicBestKernel(); kernel++) {
+					for (int bands = 1; bands <= 3; bands += 2) {
+						
+						int same = Convert(raw, width, height, flip, pattern, quality, kernel, bands, out) == OK && memcmp(out, scalar, bytes) == 0;
+						
+						if (!same) printf("  %dx%d %s %s%s %s in %d bands differs from scalar\n", width, height, PatternNames[pattern],
+										  QualityNames[quality], flip ? " flipped" : "", DemosaicKernelName(kernel), bands);
+						CHECK(same);
+					}
+				}
+			}
+		}
+	}
+	
+	free(raw);
+	free(reference);
+	free(scalar);
+	free(out);
+}
+
+int main(void) {
+	
+	uint8_t out[48];
+	
+	printf("Kernels up to %s\n", DemosaicKernelName(DemosaicBestKernel()));
+	
+	TestGolden(&InputA[0][0], 4, 4, FALSE, Golden4x4);
+	TestGolden(&InputB[0][0], 5, 3, TRUE, Golden5x3);
+	
+	TestNoise(17, 5);
+	TestNoise(101, 57);
+	
+	// Bad arguments
+	CHECK(Convert(&InputA[0][0], 1, 4, FALSE, TEST_BAYER_RG, DEMOSAIC_BILINEAR, DEMOSAIC_KERNEL_SCALAR, 1, out) == CANCEL);
+	CHECK(Convert(&InputA[0][0], 4, 4, FALSE, 5, DEMOSAIC_BILINEAR, DEMOSAIC_KERNEL_SCALAR, 1, out) == CANCEL);
+	
+	printf("DEMOSAIC: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
@@ -0,0 +1,316 @@
+#include "../FRAME_SYNC.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/***************************************************************************************************
+Frame sync test. Simulates SIM_STREAMS cameras on one hardware trigger at SIM_FPS for two minutes.
+Every camera clock starts seconds apart from the others and runs tens of ppm fast or slow, frames
+reach the host after a jittery transfer and each camera drops some frames. Checks:
+ - one set per trigger that every camera delivered, none for the others, all frames of a set from
+   the same trigger, skew within the tolerance and small once the offsets settled
+ - the frames of an incomplete trigger counted as Unmatched
+ - without drift tracking the streams drift apart and the sets stop
+ - a camera that stalls: the other queues overflow and the backlog is discarded when it is back
+ - every pushed frame released exactly once, through a set or a discard
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+#define SIM_STREAMS				4
+#define SIM_FPS					30.0
+#define SIM_FRAMES				3600		// Two minutes
+#define SIM_START_US			10e6		// Host time of the first trigger
+#define SIM_CAPTURE_JITTER_US	20.0		// Trigger to exposure start, per camera
+#define SIM_TRANSFER_US			2000.0		// Capture to host receive time
+#define SIM_TRANSFER_JITTER_US	1500.0
+#define SIM_DROP_RATE			0.02
+#define SIM_TOLERANCE_US		5000.0		// Well under half a frame period
+#define SIM_SETTLED_SKEW_US		250.0		// Largest skew once the drift tracking caught up
+#define SIM_STALL_FIRST			1000		// Stream SIM_STREAMS - 1 delivers nothing for these frames
+#define SIM_STALL_FRAMES		100
+#define SIM_STALL_QUEUE_DEPTH	8
+
+// Device clock of each camera: started at a different host time, running fast or slow
+static const double StreamZeroUs[SIM_STREAMS] = {-1.7e6, 3.2e6, 8.05e6, 0.4e6};
+static const double StreamDriftPpm[SIM_STREAMS] = {30, -25, 45, 0};
+
+struct sim_item_s {
+	int Stream;
+	int Frame;
+};
+
+// One frame on its way to FrameSyncPush
+struct sim_event_s {
+	int Stream;
+	double TimeUs;
+	double HostTimeUs;
+};
+
+int Checks   = 0;
+int Failures = 0;
+
+uint32_t RandomState = 1;
+
+struct frame_sync_s Sync;
+struct sim_item_s Items[SIM_STREAMS][SIM_FRAMES];
+int Pushed[SIM_STREAMS][SIM_FRAMES];
+int Released[SIM_STREAMS][SIM_FRAMES];
+
+// What the sets looked like
+int64_t SetsSeen;
+int64_t MixedSets;			// Frames of different triggers in one set
+int64_t SetsAfterSettling;
+double MaxSettledSkewUs;
+int LastSetFrame;
+
+double Random(void);
+void OnSet(struct frame_set_s *set, void *userData);
+void OnRelease(void *item, void *userData);
+int Run(double driftGain, int queueDepth, int stall, int *complete);
+int CheckReleasedOnce(void);
+void TestMatching(void);
+void TestWithoutDriftTracking(void);
+void TestStalledStream(void);
+void TestBadArguments(void);
+
+// Same sequence on every compiler, unlike rand()
+double Random(void) {
+	
+	RandomState = RandomState * 1664525u + 1013904223u;
+	return (RandomState >> 8) / 16777216.0;
+}
+
+void OnSet(struct frame_set_s *set, void *userData) {
+	
+	int frame = ((struct sim_item_s *)set->Entries[0].Item)->Frame;
+	
+	for (int i = 0; i < set->NumStreams; i++) {
+		
+		struct sim_item_s *item = (struct sim_item_s *)set->Entries[i].Item;
+		
+		if (item->Frame != frame || item->Stream != i || set->Entries[i].FrameID != (uint64_t)frame) MixedSets++;
+	}
+	
+	SetsSeen++;
+	LastSetFrame = frame;
+	
+	// The first frames only have the host receive times to go by
+	if (frame >= SIM_FRAMES / 10) {
+		SetsAfterSettling++;
+		if (set->SkewUs > MaxSettledSkewUs) MaxSettledSkewUs = set->SkewUs;
+	}
+}
+
+void OnRelease(void *item, void *userData) {
+	
+	struct sim_item_s *released = (struct sim_item_s *)item;
+	
+	Released[released->Stream][released->Frame]++;
+}
+
+// Pushes the frames of all triggers in host arrival order, returns the frames each stream pushed
+// that another stream did not (the ones that must end up Unmatched), *complete the triggers every stream delivered
+int Run(double driftGain, int queueDepth, int stall, int *complete) {
+	
+	double periodUs = 1e6 / SIM_FPS;
+	int incomplete = 0;
+	
+	RandomState = 1;
+	memset(Pushed, 0, sizeof(Pushed));
+	memset(Released, 0, sizeof(Released));
+	SetsSeen = MixedSets = SetsAfterSettling = 0;
+	MaxSettledSkewUs = 0;
+	LastSetFrame = -1;
+	*complete = 0;
+	
+	FrameSyncInit(&Sync, SIM_STREAMS, queueDepth, SIM_TOLERANCE_US, OnSet, OnRelease, NULL);
+	Sync.DriftGain = driftGain;
+	
+	for (int frame = 0; frame < SIM_FRAMES; frame++) {
+		
+		struct sim_event_s events[SIM_STREAMS];
+		int numEvents = 0;
+		double triggerUs = SIM_START_US + frame * periodUs;
+		
+		for (int s = 0; s < SIM_STREAMS; s++) {
+			
+			int dropped = (Random() < SIM_DROP_RATE);
+			double captureUs = triggerUs + (Random() - 0.5) * 2 * SIM_CAPTURE_JITTER_US;
+			double hostUs = captureUs + SIM_TRANSFER_US + Random() * SIM_TRANSFER_JITTER_US;
+			
+			if (stall && s == SIM_STREAMS - 1 && frame >= SIM_STALL_FIRST && frame < SIM_STALL_FIRST + SIM_STALL_FRAMES) dropped = TRUE;
+			if (dropped) continue;
+			
+			// Sorted by host arrival, the transfer jitter is far below the frame period
+			int at = numEvents++;
+			while (at > 0 && events[at - 1].HostTimeUs > hostUs) {
+				events[at] = events[at - 1];
+				at--;
+			}
+			
+			events[at].Stream     = s;
+			events[at].TimeUs     = (captureUs - StreamZeroUs[s]) * (1 + StreamDriftPpm[s] * 1e-6);
+			events[at].HostTimeUs = hostUs;
+		}
+		
+		if (numEvents == SIM_STREAMS) (*complete)++;
+		else incomplete += numEvents;
+		
+		for (int e = 0; e < numEvents; e++) {
+			
+			int s = events[e].Stream;
+			
+			Items[s][frame].Stream = s;
+			Items[s][frame].Frame  = frame;
+			Pushed[s][frame] = TRUE;
+			
+			FrameSyncPush(&Sync, s, events[e].TimeUs, events[e].HostTimeUs, (uint64_t)frame, &Items[s][frame]);
+		}
+	}
+	
+	return incomplete;
+}
+
+// Every frame that went in came out once, nothing else did
+int CheckReleasedOnce(void) {
+	
+	int wrong = 0;
+	
+	for (int s = 0; s < SIM_STREAMS; s++) {
+		for (int frame = 0; frame < SIM_FRAMES; frame++) {
+			if (Released[s][frame] != (Pushed[s][frame] ? 1 : 0)) wrong++;
+		}
+	}
+	
+	return wrong;
+}
+
+void TestMatching(void) {
+	
+	int complete = 0;
+	int64_t unmatched = 0, overflowed = 0, frames = 0, matched = 0;
+	
+	int incomplete = Run(0.05, 0, FALSE, &complete);
+	
+	// Frames still queued are the ones after the last set, all incomplete triggers
+	int64_t queued = 0;
+	for (int s = 0; s < SIM_STREAMS; s++) queued += Sync.Streams[s].Count;
+	
+	FrameSyncFlush(&Sync);
+	
+	for (int s = 0; s < SIM_STREAMS; s++) {
+		frames     += Sync.Streams[s].Frames;
+		matched    += Sync.Streams[s].Matched;
+		unmatched  += Sync.Streams[s].Unmatched;
+		overflowed += Sync.Streams[s].Overflowed;
+	}
+	
+	double seconds = SIM_FRAMES / SIM_FPS;
+	
+	printf("%d streams, %.0f s: %lld sets (%.2f/s, %.2f/s complete triggers), skew mean %.1f us, max %.1f us, %.1f us settled, %lld unmatched, %lld overflowed\n",
+		   SIM_STREAMS, seconds, (long long)Sync.Sets, Sync.Sets / seconds, complete / seconds, FrameSyncMeanSkewUs(&Sync),
+		   Sync.MaxSkewUs, MaxSettledSkewUs, (long long)unmatched, (long long)overflowed);
+	
+	CHECK(Sync.Sets == complete);
+	CHECK(SetsSeen == complete);
+	CHECK(MixedSets == 0);
+	CHECK(complete < SIM_FRAMES && complete > SIM_FRAMES * 0.85);
+	
+	CHECK(Sync.MaxSkewUs <= SIM_TOLERANCE_US);
+	CHECK(MaxSettledSkewUs <= SIM_SETTLED_SKEW_US);
+	CHECK(SetsAfterSettling > 0);
+	
+	CHECK(matched == (int64_t)complete * SIM_STREAMS);
+	CHECK(unmatched + queued == incomplete);
+	CHECK(overflowed == 0);
+	CHECK(frames == matched + unmatched + queued);
+	
+	CHECK(CheckReleasedOnce() == 0);
+}
+
+// 70 ppm between the fastest and the slowest camera is 8 ms after two minutes
+void TestWithoutDriftTracking(void) {
+	
+	int complete = 0;
+	
+	Run(0, 0, FALSE, &complete);
+	FrameSyncFlush(&Sync);
+	
+	printf("Without drift tracking: %lld sets of %d complete triggers, the last at frame %d\n", (long long)Sync.Sets, complete, LastSetFrame);
+	
+	CHECK(MixedSets == 0);
+	CHECK(Sync.MaxSkewUs <= SIM_TOLERANCE_US);
+	CHECK(Sync.Sets < complete * 0.75);
+	CHECK(LastSetFrame < SIM_FRAMES * 0.75);
+	CHECK(CheckReleasedOnce() == 0);
+}
+
+void TestStalledStream(void) {
+	
+	int complete = 0;
+	
+	Run(0.05, SIM_STALL_QUEUE_DEPTH, TRUE, &complete);
+	FrameSyncFlush(&Sync);
+	
+	printf("Stalled stream: %lld sets of %d complete triggers", (long long)Sync.Sets, complete);
+	for (int s = 0; s < SIM_STREAMS; s++) {
+		printf(", stream %d %lld overflowed %lld unmatched", s, (long long)Sync.Streams[s].Overflowed, (long long)Sync.Streams[s].Unmatched);
+	}
+	printf("\n");
+	
+	CHECK(Sync.Sets == complete);
+	CHECK(MixedSets == 0);
+	
+	// While the last stream is gone the others fill their queues and drop the oldest frame for every new one.
+	// What is queued when it comes back is unmatched.
+	for (int s = 0; s < SIM_STREAMS - 1; s++) {
+		
+		struct frame_sync_stream_s *stream = &Sync.Streams[s];
+		int64_t stalledFrames = 0;
+		
+		for (int frame = SIM_STALL_FIRST; frame < SIM_STALL_FIRST + SIM_STALL_FRAMES; frame++) stalledFrames += Pushed[s][frame];
+		
+		CHECK(stream->Overflowed >= stalledFrames - SIM_STALL_QUEUE_DEPTH);
+		CHECK(stream->Overflowed <= stalledFrames);
+		CHECK(stream->Frames == stream->Matched + stream->Unmatched + stream->Overflowed);
+	}
+	
+	CHECK(Sync.Streams[SIM_STREAMS - 1].Overflowed == 0);
+	CHECK(CheckReleasedOnce() == 0);
+}
+
+void TestBadArguments(void) {
+	
+	struct sim_item_s item = {0, 0};
+	
+	CHECK(FrameSyncInit(&Sync, 0, 0, SIM_TOLERANCE_US, OnSet, OnRelease, NULL) == CANCEL);
+	CHECK(FrameSyncInit(&Sync, FRAME_SYNC_MAX_STREAMS + 1, 0, SIM_TOLERANCE_US, OnSet, OnRelease, NULL) == CANCEL);
+	CHECK(FrameSyncInit(&Sync, 2, 0, -1, OnSet, OnRelease, NULL) == CANCEL);
+	CHECK(FrameSyncInit(&Sync, 2, 0, SIM_TOLERANCE_US, OnSet, OnRelease, NULL) == OK);
+	CHECK(Sync.QueueDepth == FRAME_SYNC_QUEUE_SIZE);
+	
+	// A frame for a stream that does not exist goes straight back
+	memset(Released, 0, sizeof(Released));
+	FrameSyncPush(&Sync, 2, 0, 0, 0, &item);
+	CHECK(Released[0][0] == 1);
+	CHECK(Sync.Streams[0].Frames == 0 && Sync.Streams[1].Frames == 0);
+}
+
+int main(void) {
+	
+	TestMatching();
+	TestWithoutDriftTracking();
+	TestStalledStream();
+	TestBadArguments();
+	
+	printf("FRAME_SYNC: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
@@ -0,0 +1,219 @@
+#include "../GX_STANDIN.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/***************************************************************************************************
+Stand-in GxIAPI test and acquisition mode comparison. Checks the GXGetImage contract of
+GxStandInGetImage (timeout, bad arguments) and that every frame the source made is either delivered
+or counted as dropped. Then runs the callback and the polling mode with a fixed amount of work per
+frame (the conversion), without and with load threads, and prints throughput, interval jitter and
+delivery latency of each, the same comparison BenchmarkAcquisitionModes makes on the real pipeline.
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+Optional arguments: frame rate, seconds per run, load threads, work per frame in us.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+#define TEST_WIDTH		640
+#define TEST_HEIGHT		480
+#define TEST_FORMAT		GX_PIXEL_FORMAT_MONO8
+
+// What a consumer saw, the callback and the polling loop keep the same
+struct delivery_s {
+	
+	double WorkUs;				// Busy time per frame
+	long Frames;
+	uint64_t LastFrameId;
+	int OutOfOrder;				// Frame IDs that did not increase
+	double LastArrivalUs;
+	double SumIntervalUs;
+	double SumIntervalSqUs;
+	double MaxIntervalUs;
+	double SumLatencyUs;		// Arrival - time the frame fell due
+	double MaxLatencyUs;
+};
+
+int Checks   = 0;
+int Failures = 0;
+
+void SleepMs(int ms);
+void Arrived(struct delivery_s *delivery, uint64_t frameId, uint64_t timestampNs);
+void GX_STDC TestCallback(GX_FRAME_CALLBACK_PARAM *frame);
+void TestGetImageContract(void);
+void RunMode(const char *name, int polling, double frameRate, double seconds, double workUs);
+
+void SleepMs(int ms) {
+	
+#ifdef _WIN32
+	Sleep((DWORD)ms);
+#else
+	usleep((useconds_t)ms * 1000);
+#endif
+}
+
+void Arrived(struct delivery_s *delivery, uint64_t frameId, uint64_t timestampNs) {
+	
+	double nowUs = GxStandInNowUs();
+	double latencyUs = nowUs - timestampNs / 1000.0;
+	
+	if (delivery->Frames > 0) {
+		
+		double intervalUs = nowUs - delivery->LastArrivalUs;
+		
+		delivery->SumIntervalUs   += intervalUs;
+		delivery->SumIntervalSqUs += intervalUs * intervalUs;
+		if (intervalUs > delivery->MaxIntervalUs) delivery->MaxIntervalUs = intervalUs;
+		if (frameId <= delivery->LastFrameId) delivery->OutOfOrder++;
+	}
+	
+	delivery->SumLatencyUs += latencyUs;
+	if (latencyUs > delivery->MaxLatencyUs) delivery->MaxLatencyUs = latencyUs;
+	
+	delivery->LastArrivalUs = nowUs;
+	delivery->LastFrameId   = frameId;
+	delivery->Frames++;
+	
+	// The conversion
+	while (GxStandInNowUs() - nowUs < delivery->WorkUs) ;
+}
+
+void GX_STDC TestCallback(GX_FRAME_CALLBACK_PARAM *frame) {
+	
+	Arrived((struct delivery_s *)frame->pUserParam, frame->nFrameID, frame->nTimestamp);
+}
+
+void TestGetImageContract(void) {
+	
+	struct gx_standin_s source;
+	GX_FRAME_DATA frameData;
+	unsigned char *buffer = (unsigned char *)malloc(TEST_WIDTH * TEST_HEIGHT);
+	
+	CHECK(GxStandInStart(&source, 0, TEST_HEIGHT, TEST_FORMAT, TEST_WIDTH * TEST_HEIGHT, 1, NULL, NULL) == CANCEL);
+	
+	// 2 fps: the first frame is due at once, the next one not within 100 ms
+	CHECK(GxStandInStart(&source, TEST_WIDTH, TEST_HEIGHT, TEST_FORMAT, TEST_WIDTH * TEST_HEIGHT, 2, NULL, NULL) == OK);
+	
+	memset(&frameData, 0, sizeof(frameData));
+	CHECK(GxStandInGetImage(&source, &frameData, 100) == GX_STATUS_INVALID_PARAMETER);
+	
+	frameData.pImgBuf = buffer;
+	CHECK(GxStandInGetImage(&source, &frameData, 1000) == GX_STATUS_SUCCESS);
+	CHECK(frameData.nFrameID == 1 && frameData.nWidth == TEST_WIDTH && frameData.nHeight == TEST_HEIGHT);
+	CHECK(frameData.nImgSize == TEST_WIDTH * TEST_HEIGHT && frameData.nStatus == GX_FRAME_STATUS_SUCCESS);
+	
+	double startUs = GxStandInNowUs();
+	CHECK(GxStandInGetImage(&source, &frameData, 100) == GX_STATUS_TIMEOUT);
+	CHECK(GxStandInNowUs() - startUs >= 90000);
+	
+	GxStandInStop(&source);
+	
+	// A callback source has nothing to poll
+	struct delivery_s delivery;
+	memset(&delivery, 0, sizeof(delivery));
+	
+	CHECK(GxStandInStart(&source, TEST_WIDTH, TEST_HEIGHT, TEST_FORMAT, TEST_WIDTH * TEST_HEIGHT, 2, TestCallback, &delivery) == OK);
+	CHECK(GxStandInGetImage(&source, &frameData, 10) == GX_STATUS_INVALID_CALL);
+	GxStandInStop(&source);
+	
+	free(buffer);
+}
+
+void RunMode(const char *name, int polling, double frameRate, double seconds, double workUs) {
+	
+	struct gx_standin_s source;
+	struct delivery_s delivery;
+	GX_FRAME_DATA frameData;
+	unsigned char *buffer = (unsigned char *)malloc(TEST_WIDTH * TEST_HEIGHT);
+	
+	memset(&delivery, 0, sizeof(delivery));
+	delivery.WorkUs = workUs;
+	
+	if (GxStandInStart(&source, TEST_WIDTH, TEST_HEIGHT, TEST_FORMAT, TEST_WIDTH * TEST_HEIGHT, frameRate,
+					   polling ? NULL : TestCallback, &delivery) != OK) {
+		CHECK(FALSE);
+		free(buffer);
+		return;
+	}
+	
+	double endUs = GxStandInNowUs() + seconds * 1e6;
+	long queued = 0;
+	
+	if (polling) {
+		
+		// This loop is the polling thread
+		memset(&frameData, 0, sizeof(frameData));
+		frameData.pImgBuf = buffer;
+		
+		while (GxStandInNowUs() < endUs) {
+			if (GxStandInGetImage(&source, &frameData, 100) == GX_STATUS_SUCCESS) Arrived(&delivery, frameData.nFrameID, frameData.nTimestamp);
+		}
+		
+		GxStandInStop(&source);
+		queued = ATOMIC_LOAD(&source.Head) - ATOMIC_LOAD(&source.Tail);
+	}
+	else {
+		
+		SleepMs((int)(seconds * 1000));
+		GxStandInStop(&source);
+	}
+	
+	// Every frame that fell due went somewhere, in order
+	long generated = ATOMIC_LOAD(&source.Generated);
+	long dropped   = ATOMIC_LOAD(&source.Dropped);
+	
+	CHECK(delivery.Frames + dropped + queued == generated);
+	CHECK(delivery.OutOfOrder == 0);
+	CHECK(delivery.Frames > 0);
+	
+	long intervals = delivery.Frames - 1;
+	double meanUs   = intervals > 0 ? delivery.SumIntervalUs / intervals : 0;
+	double jitterUs = intervals > 1 ? sqrt(fmax(0, (delivery.SumIntervalSqUs - intervals * meanUs * meanUs) / (intervals - 1))) : 0;
+	
+	printf("  %-8s %7.1f fps, %5ld dropped of %5ld, interval %7.3f ms, jitter %7.3f ms, max %7.3f ms, latency %7.3f ms (max %7.3f)\n",
+		   name, delivery.Frames / seconds, dropped, generated, meanUs / 1000, jitterUs / 1000, delivery.MaxIntervalUs / 1000,
+		   delivery.Frames > 0 ? delivery.SumLatencyUs / delivery.Frames / 1000 : 0, delivery.MaxLatencyUs / 1000);
+	
+	free(buffer);
+}
+
+int main(int argc, char *argv[]) {
+	
+	double frameRate = argc > 1 ? atof(argv[1]) : 200;
+	double seconds   = argc > 2 ? atof(argv[2]) : 1;
+	int loadThreads  = argc > 3 ? atoi(argv[3]) : 4;
+	double workUs    = argc > 4 ? atof(argv[4]) : 1000;
+	
+	TestGetImageContract();
+	
+	for (int load = 0; load <= 1; load++) {
+		
+		printf("%.0f fps, %.0f us of work per frame, %d load threads:\n", frameRate, workUs, load ? loadThreads : 0);
+		
+		if (load && GxStandInLoadStart(loadThreads) != OK) {
+			CHECK(FALSE);
+			break;
+		}
+		
+		RunMode("callback", FALSE, frameRate, seconds, workUs);
+		RunMode("polling", TRUE, frameRate, seconds, workUs);
+		
+		GxStandInLoadStop();
+	}
+	
+	printf("GX_STANDIN: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
@@ -0,0 +1,409 @@
+#include "../RECONNECT.h"
+#include "../FRAME_SYNC.h"
+#include <stdio.h>
+#include <string.h>
+
+/***************************************************************************************************
+Reconnect test. Runs the state machine against a fake device that drops offline on command and a
+fake clock the test advances by hand: a plain recovery, the retry spacing while the device stays
+away, Open and Restore failing (the handle must be closed before the next try), MaxAttempts running
+out, a second offline event during recovery and the recovery time statistics. Last, a camera
+without a timestamp latch paired with another one through FRAME_SYNC: its clock restarts with the
+reconnect, and it only pairs again because the restore realigns its stream (as ReconnectRestore).
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+// What the machine did to the device, and what the device does next
+struct fake_device_s {
+	
+	int Present;					// Visible on the bus
+	int IsOpen;
+	int OpenFailures;				// Opens still to fail
+	int RestoreFailures;			// Restores still to fail
+	double OpenTakesMs;				// Clock advance of a (successful) open
+	struct frame_sync_s *Sync;		// Stream to realign on restore, NULL = none
+	int Stream;
+	
+	int Finds;
+	int Opens;
+	int Restores;
+	int Starts;
+	int Closes;
+	double LastFindMs;
+};
+
+int Checks   = 0;
+int Failures = 0;
+
+double NowMsValue = 1000;
+struct fake_device_s Device;
+struct reconnect_s Reconnect;
+
+int FakeFind(void *device);
+int FakeOpen(void *device);
+int FakeRestore(void *device);
+int FakeStart(void *device);
+void FakeClose(void *device);
+double FakeNowMs(void);
+void Setup(int maxAttempts);
+void DropOffline(void);
+int StepUntil(int state, double advanceMs, int maxSteps);
+void TestRecovery(void);
+void TestRetrySpacing(void);
+void TestOpenAndRestoreFailures(void);
+void TestMaxAttempts(void);
+void TestSecondOfflineEvent(void);
+void OnSet(struct frame_set_s *set, void *userData);
+void OnRelease(void *item, void *userData);
+void PushFrames(struct frame_sync_s *sync, double *hostUs, double deviceZeroUs, int frames);
+void TestFrameSyncAfterReconnect(int realign);
+
+const struct reconnect_ops_s FakeOps = {FakeFind, FakeOpen, FakeRestore, FakeStart, FakeClose, FakeNowMs};
+
+int FakeFind(void *device) {
+	
+	struct fake_device_s *fake = (struct fake_device_s *)device;
+	
+	fake->Finds++;
+	fake->LastFindMs = NowMsValue;
+	
+	return fake->Present;
+}
+
+int FakeOpen(void *device) {
+	
+	struct fake_device_s *fake = (struct fake_device_s *)device;
+	
+	fake->Opens++;
+	fake->IsOpen = TRUE; // Half open even when it fails, Close has to clean up
+	
+	if (!fake->Present) return CANCEL;
+	if (fake->OpenFailures > 0) {
+		fake->OpenFailures--;
+		return CANCEL;
+	}
+	
+	NowMsValue += fake->OpenTakesMs;
+	
+	return OK;
+}
+
+int FakeRestore(void *device) {
+	
+	struct fake_device_s *fake = (struct fake_device_s *)device;
+	
+	fake->Restores++;
+	
+	if (!fake->Present || !fake->IsOpen) return CANCEL;
+	if (fake->RestoreFailures > 0) {
+		fake->RestoreFailures--;
+		return CANCEL;
+	}
+	
+	// The device clock restarted
+	if (fake->Sync) FrameSyncRealign(fake->Sync, fake->Stream);
+	
+	return OK;
+}
+
+int FakeStart(void *device) {
+	
+	struct fake_device_s *fake = (struct fake_device_s *)device;
+	
+	fake->Starts++;
+	
+	return (fake->Present && fake->IsOpen) ? OK : CANCEL;
+}
+
+void FakeClose(void *device) {
+	
+	struct fake_device_s *fake = (struct fake_device_s *)device;
+	
+	fake->Closes++;
+	fake->IsOpen = FALSE;
+}
+
+double FakeNowMs(void) {
+	
+	return NowMsValue;
+}
+
+void Setup(int maxAttempts) {
+	
+	memset(&Device, 0, sizeof(Device));
+	Device.Present = TRUE;
+	Device.IsOpen  = TRUE;
+	
+	memset(&Reconnect, 0, sizeof(Reconnect));
+	Reconnect.RetryIntervalMs = 100;
+	Reconnect.MaxAttempts     = maxAttempts;
+	ReconnectInit(&Reconnect, &FakeOps, &Device);
+}
+
+// The fake device's offline event
+void DropOffline(void) {
+	
+	Device.Present = FALSE;
+	ReconnectOffline(&Reconnect);
+}
+
+// Steps (advancing the clock between them) until the state is reached, returns the steps taken or -1
+int StepUntil(int state, double advanceMs, int maxSteps) {
+	
+	for (int steps = 1; steps <= maxSteps; steps++) {
+		if (ReconnectStep(&Reconnect) == state) return steps;
+		NowMsValue += advanceMs;
+	}
+	
+	return -1;
+}
+
+// OFFLINE -> SEARCHING -> RESTORING -> ONLINE, device back before the first search
+void TestRecovery(void) {
+	
+	Setup(0);
+	
+	CHECK(ReconnectState(&Reconnect) == RECONNECT_ONLINE);
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_ONLINE); // Nothing to do
+	
+	DropOffline();
+	CHECK(ReconnectState(&Reconnect) == RECONNECT_OFFLINE);
+	
+	Device.Present     = TRUE;
+	Device.OpenTakesMs = 40;
+	
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_SEARCHING);
+	CHECK(Device.Closes == 1 && !Device.IsOpen); // Dead handle released first
+	
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_RESTORING);
+	CHECK(Device.Finds == 1 && Device.Opens == 1);
+	
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_ONLINE);
+	CHECK(Device.Restores == 1 && Device.Starts == 1 && Device.IsOpen);
+	
+	CHECK(Reconnect.Outages == 1 && Reconnect.Recoveries == 1);
+	CHECK(Reconnect.LastRecoveryMs == 40);
+}
+
+// While the device stays away it is searched for once every RetryIntervalMs, not on every step
+void TestRetrySpacing(void) {
+	
+	Setup(0);
+	DropOffline();
+	ReconnectStep(&Reconnect); // Close, first search due at once
+	
+	double startMs = NowMsValue;
+	
+	for (int step = 0; step < 100; step++) {
+		ReconnectStep(&Reconnect);
+		NowMsValue += 10;
+	}
+	
+	// 1000 ms of steps: searches at 0, 100, ... 900
+	CHECK(Device.Finds == 10);
+	CHECK(Device.LastFindMs == startMs + 900);
+	CHECK(ReconnectState(&Reconnect) == RECONNECT_SEARCHING);
+	CHECK(Reconnect.Attempts == 10);
+	
+	// Back: found on the next due search, not earlier
+	Device.Present = TRUE;
+	
+	int steps = StepUntil(RECONNECT_RESTORING, 10, 20);
+	CHECK(steps == 1);
+	CHECK(Device.LastFindMs == startMs + 1000);
+	
+	CHECK(StepUntil(RECONNECT_ONLINE, 10, 2) == 1);
+	CHECK(Reconnect.LastRecoveryMs == 1000);
+}
+
+// A failed open or restore closes the half open device and retries after the interval
+void TestOpenAndRestoreFailures(void) {
+	
+	Setup(0);
+	DropOffline();
+	
+	Device.Present         = TRUE;
+	Device.OpenFailures    = 1;
+	Device.RestoreFailures = 1;
+	
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_SEARCHING); // Close the dead handle
+	int closes = Device.Closes;
+	
+	// Open fails
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_SEARCHING);
+	CHECK(Device.Opens == 1 && Device.Closes == closes + 1 && !Device.IsOpen);
+	
+	// Not before the retry interval
+	NowMsValue += 50;
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_SEARCHING && Device.Opens == 1);
+	
+	// Open works, restore fails
+	NowMsValue += 50;
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_RESTORING && Device.Opens == 2);
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_SEARCHING);
+	CHECK(Device.Restores == 1 && Device.Starts == 0 && Device.Closes == closes + 2 && !Device.IsOpen);
+	
+	// Third search, everything works
+	CHECK(StepUntil(RECONNECT_RESTORING, 10, 20) > 1);
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_ONLINE);
+	CHECK(Device.Opens == 3 && Device.Restores == 2 && Device.Starts == 1 && Device.IsOpen);
+	CHECK(Reconnect.Attempts == 3);
+}
+
+// Gives up after MaxAttempts searches, ReconnectReset starts over
+void TestMaxAttempts(void) {
+	
+	Setup(3);
+	DropOffline();
+	
+	CHECK(StepUntil(RECONNECT_FAILED, 100, 10) == 4); // Close, then 3 searches
+	CHECK(Device.Finds == 3);
+	
+	// FAILED stays FAILED
+	NowMsValue += 1000;
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_FAILED && Device.Finds == 3);
+	
+	// A failing open counts as an attempt too
+	Setup(2);
+	DropOffline();
+	Device.Present      = TRUE;
+	Device.OpenFailures = 5;
+	
+	CHECK(StepUntil(RECONNECT_FAILED, 100, 10) == 3);
+	CHECK(Device.Opens == 2 && !Device.IsOpen);
+	CHECK(Reconnect.Recoveries == 0);
+	
+	ReconnectReset(&Reconnect);
+	CHECK(ReconnectState(&Reconnect) == RECONNECT_ONLINE && Reconnect.Attempts == 0);
+}
+
+// An offline event while the machine is already recovering belongs to the same outage
+void TestSecondOfflineEvent(void) {
+	
+	Setup(0);
+	DropOffline();
+	
+	double offlineMs = NowMsValue;
+	
+	NowMsValue += 30;
+	CHECK(ReconnectOffline(&Reconnect) == FALSE); // OFFLINE
+	
+	ReconnectStep(&Reconnect);
+	NowMsValue += 30;
+	CHECK(ReconnectOffline(&Reconnect) == FALSE); // SEARCHING
+	
+	Device.Present = TRUE;
+	CHECK(StepUntil(RECONNECT_RESTORING, 10, 20) > 0);
+	CHECK(ReconnectOffline(&Reconnect) == FALSE); // RESTORING
+	CHECK(ReconnectState(&Reconnect) == RECONNECT_RESTORING);
+	
+	CHECK(ReconnectStep(&Reconnect) == RECONNECT_ONLINE);
+	CHECK(Reconnect.Outages == 1);
+	CHECK(Reconnect.LastRecoveryMs == NowMsValue - offlineMs); // Timed from the first event
+	
+	// Recovery statistics over three outages of 100, 200 and 300 ms
+	Setup(0);
+	
+	for (int outage = 1; outage <= 3; outage++) {
+		
+		DropOffline();
+		ReconnectStep(&Reconnect);
+		
+		NowMsValue += 100 * outage;
+		Device.Present = TRUE;
+		
+		CHECK(StepUntil(RECONNECT_ONLINE, 0, 10) > 0);
+		CHECK(Reconnect.LastRecoveryMs == 100 * outage);
+	}
+	
+	CHECK(Reconnect.Outages == 3 && Reconnect.Recoveries == 3);
+	CHECK(Reconnect.MeanRecoveryMs == 200);
+	CHECK(Reconnect.MaxRecoveryMs == 300);
+}
+
+long SetsMade    = 0;
+long FramesFreed = 0;
+
+void OnSet(struct frame_set_s *set, void *userData) {
+	
+	SetsMade++;
+}
+
+void OnRelease(void *item, void *userData) {
+	
+	FramesFreed++;
+}
+
+// 100 fps on both cameras: stream 0 keeps its clock, stream 1 counts from deviceZeroUs (host time)
+void PushFrames(struct frame_sync_s *sync, double *hostUs, double deviceZeroUs, int frames) {
+	
+	for (int i = 0; i < frames; i++) {
+		
+		*hostUs += 10000;
+		
+		// Delivered 2 ms after the capture
+		FrameSyncPush(sync, 0, *hostUs + 5e6, *hostUs + 2000, 0, NULL);
+		FrameSyncPush(sync, 1, *hostUs - deviceZeroUs, *hostUs + 2000, 0, NULL);
+	}
+}
+
+void TestFrameSyncAfterReconnect(int realign) {
+	
+	struct frame_sync_s sync;
+	double hostUs = 1e9;
+	
+	SetsMade    = 0;
+	FramesFreed = 0;
+	
+	CHECK(FrameSyncInit(&sync, 2, 0, 1000, OnSet, OnRelease, NULL) == OK);
+	
+	Setup(0);
+	Device.Sync   = realign ? &sync : NULL;
+	Device.Stream = 1;
+	
+	PushFrames(&sync, &hostUs, 3e8, 50);
+	CHECK(SetsMade >= 49);
+	
+	// Camera 1 drops for a second, its clock starts over at 0 when it is back
+	long setsBefore = SetsMade;
+	
+	FrameSyncPush(&sync, 1, hostUs + 10000 - 3e8, hostUs + 12000, 0, NULL); // Queued, no partner yet
+	DropOffline();
+	ReconnectStep(&Reconnect);
+	
+	hostUs += 1e6;
+	NowMsValue += 1000;
+	Device.Present = TRUE;
+	CHECK(StepUntil(RECONNECT_ONLINE, 10, 10) > 0);
+	
+	PushFrames(&sync, &hostUs, hostUs, 50);
+	
+	if (realign) CHECK(SetsMade - setsBefore >= 49);
+	else CHECK(SetsMade == setsBefore); // Aligned to the old clock: never pairs again
+	
+	// Every frame pushed left exactly once
+	FrameSyncFlush(&sync);
+	CHECK(FramesFreed == 2 * 100 + 1);
+}
+
+int main(void) {
+	
+	TestRecovery();
+	TestRetrySpacing();
+	TestOpenAndRestoreFailures();
+	TestMaxAttempts();
+	TestSecondOfflineEvent();
+	TestFrameSyncAfterReconnect(FALSE);
+	TestFrameSyncAfterReconnect(TRUE);
+	
+	printf("RECONNECT: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
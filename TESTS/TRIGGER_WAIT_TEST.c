@@ -0,0 +1,296 @@
+#include "../TRIGGER_WAIT.h"
+#include "../GX_STANDIN.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/***************************************************************************************************
+Trigger handoff test. The stand-in source runs in software trigger mode and its callback offers every
+frame to the handoff the way ProcessFrame does, so TriggerAndWait's arm / fire / wait sequence runs
+against a simulated device. Checks that the frame returned is the one the trigger caused, that a
+frame coming after the wait timed out is released instead of being returned to the next wait, that
+no frame reference leaks, and the latency statistics (exactly with made-up times, then roughly
+against the configured latency of the stand-in).
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+#define TEST_WIDTH		64
+#define TEST_HEIGHT		48
+#define TEST_LATENCY_MS	20.0		// Stand-in trigger -> frame
+#define TEST_SLACK_MS	15.0		// Scheduling allowed on top of it
+
+// Reference counted frame, as struct frame_s
+struct test_frame_s {
+	
+	atomic_long_t Refs;
+	uint64_t FrameId;
+	double HostTimeMs;
+};
+
+int Checks   = 0;
+int Failures = 0;
+
+struct trigger_wait_s Wait;
+atomic_long_t LiveFrames = 0;		// Frames not released yet
+atomic_long_t Offered    = 0;		// Frames the source made
+atomic_long_t Taken      = 0;		// Of which handed over
+
+void SleepMs(int ms);
+double NowMs(void);
+struct test_frame_s* NewFrame(uint64_t frameId, double hostTimeMs);
+void AddRefFrame(void *item);
+void ReleaseFrame(void *item);
+void GX_STDC OnFrame(GX_FRAME_CALLBACK_PARAM *frame);
+GX_STATUS TriggerAndWait(struct gx_standin_s *source, int timeoutMs, struct test_frame_s **frame);
+void TestStatistics(void);
+void TestStaleFrame(void);
+void TestTriggeredFrames(void);
+void TestLateFrame(void);
+
+void SleepMs(int ms) {
+	
+#ifdef _WIN32
+	Sleep((DWORD)ms);
+#else
+	usleep((useconds_t)ms * 1000);
+#endif
+}
+
+double NowMs(void) {
+	
+	return GxStandInNowUs() / 1000.0;
+}
+
+struct test_frame_s* NewFrame(uint64_t frameId, double hostTimeMs) {
+	
+	struct test_frame_s *frame = (struct test_frame_s *)calloc(1, sizeof(struct test_frame_s));
+	
+	ATOMIC_STORE(&frame->Refs, 1);
+	frame->FrameId    = frameId;
+	frame->HostTimeMs = hostTimeMs;
+	ATOMIC_INCREMENT(&LiveFrames);
+	
+	return frame;
+}
+
+void AddRefFrame(void *item) {
+	
+	ATOMIC_INCREMENT(&((struct test_frame_s *)item)->Refs);
+}
+
+void ReleaseFrame(void *item) {
+	
+	struct test_frame_s *frame = (struct test_frame_s *)item;
+	
+	if (ATOMIC_DECREMENT(&frame->Refs) != 0) return;
+	
+	free(frame);
+	ATOMIC_DECREMENT(&LiveFrames);
+}
+
+// The stand-in's capture callback: ProcessFrame's part of the handoff
+void GX_STDC OnFrame(GX_FRAME_CALLBACK_PARAM *frame) {
+	
+	struct test_frame_s *processed = NewFrame(frame->nFrameID, NowMs());
+	
+	ATOMIC_INCREMENT(&Offered);
+	if (TriggerWaitDeliver(&Wait, processed, processed->HostTimeMs)) ATOMIC_INCREMENT(&Taken);
+	
+	// The display would own this reference
+	ReleaseFrame(processed);
+}
+
+// As the driver's TriggerAndWait, with the stand-in in place of the camera
+GX_STATUS TriggerAndWait(struct gx_standin_s *source, int timeoutMs, struct test_frame_s **frame) {
+	
+	void *triggered = NULL;
+	
+	*frame = NULL;
+	
+	TriggerWaitArm(&Wait);
+	
+	double triggerTimeMs = NowMs();
+	
+	GX_STATUS emStatus = GxStandInSendTrigger(source);
+	if (emStatus != GX_STATUS_SUCCESS) {
+		TriggerWaitDisarm(&Wait);
+		return emStatus;
+	}
+	
+	if (TriggerWaitFor(&Wait, triggerTimeMs, timeoutMs, &triggered) != OK) return GX_STATUS_TIMEOUT;
+	
+	*frame = (struct test_frame_s *)triggered;
+	
+	return GX_STATUS_SUCCESS;
+}
+
+// Made-up arrival times 10, 20 and 30 ms after the trigger: mean 20, jitter 10, min 10, max 30
+void TestStatistics(void) {
+	
+	void *item = NULL;
+	double meanMs = 0, jitterMs = 0, maxMs = 0;
+	
+	CHECK(TriggerWaitInit(&Wait, AddRefFrame, ReleaseFrame) == OK);
+	
+	// Not armed: nothing is taken
+	struct test_frame_s *frame = NewFrame(1, 0);
+	CHECK(TriggerWaitDeliver(&Wait, frame, 0) == FALSE && ATOMIC_LOAD(&frame->Refs) == 1);
+	ReleaseFrame(frame);
+	
+	for (int i = 1; i <= 3; i++) {
+		
+		frame = NewFrame(i, 0);
+		
+		TriggerWaitArm(&Wait);
+		CHECK(TriggerWaitDeliver(&Wait, frame, 100.0 * i + 10 * i) == TRUE);
+		CHECK(TriggerWaitDeliver(&Wait, frame, 0) == FALSE); // One frame per arm
+		ReleaseFrame(frame);
+		
+		CHECK(TriggerWaitFor(&Wait, 100.0 * i, 0, &item) == OK && item == frame);
+		ReleaseFrame(item);
+	}
+	
+	TriggerWaitLatency(&Wait, &meanMs, &jitterMs, &maxMs);
+	
+	CHECK(Wait.Stats.Triggers == 3 && Wait.Stats.Frames == 3 && Wait.Stats.Timeouts == 0);
+	CHECK(fabs(meanMs - 20) < 1e-9 && fabs(jitterMs - 10) < 1e-9 && maxMs == 30 && Wait.Stats.MinLatencyMs == 10);
+	
+	// Nothing delivered: timeout
+	TriggerWaitArm(&Wait);
+	CHECK(TriggerWaitFor(&Wait, 0, 10, &item) == CANCEL && item == NULL);
+	CHECK(Wait.Stats.Timeouts == 1 && Wait.Stats.Triggers == 4 && Wait.Stats.Frames == 3);
+	
+	TriggerWaitClose(&Wait);
+	CHECK(ATOMIC_LOAD(&LiveFrames) == 0);
+}
+
+// A frame handed over but never waited for is released by the next arm, not returned
+void TestStaleFrame(void) {
+	
+	void *item = NULL;
+	
+	CHECK(TriggerWaitInit(&Wait, AddRefFrame, ReleaseFrame) == OK);
+	
+	struct test_frame_s *stale = NewFrame(1, 0);
+	TriggerWaitArm(&Wait);
+	CHECK(TriggerWaitDeliver(&Wait, stale, 0) == TRUE);
+	ReleaseFrame(stale);
+	CHECK(ATOMIC_LOAD(&LiveFrames) == 1);
+	
+	TriggerWaitArm(&Wait);
+	CHECK(ATOMIC_LOAD(&LiveFrames) == 0);
+	
+	struct test_frame_s *fresh = NewFrame(2, 0);
+	CHECK(TriggerWaitDeliver(&Wait, fresh, 0) == TRUE);
+	CHECK(TriggerWaitFor(&Wait, 0, 100, &item) == OK && item == fresh);
+	ReleaseFrame(fresh);
+	ReleaseFrame(item);
+	
+	// Closing with a frame nobody took releases it
+	TriggerWaitArm(&Wait);
+	stale = NewFrame(3, 0);
+	TriggerWaitDeliver(&Wait, stale, 0);
+	ReleaseFrame(stale);
+	TriggerWaitClose(&Wait);
+	CHECK(ATOMIC_LOAD(&LiveFrames) == 0);
+}
+
+// One frame per trigger, the one the trigger caused, TEST_LATENCY_MS after it
+void TestTriggeredFrames(void) {
+	
+	struct gx_standin_s source;
+	struct test_frame_s *frame = NULL;
+	double meanMs = 0, jitterMs = 0, maxMs = 0;
+	
+	CHECK(TriggerWaitInit(&Wait, AddRefFrame, ReleaseFrame) == OK);
+	CHECK(GxStandInStartTriggered(&source, 0, TEST_HEIGHT, GX_PIXEL_FORMAT_MONO8, TEST_WIDTH * TEST_HEIGHT, TEST_LATENCY_MS, OnFrame, NULL) == CANCEL);
+	CHECK(GxStandInStartTriggered(&source, TEST_WIDTH, TEST_HEIGHT, GX_PIXEL_FORMAT_MONO8, TEST_WIDTH * TEST_HEIGHT, TEST_LATENCY_MS, OnFrame, NULL) == OK);
+	
+	// Triggered mode makes nothing on its own
+	SleepMs(100);
+	CHECK(ATOMIC_LOAD(&source.Generated) == 0);
+	
+	for (uint64_t i = 1; i <= 20; i++) {
+		
+		double triggerTimeMs = NowMs();
+		
+		CHECK(TriggerAndWait(&source, 1000, &frame) == GX_STATUS_SUCCESS);
+		if (frame == NULL) continue;
+		
+		CHECK(frame->FrameId == i);
+		CHECK(frame->HostTimeMs - triggerTimeMs >= TEST_LATENCY_MS);
+		ReleaseFrame(frame);
+	}
+	
+	TriggerWaitLatency(&Wait, &meanMs, &jitterMs, &maxMs);
+	printf("Trigger latency mean %.3f ms, jitter %.3f ms, min %.3f ms, max %.3f ms (stand-in %.1f ms)\n",
+		   meanMs, jitterMs, Wait.Stats.MinLatencyMs, maxMs, TEST_LATENCY_MS);
+	
+	CHECK(Wait.Stats.Frames == 20 && Wait.Stats.Timeouts == 0);
+	CHECK(Wait.Stats.MinLatencyMs >= TEST_LATENCY_MS && maxMs < TEST_LATENCY_MS + TEST_SLACK_MS);
+	CHECK(meanMs >= Wait.Stats.MinLatencyMs && meanMs <= maxMs);
+	
+	GxStandInStop(&source);
+	TriggerWaitClose(&Wait);
+	
+	CHECK(ATOMIC_LOAD(&source.Generated) == 20);
+	CHECK(ATOMIC_LOAD(&LiveFrames) == 0);
+}
+
+// The wait gives up before the frame comes: the late frame is not handed to the next wait
+void TestLateFrame(void) {
+	
+	struct gx_standin_s source;
+	struct test_frame_s *frame = NULL;
+	
+	ATOMIC_STORE(&Offered, 0);
+	ATOMIC_STORE(&Taken, 0);
+	
+	CHECK(TriggerWaitInit(&Wait, AddRefFrame, ReleaseFrame) == OK);
+	CHECK(GxStandInStartTriggered(&source, TEST_WIDTH, TEST_HEIGHT, GX_PIXEL_FORMAT_MONO8, TEST_WIDTH * TEST_HEIGHT, 150, OnFrame, NULL) == OK);
+	
+	CHECK(TriggerAndWait(&source, 30, &frame) == GX_STATUS_TIMEOUT && frame == NULL);
+	
+	// Frame 1 comes 120 ms after the wait gave up, nobody takes it
+	SleepMs(250);
+	CHECK(ATOMIC_LOAD(&Offered) == 1 && ATOMIC_LOAD(&Taken) == 0);
+	CHECK(ATOMIC_LOAD(&LiveFrames) == 0);
+	
+	// The next wait gets the frame of its own trigger
+	CHECK(TriggerAndWait(&source, 1000, &frame) == GX_STATUS_SUCCESS);
+	CHECK(frame != NULL && frame->FrameId == 2);
+	if (frame) ReleaseFrame(frame);
+	
+	CHECK(Wait.Stats.Triggers == 2 && Wait.Stats.Frames == 1 && Wait.Stats.Timeouts == 1);
+	
+	GxStandInStop(&source);
+	TriggerWaitClose(&Wait);
+	
+	CHECK(ATOMIC_LOAD(&LiveFrames) == 0);
+}
+
+int main(void) {
+	
+	TestStatistics();
+	TestStaleFrame();
+	TestTriggeredFrames();
+	TestLateFrame();
+	
+	printf("TRIGGER_WAIT: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+#include "../TRIPLE_BUFFER.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/***************************************************************************************************
+Triple buffer test. Checks the slot rotation on one thread, then runs a synthetic producer thread
+that stamps every word of the back slot with the frame number before publishing, against a consumer
+that reads the front slot as fast as it can. A frame whose words differ was torn (the producer wrote
+a slot the consumer held), a frame number that goes back was handed out of order.
+Standalone, no camera or CVI needed, see README.md. Prints the failed checks, returns 0 when all pass.
+Optional argument: frames to publish.
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+#define CHECK(cond) do { Checks++; if (!(cond)) { Failures++; printf("FAILED line %d: %s\n", __LINE__, #cond); } } while (0)
+
+#define TEST_SLOT_WORDS		1024		// Big enough for a torn write to show
+
+int Checks   = 0;
+int Failures = 0;
+
+struct triple_buffer_s Buffer;
+long Slots[3][TEST_SLOT_WORDS];
+long FramesToPublish = 500000;
+atomic_long_t ProducerDone;
+
+void TestRotation(void);
+void Produce(void);
+#ifdef _WIN32
+DWORD WINAPI ProducerThread(LPVOID param);
+#else
+void* ProducerThread(void *param);
+#endif
+void TestProducerConsumer(void);
+
+// Every step on one thread, where the slot each call hands out is known
+void TestRotation(void) {
+	
+	int isNew = TRUE;
+	
+	TripleBufferInit(&Buffer, Slots[0], Slots[1], Slots[2]);
+	
+	// Nothing published: the front is the initial slot 2, again and again
+	CHECK(TripleBufferFront(&Buffer, &isNew) == Slots[2] && !isNew);
+	CHECK(TripleBufferBack(&Buffer) == Slots[0]);
+	
+	TripleBufferPublish(&Buffer);
+	CHECK(TripleBufferBack(&Buffer) == Slots[1]);
+	CHECK(TripleBufferFront(&Buffer, &isNew) == Slots[0] && isNew);
+	CHECK(TripleBufferFront(&Buffer, &isNew) == Slots[0] && !isNew);
+	
+	// Two publishes before the consumer looks: the newest wins, the other is overwritten
+	TripleBufferPublish(&Buffer);
+	TripleBufferPublish(&Buffer);
+	CHECK(TripleBufferFront(&Buffer, &isNew) == Slots[2] && isNew);
+	CHECK(ATOMIC_LOAD(&Buffer.Published) == 3 && ATOMIC_LOAD(&Buffer.Overwritten) == 1);
+	
+	// The three slots stay distinct
+	CHECK(TripleBufferBack(&Buffer) != TripleBufferFront(&Buffer, NULL));
+	
+	TripleBufferSetBack(&Buffer, NULL);
+	CHECK(TripleBufferBack(&Buffer) == NULL);
+	CHECK(TripleBufferSlot(&Buffer, 3) == NULL);
+}
+
+void Produce(void) {
+	
+	for (long frame = 1; frame <= FramesToPublish; frame++) {
+		
+		long *words = (long *)TripleBufferBack(&Buffer);
+		
+		for (int i = 0; i < TEST_SLOT_WORDS; i++) words[i] = frame;
+		TripleBufferPublish(&Buffer);
+	}
+	
+	ATOMIC_STORE(&ProducerDone, TRUE);
+}
+
+#ifdef _WIN32
+DWORD WINAPI ProducerThread(LPVOID param) {
+	
+	Produce();
+	return 0;
+}
+#else
+void* ProducerThread(void *param) {
+	
+	Produce();
+	return NULL;
+}
+#endif
+
+void TestProducerConsumer(void) {
+	
+	long picked = 0, torn = 0, outOfOrder = 0, lastFrame = 0;
+	int isNew = FALSE, done = FALSE;
+	
+	memset(Slots, 0, sizeof(Slots));
+	TripleBufferInit(&Buffer, Slots[0], Slots[1], Slots[2]);
+	ATOMIC_STORE(&ProducerDone, FALSE);
+	
+#ifdef _WIN32
+	HANDLE thread = CreateThread(NULL, 0, ProducerThread, NULL, 0, NULL);
+	CHECK(thread != NULL);
+	if (!thread) return;
+#else
+	pthread_t thread;
+	CHECK(pthread_create(&thread, NULL, ProducerThread, NULL) == 0);
+#endif
+
+	// The done flag is read before the last look, so the final frame is always picked up
+	while (!done) {
+		
+		done = ATOMIC_LOAD(&ProducerDone);
+		
+		long *words = (long *)TripleBufferFront(&Buffer, &isNew);
+		long frame = words[0];
+		
+		for (int i = 1; i < TEST_SLOT_WORDS; i++) {
+			if (words[i] != frame) {
+				torn++;
+				break;
+			}
+		}
+		
+		if (!isNew) {
+			if (frame != lastFrame) outOfOrder++;
+			continue;
+		}
+		
+		if (frame <= lastFrame) outOfOrder++;
+		lastFrame = frame;
+		picked++;
+	}
+	
+#ifdef _WIN32
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, NULL);
+#endif
+
+	long published   = ATOMIC_LOAD(&Buffer.Published);
+	long overwritten = ATOMIC_LOAD(&Buffer.Overwritten);
+	
+	printf("%ld frames published, %ld picked up, %ld overwritten, %ld torn, %ld out of order\n",
+		   published, picked, overwritten, torn, outOfOrder);
+	
+	CHECK(torn == 0);
+	CHECK(outOfOrder == 0);
+	CHECK(lastFrame == FramesToPublish);
+	CHECK(published == FramesToPublish);
+	
+	// Every published frame was either picked up or replaced before that
+	CHECK(picked + overwritten == published);
+}
+
+int main(int argc, char *argv[]) {
+	
+	if (argc > 1) FramesToPublish = atol(argv[1]);
+	
+	TestRotation();
+	TestProducerConsumer();
+	
+	printf("TRIPLE_BUFFER: %d of %d checks passed\n", Checks - Failures, Checks);
+	
+	return Failures ? 1 : 0;
+}
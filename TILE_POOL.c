@@ -0,0 +1,348 @@
+#include "TILE_POOL.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/***************************************************************************************************
+Tile Pool Private Functions
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+// Packed unsigned: an end above 0x7FFF would overflow a signed shift into the sign bit
+#define TILE_RANGE(first, end)	(long)((unsigned long)(first) | ((unsigned long)(end) << 16))
+#define TILE_FIRST(range)		(int)((unsigned long)(range) & 0xFFFF)
+#define TILE_END(range)			(int)(((unsigned long)(range) >> 16) & 0xFFFF)
+
+// Wake/done signalling. Windows: one auto-reset event per helper and one for the end of the job.
+// Elsewhere: a job counter under a mutex, helpers wait for it to change.
+struct tile_sync_s {
+#ifdef _WIN32
+	HANDLE Wake[TILE_POOL_MAX_THREADS];
+	HANDLE Done;
+#else
+	pthread_mutex_t Lock;
+	pthread_cond_t Wake;
+	pthread_cond_t Done;
+	long Job;						// Jobs started
+	long JobDone;					// Jobs finished by every helper
+	pthread_t Thread[TILE_POOL_MAX_THREADS];
+#endif
+};
+
+int  TileTakeFirst(struct tile_worker_s *worker);
+int  TileTakeLast(struct tile_worker_s *worker);
+void TileRunBand(struct tile_worker_s *worker, int band);
+void TileWork(struct tile_worker_s *worker);
+int  TileWaitForJob(struct tile_worker_s *worker, long *job);
+void TileJobDone(struct tile_pool_s *pool);
+
+#ifdef _WIN32
+DWORD WINAPI TileThreadFunction(LPVOID parameter);
+#else
+void* TileThreadFunction(void *parameter);
+#endif
+
+/***************************************************************************************************
+Bands. Owner and thieves change a run with one compare-exchange of both ends, a band is taken once.
+****************************************************************************************************/
+
+// Next band of the worker's own run, -1 when it is empty
+int TileTakeFirst(struct tile_worker_s *worker) {
+	
+	for (;;) {
+		
+		long range = ATOMIC_LOAD(&worker->Range);
+		int first  = TILE_FIRST(range);
+		int end    = TILE_END(range);
+		
+		if (first >= end) return -1;
+		
+		if (ATOMIC_COMPARE_EXCHANGE(&worker->Range, TILE_RANGE(first + 1, end), range) == range) return first;
+	}
+}
+
+// Last band of another worker's run, -1 when it is empty
+int TileTakeLast(struct tile_worker_s *worker) {
+	
+	for (;;) {
+		
+		long range = ATOMIC_LOAD(&worker->Range);
+		int first  = TILE_FIRST(range);
+		int end    = TILE_END(range);
+		
+		if (first >= end) return -1;
+		
+		if (ATOMIC_COMPARE_EXCHANGE(&worker->Range, TILE_RANGE(first, end - 1), range) == range) return end - 1;
+	}
+}
+
+void TileRunBand(struct tile_worker_s *worker, int band) {
+	
+	struct tile_pool_s *pool = worker->Pool;
+	
+	int firstRow = band * pool->BandRows;
+	int lastRow  = firstRow + pool->BandRows;
+	
+	if (lastRow > pool->Rows) lastRow = pool->Rows;
+	
+	pool->Function(pool->Context, firstRow, lastRow, worker->Index);
+	worker->Bands++;
+}
+
+// Own bands first, then the others' from the far end, starting with the next worker
+void TileWork(struct tile_worker_s *worker) {
+	
+	struct tile_pool_s *pool = worker->Pool;
+	int band;
+	
+	worker->Bands  = 0;
+	worker->Stolen = 0;
+	
+	while ((band = TileTakeFirst(worker)) >= 0) TileRunBand(worker, band);
+	
+	for (int i = 1; i < pool->Threads; i++) {
+		
+		struct tile_worker_s *victim = &pool->Worker[(worker->Index + i) % pool->Threads];
+		
+		while ((band = TileTakeLast(victim)) >= 0) {
+			TileRunBand(worker, band);
+			worker->Stolen++;
+		}
+	}
+}
+
+/***************************************************************************************************
+Helper threads
+****************************************************************************************************/
+
+// Block until the next job (return TRUE) or until the pool is destroyed (return FALSE)
+int TileWaitForJob(struct tile_worker_s *worker, long *job) {
+	
+	struct tile_pool_s *pool = worker->Pool;
+	struct tile_sync_s *sync = (struct tile_sync_s *)pool->Sync;
+	
+#ifdef _WIN32
+	(void)job;
+	WaitForSingleObject(sync->Wake[worker->Index], INFINITE);
+#else
+	pthread_mutex_lock(&sync->Lock);
+	while (sync->Job == *job && !ATOMIC_LOAD(&pool->Quit)) pthread_cond_wait(&sync->Wake, &sync->Lock);
+	*job = sync->Job;
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+	
+	return !ATOMIC_LOAD(&pool->Quit);
+}
+
+// The last helper to finish wakes TilePoolRun
+void TileJobDone(struct tile_pool_s *pool) {
+	
+	struct tile_sync_s *sync = (struct tile_sync_s *)pool->Sync;
+	
+	if (ATOMIC_DECREMENT(&pool->Pending) != 0) return;
+	
+#ifdef _WIN32
+	SetEvent(sync->Done);
+#else
+	pthread_mutex_lock(&sync->Lock);
+	sync->JobDone = sync->Job;
+	pthread_cond_signal(&sync->Done);
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+}
+
+#ifdef _WIN32
+DWORD WINAPI TileThreadFunction(LPVOID parameter) {
+#else
+void* TileThreadFunction(void *parameter) {
+#endif
+	
+	struct tile_worker_s *worker = (struct tile_worker_s *)parameter;
+	long job = 0;
+	
+	while (TileWaitForJob(worker, &job)) {
+		
+		TileWork(worker);
+		TileJobDone(worker->Pool);
+	}
+	
+	return 0;
+}
+
+/***************************************************************************************************
+Tile Pool Public Functions
+****************************************************************************************************/
+
+int TilePoolCreate(struct tile_pool_s *pool, int threads) {
+	
+	memset(pool, 0, sizeof(*pool));
+	
+	if (threads < 1) threads = 1;
+	if (threads > TILE_POOL_MAX_THREADS) threads = TILE_POOL_MAX_THREADS;
+	
+	struct tile_sync_s *sync = (struct tile_sync_s *)calloc(1, sizeof(struct tile_sync_s));
+	if (sync == NULL) return CANCEL;
+	
+	pool->Sync = sync;
+	
+#ifdef _WIN32
+	sync->Done = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (sync->Done == NULL) {
+		TilePoolDestroy(pool);
+		return CANCEL;
+	}
+#else
+	pthread_mutex_init(&sync->Lock, NULL);
+	pthread_cond_init(&sync->Wake, NULL);
+	pthread_cond_init(&sync->Done, NULL);
+#endif
+	
+	for (int i = 0; i < threads; i++) {
+		pool->Worker[i].Index = i;
+		pool->Worker[i].Pool  = pool;
+	}
+	
+	// Worker 0 is whoever calls TilePoolRun
+	pool->Threads = 1;
+	
+	for (int i = 1; i < threads; i++) {
+		
+		struct tile_worker_s *worker = &pool->Worker[i];
+		
+#ifdef _WIN32
+		sync->Wake[i] = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if (sync->Wake[i] != NULL) worker->Thread = CreateThread(NULL, 0, TileThreadFunction, worker, 0, NULL);
+		if (worker->Thread == NULL) break;
+#else
+		if (pthread_create(&sync->Thread[i], NULL, TileThreadFunction, worker) != 0) break;
+		worker->Thread = &sync->Thread[i];
+#endif
+		
+		pool->Threads++;
+	}
+	
+	if (pool->Threads < threads) {
+		TilePoolDestroy(pool);
+		return CANCEL;
+	}
+	
+	return OK;
+}
+
+void TilePoolDestroy(struct tile_pool_s *pool) {
+	
+	struct tile_sync_s *sync = (struct tile_sync_s *)pool->Sync;
+	
+	if (sync == NULL) return;
+	
+	ATOMIC_STORE(&pool->Quit, 1);
+	
+#ifdef _WIN32
+	for (int i = 1; i < pool->Threads; i++) SetEvent(sync->Wake[i]);
+	
+	for (int i = 1; i < pool->Threads; i++) {
+		WaitForSingleObject((HANDLE)pool->Worker[i].Thread, INFINITE);
+		CloseHandle((HANDLE)pool->Worker[i].Thread);
+	}
+	
+	for (int i = 1; i < TILE_POOL_MAX_THREADS; i++) {
+		if (sync->Wake[i] != NULL) CloseHandle(sync->Wake[i]);
+	}
+	if (sync->Done != NULL) CloseHandle(sync->Done);
+#else
+	pthread_mutex_lock(&sync->Lock);
+	pthread_cond_broadcast(&sync->Wake);
+	pthread_mutex_unlock(&sync->Lock);
+	
+	for (int i = 1; i < pool->Threads; i++) pthread_join(sync->Thread[i], NULL);
+	
+	pthread_mutex_destroy(&sync->Lock);
+	pthread_cond_destroy(&sync->Wake);
+	pthread_cond_destroy(&sync->Done);
+#endif
+	
+	free(sync);
+	memset(pool, 0, sizeof(*pool));
+}
+
+int TilePoolRun(struct tile_pool_s *pool, int rows, int bandRows, tile_band_fn function, void *context) {
+	
+	if (function == NULL || rows < 0) return CANCEL;
+	if (rows == 0) return OK;
+	
+	int threads = pool->Threads > 1 ? pool->Threads : 1;
+	
+	// Without helpers there is nothing to split
+	if (threads == 1) {
+		function(context, 0, rows, 0);
+		return OK;
+	}
+	
+	if (bandRows <= 0) {
+		bandRows = rows / (threads * TILE_POOL_BANDS_PER_THREAD);
+		if (bandRows < TILE_POOL_MIN_BAND_ROWS) bandRows = TILE_POOL_MIN_BAND_ROWS;
+	}
+	if ((rows + bandRows - 1) / bandRows > TILE_POOL_MAX_BANDS) bandRows = (rows + TILE_POOL_MAX_BANDS - 1) / TILE_POOL_MAX_BANDS;
+	
+	int bands = (rows + bandRows - 1) / bandRows;
+	
+	pool->Function = function;
+	pool->Context  = context;
+	pool->Rows     = rows;
+	pool->BandRows = bandRows;
+	
+	// Equal runs of bands, the first ones get the remainder
+	for (int i = 0, first = 0; i < threads; i++) {
+		
+		int count = bands / threads + (i < bands % threads ? 1 : 0);
+		
+		ATOMIC_STORE(&pool->Worker[i].Range, TILE_RANGE(first, first + count));
+		first += count;
+	}
+	
+	ATOMIC_STORE(&pool->Pending, threads - 1);
+	
+	struct tile_sync_s *sync = (struct tile_sync_s *)pool->Sync;
+	
+#ifdef _WIN32
+	for (int i = 1; i < threads; i++) SetEvent(sync->Wake[i]);
+#else
+	pthread_mutex_lock(&sync->Lock);
+	sync->Job++;
+	pthread_cond_broadcast(&sync->Wake);
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+	
+	TileWork(&pool->Worker[0]);
+	
+	// Every band is taken, wait for the helpers still running theirs
+#ifdef _WIN32
+	WaitForSingleObject(sync->Done, INFINITE);
+#else
+	pthread_mutex_lock(&sync->Lock);
+	while (sync->JobDone != sync->Job) pthread_cond_wait(&sync->Done, &sync->Lock);
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+	
+	return OK;
+}
+
+int TilePoolProcessors(void) {
+	
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#endif
+}
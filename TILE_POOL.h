@@ -0,0 +1,64 @@
+#ifndef TILE_POOL_H
+#define TILE_POOL_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Tile Pool. A fixed set of worker threads that runs one job at a time over the rows of an image.
+
+TilePoolRun cuts the rows into bands and deals an equal run of bands to every worker, the calling
+thread being worker 0. A worker takes bands from the front of its own run and, when that is empty,
+steals from the back of the others' runs, so a worker that was held up (preempted, a busy core)
+does not hold up the frame. TilePoolRun returns when every band is done.
+
+The band function gets the worker index, for per-worker scratch memory. Bands must not depend on each
+other: each reads what it needs of the source (the halo rows above and below it included) and
+writes only its own rows, so the result does not depend on the thread count.
+****************************************************************************************************/
+
+#define TILE_POOL_MAX_THREADS		32
+#define TILE_POOL_MAX_BANDS			0xFFFF	// A run of bands is packed into 16 + 16 bits
+#define TILE_POOL_BANDS_PER_THREAD	8		// Default band size: the rows split into this many bands per worker
+#define TILE_POOL_MIN_BAND_ROWS		16
+
+typedef void (*tile_band_fn)(void *context, int firstRow, int lastRow, int worker);
+
+struct tile_pool_s;
+
+struct tile_worker_s {
+	
+	atomic_long_t Range;			// Bands not taken yet: first | end << 16
+	long Bands;						// Bands run in the last job, stolen ones included
+	long Stolen;					// Bands taken from other workers in the last job
+	void *Thread;					// NULL for worker 0, the caller of TilePoolRun
+	int Index;
+	struct tile_pool_s *Pool;
+};
+
+struct tile_pool_s {
+	
+	int Threads;					// Workers, the calling thread included. 0 = pool not created
+	struct tile_worker_s Worker[TILE_POOL_MAX_THREADS];
+	
+	// Job being run
+	tile_band_fn Function;
+	void *Context;
+	int Rows;
+	int BandRows;
+	
+	atomic_long_t Pending;			// Helper threads still on the job
+	atomic_long_t Quit;
+	void *Sync;						// Wake/done signalling, platform specific
+};
+
+/***************************************************************************************************
+Tile Pool Public Functions
+****************************************************************************************************/
+
+int  TilePoolCreate  (struct tile_pool_s *pool, int threads); // threads - 1 helper threads are started, OK or CANCEL
+void TilePoolDestroy (struct tile_pool_s *pool);
+int  TilePoolRun     (struct tile_pool_s *pool, int rows, int bandRows, tile_band_fn function, void *context); // bandRows 0 = default, OK or CANCEL
+int  TilePoolProcessors (void); // Logical processors of the host
+
+#endif
@@ -0,0 +1,89 @@
+#include "TONE_LUT.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/***************************************************************************************************
+Tone LUT Private Functions
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+void ToneLutBuild(struct tone_lut_s *lut);
+
+void ToneLutBuild(struct tone_lut_s *lut) {
+	
+	int entries   = 1 << lut->Bits;
+	double maxIn  = (double)(entries - 1);
+	double power  = 1.0 / lut->Gamma;
+	double slope  = (100.0 + lut->Contrast) / 100.0;
+	int identity  = TRUE;
+	
+	for (int i = 0; i < entries; i++) {
+		
+		double y = pow(i / maxIn, power);
+		y = (y - 0.5) * slope + 0.5;
+		
+		long v = lround(255.0 * y) + lut->Lightness;
+		if (v < 0) v = 0;
+		if (v > 255) v = 255;
+		
+		lut->Table[i] = (uint8_t)v;
+		if (v != i) identity = FALSE;
+	}
+	
+	lut->Identity = identity;
+	lut->Builds++;
+}
+
+/***************************************************************************************************
+Tone LUT Public Functions
+****************************************************************************************************/
+
+int ToneLutUpdate(struct tone_lut_s *lut, int bits, double gamma, int contrast, int lightness) {
+	
+	if (bits < 8 || bits > TONE_LUT_MAX_BITS) return CANCEL;
+	
+	if (gamma < 0.1) gamma = 0.1;
+	if (gamma > 10) gamma = 10;
+	if (contrast < -50) contrast = -50;
+	if (contrast > 100) contrast = 100;
+	if (lightness < -150) lightness = -150;
+	if (lightness > 150) lightness = 150;
+	
+	if (lut->Table != NULL && lut->Bits == bits && lut->Gamma == gamma && lut->Contrast == contrast && lut->Lightness == lightness) return OK;
+	
+	if (lut->Table == NULL || lut->Bits != bits) {
+		
+		free(lut->Table);
+		lut->Table = (uint8_t *)malloc((size_t)1 << bits);
+		if (lut->Table == NULL) {
+			lut->Bits = 0;
+			return CANCEL;
+		}
+	}
+	
+	lut->Bits      = bits;
+	lut->Gamma     = gamma;
+	lut->Contrast  = contrast;
+	lut->Lightness = lightness;
+	
+	ToneLutBuild(lut);
+	return OK;
+}
+
+void ToneLutFree(struct tone_lut_s *lut) {
+	
+	free(lut->Table);
+	memset(lut, 0, sizeof(*lut));
+}
+
+const uint8_t* ToneLutTable(const struct tone_lut_s *lut) {
+	
+	if (lut->Table == NULL || lut->Identity) return NULL;
+	
+	return lut->Table;
+}
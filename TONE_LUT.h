@@ -0,0 +1,41 @@
+#ifndef TONE_LUT_H
+#define TONE_LUT_H
+
+#include <stdint.h>
+
+/***************************************************************************************************
+Tone LUT. Maps raw pixel values (8 bits: 256 entries, 10/12 bits: 1024/4096 entries) to the 8-bit
+display value with gamma, contrast and lightness applied, the parameters of DxGetLut:
+
+ x = in / (2^bits - 1)
+ y = x^(1/gamma)                                  gamma 0.1 .. 10, 1 = none
+ y = (y - 0.5) * (100 + contrast) / 100 + 0.5     contrast -50 .. 100, 0 = none
+ out = round(255 * y) + lightness, clamped        lightness -150 .. 150, 0 = none
+
+The table is applied to the raw Bayer/mono values as they are read (DemosaicRows, DemosaicMapRow),
+no extra pass over the frame. ToneLutUpdate only rebuilds it when the bit depth or a parameter
+changed, call it once per frame.
+****************************************************************************************************/
+
+#define TONE_LUT_MAX_BITS	16
+
+struct tone_lut_s {
+	
+	uint8_t *Table;				// 2^Bits entries, NULL until the first ToneLutUpdate
+	int Bits;					// Source bits the table is for
+	int Identity;				// 8 bits with neutral parameters: the table changes nothing
+	double Gamma;				// Parameters the table was built with
+	int Contrast;
+	int Lightness;
+	long Builds;				// Times the table was (re)built
+};
+
+/***************************************************************************************************
+Tone LUT Public Functions
+****************************************************************************************************/
+
+int  ToneLutUpdate (struct tone_lut_s *lut, int bits, double gamma, int contrast, int lightness); // OK or CANCEL, parameters are clamped to their range
+void ToneLutFree   (struct tone_lut_s *lut);
+const uint8_t* ToneLutTable (const struct tone_lut_s *lut); // NULL when it changes nothing (8-bit identity) or is not built
+
+#endif
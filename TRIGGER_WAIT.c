@@ -0,0 +1,260 @@
+#include "TRIGGER_WAIT.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+/***************************************************************************************************
+Trigger Handoff Private Functions And Variables
+****************************************************************************************************/
+
+#define TRUE        1
+#define FALSE       0
+#define CANCEL      -1
+#define OK			1
+
+// Windows: a critical section and an auto-reset event set for every handed over frame.
+// Elsewhere: a mutex and a condition variable.
+struct trigger_wait_sync_s {
+#ifdef _WIN32
+	CRITICAL_SECTION Lock;
+	HANDLE ItemReady;
+#else
+	pthread_mutex_t Lock;
+	pthread_cond_t ItemReady;
+#endif
+};
+
+void* TriggerWaitTake(struct trigger_wait_s *wait, double *timeMs);
+void* TriggerWaitBlock(struct trigger_wait_s *wait, int timeoutMs, double *timeMs);
+
+// The handed over frame, NULL if none
+void* TriggerWaitTake(struct trigger_wait_s *wait, double *timeMs) {
+	
+	struct trigger_wait_sync_s *sync = (struct trigger_wait_sync_s *)wait->Sync;
+	void *item = NULL;
+	
+#ifdef _WIN32
+	EnterCriticalSection(&sync->Lock);
+#else
+	pthread_mutex_lock(&sync->Lock);
+#endif
+
+	item       = wait->Item;
+	*timeMs    = wait->ItemTimeMs;
+	wait->Item = NULL;
+	
+#ifdef _WIN32
+	LeaveCriticalSection(&sync->Lock);
+#else
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+
+	return item;
+}
+
+// Waits up to timeoutMs (< 0 = forever) for a handed over frame
+void* TriggerWaitBlock(struct trigger_wait_s *wait, int timeoutMs, double *timeMs) {
+	
+	struct trigger_wait_sync_s *sync = (struct trigger_wait_sync_s *)wait->Sync;
+	void *item = NULL;
+	
+#ifdef _WIN32
+	DWORD startMs = GetTickCount();
+	
+	while ((item = TriggerWaitTake(wait, timeMs)) == NULL) {
+		
+		DWORD waitMs = INFINITE;
+		
+		if (timeoutMs >= 0) {
+			DWORD elapsedMs = GetTickCount() - startMs;
+			if (elapsedMs >= (DWORD)timeoutMs) break;
+			waitMs = (DWORD)timeoutMs - elapsedMs;
+		}
+		
+		// The event can still be set by a frame an earlier TriggerWaitArm released, the loop looks again
+		WaitForSingleObject(sync->ItemReady, waitMs);
+	}
+#else
+	struct timespec until;
+	
+	clock_gettime(CLOCK_REALTIME, &until);
+	until.tv_sec  += timeoutMs / 1000;
+	until.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+	if (until.tv_nsec >= 1000000000L) {
+		until.tv_sec++;
+		until.tv_nsec -= 1000000000L;
+	}
+	
+	pthread_mutex_lock(&sync->Lock);
+	
+	while (wait->Item == NULL) {
+		if (timeoutMs < 0) pthread_cond_wait(&sync->ItemReady, &sync->Lock);
+		else if (pthread_cond_timedwait(&sync->ItemReady, &sync->Lock, &until) != 0) break;
+	}
+	
+	item       = wait->Item;
+	*timeMs    = wait->ItemTimeMs;
+	wait->Item = NULL;
+	
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+
+	return item;
+}
+
+/***************************************************************************************************
+Setup
+****************************************************************************************************/
+
+int TriggerWaitInit(struct trigger_wait_s *wait, TriggerItemCallback addRef, TriggerItemCallback release) {
+	
+	memset(wait, 0, sizeof(*wait));
+	
+	struct trigger_wait_sync_s *sync = (struct trigger_wait_sync_s *)calloc(1, sizeof(struct trigger_wait_sync_s));
+	if (sync == NULL) return CANCEL;
+	
+#ifdef _WIN32
+	sync->ItemReady = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (sync->ItemReady == NULL) {
+		free(sync);
+		return CANCEL;
+	}
+	InitializeCriticalSection(&sync->Lock);
+#else
+	pthread_mutex_init(&sync->Lock, NULL);
+	pthread_cond_init(&sync->ItemReady, NULL);
+#endif
+
+	wait->AddRef  = addRef;
+	wait->Release = release;
+	wait->Sync    = sync;
+	
+	return OK;
+}
+
+// No wait and no delivery may be running
+void TriggerWaitClose(struct trigger_wait_s *wait) {
+	
+	struct trigger_wait_sync_s *sync = (struct trigger_wait_sync_s *)wait->Sync;
+	
+	if (sync == NULL) return;
+	
+	ATOMIC_STORE(&wait->Armed, 0);
+	if (wait->Item != NULL) wait->Release(wait->Item);
+	wait->Item = NULL;
+	
+#ifdef _WIN32
+	DeleteCriticalSection(&sync->Lock);
+	CloseHandle(sync->ItemReady);
+#else
+	pthread_mutex_destroy(&sync->Lock);
+	pthread_cond_destroy(&sync->ItemReady);
+#endif
+
+	free(sync);
+	wait->Sync = NULL;
+}
+
+/***************************************************************************************************
+Waiter side. Only one thread may wait at a time.
+****************************************************************************************************/
+
+void TriggerWaitArm(struct trigger_wait_s *wait) {
+	
+	double timeMs = 0;
+	
+	// A frame of an earlier trigger that nobody took is not ours
+	void *stale = TriggerWaitTake(wait, &timeMs);
+	if (stale != NULL) wait->Release(stale);
+	
+	ATOMIC_STORE(&wait->Armed, 1);
+}
+
+void TriggerWaitDisarm(struct trigger_wait_s *wait) {
+	
+	ATOMIC_STORE(&wait->Armed, 0);
+}
+
+int TriggerWaitFor(struct trigger_wait_s *wait, double triggerTimeMs, int timeoutMs, void **item) {
+	
+	struct trigger_stats_s *stats = &wait->Stats;
+	double timeMs = 0;
+	
+	*item = NULL;
+	stats->Triggers++;
+	
+	void *triggered = TriggerWaitBlock(wait, timeoutMs, &timeMs);
+	
+	if (triggered == NULL) {
+		
+		// Disarm. If the acquisition thread got there first its frame is on the way, take it.
+		if (ATOMIC_EXCHANGE(&wait->Armed, 0) != 0) {
+			stats->Timeouts++;
+			return CANCEL;
+		}
+		
+		triggered = TriggerWaitBlock(wait, -1, &timeMs);
+	}
+	
+	// Latency statistics (Welford)
+	double latency = timeMs - triggerTimeMs;
+	double delta   = latency - stats->MeanLatencyMs;
+	
+	stats->Frames++;
+	stats->MeanLatencyMs += delta / (double)stats->Frames;
+	stats->M2 += delta * (latency - stats->MeanLatencyMs);
+	if (stats->Frames == 1 || latency < stats->MinLatencyMs) stats->MinLatencyMs = latency;
+	if (latency > stats->MaxLatencyMs) stats->MaxLatencyMs = latency;
+	
+	*item = triggered;
+	
+	return OK;
+}
+
+void TriggerWaitLatency(struct trigger_wait_s *wait, double *meanMs, double *jitterMs, double *maxMs) {
+	
+	struct trigger_stats_s *stats = &wait->Stats;
+	
+	*meanMs   = stats->MeanLatencyMs;
+	*jitterMs = (stats->Frames > 1) ? sqrt(stats->M2 / (double)(stats->Frames - 1)) : 0;
+	*maxMs    = stats->MaxLatencyMs;
+}
+
+/***************************************************************************************************
+Acquisition side. Called for every complete frame, costs an atomic load while nobody waits.
+****************************************************************************************************/
+
+int TriggerWaitDeliver(struct trigger_wait_s *wait, void *item, double timeMs) {
+	
+	struct trigger_wait_sync_s *sync = (struct trigger_wait_sync_s *)wait->Sync;
+	
+	if (sync == NULL || !ATOMIC_LOAD(&wait->Armed)) return FALSE;
+	
+	// Only one frame per arm, and none after the wait timed out
+	if (ATOMIC_COMPARE_EXCHANGE(&wait->Armed, 0, 1) != 1) return FALSE;
+	
+	wait->AddRef(item);
+	
+#ifdef _WIN32
+	EnterCriticalSection(&sync->Lock);
+	wait->Item       = item;
+	wait->ItemTimeMs = timeMs;
+	LeaveCriticalSection(&sync->Lock);
+	SetEvent(sync->ItemReady);
+#else
+	pthread_mutex_lock(&sync->Lock);
+	wait->Item       = item;
+	wait->ItemTimeMs = timeMs;
+	pthread_cond_signal(&sync->ItemReady);
+	pthread_mutex_unlock(&sync->Lock);
+#endif
+
+	return TRUE;
+}
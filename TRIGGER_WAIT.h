@@ -0,0 +1,59 @@
+#ifndef TRIGGER_WAIT_H
+#define TRIGGER_WAIT_H
+
+#include <stdint.h>
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Trigger handoff. One thread arms, fires a trigger and waits for the frame it caused; the acquisition
+thread offers every frame and the first one that arrives while armed is handed over, with a
+reference taken for the waiter:
+
+ waiter       TriggerWaitArm -> fire the trigger -> TriggerWaitFor (OK with the frame, or timeout)
+ acquisition  TriggerWaitDeliver for every frame, only takes it while armed
+
+A timed out wait disarms, so a frame that comes late is never handed over: the acquisition thread
+keeps (and releases) its own reference and the next wait gets the frame of its own trigger. If the
+frame was already on its way when the timeout hit, the wait takes it after all.
+Win32 event / pthreads condition variable, the handoff runs without CVI or a camera.
+****************************************************************************************************/
+
+// Trigger-to-frame latency of the waits
+struct trigger_stats_s {
+	int64_t Triggers;
+	int64_t Frames;
+	int64_t Timeouts;
+	double MeanLatencyMs;
+	double M2;					// Sum of squared latency deviations (Welford)
+	double MinLatencyMs;
+	double MaxLatencyMs;
+};
+
+typedef void (*TriggerItemCallback)(void *item);
+
+struct trigger_wait_s {
+	
+	atomic_long_t Armed;			// Set by TriggerWaitArm, cleared by the delivery or the timeout
+	void *Item;						// Handed over frame, under the lock
+	double ItemTimeMs;				// Its arrival time, clock of the trigger time
+	
+	TriggerItemCallback AddRef;		// Reference for the waiter
+	TriggerItemCallback Release;
+	
+	struct trigger_stats_s Stats;
+	void *Sync;						// Lock and wake-up, platform specific. NULL = not initialized
+};
+
+/***************************************************************************************************
+Trigger Handoff Public Functions
+****************************************************************************************************/
+
+int  TriggerWaitInit    (struct trigger_wait_s *wait, TriggerItemCallback addRef, TriggerItemCallback release); // OK or CANCEL
+void TriggerWaitClose   (struct trigger_wait_s *wait); // Releases a frame nobody picked up
+void TriggerWaitArm     (struct trigger_wait_s *wait); // Before firing the trigger
+void TriggerWaitDisarm  (struct trigger_wait_s *wait); // The trigger could not be fired
+int  TriggerWaitDeliver (struct trigger_wait_s *wait, void *item, double timeMs); // TRUE if handed over
+int  TriggerWaitFor     (struct trigger_wait_s *wait, double triggerTimeMs, int timeoutMs, void **item); // OK, CANCEL = timeout
+void TriggerWaitLatency (struct trigger_wait_s *wait, double *meanMs, double *jitterMs, double *maxMs);
+
+#endif
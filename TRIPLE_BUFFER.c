@@ -0,0 +1,77 @@
+#include "TRIPLE_BUFFER.h"
+#include <stddef.h>
+
+/***************************************************************************************************
+Setup. Must not race with the producer or consumer (call it before starting the acquisition).
+****************************************************************************************************/
+
+void TripleBufferInit(struct triple_buffer_s *tb, void *slot0, void *slot1, void *slot2) {
+	
+	tb->Slots[0] = slot0;
+	tb->Slots[1] = slot1;
+	tb->Slots[2] = slot2;
+	
+	tb->BackIndex  = 0;
+	tb->FrontIndex = 2;
+	
+	ATOMIC_STORE(&tb->MiddleState, 1); // Slot 1 is the middle, nothing published yet
+	ATOMIC_STORE(&tb->Published, 0);
+	ATOMIC_STORE(&tb->Overwritten, 0);
+}
+
+void* TripleBufferSlot(struct triple_buffer_s *tb, int index) {
+	
+	if (index < 0 || index > 2) return NULL;
+	
+	return tb->Slots[index];
+}
+
+/***************************************************************************************************
+Producer side. Only one thread may call these.
+****************************************************************************************************/
+
+void* TripleBufferBack(struct triple_buffer_s *tb) {
+	
+	return tb->Slots[tb->BackIndex];
+}
+
+void TripleBufferSetBack(struct triple_buffer_s *tb, void *item) {
+	
+	tb->Slots[tb->BackIndex] = item;
+}
+
+void TripleBufferPublish(struct triple_buffer_s *tb) {
+	
+	// Swap back and middle. The exchange is a full barrier, so the frame data written
+	// into the back slot is visible before the consumer can see the new middle index.
+	long previous = ATOMIC_EXCHANGE(&tb->MiddleState, tb->BackIndex | TRIPLE_BUFFER_FRESH);
+	
+	tb->BackIndex = (int)(previous & TRIPLE_BUFFER_INDEX_MASK);
+	
+	ATOMIC_INCREMENT(&tb->Published);
+	
+	// The consumer never picked up the previous frame
+	if (previous & TRIPLE_BUFFER_FRESH) ATOMIC_INCREMENT(&tb->Overwritten);
+}
+
+/***************************************************************************************************
+Consumer side. Only one thread may call this. Never blocks: if nothing new was published the
+current front slot is returned again and isNew is set to 0.
+****************************************************************************************************/
+
+void* TripleBufferFront(struct triple_buffer_s *tb, int *isNew) {
+	
+	if (isNew) *isNew = 0;
+	
+	if ((ATOMIC_LOAD(&tb->MiddleState) & TRIPLE_BUFFER_FRESH) == 0) return tb->Slots[tb->FrontIndex];
+	
+	// Swap front and middle, clearing the fresh flag. Only the consumer clears it,
+	// so the middle we get back is always a freshly published frame.
+	long previous = ATOMIC_EXCHANGE(&tb->MiddleState, tb->FrontIndex);
+	
+	tb->FrontIndex = (int)(previous & TRIPLE_BUFFER_INDEX_MASK);
+	
+	if (isNew) *isNew = 1;
+	
+	return tb->Slots[tb->FrontIndex];
+}
@@ -0,0 +1,43 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include "ATOMIC_OPS.h"
+
+/***************************************************************************************************
+Lock-free triple buffer. Hands frames from one producer (the frame callback) to one consumer
+(the display timer) without either side ever blocking.
+
+The producer always owns the back slot and the consumer always owns the front slot. The third
+slot ("middle") is swapped atomically: Publish swaps the back slot with the middle and marks it
+fresh, Front swaps the middle with the front if something fresh was published. The consumer
+therefore always gets the newest complete frame, and frames it never saw are simply overwritten.
+****************************************************************************************************/
+
+#define TRIPLE_BUFFER_INDEX_MASK  0x3 // Middle slot index
+#define TRIPLE_BUFFER_FRESH       0x4 // Middle slot holds a frame the consumer has not picked up yet
+
+struct triple_buffer_s {
+	
+	void *Slots[3];					// Whatever the slots hold (image buffers, frames...)
+	
+	int BackIndex;					// Slot being written. Producer only
+	int FrontIndex;					// Slot being displayed. Consumer only
+	atomic_long_t MiddleState;		// Middle slot index + fresh flag, only ever changed with an atomic exchange
+	
+	// Statistics
+	atomic_long_t Published;		// Frames published by the producer
+	atomic_long_t Overwritten;		// Frames published and replaced before the consumer picked them up
+};
+
+/***************************************************************************************************
+Triple Buffer Public Functions
+****************************************************************************************************/
+
+void  TripleBufferInit    (struct triple_buffer_s *tb, void *slot0, void *slot1, void *slot2);
+void* TripleBufferBack    (struct triple_buffer_s *tb); // Producer: slot to write the next frame into
+void  TripleBufferSetBack (struct triple_buffer_s *tb, void *item); // Producer: replace the back slot item
+void  TripleBufferPublish (struct triple_buffer_s *tb); // Producer: make the back slot the newest frame
+void* TripleBufferFront   (struct triple_buffer_s *tb, int *isNew); // Consumer: newest complete frame
+void* TripleBufferSlot    (struct triple_buffer_s *tb, int index); // Raw access for setup/teardown
+
+#endif
@@ -1,70 +1,70 @@
-//==============================================================================
-//
-// Title:		camera_test_program
-// Purpose:		A short description of the application.
-//
-// Created on:	12/27/2024 at 11:30:31 AM by jwatts.
-// Copyright:	. All Rights Reserved.
-//
-//==============================================================================
-
-//==============================================================================
-// Include files
-
-#include <ansi_c.h>
-#include <cvirte.h>		
-#include <userint.h>
-#include "camera_test_program.h"
-#include "toolbox.h"
-
-//==============================================================================
-// Constants
-
-//==============================================================================
-// Types
-
-//==============================================================================
-// Static global variables
-
-static int panelHandle = 0;
-
-//==============================================================================
-// Static functions
-
-//==============================================================================
-// Global variables
-
-//==============================================================================
-// Global functions
-
-/// HIFN The main entry-point function.
-int main (int argc, char *argv[])
-{
-	int error = 0;
-	
-	/* initialize and load resources */
-	nullChk (InitCVIRTE (0, argv, 0));
-	errChk (panelHandle = LoadPanel (0, "camera_test_program.uir", PANEL));
-	
-	/* display the panel and run the user interface */
-	errChk (DisplayPanel (panelHandle));
-	errChk (RunUserInterface ());
-
-Error:
-	/* clean up */
-	if (panelHandle > 0)
-		DiscardPanel (panelHandle);
-	return 0;
-}
-
-//==============================================================================
-// UI callback function prototypes
-
-/// HIFN Exit when the user dismisses the panel.
-int CVICALLBACK panelCB (int panel, int event, void *callbackData,
-		int eventData1, int eventData2)
-{
-	if (event == EVENT_CLOSE)
-		QuitUserInterface (0);
-	return 0;
-}
+//==============================================================================
+//
+// Title:		camera_test_program
+// Purpose:		A short description of the application.
+//
+// Created on:	12/27/2024 at 11:30:31 AM by jwatts.
+// Copyright:	. All Rights Reserved.
+//
+//==============================================================================
+
+//==============================================================================
+// Include files
+
+#include <ansi_c.h>
+#include <cvirte.h>		
+#include <userint.h>
+#include "camera_test_program.h"
+#include "toolbox.h"
+
+//==============================================================================
+// Constants
+
+//==============================================================================
+// Types
+
+//==============================================================================
+// Static global variables
+
+static int panelHandle = 0;
+
+//==============================================================================
+// Static functions
+
+//==============================================================================
+// Global variables
+
+//==============================================================================
+// Global functions
+
+/// HIFN The main entry-point function.
+int main (int argc, char *argv[])
+{
+	int error = 0;
+	
+	/* initialize and load resources */
+	nullChk (InitCVIRTE (0, argv, 0));
+	errChk (panelHandle = LoadPanel (0, "camera_test_program.uir", PANEL));
+	
+	/* display the panel and run the user interface */
+	errChk (DisplayPanel (panelHandle));
+	errChk (RunUserInterface ());
+
+Error:
+	/* clean up */
+	if (panelHandle > 0)
+		DiscardPanel (panelHandle);
+	return 0;
+}
+
+//==============================================================================
+// UI callback function prototypes
+
+/// HIFN Exit when the user dismisses the panel.
+int CVICALLBACK panelCB (int panel, int event, void *callbackData,
+		int eventData1, int eventData2)
+{
+	if (event == EVENT_CLOSE)
+		QuitUserInterface (0);
+	return 0;
+}